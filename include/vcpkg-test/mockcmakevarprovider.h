@@ -2,6 +2,7 @@
 
 #include <vcpkg/cmakevars.h>
 #include <vcpkg/dependencies.h>
+#include <vcpkg/platform-expression.h>
 
 namespace vcpkg::Test
 {
@@ -13,9 +14,12 @@ namespace vcpkg::Test
         void load_tag_vars(View<FullPackageSpec> specs, Triplet host_triplet) const override;
         const SMap* get_generic_triplet_vars(Triplet triplet) const override;
         const SMap* get_dep_info_vars(const PackageSpec& spec) const override;
+        const PlatformExpression::ContextIdentifiers* get_dep_info_identifiers(const PackageSpec& spec) const override;
         const SMap* get_tag_vars(const PackageSpec& spec) const override;
 
         mutable std::unordered_map<PackageSpec, SMap> dep_info_vars;
+        // reduced from dep_info_vars on every call, as tests modify dep_info_vars directly
+        mutable std::unordered_map<PackageSpec, PlatformExpression::ContextIdentifiers> dep_info_identifiers;
         mutable std::unordered_map<PackageSpec, SMap> tag_vars;
         mutable std::unordered_map<Triplet, SMap> generic_triplet_vars;
     };
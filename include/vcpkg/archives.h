@@ -64,7 +64,13 @@ namespace vcpkg
                                        const Path& source,
                                        const Path& destination) const;
 
-        Command decompress_zip_archive_cmd(const Path& dst, const Path& archive_path) const;
+        // Extract the zip archive `archive_path` into the existing directory `dst`, decompressing entries on up to
+        // `max_concurrency` threads. Callers extracting several archives at once should pass 1.
+        bool decompress_zip_archive(DiagnosticContext& context,
+                                    const Filesystem& fs,
+                                    const Path& dst,
+                                    const Path& archive_path,
+                                    size_t max_concurrency) const;
 
     private:
 #if defined _WIN32
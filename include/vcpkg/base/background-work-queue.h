@@ -2,6 +2,7 @@
 
 #include <condition_variable>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 template<class WorkItem>
@@ -36,6 +37,28 @@ struct BackgroundWorkQueue
         }
     }
 
+    // Like get_work, but takes only the oldest item, so that several consumers can share the queue.
+    bool get_one(WorkItem& out)
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        for (;;)
+        {
+            if (!m_tasks.empty())
+            {
+                out = std::move(m_tasks.front());
+                m_tasks.erase(m_tasks.begin());
+                return true;
+            }
+
+            if (!m_running)
+            {
+                return false;
+            }
+
+            m_cv.wait(lock);
+        }
+    }
+
     void stop()
     {
         std::lock_guard<std::mutex> lock(m_mtx);
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <vcpkg/base/delayed-init.h>
+
 #include <map>
+#include <mutex>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -49,4 +53,45 @@ namespace vcpkg
     private:
         mutable std::map<Key, Value, Compare> m_cache;
     };
+
+    // Like Cache, but get_lazy may be called from several threads at once. Values for different keys are computed
+    // concurrently; a caller asking for a key whose value is already being computed waits for that computation.
+    template<class Key, class Value, class Compare = std::less<>>
+    struct ConcurrentCache
+    {
+        ConcurrentCache() = default;
+        // Moving is only allowed before the cache is shared between threads, so that caches can be nested
+        ConcurrentCache(ConcurrentCache&& other) : m_cache(std::move(other.m_cache)) { }
+        ConcurrentCache& operator=(ConcurrentCache&& other)
+        {
+            m_cache = std::move(other.m_cache);
+            return *this;
+        }
+
+        template<class KeyIsh,
+                 class F,
+                 std::enable_if_t<std::is_constructible_v<Key, const KeyIsh&> &&
+                                      detail::is_callable<Compare&, const Key&, const KeyIsh&>::value,
+                                  int> = 0>
+        const Value& get_lazy(const KeyIsh& k, F&& f) const
+        {
+            const DelayedInit<Value>* entry;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_cache.lower_bound(k);
+                if (it == m_cache.end() || m_cache.key_comp()(k, it->first))
+                {
+                    it = m_cache.emplace_hint(it, std::piecewise_construct, std::forward_as_tuple(k), std::tuple<>());
+                }
+
+                entry = &it->second;
+            }
+
+            return entry->get(static_cast<F&&>(f));
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        mutable std::map<Key, DelayedInit<Value>, Compare> m_cache;
+    };
 }
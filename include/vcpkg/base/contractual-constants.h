@@ -342,6 +342,8 @@ namespace vcpkg
     inline constexpr StringLiteral FileBaselineDotJson = "baseline.json";
     inline constexpr StringLiteral FileBin = "bin";
     inline constexpr StringLiteral FileBuildInfo = "BUILD_INFO";
+    inline constexpr StringLiteral FileCMakeVarsCacheDotJson = "cmake-vars-cache.json";
+    inline constexpr StringLiteral FileCompilerInfoCacheDotJson = "compiler-info-cache.json";
     inline constexpr StringLiteral FileCompilerFileHashCacheDotJson = "compiler-file-hash-cache.json";
     inline constexpr StringLiteral FileControl = "CONTROL";
     inline constexpr StringLiteral FileCopying = "COPYING";
@@ -349,9 +351,11 @@ namespace vcpkg
     inline constexpr StringLiteral FileDebug = "debug";
     inline constexpr StringLiteral FileDetectCompiler = "detect_compiler";
     inline constexpr StringLiteral FileDotDsStore = ".DS_Store";
+    inline constexpr StringLiteral FileFileHashCacheDotJson = "file-hash-cache.json";
     inline constexpr StringLiteral FileInclude = "include";
     inline constexpr StringLiteral FileIncomplete = "incomplete";
     inline constexpr StringLiteral FileInfo = "info";
+    inline constexpr StringLiteral FileInstalledFileIndex = "installed-file-index";
     inline constexpr StringLiteral FileIssueBodyMD = "issue_body.md";
     inline constexpr StringLiteral FileLicense = "LICENSE";
     inline constexpr StringLiteral FileLicenseDotTxt = "LICENSE.txt";
@@ -361,6 +365,8 @@ namespace vcpkg
     inline constexpr StringLiteral FileShare = "share";
     inline constexpr StringLiteral FileStatus = "status";
     inline constexpr StringLiteral FileStatusNew = "status-new";
+    inline constexpr StringLiteral FileStatusSnapshot = "status-snapshot";
+    inline constexpr StringLiteral FileStatusSnapshotNew = "status-snapshot-new";
     inline constexpr StringLiteral FileTestedSpecDotTxt = "tested-spec.txt";
     inline constexpr StringLiteral FileTools = "tools";
     inline constexpr StringLiteral FileUpdates = "updates";
@@ -379,6 +385,7 @@ namespace vcpkg
     inline constexpr StringLiteral FileVcpkgSpdxJson = "vcpkg.spdx.json";
     inline constexpr StringLiteral FileVcpkgUserProps = "vcpkg.user.props";
     inline constexpr StringLiteral FileVcpkgUserTargets = "vcpkg.user.targets";
+    inline constexpr StringLiteral FileVerifiedGitTreesDotJson = "verified-git-trees.json";
     inline constexpr StringLiteral FileVersions = "versions";
 
     // CMake variables are usually ALL_CAPS_WITH_UNDERSCORES
@@ -568,6 +575,12 @@ namespace vcpkg
     inline constexpr StringLiteral EnvironmentVariableVsLang = "VSLANG";
     inline constexpr StringLiteral EnvironmentVariableVscmdArgTgtArch = "VSCMD_ARG_TGT_ARCH";
     inline constexpr StringLiteral EnvironmentVariableXVcpkgAssetSources = "X_VCPKG_ASSET_SOURCES";
+    inline constexpr StringLiteral EnvironmentVariableXVcpkgBinaryCachePushConcurrency =
+        "X_VCPKG_BINARY_CACHE_PUSH_CONCURRENCY";
+    inline constexpr StringLiteral EnvironmentVariableXVcpkgBuildConcurrency = "X_VCPKG_BUILD_CONCURRENCY";
+    inline constexpr StringLiteral EnvironmentVariableXVcpkgCMakeVarsCache = "X_VCPKG_CMAKE_VARS_CACHE";
+    inline constexpr StringLiteral EnvironmentVariableXVcpkgFileHashCache = "X_VCPKG_FILE_HASH_CACHE";
+    inline constexpr StringLiteral EnvironmentVariableXVcpkgGitObjectReader = "X_VCPKG_GIT_OBJECT_READER";
     inline constexpr StringLiteral EnvironmentVariableXVcpkgIgnoreLockFailures = "X_VCPKG_IGNORE_LOCK_FAILURES";
     inline constexpr StringLiteral EnvironmentVariableXVcpkgNuGetIDPrefix = "X_VCPKG_NUGET_ID_PREFIX";
     inline constexpr StringLiteral EnvironmentVariableXVcpkgRecursiveData = "X_VCPKG_RECURSIVE_DATA";
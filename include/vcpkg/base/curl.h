@@ -3,9 +3,11 @@
 #include <vcpkg/base/fwd/span.h>
 
 #include <vcpkg/base/pragmas.h>
+#include <vcpkg/base/stringview.h>
 
 #include <vcpkg/commands.version.h>
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -37,6 +39,11 @@ extern decltype(&curl_multi_remove_handle) vcpkg_curl_multi_remove_handle;
 extern decltype(&curl_multi_strerror) vcpkg_curl_multi_strerror;
 extern decltype(&curl_multi_perform) vcpkg_curl_multi_perform;
 extern decltype(&curl_multi_wait) vcpkg_curl_multi_poll; // or _wait, if _poll is not present
+extern decltype(&curl_multi_setopt) vcpkg_curl_multi_setopt;
+
+extern decltype(&curl_share_cleanup) vcpkg_curl_share_cleanup;
+extern decltype(&curl_share_init) vcpkg_curl_share_init;
+extern decltype(&curl_share_setopt) vcpkg_curl_share_setopt;
 
 extern decltype(&curl_slist_append) vcpkg_curl_slist_append;
 extern decltype(&curl_slist_free_all) vcpkg_curl_slist_free_all;
@@ -62,6 +69,11 @@ extern decltype(&curl_version) vcpkg_curl_version;
 #define vcpkg_curl_multi_poll(multi_handle, extra_fds, extra_nfds, timeout_ms, numfds)                                 \
     curl_multi_poll(multi_handle, extra_fds, extra_nfds, timeout_ms, numfds)
 #define vcpkg_curl_multi_perform(multi_handle, running_handles) curl_multi_perform(multi_handle, running_handles)
+#define vcpkg_curl_multi_setopt(multi_handle, option, parameter) curl_multi_setopt(multi_handle, option, parameter)
+
+#define vcpkg_curl_share_cleanup(share_handle) curl_share_cleanup(share_handle)
+#define vcpkg_curl_share_init() curl_share_init()
+#define vcpkg_curl_share_setopt(share_handle, option, parameter) curl_share_setopt(share_handle, option, parameter)
 
 #define vcpkg_curl_slist_append(list, string) curl_slist_append(list, string)
 #define vcpkg_curl_slist_free_all(list) curl_slist_free_all(list)
@@ -99,6 +111,9 @@ namespace vcpkg
         // Makes sure that the easy handle is removed from the multi handle on cleanup.
         void add_easy_handle(CurlEasyHandle& easy_handle);
 
+        // Removes an easy handle added by add_easy_handle, for example so that it can be added again.
+        void remove_easy_handle(CurlEasyHandle& easy_handle);
+
         CURLM* get();
 
     private:
@@ -106,6 +121,25 @@ namespace vcpkg
         std::vector<CURL*> m_easy_handles;
     };
 
+    // Shares DNS lookups and TLS sessions between the easy handles which use it, which may run on different threads.
+    // Connections are not shared, as libcurl does not support sharing its connection cache between threads.
+    struct CurlShareHandle
+    {
+        CurlShareHandle();
+        CurlShareHandle(const CurlShareHandle&) = delete;
+        CurlShareHandle& operator=(const CurlShareHandle&) = delete;
+        ~CurlShareHandle();
+
+        CURLSH* get();
+
+    private:
+        static void lock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+        static void unlock(CURL* handle, curl_lock_data data, void* userptr);
+
+        CURLSH* m_ptr = nullptr;
+        std::mutex m_mutexes[CURL_LOCK_DATA_LAST];
+    };
+
     struct CurlHeaders
     {
         CurlHeaders() = default;
@@ -122,6 +156,15 @@ namespace vcpkg
         curl_slist* m_headers = nullptr;
     };
 
+    // Whether a transfer of `raw_url` which completed with `response_code` might succeed if tried again: an FTP 4xx
+    // response code or an HTTP 408, 429, 500, 502, 503 or 504 response code.
+    // https://everything.curl.dev/usingcurl/downloads/retry.html
+    bool is_transient_response_code(StringView raw_url, long response_code);
+
+    // Whether a transfer of `raw_url` which finished with `curl_code` and, if that is CURLE_OK, `response_code` should
+    // be tried again: it timed out or completed with a transient response code.
+    bool should_retry_transfer(StringView raw_url, CURLcode curl_code, long response_code);
+
     constexpr char vcpkg_curl_user_agent[] =
         "vcpkg/" VCPKG_BASE_VERSION_AS_STRING "-" VCPKG_VERSION_AS_STRING " (curl)";
 }
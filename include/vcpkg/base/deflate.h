@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vcpkg/base/fwd/optional.h>
+
+#include <vcpkg/base/stringview.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+// An implementation of the DEFLATE compressed data format (RFC 1951), and the zlib wrapper (RFC 1950) around it.
+// This exists so that vcpkg can read and write zip archives and git objects without launching external tools.
+namespace vcpkg::Deflate
+{
+    // Continues the CRC-32 (as used by zip and gzip) `crc` over [first, last). Start with a `crc` of 0.
+    uint32_t crc32(uint32_t crc, const void* first, const void* last) noexcept;
+    // Continues the Adler-32 checksum (as used by zlib) `adler` over [first, last). Start with an `adler` of 1.
+    uint32_t adler32(uint32_t adler, const void* first, const void* last) noexcept;
+
+    struct CompressorState;
+
+    // Streaming compressor producing raw DEFLATE output, with compression similar to zlib's default level.
+    struct Compressor
+    {
+        Compressor();
+        Compressor(const Compressor&) = delete;
+        Compressor& operator=(const Compressor&) = delete;
+        ~Compressor();
+
+        // Compresses [first, last), appending any completed output to `out`.
+        void add_bytes(const void* first, const void* last, std::string& out);
+        // Terminates the stream, appending all remaining output to `out`. After calling `finish`, the
+        // compressor may only be reused after `clear()`.
+        void finish(std::string& out);
+        void clear() noexcept;
+
+    private:
+        std::unique_ptr<CompressorState> m_state;
+    };
+
+    // Compresses `data` into a complete raw DEFLATE stream.
+    std::string compress(StringView data);
+    // Compresses `data` into a complete zlib stream.
+    std::string compress_zlib(StringView data);
+
+    // Supplies compressed input to `inflate`.
+    struct InflateSource
+    {
+        // Stores up to `size` bytes in `buffer`, returning the number of bytes stored. Returning 0 indicates the end
+        // of the input.
+        virtual size_t read(void* buffer, size_t size) = 0;
+
+    protected:
+        ~InflateSource() = default;
+    };
+
+    // Receives decompressed output from `inflate`.
+    struct InflateSink
+    {
+        // Returning false aborts decompression.
+        virtual bool write(const void* buffer, size_t size) = 0;
+
+    protected:
+        ~InflateSink() = default;
+    };
+
+    enum class InflateResult
+    {
+        Success,
+        // The input ended before the end of the compressed stream.
+        Truncated,
+        // The input is not a valid compressed stream, or a checksum did not match.
+        Corrupt,
+        // The sink returned false.
+        SinkFailed,
+    };
+
+    struct InflateOutcome
+    {
+        InflateResult result;
+        // The number of bytes of input consumed by the compressed stream, excluding any trailing data.
+        uint64_t consumed;
+    };
+
+    // Decompresses a raw DEFLATE stream from `source` to `sink`.
+    InflateOutcome inflate(InflateSource& source, InflateSink& sink);
+    // Decompresses a zlib stream from `source` to `sink`, verifying its checksum.
+    InflateOutcome inflate_zlib(InflateSource& source, InflateSink& sink);
+
+    // Decompresses a complete raw DEFLATE stream; returns nullopt if `compressed` is not one.
+    Optional<std::string> inflate(StringView compressed);
+    // Decompresses a complete zlib stream; returns nullopt if `compressed` is not one.
+    Optional<std::string> inflate_zlib(StringView compressed);
+}
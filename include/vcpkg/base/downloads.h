@@ -31,6 +31,25 @@ namespace vcpkg
                                              View<std::pair<std::string, Path>> url_pairs,
                                              View<std::string> headers);
 
+    // Lets a caller of download_files_no_cache act on each download as soon as it finishes, and drop downloads it
+    // no longer needs. Called on the thread which called download_files_no_cache.
+    struct BulkDownloadListener
+    {
+        // Returns whether the download at `idx` is still needed. A download which is not is not started, or is
+        // abandoned if it is in flight; its output is removed, and its code is -1.
+        virtual bool still_needed(size_t idx) = 0;
+        // Called once the download at `idx` has finished, with its HTTP status code or -1 if it failed.
+        virtual void finished(size_t idx, int code) = 0;
+
+    protected:
+        ~BulkDownloadListener() = default;
+    };
+
+    std::vector<int> download_files_no_cache(DiagnosticContext& context,
+                                             View<std::pair<std::string, Path>> url_pairs,
+                                             View<std::string> headers,
+                                             BulkDownloadListener& listener);
+
     bool submit_github_dependency_graph_snapshot(DiagnosticContext& context,
                                                  const Optional<std::string>& maybe_github_api_url,
                                                  const std::string& github_token,
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vcpkg/base/fwd/file-hash-cache.h>
+#include <vcpkg/base/fwd/files.h>
+
+#include <vcpkg/base/expected.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/path.h>
+#include <vcpkg/base/stringview.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vcpkg
+{
+    // Remembers the SHA-256 hashes of files across vcpkg invocations, keyed by each file's path, size, last write
+    // time, and inode. This type is safe to use from several threads at once.
+    struct FileHashCache
+    {
+        // Loads the hashes previously saved to `cache_file`, if any. A missing or invalid cache file is ignored.
+        FileHashCache(const ReadOnlyFilesystem& fs, FileHashCacheMode mode, Optional<Path> cache_file);
+        FileHashCache(const FileHashCache&) = delete;
+        FileHashCache& operator=(const FileHashCache&) = delete;
+
+        ExpectedL<std::string> get_file_sha256(const Filesystem& fs, const Path& path);
+
+        // Like get_file_sha256, but `contents` must have just been read from `path` by the caller, and is hashed
+        // instead of reading the file again.
+        std::string get_contents_sha256(const Filesystem& fs, const Path& path, StringView contents);
+
+        // Writes the remembered hashes back to the cache file, if any were added. Failures are ignored, as the
+        // cache only affects performance.
+        void save(const Filesystem& fs);
+
+    private:
+        struct Entry
+        {
+            FileMetadata metadata;
+            std::string sha256;
+            bool used = false;
+        };
+
+        Optional<std::string> lookup(const Path& path, const FileMetadata& metadata);
+        void remember(const Filesystem& fs, const Path& path, const FileMetadata& metadata, const std::string& sha256);
+
+        FileHashCacheMode m_mode;
+        Optional<Path> m_cache_file;
+        std::mutex m_mtx;
+        std::unordered_map<std::string, Entry> m_entries;
+        bool m_dirty = false;
+    };
+}
@@ -137,6 +137,15 @@ namespace vcpkg
 
     uint64_t get_filesystem_stats();
 
+    // The properties of a file used to notice that its contents may have changed since it was last observed.
+    struct FileMetadata
+    {
+        std::uint64_t size = 0;
+        int64_t last_write_time = 0;
+        // 0 if the platform does not expose a stable identity for the file
+        std::uint64_t inode = 0;
+    };
+
     struct ILineReader
     {
         virtual ExpectedL<std::vector<std::string>> read_lines(const Path& file_path) const = 0;
@@ -151,6 +160,9 @@ namespace vcpkg
         virtual std::uint64_t file_size(const Path& file_path, std::error_code& ec) const = 0;
         std::uint64_t file_size(const Path& file_path, LineInfo li) const;
 
+        // Follows symlinks, like is_regular_file
+        virtual FileMetadata file_metadata(const Path& target, std::error_code& ec) const = 0;
+
         virtual std::string read_contents(const Path& file_path, std::error_code& ec) const = 0;
         std::string read_contents(const Path& file_path, LineInfo li) const;
 
@@ -3,5 +3,6 @@
 namespace vcpkg
 {
     struct SanitizedUrl;
+    struct BulkDownloadListener;
     struct AssetCachingSettings;
 }
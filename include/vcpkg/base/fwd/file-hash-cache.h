@@ -0,0 +1,17 @@
+#pragma once
+
+namespace vcpkg
+{
+    enum class FileHashCacheMode
+    {
+        // Every file is hashed, and nothing is remembered
+        Disabled,
+        // Files whose metadata is unchanged since they were last hashed are not read again
+        Enabled,
+        // Every file is hashed, and a warning is printed for each remembered hash that turns out to be wrong even
+        // though the file's metadata is unchanged
+        Strict,
+    };
+
+    struct FileHashCache;
+}
@@ -20,7 +20,17 @@ namespace vcpkg
         Unknown,
     };
 
+    enum class GitObjectType
+    {
+        Commit,
+        Tree,
+        Blob,
+        Tag,
+    };
+
     struct GitRepoLocator;
     struct GitLSTreeEntry;
     struct GitDiffTreeLine;
+    struct GitObject;
+    struct GitObjectDatabase;
 }
@@ -13,5 +13,6 @@ namespace vcpkg
 
     struct FileSink;
     struct TeeSink;
+    struct LineBufferSink;
     struct BGMessageSink;
 }
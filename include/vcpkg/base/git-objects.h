@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vcpkg/base/fwd/files.h>
+#include <vcpkg/base/fwd/git.h>
+
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/path.h>
+#include <vcpkg/base/stringview.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vcpkg
+{
+    struct GitObject
+    {
+        GitObjectType type;
+        std::string data;
+    };
+
+    // Reads objects directly from the object database of a git repository, from loose objects and from packfiles
+    // with version 2 pack indexes, so that looking up versions and baselines does not launch git for each object.
+    // Every operation returns nullopt or false when it cannot be completed this way, for example for objects that
+    // are not present or repositories using features not implemented here; callers then fall back to running git,
+    // which also reports any errors. This type is safe to use from several threads at once.
+    struct GitObjectDatabase
+    {
+        // `git_dir` is the .git directory of the repository, or the repository itself if it is bare.
+        GitObjectDatabase(const ReadOnlyFilesystem& fs, const Path& git_dir);
+        GitObjectDatabase(const GitObjectDatabase&) = delete;
+        GitObjectDatabase& operator=(const GitObjectDatabase&) = delete;
+        ~GitObjectDatabase();
+
+        // Reads the object named by the 40 character hexadecimal id `sha`.
+        Optional<GitObject> read_object(StringView sha);
+
+        // Resolves `treeish`, which is an object id optionally followed by a colon and a path within the tree of
+        // that object, to the id of the object it names, like `git rev-parse`.
+        Optional<std::string> resolve(StringView treeish);
+
+        // Reads the contents of the blob named by `treeish`, like `git show`.
+        Optional<std::string> read_blob(StringView treeish);
+
+        // Writes the files of the tree named by `treeish` to `destination`, like `git checkout-index`. If this
+        // returns false, `destination` has not been modified. Trees containing symbolic links, submodules, or
+        // .gitattributes files are not supported.
+        bool extract_tree(const Filesystem& fs, StringView treeish, const Path& destination);
+
+    private:
+        using ObjectId = std::array<unsigned char, 20>;
+        using PackLocation = std::pair<size_t, uint64_t>;
+        struct Pack;
+
+        Optional<GitObject> read_object_locked(const ObjectId& id);
+        Optional<GitObject> read_loose(const ObjectId& id);
+        Optional<GitObject> read_packed(PackLocation location);
+        void remember_delta_base(PackLocation location, const GitObject& object);
+        Optional<PackLocation> find_packed(const ObjectId& id) const;
+        Optional<ObjectId> peel_to_tree(const ObjectId& id);
+        bool write_tree(const Filesystem& fs, const ObjectId& tree, const Path& destination, int depth);
+        bool scan_packs();
+
+        const ReadOnlyFilesystem& m_fs;
+        std::vector<Path> m_object_dirs;
+        std::mutex m_mtx;
+        std::vector<std::unique_ptr<Pack>> m_packs;
+        std::set<std::string> m_scanned_pack_indexes;
+        bool m_packs_scanned = false;
+        std::map<PackLocation, GitObject> m_delta_bases;
+        size_t m_delta_bases_size = 0;
+    };
+}
@@ -42,8 +42,13 @@ namespace vcpkg::Hash
         virtual ~Hasher() = default;
     };
 
+    // Returns a hasher using the fastest implementation available on this machine, such as the SHA extensions of
+    // x86-64 or ARMv8 processors.
     std::unique_ptr<Hasher> get_hasher_for(Algorithm algo);
 
+    // Returns a hasher using only the portable scalar implementation, regardless of the processor.
+    std::unique_ptr<Hasher> get_portable_hasher_for(Algorithm algo);
+
     std::string get_bytes_hash(const void* first, const void* last, Algorithm algo);
     std::string get_string_hash(StringView s, Algorithm algo);
     std::string get_string_sha256(StringView s);
@@ -13,6 +13,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace vcpkg::Json
@@ -77,11 +78,6 @@ namespace vcpkg::Json
         Object
     };
 
-    namespace impl
-    {
-        struct ValueImpl;
-    }
-
     struct Value
     {
         Value() noexcept; // equivalent to Value::null()
@@ -144,8 +140,12 @@ namespace vcpkg::Json
         friend bool operator!=(const Value& lhs, const Value& rhs) { return !(lhs == rhs); }
 
     private:
-        friend struct impl::ValueImpl;
-        std::unique_ptr<impl::ValueImpl> underlying_;
+        // Scalars and strings are stored inline rather than in a separately allocated node. Arrays and objects are
+        // owned through a pointer, so that references to them remain valid while their parent grows. The alternatives
+        // are in the order of ValueKind.
+        using underlying_t = std::
+            variant<std::nullptr_t, bool, int64_t, double, std::string, std::unique_ptr<Array>, std::unique_ptr<Object>>;
+        underlying_t underlying_;
     };
 
     struct Array
@@ -212,6 +212,11 @@ namespace vcpkg::Json
         using underlying_t = std::vector<value_type>;
 
         underlying_t::const_iterator internal_find_key(StringView key) const noexcept;
+        void internal_index_back();
+        void internal_rebuild_index();
+        // Renumbers the entries after some were removed, without allocating
+        void internal_reindex_in_place() noexcept;
+        void internal_index_insert(size_t position) noexcept;
 
     public:
         // these are here for better diagnostics
@@ -326,6 +331,10 @@ namespace vcpkg::Json
 
     private:
         underlying_t underlying_;
+        // Once an object grows past a few members, its keys are indexed by an open addressing hash table of
+        // positions in underlying_ plus one, with zero marking empty slots. Only mutating members update the
+        // index, so that const objects may be shared between threads.
+        std::vector<size_t> index_;
     };
 
     struct ParsedJson
@@ -334,6 +343,41 @@ namespace vcpkg::Json
         JsonStyle style;
     };
 
+    // Reads a JSON document in a single pass without building a DOM for all of it. Objects and arrays can be read
+    // one member or element at a time, and values that are not needed can be skipped; the whole document is still
+    // checked as Json::parse would. After a syntax error every read fails, and finish() returns the error.
+    // `text` must outlive the reader.
+    struct PullReader
+    {
+        PullReader(StringView text, StringView origin);
+        PullReader(const PullReader&) = delete;
+        PullReader& operator=(const PullReader&) = delete;
+        ~PullReader();
+
+        // if the next value is an object, reads its opening brace and returns true
+        bool begin_object();
+        // reads the key of the next member of the innermost object begun, leaving its value to be read next;
+        // returns false, after reading the closing brace, when there are no more members
+        bool next_member(std::string& key);
+        // if the next value is an array, reads its opening bracket and returns true
+        bool begin_array();
+        // returns whether the innermost array begun has another element, leaving it to be read next;
+        // returns false, after reading the closing bracket, when there are no more elements
+        bool next_element();
+
+        // reads the next value, including any values nested in it
+        Value read_value();
+        // checks the next value, including any values nested in it, without building it
+        void skip_value();
+
+        // checks that the document ends after the values read so far, and returns the first syntax error if any
+        ExpectedL<Unit> finish();
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+
     ExpectedL<ParsedJson> parse(StringView text, StringView origin);
     Optional<ParsedJson> parse(DiagnosticContext& context, StringView text, StringView origin);
     ExpectedL<Json::Object> parse_object(StringView text, StringView origin);
@@ -209,6 +209,60 @@ namespace vcpkg::Json
                 });
         }
 
+        // reads the next value of `parser`, which is the value at `key` of the currently visited object
+        template<class Type>
+        void visit_in_key(PullReader& parser, StringView key, Type& place, const IDeserializer<Type>& visitor)
+        {
+            visit_in_key(parser.read_value(), key, place, visitor);
+        }
+
+        // reads the members of the object begun by parser.begin_object(), which is the value at `key` of the
+        // currently visited object, without building it; `member_fn(member_key)` must read or skip each value
+        template<class Fn>
+        void object_members_in_key(PullReader& parser, StringView key, Fn member_fn)
+        {
+            PathGuard guard{m_path, key};
+            std::string member_key;
+            while (parser.next_member(member_key))
+            {
+                member_fn(static_cast<const std::string&>(member_key));
+            }
+        }
+
+        // like array_elements, for the array begun by parser.begin_array(), which is the value at `key` of the
+        // currently visited object; elements are deserialized as they are read, without building the array
+        template<class Type>
+        Optional<std::vector<Type>> array_elements_in_key(PullReader& parser,
+                                                          StringView key,
+                                                          const IDeserializer<Type>& visitor)
+        {
+            PathGuard key_guard{m_path, key};
+            Optional<std::vector<Type>> result{std::vector<Type>()};
+            auto& result_vec = *result.get();
+            bool success = true;
+            PathGuard guard{m_path};
+            for (int64_t i = 0; parser.next_element(); ++i)
+            {
+                m_path.back().index = i;
+                auto opt = visitor.visit(*this, parser.read_value());
+                if (auto parsed = opt.get())
+                {
+                    if (success)
+                    {
+                        result_vec.push_back(std::move(*parsed));
+                    }
+                }
+                else
+                {
+                    this->add_expected_type_error(visitor.type_name());
+                    result_vec.clear();
+                    success = false;
+                }
+            }
+
+            return result;
+        }
+
         static uint64_t get_reader_stats();
 
     private:
@@ -1389,6 +1389,11 @@ DECLARE_MESSAGE(FeatureBaselineFormatted, (), "", "Succeeded in formatting the f
 DECLARE_MESSAGE(FeatureBaselineNoFeaturesForFail, (), "", "When using '= fail' no list of features is allowed.")
 DECLARE_MESSAGE(FeatureBaselineNoFeaturesForPass, (), "", "When using '= pass' no list of features is allowed.")
 DECLARE_MESSAGE(FeatureTestProblems, (), "", "There are some feature test problems!")
+DECLARE_MESSAGE(FileHashCacheStale,
+                (msg::path),
+                "",
+                "the remembered hash of {path} was out of date even though the file's size, modification time, and "
+                "inode were unchanged")
 DECLARE_MESSAGE(FileIsNotExecutable, (), "", "this file does not appear to be executable")
 DECLARE_MESSAGE(FilesRelativeToTheBuildDirectoryHere, (), "", "the files are relative to the build directory here")
 DECLARE_MESSAGE(FilesRelativeToThePackageDirectoryHere,
@@ -1581,6 +1586,12 @@ DECLARE_MESSAGE(HelpBinaryCachingAzUpkg,
                 "**Experimental: will change or be removed without warning**\n"
                 "Adds a Universal Package Azure Artifacts source. Uses the Azure CLI "
                 "(az artifacts) for uploads and downloads.")
+DECLARE_MESSAGE(HelpBinaryCachingConcurrentFetch,
+                (),
+                "Printed as the 'definition' for 'x-concurrent-fetch'.",
+                "**Experimental: will change or be removed without warning**\n"
+                "Requests archives from all read sources at the same time, restoring each package from whichever "
+                "source responds first.")
 DECLARE_MESSAGE(HelpBinaryCachingCos,
                 (),
                 "Printed as the 'definition' for 'x-cos,<prefix>[,<rw>]'.",
@@ -1599,6 +1610,13 @@ DECLARE_MESSAGE(HelpBinaryCachingDefaultsError,
                 "Printed as the 'definition' in a table for 'default[,<rw>]', when there was an error fetching the "
                 "default for some reason.",
                 "Adds the default file-based location.")
+DECLARE_MESSAGE(HelpBinaryCachingDirectRestore,
+                (),
+                "Printed as the 'definition' for 'x-direct-restore'.",
+                "**Experimental: will change or be removed without warning**\n"
+                "Installs restored zip archives by extracting them directly into the installed tree, rather than "
+                "extracting them into the packages tree first. The packages tree then only holds the control files "
+                "of restored packages.")
 DECLARE_MESSAGE(HelpBinaryCachingFiles,
                 (),
                 "Printed as the 'definition' for 'files,<path>[,<rw>]'",
@@ -3439,3 +3457,14 @@ DECLARE_MESSAGE(WhileValidatingVersion, (msg::version), "", "while validating ve
 DECLARE_MESSAGE(WindowsEnvMustAlwaysBePresent, (msg::env_var), "", "expected {env_var} to be always set on Windows")
 DECLARE_MESSAGE(WindowsOnlyCommand, (), "", "This command only supports Windows.")
 DECLARE_MESSAGE(WroteNuGetPkgConfInfo, (msg::path), "", "Wrote NuGet package config information to {path}")
+DECLARE_MESSAGE(ZipCorruptArchive, (), "", "this is not a zip archive, or it is corrupt or truncated")
+DECLARE_MESSAGE(ZipCorruptEntry, (msg::path), "", "the zip entry {path} is corrupt")
+DECLARE_MESSAGE(ZipInvalidEntryName,
+                (msg::path),
+                "",
+                "the zip entry {path} is not a relative path to a location inside the destination directory")
+DECLARE_MESSAGE(ZipUnsupportedEntry,
+                (msg::path),
+                "",
+                "the zip entry {path} uses encryption or a compression method other than deflate, which vcpkg does "
+                "not support")
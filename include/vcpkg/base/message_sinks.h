@@ -94,6 +94,16 @@ namespace vcpkg
         virtual void println(Color color, LocalizedString&& line) override;
     };
 
+    // Collects lines so that output produced on another thread can be printed all at once.
+    struct LineBufferSink final : MessageSink
+    {
+        virtual void println(const MessageLine& line) override;
+        virtual void println(MessageLine&& line) override;
+        using MessageSink::println;
+
+        std::vector<MessageLine> lines;
+    };
+
     struct BGMessageSink final : MessageSink
     {
         BGMessageSink(MessageSink& out_sink) : out_sink(out_sink) { }
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vcpkg/base/fwd/files.h>
+#include <vcpkg/base/fwd/optional.h>
+#include <vcpkg/base/fwd/span.h>
+
+#include <vcpkg/base/diagnostics.h>
+#include <vcpkg/base/path.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+// A reader and writer for the subset of the zip file format (APPNOTE.TXT) that vcpkg produces and consumes: stored and
+// deflated entries, directories, symbolic links, unix permissions, and zip64 extensions. Encryption, multi-disk
+// archives, and other compression methods are not supported.
+namespace vcpkg::Zip
+{
+    enum class EntryKind
+    {
+        RegularFile,
+        Directory,
+        Symlink,
+    };
+
+    struct Entry
+    {
+        // The name of the entry as recorded in the archive, always using / as the separator. Directory entries do not
+        // retain their trailing /.
+        std::string name;
+        EntryKind kind = EntryKind::RegularFile;
+        uint16_t method = 0;
+        uint32_t crc32 = 0;
+        uint64_t compressed_size = 0;
+        uint64_t uncompressed_size = 0;
+        uint64_t local_header_offset = 0;
+        // The unix permission bits (such as 0755), or 0 if the archive was not created on a unix-like system.
+        uint32_t permissions = 0;
+    };
+
+    // Reads the central directory of the zip archive `archive`. The entry names are validated such that they
+    // are relative, contain no . or .. components, and are unique; if any are not, or the archive uses
+    // unsupported features, reports an error and returns nullopt.
+    Optional<std::vector<Entry>> read_central_directory(DiagnosticContext& context,
+                                                        const ReadOnlyFilesystem& fs,
+                                                        const Path& archive);
+
+    // Writes every regular file, directory, and symbolic link under `source` into a new deflated zip archive at
+    // `destination`, excluding .DS_Store files. Symbolic links are stored as links rather than followed.
+    bool compress_directory(DiagnosticContext& context,
+                            const Filesystem& fs,
+                            const Path& source,
+                            const Path& destination);
+
+    // Extracts all entries of the zip archive `archive` into the existing directory `destination`, decompressing
+    // entries on up to `max_concurrency` threads. The last write times recorded in the archive are not restored.
+    bool extract(DiagnosticContext& context,
+                 const Filesystem& fs,
+                 const Path& archive,
+                 const Path& destination,
+                 size_t max_concurrency);
+    bool extract(DiagnosticContext& context, const Filesystem& fs, const Path& archive, const Path& destination);
+
+    // Extracts `entries`, which must have been returned by read_central_directory for `archive`, into `destination`,
+    // whose subdirectories named by the entries must already exist. Directory entries are ignored. Regular files are
+    // decompressed on up to `max_concurrency` threads, and symbolic links are created after all of them.
+    bool extract_entries(DiagnosticContext& context,
+                         const Filesystem& fs,
+                         const Path& archive,
+                         View<Entry> entries,
+                         const Path& destination,
+                         size_t max_concurrency);
+}
@@ -9,17 +9,21 @@
 #include <vcpkg/fwd/vcpkgpaths.h>
 
 #include <vcpkg/base/background-work-queue.h>
+#include <vcpkg/base/chrono.h>
 #include <vcpkg/base/downloads.h>
 #include <vcpkg/base/expected.h>
 #include <vcpkg/base/message_sinks.h>
 #include <vcpkg/base/path.h>
+#include <vcpkg/base/zip.h>
 
 #include <vcpkg/archives.h>
 #include <vcpkg/packagespec.h>
 #include <vcpkg/versions.h>
 
+#include <atomic>
 #include <chrono>
 #include <iterator>
+#include <memory>
 #include <set>
 #include <string>
 #include <thread>
@@ -28,6 +32,28 @@
 
 namespace vcpkg
 {
+    enum class RemoveWhen
+    {
+        nothing,
+        always,
+    };
+
+    struct ZipResource
+    {
+        ZipResource(Path&& p, RemoveWhen t) : path(std::move(p)), to_remove(t) { }
+
+        Path path;
+        RemoveWhen to_remove;
+    };
+
+    // A restored archive whose files are extracted directly into the installed tree when the package is installed.
+    // Only the control files are extracted into the package directory when it is restored.
+    struct DeferredArchive
+    {
+        ZipResource zip;
+        std::vector<Zip::Entry> entries;
+    };
+
     struct CacheStatus
     {
         bool should_attempt_precheck(const IReadBinaryProvider* sender) const noexcept;
@@ -36,14 +62,19 @@ namespace vcpkg
         bool is_unavailable(const IReadBinaryProvider* sender) const noexcept;
         const IReadBinaryProvider* get_available_provider() const noexcept;
         bool is_restored() const noexcept;
+        // The archive to install the restored package from, or nullptr if it was extracted into the package directory.
+        const DeferredArchive* deferred_archive() const noexcept;
 
         void mark_unavailable(const IReadBinaryProvider* sender);
         void mark_available(const IReadBinaryProvider* sender) noexcept;
         void mark_restored() noexcept;
         void mark_unrestored() noexcept;
+        // Returns the previously deferred archive, if any.
+        Optional<DeferredArchive> set_deferred_archive(Optional<DeferredArchive>&& archive);
 
     private:
         CacheStatusState m_status = CacheStatusState::unknown;
+        Optional<DeferredArchive> m_deferred_archive;
 
         // The set of providers who know they do not have the associated cache entry.
         // Flat vector set because N is tiny.
@@ -90,6 +121,23 @@ namespace vcpkg
 
         virtual bool needs_nuspec_data() const = 0;
         virtual bool needs_zip_file() const = 0;
+
+        /// The maximum number of calls to push_success this provider can service at the same time.
+        virtual size_t max_concurrent_pushes() const = 0;
+    };
+
+    /// Receives the archives acquired by IReadBinaryProvider::try_acquire_zips_as_available(), possibly from several
+    /// threads at once.
+    struct AcquiredZipSink
+    {
+        /// Returns whether the archive for actions[idx] is still wanted. Providers do not request archives which are
+        /// not, and abandon them if they are in flight where they can.
+        virtual bool wants(size_t idx) = 0;
+        /// Takes the archive for actions[idx] as soon as it has been acquired.
+        virtual void acquired(size_t idx, ZipResource&& zip) = 0;
+
+    protected:
+        ~AcquiredZipSink() = default;
     };
 
     struct IReadBinaryProvider
@@ -121,6 +169,39 @@ namespace vcpkg
 
         virtual LocalizedString restored_message(size_t count,
                                                  std::chrono::high_resolution_clock::duration elapsed) const = 0;
+
+        /// For providers which restore packages from zip archives, fetch() is try_acquire_zips() followed by
+        /// extract_zips(). Splitting them allows ReadOnlyBinaryCache to download from several providers at once and
+        /// extract only the archive that arrives first.
+        ///
+        /// Stores the location of each downloaded archive at the corresponding index of `out_zips`, leaving it
+        /// disengaged if the cache does not contain the requested zip. Archives are downloaded to locations distinct
+        /// from those of any other provider. Returns false, having done nothing, if this provider does not restore
+        /// from zip archives.
+        ///
+        /// Prerequisites: actions[i].package_abi(), out_zips.size() == actions.size()
+        virtual bool try_acquire_zips(DiagnosticContext& context,
+                                      const Filesystem& fs,
+                                      View<const InstallPlanAction*> actions,
+                                      Span<Optional<ZipResource>> out_zips) const;
+
+        /// Like try_acquire_zips(), but passes each archive to `sink` as soon as it has been acquired, rather than once
+        /// all of them have been, and skips archives that `sink` no longer wants. Used to restore each package from
+        /// whichever provider delivers it first.
+        ///
+        /// Prerequisites: actions[i].package_abi()
+        virtual bool try_acquire_zips_as_available(DiagnosticContext& context,
+                                                   const Filesystem& fs,
+                                                   View<const InstallPlanAction*> actions,
+                                                   AcquiredZipSink& sink) const;
+
+        /// Extracts each engaged zip from try_acquire_zips() into the package directory of the corresponding action,
+        /// setting out_status[i] to RestoreResult::restored on success, then removes those marked RemoveWhen::always.
+        virtual void extract_zips(DiagnosticContext& context,
+                                  const Filesystem& fs,
+                                  View<const InstallPlanAction*> actions,
+                                  View<Optional<ZipResource>> zips,
+                                  Span<RestoreResult> out_status) const;
     };
 
     struct UrlTemplate
@@ -194,6 +275,9 @@ namespace vcpkg
 
         std::vector<std::string> secrets;
 
+        bool concurrent_fetch = false;
+        bool direct_restore = false;
+
         // These are filled in after construction by reading from args and environment
         std::string nuget_prefix;
         bool use_nuget_cache = false;
@@ -210,6 +294,10 @@ namespace vcpkg
         std::vector<std::unique_ptr<IWriteBinaryProvider>> write;
         std::string nuget_prefix;
         NuGetRepoInfo nuget_repo;
+        // If set, zip archives are requested from all read providers at once rather than one provider at a time
+        bool concurrent_fetch = false;
+        // If set, restored zip archives are installed directly into the installed tree; see DeferredArchive
+        bool direct_restore = false;
     };
 
     struct ReadOnlyBinaryCache
@@ -223,8 +311,13 @@ namespace vcpkg
         void fetch(DiagnosticContext& context, const Filesystem& fs, View<InstallPlanAction> actions);
 
         bool is_restored(const InstallPlanAction& ipa) const;
+        // Returns the archive to install `ipa` from if it was restored without being extracted into its package
+        // directory, otherwise nullptr.
+        const DeferredArchive* deferred_archive(const InstallPlanAction& ipa) const;
 
         void install_read_provider(std::unique_ptr<IReadBinaryProvider>&& provider);
+        void set_concurrent_fetch(bool concurrent_fetch) noexcept;
+        void set_direct_restore(bool direct_restore) noexcept;
 
         /// Checks whether the `actions` are present in the cache, without restoring them. Used by CI to determine
         /// missing packages.
@@ -241,6 +334,17 @@ namespace vcpkg
         BinaryProviders m_config;
 
         std::unordered_map<std::string, CacheStatus> m_status;
+
+    private:
+        void fetch_concurrently(DiagnosticContext& context, const Filesystem& fs, View<InstallPlanAction> actions);
+        // Calls provider.extract_zips(), except for archives that are instead deferred when direct restore is enabled.
+        void extract_zips(DiagnosticContext& context,
+                          const Filesystem& fs,
+                          const IReadBinaryProvider& provider,
+                          View<const InstallPlanAction*> actions,
+                          View<Optional<ZipResource>> zips,
+                          View<CacheStatus*> statuses,
+                          Span<RestoreResult> out_status);
     };
 
     struct BinaryCacheSyncState;
@@ -278,35 +382,63 @@ namespace vcpkg
         bool submission_complete;
     };
 
-    // compression and upload of binary cache entries happens on a single 'background' thread, `m_push_thread`
+    // compression and upload of binary cache entries happens on 'background' threads, in two stages:
+    //   1. `m_compress_threads` take work from `m_actions_to_push` and, if any provider needs one, create the zip file.
+    //   2. Each write provider has its own queue and pool of upload threads in `m_provider_queues`, sized by the
+    //   provider's `max_concurrent_pushes()`, so uploads to different providers overlap with each other and with
+    //   compression of the next package.
     // Thread safety is achieved within the binary cache providers by:
-    //   1. Only using one thread in the background for this work.
-    //   2. Forming a queue of work for that thread to consume in `m_actions_to_push`, which maintains its own thread
-    //   safety
-    //   3. Sending any replies from the background thread through `m_bg_msg_sink`
-    //   4. Ensuring any supporting data, such as tool exes, is provided before the background thread is started.
-    //   5. Ensuring that work is not submitted to the background thread until the corresponding `packages` directory to
-    //   upload is no longer being actively written by the foreground thread.
+    //   1. Never running more than `max_concurrent_pushes()` simultaneous pushes on any one provider.
+    //   2. Forming queues of work for those threads to consume, which maintain their own thread safety
+    //   3. Sending any replies from the background threads through `m_bg_msg_sink`
+    //   4. Ensuring any supporting data, such as tool exes, is provided before the background threads are started,
+    //   which happens when the first package is submitted.
+    //   5. Ensuring that work is not submitted to the background threads until the corresponding `packages` directory
+    //   to upload is no longer being actively written by the foreground thread.
+    //   6. Removing the zip file and `packages` directory only after the last provider has finished with them.
     struct BinaryCache : ReadOnlyBinaryCache
     {
         bool install_providers(DiagnosticContext& context, const VcpkgCmdArguments& args, const VcpkgPaths& paths);
 
-        // fs must outlive the BinaryCache, and will be accessed from the background thread that does pushes
+        // fs must outlive the BinaryCache, and will be accessed from the background threads that do pushes
+        // The number of compression threads, and the upper bound on upload threads per provider, is taken from
+        // X_VCPKG_BINARY_CACHE_PUSH_CONCURRENCY if set.
         explicit BinaryCache(const Filesystem& fs);
+        BinaryCache(const Filesystem& fs, size_t max_push_workers);
         BinaryCache(const BinaryCache&) = delete;
         BinaryCache& operator=(const BinaryCache&) = delete;
         ~BinaryCache();
         /// Called upon a successful build of `action` to store those contents in the binary cache.
         void push_success(CleanPackages clean_packages, const InstallPlanAction& action);
 
+        // Must be called before the first call to push_success.
+        void install_write_provider(std::unique_ptr<IWriteBinaryProvider>&& provider);
+
         void print_updates();
         void wait_for_async_complete_and_join();
 
     private:
-        struct ActionToPush
+        // A package submitted for upload. After compression, it is shared by the upload queues of every provider it
+        // is sent to.
+        struct PushJob
         {
+            PushJob(BinaryPackageWriteInfo&& request, CleanPackages clean_after_push)
+                : request(std::move(request)), clean_after_push(clean_after_push)
+            {
+            }
+
             BinaryPackageWriteInfo request;
             CleanPackages clean_after_push;
+            ElapsedTime::clock::time_point started;
+            std::atomic<size_t> remaining_uploads{0};
+            std::atomic<size_t> num_destinations{0};
+        };
+
+        struct ProviderPushQueue
+        {
+            IWriteBinaryProvider* provider = nullptr;
+            BackgroundWorkQueue<std::shared_ptr<PushJob>> jobs;
+            std::vector<std::thread> threads;
         };
 
         ZipTool m_zip_tool;
@@ -316,11 +448,17 @@ namespace vcpkg
         const Filesystem& m_fs;
 
         BGMessageSink m_bg_msg_sink;
-        BackgroundWorkQueue<ActionToPush> m_actions_to_push;
+        BackgroundWorkQueue<std::shared_ptr<PushJob>> m_actions_to_push;
         BinaryCacheSynchronizer m_synchronizer;
-        std::thread m_push_thread;
-
-        void push_thread_main();
+        size_t m_max_push_workers;
+        bool m_push_threads_started = false;
+        std::vector<std::thread> m_compress_threads;
+        std::vector<std::unique_ptr<ProviderPushQueue>> m_provider_queues;
+
+        void start_push_threads();
+        void compress_thread_main();
+        void upload_thread_main(ProviderPushQueue& queue);
+        void complete_push(PushJob& job);
     };
 
     ExpectedL<AssetCachingSettings> parse_download_configuration(const Optional<std::string>& arg);
@@ -10,6 +10,9 @@
 
 #include <vcpkg/binarycaching.h>
 
+#include <string>
+#include <vector>
+
 namespace vcpkg
 {
     // Turns:
@@ -31,6 +34,9 @@ namespace vcpkg
         std::string nupkg_filename() const { return Strings::concat(id, '.', version, ".nupkg"); }
     };
 
+    // Extracts the object names from the output of `gsutil ls <prefix>` or `aws s3 ls <prefix>`.
+    std::vector<std::string> parse_object_storage_listing(StringView output);
+
     FeedReference make_nugetref(const InstallPlanAction& action, StringView prefix);
 
     std::string generate_nuspec(const Path& package_dir,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vcpkg/base/fwd/file-hash-cache.h>
 #include <vcpkg/base/fwd/files.h>
 #include <vcpkg/base/fwd/optional.h>
 #include <vcpkg/base/fwd/span.h>
@@ -7,13 +8,26 @@
 #include <vcpkg/fwd/dependencies.h>
 #include <vcpkg/fwd/installeddatabase.h>
 #include <vcpkg/fwd/packagespec.h>
+#include <vcpkg/fwd/platform-expression.h>
 #include <vcpkg/fwd/portfileprovider.h>
 #include <vcpkg/fwd/triplet.h>
 #include <vcpkg/fwd/vcpkgpaths.h>
 
+#include <vcpkg/base/expected.h>
+#include <vcpkg/base/messages.h>
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/path.h>
+#include <vcpkg/base/span.h>
+#include <vcpkg/base/stringview.h>
+
+#include <stddef.h>
+
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace vcpkg::CMakeVars
 {
@@ -29,6 +43,13 @@ namespace vcpkg::CMakeVars
 
         const CMakeVars& get_or_load_dep_info_vars(const PackageSpec& spec, Triplet host_triplet) const;
 
+        // The dep info vars of `spec` reduced for evaluating platform expressions, available once they are loaded.
+        virtual const PlatformExpression::ContextIdentifiers* get_dep_info_identifiers(
+            const PackageSpec& spec) const = 0;
+
+        const PlatformExpression::ContextIdentifiers& get_or_load_dep_info_identifiers(const PackageSpec& spec,
+                                                                                       Triplet host_triplet) const;
+
         virtual const CMakeVars* get_tag_vars(const PackageSpec& spec) const = 0;
 
         virtual void load_generic_triplet_vars(Triplet triplet) const = 0;
@@ -40,6 +61,102 @@ namespace vcpkg::CMakeVars
         void load_tag_vars(const std::vector<InstallPlanAction>& install_actions, Triplet host_triplet) const;
     };
 
+    // Parses the output of a CMake extraction script, which prints the variables of each of `vars.size()` specs in
+    // order, into `vars`. The output of each spec is enclosed in port markers and holds one or more blocks of
+    // NAME=VALUE lines enclosed in block markers. Lines outside of blocks, which include any messages from CMake, are
+    // kept so that they can be reported if CMake fails.
+    struct CMakeVarsOutputParser
+    {
+        explicit CMakeVarsOutputParser(Span<std::vector<std::pair<std::string, std::string>>> vars);
+
+        void parse_line(StringView line);
+
+        // Checks that the output held exactly one complete port section, with at least one block, for each spec.
+        ExpectedL<Unit> finish() const;
+
+        const std::vector<std::string>& other_lines() const noexcept { return m_other_lines; }
+
+    private:
+        enum class State
+        {
+            OutsidePort,
+            InPort,
+            InBlock,
+        };
+
+        Span<std::vector<std::pair<std::string, std::string>>> m_vars;
+        State m_state = State::OutsidePort;
+        size_t m_ports = 0;
+        bool m_port_has_block = false;
+        Optional<LocalizedString> m_error;
+        std::vector<std::string> m_other_lines;
+    };
+
+    // Parses the complete `output` of an extraction script with CMakeVarsOutputParser.
+    ExpectedL<Unit> parse_cmake_vars_output(StringView output,
+                                            Span<std::vector<std::pair<std::string, std::string>>> vars);
+
+    // Remembers the variables extracted by CMake across vcpkg invocations, so that they can be served without
+    // running CMake again. Each entry is keyed by a hash of everything that can affect its variables.
+    struct CMakeVarsCache
+    {
+        // A missing or invalid cache file is ignored; if `cache_file` is empty, nothing is remembered. Entries not
+        // used since the cache was loaded are dropped when saving more than `max_entries` of them, so that the cache
+        // does not grow without bound as triplets and the environment change.
+        CMakeVarsCache(const ReadOnlyFilesystem& fs, Optional<Path> cache_file, size_t max_entries = 8192);
+
+        const std::vector<std::pair<std::string, std::string>>* find(const std::string& key);
+        void store(const std::string& key, const std::vector<std::pair<std::string, std::string>>& vars);
+
+        // Writes the cache back to disk if anything was stored. Failures are ignored, as the cache only affects
+        // performance.
+        void save(const Filesystem& fs);
+
+    private:
+        struct Entry
+        {
+            std::vector<std::pair<std::string, std::string>> vars;
+            bool used = false;
+        };
+
+        Optional<Path> m_cache_file;
+        size_t m_max_entries;
+        std::unordered_map<std::string, Entry> m_entries;
+        bool m_dirty = false;
+    };
+
+    // Saves the caches of the CMake variable providers which still exist. Called as vcpkg exits, which commands usually
+    // do without destroying their provider.
+    void save_cmake_vars_caches();
+
+    // The file under `buildtrees` that the CMake variables cache is kept in, or nullopt if the cache is turned off by
+    // setting X_VCPKG_CMAKE_VARS_CACHE to "off".
+    Optional<Path> get_cmake_vars_cache_file(const Path& buildtrees);
+
+    // A hash of everything that may affect the variables of every triplet: the scripts of this vcpkg, the CMake
+    // executables that may be used, whose properties of the host they report, and the variables of `environment` that
+    // vcpkg or CMake read, or that VCPKG_KEEP_ENV_VARS passes through. Other variables, such as the IDs of CI runs,
+    // do not affect the key.
+    std::string get_common_cmake_vars_cache_key(StringView ports_cmake_hash,
+                                                const std::map<std::string, std::string>& script_hashes,
+                                                View<std::pair<Path, FileMetadata>> cmake_candidates,
+                                                std::vector<std::string> environment);
+
+    // A hash of `common_key` and the files that may affect the variables of `triplet`, which is defined by
+    // `triplet_file`: every triplet in the same directory, as triplets commonly include their siblings, every file
+    // that those included by `triplet_file` include in turn, and the environment variables those files read. Returns
+    // nullopt if a triplet includes a file or reads a variable whose name cannot be determined without running CMake,
+    // in which case the triplet's variables must not be cached.
+    Optional<std::string> get_triplet_cmake_vars_cache_key(const Filesystem& fs,
+                                                           FileHashCache& file_hash_cache,
+                                                           StringView common_key,
+                                                           Triplet triplet,
+                                                           const Path& triplet_file);
+
+    // Splits `spec_count` specs into consecutive shards of at least 32 specs, each extracted by its own CMake process,
+    // and at most `max_shards` of them. Returns the index one past the last spec of each shard.
+    std::vector<size_t> extraction_shard_ends(size_t spec_count, size_t max_shards);
+
     // Ideally, buildtrees would have its own locks rather than reusing the installed database lock; this behavior
     // attempts to match previous versions of vcpkg which used one lock on VCPKG_ROOT.
     std::unique_ptr<CMakeVarProvider> make_triplet_cmake_var_provider(const VcpkgPaths& paths,
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <vcpkg/base/fwd/file-hash-cache.h>
+#include <vcpkg/base/fwd/json.h>
+#include <vcpkg/base/fwd/message_sinks.h>
 #include <vcpkg/base/fwd/system.process.h>
 
 #include <vcpkg/fwd/binarycaching.h>
@@ -29,6 +32,7 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace vcpkg
@@ -109,6 +113,8 @@ namespace vcpkg
         CleanDownloads clean_downloads;
         BackcompatFeatures backcompat_features;
         KeepGoing keep_going;
+        // The number of packages being built at the same time, which share the available processors.
+        unsigned int concurrent_builds = 1;
     };
 
     struct BuildResultCounts
@@ -227,6 +233,23 @@ namespace vcpkg
                                       const IBuildLogsRecorder& build_logs_recorder,
                                       const StatusParagraphs& status_db);
 
+    // The two halves of build_package, for callers that build several packages at once and so must not read
+    // status_db while it is being modified. check_build_dependencies returns the result to report if `action`
+    // cannot be built because some of its dependencies are not installed, and otherwise sets
+    // `all_dependencies_satisfied` for build_checked_package, which writes console output to `build_out`.
+    Optional<ExtendedBuildResult> check_build_dependencies(const BuildPackageOptions& build_options,
+                                                           const InstallPlanAction& action,
+                                                           const StatusParagraphs& status_db,
+                                                           bool& all_dependencies_satisfied);
+    ExtendedBuildResult build_checked_package(const VcpkgCmdArguments& args,
+                                              const VcpkgPaths& paths,
+                                              Triplet host_triplet,
+                                              const BuildPackageOptions& build_options,
+                                              const InstallPlanAction& action,
+                                              const IBuildLogsRecorder& build_logs_recorder,
+                                              bool all_dependencies_satisfied,
+                                              MessageSink& build_out);
+
     StringLiteral to_string_view(BuildPolicy policy);
     std::string to_string(BuildPolicy policy);
     StringLiteral to_cmake_variable(BuildPolicy policy);
@@ -285,7 +308,7 @@ namespace vcpkg
         std::vector<std::string> hashes;
     };
 
-    using SpecAbiInfoCache = Cache<PackageSpec, SpecAbiInfoCacheEntry>;
+    using SpecAbiInfoCache = ConcurrentCache<PackageSpec, SpecAbiInfoCacheEntry>;
 
     struct CompilerInfo
     {
@@ -295,6 +318,35 @@ namespace vcpkg
         std::string path;
     };
 
+    // Identifies everything that can change the CompilerInfo detected for `triplet` without changing its triplet file
+    // or toolchain file, so that it can be reused across invocations. `compilers` are the compilers found on PATH,
+    // which may be upgraded in place.
+    std::string get_compiler_info_cache_key(const Filesystem& fs,
+                                            FileHashCache& file_hash_cache,
+                                            const Path& detect_compiler_dir,
+                                            StringView cmake_version,
+                                            StringView ports_cmake_hash,
+                                            Triplet triplet,
+                                            View<std::string> passthrough_env_vars,
+                                            const Toolset& toolset,
+                                            StringView triplet_hash,
+                                            StringView toolchain_hash,
+                                            View<Path> compilers);
+
+    // Reads the entries of the compiler information cache `cache_file`. A missing or invalid file has no entries.
+    Json::Array load_compiler_info_cache_entries(const Filesystem& fs, const Path& cache_file);
+
+    // Finds the CompilerInfo remembered for `key` among `entries`, unless the compiler it names has been replaced.
+    Optional<CompilerInfo> find_cached_compiler_info(const Filesystem& fs, const Json::Array& entries, StringView key);
+
+    // Adds `compiler_info` to `cache_file` as the most recently used entry, for `key`. The file is reread under a lock,
+    // so that entries saved meanwhile by other builds or vcpkg processes are kept. Failures are ignored, as the cache
+    // only saves time.
+    void save_cached_compiler_info(const Filesystem& fs,
+                                   const Path& cache_file,
+                                   StringView key,
+                                   const CompilerInfo& compiler_info);
+
     struct AbiInfo
     {
         // These should always be known if an AbiInfo exists
@@ -309,6 +361,24 @@ namespace vcpkg
         std::vector<std::string> relative_port_hashes;
     };
 
+    // Finds the dependencies of install plan actions by spec, rather than by searching the plan and the status database
+    // for each of them.
+    struct AbiDependencyIndex
+    {
+        explicit AbiDependencyIndex(const StatusParagraphs& status_db);
+
+        // Actions are added in plan order, so that only the actions before the one being resolved are found.
+        void add_action(const PackageSpec& spec, size_t action_index);
+        // Returns the index of the plan action for `spec`, or SIZE_MAX if it has not been added.
+        size_t find_action(const PackageSpec& spec) const;
+        // Returns the installed core paragraph for `spec` that StatusParagraphs::find would, or nullptr.
+        const StatusParagraph* find_installed(const PackageSpec& spec) const;
+
+    private:
+        std::unordered_map<PackageSpec, size_t> m_action_indices;
+        std::unordered_map<PackageSpec, const StatusParagraph*> m_core_status_paragraphs;
+    };
+
     // It is important that `status_db` is the same status database as was used when constructing `action_plan`. Note
     // that this is expected to be a default constructed / empty StatusParagraphs for the "versioned" install plan types
     // as they always start from a clean state.
@@ -323,6 +393,7 @@ namespace vcpkg
                           const StatusParagraphs& status_db,
                           SpecAbiInfoCache& port_dir_cache);
 
+    // May be used by several builds running at once.
     struct EnvCache
     {
         explicit EnvCache(bool compiler_tracking) : m_compiler_tracking(compiler_tracking) { }
@@ -341,12 +412,12 @@ namespace vcpkg
         struct TripletMapEntry
         {
             std::string hash;
-            Cache<std::string, std::string> triplet_infos;
-            Cache<std::string, std::string> triplet_infos_without_compiler;
-            Cache<std::string, CompilerInfo> compiler_info;
+            ConcurrentCache<std::string, std::string> triplet_infos;
+            ConcurrentCache<std::string, std::string> triplet_infos_without_compiler;
+            ConcurrentCache<std::string, CompilerInfo> compiler_info;
         };
-        Cache<Path, TripletMapEntry> m_triplet_cache;
-        Cache<Path, std::string> m_toolchain_cache;
+        ConcurrentCache<Path, TripletMapEntry> m_triplet_cache;
+        ConcurrentCache<Path, std::string> m_toolchain_cache;
 
         const TripletMapEntry& get_triplet_cache(const ReadOnlyFilesystem& fs, const Path& p) const;
 
@@ -354,10 +425,10 @@ namespace vcpkg
         struct EnvMapEntry
         {
             std::unordered_map<std::string, std::string> env_map;
-            Cache<vcpkg::Command, Environment, CommandLess> cmd_cache;
+            ConcurrentCache<vcpkg::Command, Environment, CommandLess> cmd_cache;
         };
 
-        Cache<std::vector<std::string>, EnvMapEntry> envs;
+        ConcurrentCache<std::vector<std::string>, EnvMapEntry> envs;
 #endif
 
         bool m_compiler_tracking;
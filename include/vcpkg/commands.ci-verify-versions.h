@@ -1,10 +1,64 @@
 #pragma once
 
+#include <vcpkg/base/fwd/files.h>
+#include <vcpkg/base/fwd/message_sinks.h>
+
+#include <vcpkg/fwd/registries.h>
 #include <vcpkg/fwd/vcpkgcmdarguments.h>
 #include <vcpkg/fwd/vcpkgpaths.h>
 
+#include <vcpkg/base/path.h>
+#include <vcpkg/base/span.h>
+
+#include <functional>
+#include <set>
+#include <string>
+
 namespace vcpkg
 {
     extern const CommandMetadata CommandCiVerifyVersionsMetadata;
+
+    // Identifies a version database entry of `port_name` for VerifiedGitTreesCache.
+    std::string verified_git_tree_key(const std::string& port_name, const GitVersionDbEntry& version_entry);
+
+    // Remembers the version database entries that previous runs verified with --verify-git-trees. A git tree id
+    // names the exact contents of a port, so an entry stays verified as long as its port name, git tree, and
+    // version are unchanged, and this vcpkg checks them the same way.
+    struct VerifiedGitTreesCache
+    {
+        VerifiedGitTreesCache(const ReadOnlyFilesystem& fs, Path cache_file);
+
+        bool was_verified(const std::string& key) const;
+
+        // Writes the entries verified by this run, including those skipped because they were previously verified.
+        // Failures are ignored, as the cache only affects performance.
+        void save(const Filesystem& fs, const std::set<std::string>& verified) const;
+
+    private:
+        Path m_cache_file;
+        std::set<std::string> m_previously_verified;
+    };
+
+    struct GitTreeVerification
+    {
+        const std::string* port_name;
+        const Path* versions_file_path;
+        const GitVersionDbEntry* version_entry;
+        std::string key;
+    };
+
+    using GitTreeVerifier = std::function<bool(
+        MessageSink& errors_sink, MessageSink& success_sink, const GitTreeVerification& verification)>;
+
+    // Calls `verify` in parallel for each of `verifications` that `verified_cache` does not remember, then prints
+    // everything they printed to `sink` in the order of `verifications` and saves the verified entries to
+    // `verified_cache`. Returns whether every entry was verified.
+    bool verify_git_trees_in_parallel(const Filesystem& fs,
+                                      MessageSink& sink,
+                                      const VerifiedGitTreesCache& verified_cache,
+                                      View<GitTreeVerification> verifications,
+                                      bool verbose,
+                                      const GitTreeVerifier& verify);
+
     void command_ci_verify_versions_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths);
-}
\ No newline at end of file
+}
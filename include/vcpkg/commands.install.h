@@ -20,6 +20,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace vcpkg
@@ -148,6 +149,37 @@ namespace vcpkg
     void install_preclear_plan_packages(const VcpkgPaths& paths, const ActionPlan& action_plan);
     void install_clear_installed_packages(const VcpkgPaths& paths, View<InstallPlanAction> install_actions);
 
+    // Decides which actions of an install plan run when. An action is started once every action it depends on has
+    // finished, in plan order among the actions that are ready. Two actions for the same port never run at the same
+    // time, as they share a buildtrees directory.
+    struct InstallPlanScheduler
+    {
+        explicit InstallPlanScheduler(View<InstallPlanAction> actions);
+
+        // Returns the index of an action that can be started now, or nullopt if there is none.
+        Optional<size_t> start_next();
+
+        void finish(size_t idx);
+
+        // Stops starting new actions; actions that are running still finish.
+        void stop();
+
+        bool done() const;
+
+    private:
+        View<InstallPlanAction> m_actions;
+        // The number of dependencies of each action which have not finished yet
+        std::vector<size_t> m_remaining_dependencies;
+        std::vector<std::vector<size_t>> m_dependents;
+        // Actions whose dependencies have all finished, in plan order
+        std::set<size_t> m_ready;
+        // The ports with a running action, each with the ready actions of that port waiting for it to finish
+        std::unordered_map<std::string, std::vector<size_t>> m_running_ports;
+        size_t m_started = 0;
+        size_t m_running = 0;
+        bool m_stopped = false;
+    };
+
     InstallSummary install_execute_plan(const VcpkgCmdArguments& args,
                                         const VcpkgPaths& paths,
                                         Triplet host_triplet,
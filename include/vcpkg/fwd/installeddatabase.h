@@ -5,4 +5,6 @@ namespace vcpkg
     // intentionally omitted struct InstalledDatabaseLockImpl;
     struct InstalledDatabaseLock;
     struct InstallAndBuildDatabaseLock;
+    struct InstalledFileOwner;
+    struct InstalledFileIndex;
 }
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace vcpkg::PlatformExpression
+{
+    struct ContextIdentifiers;
+    struct Expr;
+}
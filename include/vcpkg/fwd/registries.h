@@ -7,4 +7,5 @@ namespace vcpkg
     struct Registry;
     struct RegistrySet;
     struct LockFile;
+    struct GitVersionDbEntry;
 }
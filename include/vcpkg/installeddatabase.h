@@ -6,10 +6,16 @@
 #include <vcpkg/fwd/installedpaths.h>
 #include <vcpkg/fwd/statusparagraphs.h>
 
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/stringview.h>
+
 #include <vcpkg/statusparagraph.h>
 
+#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace vcpkg
 {
@@ -93,4 +99,66 @@ namespace vcpkg
     std::vector<StatusParagraphAndAssociatedFiles> get_installed_files_and_upgrade(const Filesystem& fs,
                                                                                    const InstalledPaths& installed,
                                                                                    const StatusParagraphs& status_db);
+
+    struct InstalledFileOwner
+    {
+        // Relative to the installed root, such as x64-linux/include/zlib.h
+        StringView file;
+        StringView owner_display_name;
+    };
+
+    // Maps each file in an installed tree to the package that installed it. The index is saved next to the status
+    // database, and is revalidated against the size, last write time, and inode of every listfile each time it is
+    // loaded, so that only listfiles which changed since it was saved are read.
+    struct InstalledFileIndex
+    {
+        InstalledFileIndex() = default;
+        InstalledFileIndex(const InstalledFileIndex&) = delete;
+        InstalledFileIndex(InstalledFileIndex&&) = default;
+        InstalledFileIndex& operator=(const InstalledFileIndex&) = delete;
+        InstalledFileIndex& operator=(InstalledFileIndex&&) = default;
+
+        // Loads the index for the installed packages in `status_db`, converting installed file lists to the current
+        // version if necessary.
+        static InstalledFileIndex load(const Filesystem& fs,
+                                       const InstalledPaths& installed,
+                                       const StatusParagraphs& status_db);
+
+        // Adds the files of a package whose listfile has just been written.
+        void add_package(const Filesystem& fs, const InstalledPaths& installed, const BinaryParagraph& core_pgh);
+
+        // Returns the installed files named `file`, compared ASCII case-insensitively, and their owners.
+        std::vector<InstalledFileOwner> find(StringView file) const;
+
+        // Returns the installed files whose path, or the part of it after any '/', starts with `prefix`, compared ASCII
+        // case-insensitively, and their owners, grouped by owner. The sorted table this searches is built on first use.
+        std::vector<InstalledFileOwner> find_prefix(StringView prefix);
+
+        // Returns every installed file and its owner, grouped by owner.
+        std::vector<InstalledFileOwner> all_files() const;
+
+        // Writes the index back to disk if it changed since it was loaded.
+        void save(const Filesystem& fs, const InstalledPaths& installed);
+
+    private:
+        struct Owner
+        {
+            std::string display_name;
+            FileMetadata listfile_metadata;
+            // As they appear in the listfile, without directories
+            std::vector<std::string> files;
+        };
+
+        static std::map<std::string, Owner> parse_saved_owners(StringView text);
+        void index_owner(const Owner& owner);
+        void unindex_owner(const Owner& owner);
+
+        // Keyed by the listfile name, which identifies the package, version, and triplet
+        std::map<std::string, Owner> m_owners;
+        // Keyed by the ASCII lowercase file path
+        std::unordered_multimap<std::string, std::pair<const Owner*, size_t>> m_files;
+        // The keys of m_files and each part of them after a '/', sorted; empty until find_prefix needs it
+        std::vector<std::pair<StringView, std::pair<const Owner*, size_t>>> m_sorted_suffixes;
+        bool m_dirty = false;
+    };
 } // namespace vcpkg
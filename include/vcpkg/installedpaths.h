@@ -47,8 +47,16 @@ namespace vcpkg
         Path vcpkg_dir_info() const { return vcpkg_dir() / FileInfo; }
         Path listfile_path(const BinaryParagraph& pgh) const;
 
+        // /vcpkg/installed-file-index maps every installed file to the package that installed it; it is derived from
+        // the listfiles, and revalidated against them whenever it is loaded
+        Path installed_file_index_path() const { return vcpkg_dir() / FileInstalledFileIndex; }
+
         // /vcpkg/status contains information about which packages are installed in this tree
         Path vcpkg_dir_status_file() const { return vcpkg_dir() / FileStatus; }
+        // /vcpkg/status-snapshot is a binary encoding of the status file, written by database_sync so that later loads
+        // need not parse the status file. The status file remains authoritative: the snapshot records the metadata of
+        // the status file it describes and is ignored if they no longer match.
+        Path vcpkg_dir_status_snapshot_file() const { return vcpkg_dir() / FileStatusSnapshot; }
         // /vcpkg/updates/*
         // rolling updates to the status file, written by database_write_update.
         Path vcpkg_dir_updates() const { return vcpkg_dir() / FileUpdates; }
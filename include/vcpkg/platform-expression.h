@@ -1,11 +1,16 @@
 #pragma once
 
+#include <vcpkg/fwd/platform-expression.h>
+
 #include <vcpkg/base/expected.h>
 #include <vcpkg/base/stringview.h>
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace vcpkg::PlatformExpression
@@ -13,9 +18,30 @@ namespace vcpkg::PlatformExpression
     // map of cmake variables and their values.
     using Context = std::unordered_map<std::string, std::string>;
 
+    // The identifiers which are true in a context, with the overrides from VCPKG_DEP_INFO_OVERRIDE_VARS applied.
+    // Evaluating an expression against these needs no lookups of cmake variables, so callers which evaluate many
+    // expressions against one context should reduce it once.
+    struct ContextIdentifiers
+    {
+        static ContextIdentifiers reduce(const Context& context);
+
+    private:
+        friend struct Expr;
+
+        ContextIdentifiers() = default;
+
+        // bit N is set if the built in identifier N is true
+        uint64_t true_identifiers_ = 0;
+        // bit N is set if the context lacks the variables needed to evaluate the built in identifier N
+        uint64_t missing_identifiers_ = 0;
+        // overrides of identifiers which are not built in, sorted by name
+        std::vector<std::pair<std::string, bool>> other_overrides_;
+    };
+
     namespace detail
     {
         struct ExprImpl;
+        struct Instruction;
     }
     struct Expr
     {
@@ -35,6 +61,7 @@ namespace vcpkg::PlatformExpression
         ~Expr();
 
         bool evaluate(const Context& context) const;
+        bool evaluate(const ContextIdentifiers& identifiers) const;
         bool is_empty() const { return !static_cast<bool>(underlying_); }
 
         // returns:
@@ -69,7 +96,11 @@ namespace vcpkg::PlatformExpression
         Expr& simplify();
 
     private:
+        void compile();
+
         std::unique_ptr<detail::ExprImpl> underlying_;
+        // underlying_ flattened for evaluate; rebuilt whenever underlying_ changes
+        std::vector<detail::Instruction> program_;
     };
 
     // Note: for backwards compatibility, in CONTROL files,
@@ -43,13 +43,16 @@ namespace vcpkg
             LockDataType::iterator data;
 
             const std::string& reference() const { return data->second.reference; }
-            const std::string& commit_id() const { return data->second.commit_id; }
-            bool stale() const { return data->second.stale; }
+            // The commit and staleness of an entry change when ensure_up_to_date fetches it, so they are read under
+            // the lock file's lock rather than returned by reference.
+            std::string commit_id() const;
+            bool stale() const;
             const std::string& uri() const { return data->first; }
 
             ExpectedL<Unit> ensure_up_to_date(const VcpkgPaths& paths) const;
         };
 
+        // May be called from several threads at once.
         ExpectedL<Entry> get_or_fetch(const VcpkgPaths& paths, StringView repo, StringView reference);
 
         LockDataType lockdata;
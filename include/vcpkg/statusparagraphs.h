@@ -8,6 +8,9 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace vcpkg
 {
@@ -80,7 +83,16 @@ namespace vcpkg
         const_iterator begin() const { return paragraphs.rbegin(); }
 
     private:
+        void index_paragraph(size_t index);
+        // Returns SIZE_MAX if there is no such paragraph
+        size_t find_index(const std::string& name, Triplet triplet, const std::string& feature) const;
+        iterator iterator_at(size_t index) { return iterator{paragraphs.begin() + index + 1}; }
+        const_iterator iterator_at(size_t index) const { return const_iterator{paragraphs.begin() + index + 1}; }
+
         std::vector<std::unique_ptr<StatusParagraph>> paragraphs;
+        // The indices in `paragraphs` of the paragraphs of each package name, in increasing order. Lookups scan these
+        // backwards, so that like iteration they find the most recently added paragraph first.
+        std::unordered_map<std::string, std::vector<size_t>> indices_by_name;
     };
 
     void print_package_not_installed_but_exists_for_other_triplets(const StatusParagraphs& status_db,
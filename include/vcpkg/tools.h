@@ -60,6 +60,11 @@ namespace vcpkg
         virtual const std::string* get_tool_version(DiagnosticContext& context,
                                                     const Filesystem& fs,
                                                     StringView tool) const = 0;
+        // Returns the paths get_tool_path() considers for `tool`, in order of preference, without running any of them
+        // to check its version.
+        virtual std::vector<Path> get_tool_candidates(DiagnosticContext& context,
+                                                      const Filesystem& fs,
+                                                      StringView tool) const = 0;
     };
 
     void extract_prefixed_nonquote(DiagnosticContext& context,
@@ -2,6 +2,7 @@
 
 #include <vcpkg/base/fwd/downloads.h>
 #include <vcpkg/base/fwd/expected.h>
+#include <vcpkg/base/fwd/file-hash-cache.h>
 #include <vcpkg/base/fwd/files.h>
 #include <vcpkg/base/fwd/git.h>
 #include <vcpkg/base/fwd/system.h>
@@ -60,6 +61,9 @@ namespace vcpkg
         const TripletDatabase& get_triplet_db() const;
         const std::map<std::string, std::string>& get_cmake_script_hashes() const;
         StringView get_ports_cmake_hash() const;
+        // Remembers file hashes across invocations; see X_VCPKG_FILE_HASH_CACHE. Safe to use from several threads
+        // once it has been created.
+        FileHashCache& get_file_hash_cache() const;
 
         LockFile& get_installed_lockfile() const;
         void flush_lockfile() const;
@@ -115,6 +119,9 @@ namespace vcpkg
         LocalizedString get_current_git_sha_baseline_message() const;
         ExpectedL<Path> git_checkout_port(StringView port_name, StringView git_tree, const Path& dot_git_dir) const;
         ExpectedL<std::string> git_show(StringView treeish, const Path& dot_git_dir) const;
+        // Returns the reader of the objects in `dot_git_dir` which git commands here try before launching git, or
+        // nullptr if that is disabled with X_VCPKG_GIT_OBJECT_READER=off. Safe to use from several threads.
+        GitObjectDatabase* get_git_object_database(const Path& dot_git_dir) const;
         Optional<std::vector<GitLSTreeEntry>> get_builtin_ports_directory_trees(DiagnosticContext& context) const;
 
         // Git manipulation for remote registries
@@ -1,6 +1,9 @@
 #include <vcpkg-test/util.h>
 
+#include <vcpkg/base/contractual-constants.h>
+#include <vcpkg/base/files.h>
 #include <vcpkg/base/xmlserializer.h>
+#include <vcpkg/base/zip.h>
 
 #include <vcpkg/binarycaching.h>
 #include <vcpkg/binarycaching.private.h>
@@ -8,7 +11,10 @@
 #include <vcpkg/paragraphs.h>
 #include <vcpkg/sourceparagraph.h>
 
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
 
 using namespace vcpkg;
 
@@ -370,6 +376,19 @@ Description:
     REQUIRE(fbdc.empty());
 }
 
+TEST_CASE ("parse_object_storage_listing", "[BinaryCache]")
+{
+    CHECK(parse_object_storage_listing("").empty());
+    CHECK(parse_object_storage_listing("gs://bucket/prefix/aaaa.zip\n"
+                                       "gs://bucket/prefix/bbbb.zip\r\n"
+                                       "gs://bucket/prefix/subdir/\n") ==
+          std::vector<std::string>{"aaaa.zip", "bbbb.zip"});
+    CHECK(parse_object_storage_listing("                           PRE subdir/\n"
+                                       "2024-01-02 03:04:05      12345 aaaa.zip\n"
+                                       "2024-01-02 03:04:06        678 bbbb.zip\n") ==
+          std::vector<std::string>{"aaaa.zip", "bbbb.zip"});
+}
+
 TEST_CASE ("XmlSerializer", "[XmlSerializer]")
 {
     XmlSerializer xml;
@@ -661,3 +680,482 @@ TEST_CASE ("Test batch_command_arguments_with_fixed_length", "[batch-arguments]"
         REQUIRE(batches[0].size() == 3);
     }
 }
+
+namespace
+{
+    struct CountingWriteBinaryProvider : IWriteBinaryProvider
+    {
+        explicit CountingWriteBinaryProvider(size_t max_concurrent) : max_concurrent(max_concurrent) { }
+
+        size_t push_success(DiagnosticContext&, const Filesystem& fs, const BinaryPackageWriteInfo& request) override
+        {
+            const auto now_running = ++running;
+            auto old_max = max_running.load();
+            while (old_max < now_running && !max_running.compare_exchange_weak(old_max, now_running))
+            {
+            }
+
+            // the packages directory must not be cleaned until every provider is done with it
+            if (!fs.exists(request.package_dir / "contents.txt", IgnoreErrors{}))
+            {
+                ++missing_packages;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            --running;
+            ++pushed;
+            return 1;
+        }
+
+        bool needs_nuspec_data() const override { return false; }
+        bool needs_zip_file() const override { return false; }
+        size_t max_concurrent_pushes() const override { return max_concurrent; }
+
+        size_t max_concurrent;
+        std::atomic<size_t> running{0};
+        std::atomic<size_t> max_running{0};
+        std::atomic<size_t> pushed{0};
+        std::atomic<size_t> missing_packages{0};
+    };
+}
+
+TEST_CASE ("BinaryCache pushes to every provider within its concurrency limit", "[BinaryCache]")
+{
+    auto& fs = real_filesystem;
+    const auto packages_root = Test::base_temporary_directory() / "binarycache-push";
+    fs.remove_all(packages_root, VCPKG_LINE_INFO);
+
+    auto pghs = Paragraphs::parse_paragraphs(R"(
+Source: zlib
+Version: 1.5
+Description: a spiffy compression library wrapper
+)",
+                                             "<testdata>");
+    REQUIRE(pghs.has_value());
+    auto maybe_scf = SourceControlFile::parse_control_file("test-origin", std::move(*pghs.get()));
+    REQUIRE(maybe_scf.has_value());
+    SourceControlFileAndLocation scfl{std::move(*maybe_scf.get()), Path()};
+    PackagesDirAssigner packages_dir_assigner{packages_root};
+
+    static constexpr size_t package_count = 8;
+    std::vector<InstallPlanAction> actions;
+    for (size_t i = 0; i < package_count; ++i)
+    {
+        auto& action = actions.emplace_back(PackageSpec{fmt::format("zlib{}", i), Test::X64_WINDOWS},
+                                            scfl,
+                                            packages_dir_assigner,
+                                            RequestType::USER_REQUESTED,
+                                            UseHeadVersion::No,
+                                            Editable::No,
+                                            std::map<std::string, std::vector<FeatureSpec>>{},
+                                            std::vector<DiagnosticLine>{},
+                                            std::vector<std::string>{});
+        action.abi_info = AbiInfo{};
+        action.abi_info.get()->package_abi = fmt::format("packageabi{}", i);
+        fs.create_directories(action.package_dir, VCPKG_LINE_INFO);
+        fs.write_contents(action.package_dir / "contents.txt", "contents", VCPKG_LINE_INFO);
+    }
+
+    auto parallel_provider = std::make_unique<CountingWriteBinaryProvider>(2);
+    auto serial_provider = std::make_unique<CountingWriteBinaryProvider>(1);
+    auto& parallel = *parallel_provider;
+    auto& serial = *serial_provider;
+    {
+        BinaryCache uut(fs, 4);
+        uut.install_write_provider(std::move(parallel_provider));
+        uut.install_write_provider(std::move(serial_provider));
+        for (auto&& action : actions)
+        {
+            uut.push_success(CleanPackages::Yes, action);
+        }
+
+        uut.wait_for_async_complete_and_join();
+
+        CHECK(parallel.pushed == package_count);
+        CHECK(parallel.max_running <= 2);
+        CHECK(parallel.missing_packages == 0);
+        CHECK(serial.pushed == package_count);
+        CHECK(serial.max_running == 1);
+        CHECK(serial.missing_packages == 0);
+        for (auto&& action : actions)
+        {
+            CHECK(!fs.exists(action.package_dir, IgnoreErrors{}));
+        }
+    }
+
+    fs.remove_all(packages_root, VCPKG_LINE_INFO);
+}
+
+namespace
+{
+    struct FakeZipBinaryProvider : IReadBinaryProvider
+    {
+        FakeZipBinaryProvider(std::vector<std::string> abis, std::chrono::milliseconds delay)
+            : abis(std::move(abis)), delay(delay)
+        {
+        }
+
+        void fetch(DiagnosticContext&,
+                   const Filesystem&,
+                   View<const InstallPlanAction*> actions,
+                   Span<RestoreResult>) const override
+        {
+            fetched += actions.size();
+        }
+
+        void precheck(DiagnosticContext&,
+                      const Filesystem&,
+                      View<const InstallPlanAction*>,
+                      Span<CacheAvailability>) const override
+        {
+        }
+
+        LocalizedString restored_message(size_t, std::chrono::high_resolution_clock::duration) const override
+        {
+            return LocalizedString::from_raw("Fake");
+        }
+
+        bool try_acquire_zips(DiagnosticContext&,
+                              const Filesystem&,
+                              View<const InstallPlanAction*> actions,
+                              Span<Optional<ZipResource>> out_zips) const override
+        {
+            std::this_thread::sleep_for(delay);
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                const auto& abi = actions[i]->package_abi_or_exit(VCPKG_LINE_INFO);
+                if (Util::Vectors::contains(abis, abi))
+                {
+                    out_zips[i].emplace(Path{abi + ".zip"}, RemoveWhen::nothing);
+                }
+            }
+
+            return true;
+        }
+
+        void extract_zips(DiagnosticContext&,
+                          const Filesystem&,
+                          View<const InstallPlanAction*> actions,
+                          View<Optional<ZipResource>> zips,
+                          Span<RestoreResult> out_status) const override
+        {
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                REQUIRE(zips[i].has_value());
+                extracted.push_back(actions[i]->package_abi_or_exit(VCPKG_LINE_INFO));
+                out_status[i] = RestoreResult::restored;
+            }
+        }
+
+        std::vector<std::string> abis;
+        std::chrono::milliseconds delay;
+        mutable std::vector<std::string> extracted;
+        mutable size_t fetched = 0;
+    };
+
+    // Acquires archives one at a time, waiting `delay` before each, as if the requests were queued
+    struct FakeQueuedZipBinaryProvider : FakeZipBinaryProvider
+    {
+        using FakeZipBinaryProvider::FakeZipBinaryProvider;
+
+        bool try_acquire_zips_as_available(DiagnosticContext&,
+                                           const Filesystem&,
+                                           View<const InstallPlanAction*> actions,
+                                           AcquiredZipSink& sink) const override
+        {
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                std::this_thread::sleep_for(delay);
+                const auto& abi = actions[i]->package_abi_or_exit(VCPKG_LINE_INFO);
+                if (!sink.wants(i))
+                {
+                    skipped.push_back(abi);
+                }
+                else if (Util::Vectors::contains(abis, abi))
+                {
+                    sink.acquired(i, ZipResource{Path{abi + ".zip"}, RemoveWhen::nothing});
+                }
+            }
+
+            return true;
+        }
+
+        mutable std::vector<std::string> skipped;
+    };
+
+    struct FakeNonZipBinaryProvider : IReadBinaryProvider
+    {
+        void fetch(DiagnosticContext&,
+                   const Filesystem&,
+                   View<const InstallPlanAction*> actions,
+                   Span<RestoreResult> out_status) const override
+        {
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                const auto& abi = actions[i]->package_abi_or_exit(VCPKG_LINE_INFO);
+                fetched.push_back(abi);
+                if (abi == "abi3")
+                {
+                    out_status[i] = RestoreResult::restored;
+                }
+            }
+        }
+
+        void precheck(DiagnosticContext&,
+                      const Filesystem&,
+                      View<const InstallPlanAction*>,
+                      Span<CacheAvailability>) const override
+        {
+        }
+
+        LocalizedString restored_message(size_t, std::chrono::high_resolution_clock::duration) const override
+        {
+            return LocalizedString::from_raw("Fake");
+        }
+
+        mutable std::vector<std::string> fetched;
+    };
+}
+
+TEST_CASE ("ReadOnlyBinaryCache concurrent fetch restores from the first provider", "[BinaryCache]")
+{
+    auto pghs = Paragraphs::parse_paragraphs(R"(
+Source: zlib
+Version: 1.5
+Description: a spiffy compression library wrapper
+)",
+                                             "<testdata>");
+    REQUIRE(pghs.has_value());
+    auto maybe_scf = SourceControlFile::parse_control_file("test-origin", std::move(*pghs.get()));
+    REQUIRE(maybe_scf.has_value());
+    SourceControlFileAndLocation scfl{std::move(*maybe_scf.get()), Path()};
+    PackagesDirAssigner packages_dir_assigner{"test_packages_root"};
+    std::vector<InstallPlanAction> actions;
+    for (size_t i = 1; i <= 4; ++i)
+    {
+        auto& action = actions.emplace_back(PackageSpec{fmt::format("zlib{}", i), Test::X64_WINDOWS},
+                                            scfl,
+                                            packages_dir_assigner,
+                                            RequestType::USER_REQUESTED,
+                                            UseHeadVersion::No,
+                                            Editable::No,
+                                            std::map<std::string, std::vector<FeatureSpec>>{},
+                                            std::vector<DiagnosticLine>{},
+                                            std::vector<std::string>{});
+        action.abi_info = AbiInfo{};
+        action.abi_info.get()->package_abi = fmt::format("abi{}", i);
+    }
+
+    auto slow_provider = std::make_unique<FakeZipBinaryProvider>(std::vector<std::string>{"abi1", "abi2"},
+                                                                 std::chrono::milliseconds(200));
+    auto fast_provider =
+        std::make_unique<FakeZipBinaryProvider>(std::vector<std::string>{"abi1"}, std::chrono::milliseconds(0));
+    auto non_zip_provider = std::make_unique<FakeNonZipBinaryProvider>();
+    auto& slow = *slow_provider;
+    auto& fast = *fast_provider;
+    auto& non_zip = *non_zip_provider;
+
+    ReadOnlyBinaryCache uut;
+    uut.install_read_provider(std::move(slow_provider));
+    uut.install_read_provider(std::move(fast_provider));
+    uut.install_read_provider(std::move(non_zip_provider));
+    uut.set_concurrent_fetch(true);
+
+    FullyBufferedDiagnosticContext fbdc;
+    uut.fetch(fbdc, always_failing_filesystem, actions);
+
+    // abi1 is restored from the fast provider even though the slow one is consulted first
+    CHECK(fast.extracted == std::vector<std::string>{"abi1"});
+    CHECK(slow.extracted == std::vector<std::string>{"abi2"});
+    CHECK(fast.fetched == 0);
+    CHECK(slow.fetched == 0);
+    // providers which can't acquire zips get whatever is left afterwards
+    CHECK(non_zip.fetched == std::vector<std::string>{"abi3", "abi4"});
+    CHECK(uut.is_restored(actions[0]));
+    CHECK(uut.is_restored(actions[1]));
+    CHECK(uut.is_restored(actions[2]));
+    CHECK(!uut.is_restored(actions[3]));
+}
+
+TEST_CASE ("ReadOnlyBinaryCache concurrent fetch skips archives another provider delivered", "[BinaryCache]")
+{
+    auto pghs = Paragraphs::parse_paragraphs(R"(
+Source: zlib
+Version: 1.5
+Description: a spiffy compression library wrapper
+)",
+                                             "<testdata>");
+    REQUIRE(pghs.has_value());
+    auto maybe_scf = SourceControlFile::parse_control_file("test-origin", std::move(*pghs.get()));
+    REQUIRE(maybe_scf.has_value());
+    SourceControlFileAndLocation scfl{std::move(*maybe_scf.get()), Path()};
+    PackagesDirAssigner packages_dir_assigner{"test_packages_root"};
+    std::vector<InstallPlanAction> actions;
+    for (size_t i = 1; i <= 3; ++i)
+    {
+        auto& action = actions.emplace_back(PackageSpec{fmt::format("zlib{}", i), Test::X64_WINDOWS},
+                                            scfl,
+                                            packages_dir_assigner,
+                                            RequestType::USER_REQUESTED,
+                                            UseHeadVersion::No,
+                                            Editable::No,
+                                            std::map<std::string, std::vector<FeatureSpec>>{},
+                                            std::vector<DiagnosticLine>{},
+                                            std::vector<std::string>{});
+        action.abi_info = AbiInfo{};
+        action.abi_info.get()->package_abi = fmt::format("abi{}", i);
+    }
+
+    auto queued_provider = std::make_unique<FakeQueuedZipBinaryProvider>(
+        std::vector<std::string>{"abi1", "abi2", "abi3"}, std::chrono::milliseconds(100));
+    auto fast_provider =
+        std::make_unique<FakeZipBinaryProvider>(std::vector<std::string>{"abi1"}, std::chrono::milliseconds(0));
+    auto& queued = *queued_provider;
+    auto& fast = *fast_provider;
+
+    ReadOnlyBinaryCache uut;
+    uut.install_read_provider(std::move(queued_provider));
+    uut.install_read_provider(std::move(fast_provider));
+    uut.set_concurrent_fetch(true);
+
+    FullyBufferedDiagnosticContext fbdc;
+    uut.fetch(fbdc, always_failing_filesystem, actions);
+
+    // abi1 is never requested from the queued provider, as the fast one delivered it first
+    CHECK(queued.skipped == std::vector<std::string>{"abi1"});
+    CHECK(fast.extracted == std::vector<std::string>{"abi1"});
+    CHECK(queued.extracted == std::vector<std::string>{"abi2", "abi3"});
+    CHECK(uut.is_restored(actions[0]));
+    CHECK(uut.is_restored(actions[1]));
+    CHECK(uut.is_restored(actions[2]));
+}
+
+namespace
+{
+    struct DirectoryZipBinaryProvider : IReadBinaryProvider
+    {
+        DirectoryZipBinaryProvider(Path dir) : dir(std::move(dir)) { }
+
+        void fetch(DiagnosticContext&,
+                   const Filesystem&,
+                   View<const InstallPlanAction*>,
+                   Span<RestoreResult>) const override
+        {
+            FAIL();
+        }
+
+        void precheck(DiagnosticContext&,
+                      const Filesystem&,
+                      View<const InstallPlanAction*>,
+                      Span<CacheAvailability>) const override
+        {
+        }
+
+        LocalizedString restored_message(size_t, std::chrono::high_resolution_clock::duration) const override
+        {
+            return LocalizedString::from_raw("Directory");
+        }
+
+        bool try_acquire_zips(DiagnosticContext&,
+                              const Filesystem&,
+                              View<const InstallPlanAction*> actions,
+                              Span<Optional<ZipResource>> out_zips) const override
+        {
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                out_zips[i].emplace(dir / (actions[i]->package_abi_or_exit(VCPKG_LINE_INFO) + ".zip"),
+                                    RemoveWhen::nothing);
+            }
+
+            return true;
+        }
+
+        void extract_zips(DiagnosticContext&,
+                          const Filesystem&,
+                          View<const InstallPlanAction*> actions,
+                          View<Optional<ZipResource>> zips,
+                          Span<RestoreResult> out_status) const override
+        {
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                if (zips[i].has_value())
+                {
+                    extracted.push_back(actions[i]->package_abi_or_exit(VCPKG_LINE_INFO));
+                    out_status[i] = RestoreResult::restored;
+                }
+            }
+        }
+
+        Path dir;
+        mutable std::vector<std::string> extracted;
+    };
+}
+
+TEST_CASE ("ReadOnlyBinaryCache direct restore defers archives", "[BinaryCache]")
+{
+    auto& fs = real_filesystem;
+    const auto root = Test::base_temporary_directory() / "direct-restore";
+    fs.remove_all(root, VCPKG_LINE_INFO);
+    const auto package_source = root / "source";
+    fs.write_contents_and_dirs(package_source / FileControl, "Package: zlib2\n", VCPKG_LINE_INFO);
+    fs.write_contents(package_source / FileBuildInfo, "CRTLinkage: dynamic\n", VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(package_source / "include" / "zlib.h", "// zlib\n", VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(package_source / "share" / "zlib2" / "copyright", "copyright\n", VCPKG_LINE_INFO);
+    const auto archives = root / "archives";
+    fs.create_directories(archives, VCPKG_LINE_INFO);
+    REQUIRE(Zip::compress_directory(console_diagnostic_context, fs, package_source, archives / "abi1.zip"));
+    fs.write_contents(archives / "abi2.zip", "not a zip archive", VCPKG_LINE_INFO);
+
+    auto pghs = Paragraphs::parse_paragraphs(R"(
+Source: zlib
+Version: 1.5
+Description: a spiffy compression library wrapper
+)",
+                                             "<testdata>");
+    REQUIRE(pghs.has_value());
+    auto maybe_scf = SourceControlFile::parse_control_file("test-origin", std::move(*pghs.get()));
+    REQUIRE(maybe_scf.has_value());
+    SourceControlFileAndLocation scfl{std::move(*maybe_scf.get()), Path()};
+    PackagesDirAssigner packages_dir_assigner{root / "packages"};
+    std::vector<InstallPlanAction> actions;
+    for (size_t i = 1; i <= 2; ++i)
+    {
+        auto& action = actions.emplace_back(PackageSpec{fmt::format("zlib{}", i + 1), Test::X64_WINDOWS},
+                                            scfl,
+                                            packages_dir_assigner,
+                                            RequestType::USER_REQUESTED,
+                                            UseHeadVersion::No,
+                                            Editable::No,
+                                            std::map<std::string, std::vector<FeatureSpec>>{},
+                                            std::vector<DiagnosticLine>{},
+                                            std::vector<std::string>{});
+        action.abi_info = AbiInfo{};
+        action.abi_info.get()->package_abi = fmt::format("abi{}", i);
+    }
+
+    auto provider = std::make_unique<DirectoryZipBinaryProvider>(archives);
+    auto& directory_provider = *provider;
+    ReadOnlyBinaryCache uut;
+    uut.install_read_provider(std::move(provider));
+    uut.set_direct_restore(true);
+
+    FullyBufferedDiagnosticContext fbdc;
+    uut.fetch(fbdc, fs, actions);
+    CHECK(uut.is_restored(actions[0]));
+    CHECK(uut.is_restored(actions[1]));
+
+    // Only the control files of the deferred archive are extracted
+    auto deferred = uut.deferred_archive(actions[0]);
+    REQUIRE(deferred);
+    CHECK(deferred->zip.path == archives / "abi1.zip");
+    CHECK(Util::any_of(deferred->entries, [](const Zip::Entry& entry) { return entry.name == "include/zlib.h"; }));
+    auto package_files = Util::fmap(fs.get_files_recursive_lexically_proximate(actions[0].package_dir, VCPKG_LINE_INFO),
+                                    [](const Path& file) { return file.native(); });
+    Util::sort(package_files);
+    CHECK(package_files == std::vector<std::string>{"BUILD_INFO", "CONTROL"});
+
+    // Archives which the built-in reader can't read are extracted by the provider
+    CHECK(!uut.deferred_archive(actions[1]));
+    CHECK(directory_provider.extracted == std::vector<std::string>{"abi2"});
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
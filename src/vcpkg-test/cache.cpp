@@ -1,8 +1,10 @@
 #include <vcpkg-test/util.h>
 
 #include <vcpkg/base/cache.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/stringview.h>
 
+#include <atomic>
 #include <string>
 
 using namespace vcpkg;
@@ -13,10 +15,10 @@ struct Just
     int operator()() const { return result; }
 };
 
-template<class StringLiteralType>
+template<template<class...> class CacheType, class StringLiteralType>
 void test_case_cache()
 {
-    Cache<std::string, int> cache;
+    CacheType<std::string, int> cache;
     const StringLiteralType apple{"apple"};
     const StringLiteralType durian{"durian"};
     const StringLiteralType melon{"melon"};
@@ -43,10 +45,62 @@ void test_case_cache()
 
 TEST_CASE ("cache non-transparent", "[cache]")
 {
-    test_case_cache<std::string>();
+    test_case_cache<Cache, std::string>();
+    test_case_cache<ConcurrentCache, std::string>();
 }
 
 TEST_CASE ("cache transparent", "[cache]")
 {
-    test_case_cache<StringLiteral>();
+    test_case_cache<Cache, StringLiteral>();
+    test_case_cache<ConcurrentCache, StringLiteral>();
+}
+
+TEST_CASE ("concurrent cache computes each value once", "[cache]")
+{
+    ConcurrentCache<int, int> cache;
+    std::atomic<int> computations{0};
+    std::atomic<int> mismatches{0};
+    execute_in_parallel(400, [&](size_t i) {
+        const auto key = static_cast<int>(i % 10);
+        const auto& value = cache.get_lazy(key, [&] {
+            ++computations;
+            return key * 2;
+        });
+        if (value != key * 2)
+        {
+            ++mismatches;
+        }
+    });
+
+    CHECK(computations.load() == 10);
+    CHECK(mismatches.load() == 0);
+}
+
+TEST_CASE ("concurrent caches can be nested", "[cache]")
+{
+    struct Entry
+    {
+        int value;
+        ConcurrentCache<int, int> inner;
+    };
+
+    ConcurrentCache<int, Entry> cache;
+    std::atomic<int> computations{0};
+    std::atomic<int> mismatches{0};
+    execute_in_parallel(400, [&](size_t i) {
+        const auto key = static_cast<int>(i % 10);
+        const auto inner_key = static_cast<int>(i / 10 % 4);
+        const auto& entry = cache.get_lazy(key, [&] { return Entry{key * 2, {}}; });
+        const auto& value = entry.inner.get_lazy(inner_key, [&] {
+            ++computations;
+            return entry.value + inner_key;
+        });
+        if (value != key * 2 + inner_key)
+        {
+            ++mismatches;
+        }
+    });
+
+    CHECK(computations.load() == 40);
+    CHECK(mismatches.load() == 0);
 }
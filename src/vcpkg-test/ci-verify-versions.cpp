@@ -0,0 +1,244 @@
+#include <vcpkg-test/util.h>
+
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/message_sinks.h>
+#include <vcpkg/base/util.h>
+
+#include <vcpkg/commands.ci-verify-versions.h>
+#include <vcpkg/registries.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+using namespace vcpkg;
+
+namespace
+{
+    struct VersionDatabaseEntries
+    {
+        explicit VersionDatabaseEntries(size_t count)
+        {
+            for (size_t idx = 0; idx < count; ++idx)
+            {
+                port_names.push_back(fmt::format("port-{}", idx));
+                version_entries.push_back(GitVersionDbEntry{SchemedVersion{VersionScheme::Relaxed, Version{"1.0", 0}},
+                                                            fmt::format("{:040}", idx)});
+            }
+        }
+
+        std::vector<GitTreeVerification> verifications() const
+        {
+            std::vector<GitTreeVerification> result;
+            for (size_t idx = 0; idx < port_names.size(); ++idx)
+            {
+                result.push_back(GitTreeVerification{&port_names[idx],
+                                                     &versions_file_path,
+                                                     &version_entries[idx],
+                                                     verified_git_tree_key(port_names[idx], version_entries[idx])});
+            }
+
+            return result;
+        }
+
+        Path versions_file_path = "versions/p-/port.json";
+        std::vector<std::string> port_names;
+        std::vector<GitVersionDbEntry> version_entries;
+    };
+
+    // Verifies every entry but `failing_port`, with later entries finishing first, and remembers which ports it
+    // was asked to verify
+    struct RecordingVerifier
+    {
+        explicit RecordingVerifier(std::string failing_port) : failing_port(std::move(failing_port)) { }
+
+        bool operator()(MessageSink& errors_sink, MessageSink& success_sink, const GitTreeVerification& verification)
+        {
+            auto& port_name = *verification.port_name;
+            const auto idx = std::stoi(port_name.substr(5));
+            std::this_thread::sleep_for(std::chrono::milliseconds((32 - idx) % 8));
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                verified_ports.push_back(port_name);
+            }
+
+            if (port_name == failing_port)
+            {
+                errors_sink.println(LocalizedString::from_raw(fmt::format("error: {}", port_name)));
+                return false;
+            }
+
+            success_sink.println(LocalizedString::from_raw(fmt::format("verified: {}", port_name)));
+            return true;
+        }
+
+        std::vector<std::string> sorted_verified_ports()
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto result = verified_ports;
+            Util::sort(result);
+            verified_ports.clear();
+            return result;
+        }
+
+        std::string failing_port;
+        std::mutex mtx;
+        std::vector<std::string> verified_ports;
+    };
+
+    std::vector<std::string> to_strings(const std::vector<MessageLine>& lines)
+    {
+        return Util::fmap(lines, [](const MessageLine& line) { return line.to_string(); });
+    }
+}
+
+TEST_CASE ("verified_git_tree_key", "[ci-verify-versions]")
+{
+    const std::string port_name = "zlib";
+    const GitVersionDbEntry entry{SchemedVersion{VersionScheme::Relaxed, Version{"1.3.1", 0}},
+                                  "3f05e5a6c4e2a2b7e5de1b4c1bbbf1e2a1f2e3d4"};
+    const auto key = verified_git_tree_key(port_name, entry);
+    CHECK(verified_git_tree_key(port_name, entry) == key);
+    CHECK(verified_git_tree_key("zlib-ng", entry) != key);
+
+    auto other_tree = entry;
+    other_tree.git_tree = "0000000000000000000000000000000000000000";
+    CHECK(verified_git_tree_key(port_name, other_tree) != key);
+
+    auto other_version = entry;
+    other_version.version.version = Version{"1.3.2", 0};
+    CHECK(verified_git_tree_key(port_name, other_version) != key);
+
+    auto other_port_version = entry;
+    other_port_version.version.version = Version{"1.3.1", 1};
+    CHECK(verified_git_tree_key(port_name, other_port_version) != key);
+
+    auto other_scheme = entry;
+    other_scheme.version.scheme = VersionScheme::Semver;
+    CHECK(verified_git_tree_key(port_name, other_scheme) != key);
+}
+
+TEST_CASE ("VerifiedGitTreesCache", "[ci-verify-versions]")
+{
+    auto const root = Test::base_temporary_directory() / "verified-git-trees-cache";
+    real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+    auto const cache_file = root / "verified-git-trees.json";
+
+    {
+        VerifiedGitTreesCache missing(real_filesystem, cache_file);
+        CHECK(!missing.was_verified("a"));
+        missing.save(real_filesystem, {"a", "b"});
+    }
+
+    VerifiedGitTreesCache reloaded(real_filesystem, cache_file);
+    CHECK(reloaded.was_verified("a"));
+    CHECK(reloaded.was_verified("b"));
+    CHECK(!reloaded.was_verified("c"));
+
+    SECTION ("entries that are no longer verified are forgotten")
+    {
+        reloaded.save(real_filesystem, {"b", "c"});
+        VerifiedGitTreesCache next(real_filesystem, cache_file);
+        CHECK(!next.was_verified("a"));
+        CHECK(next.was_verified("b"));
+        CHECK(next.was_verified("c"));
+    }
+
+    SECTION ("a corrupt cache file is ignored")
+    {
+        real_filesystem.write_contents(cache_file, "{\"version\": 1, \"verified\": [", VCPKG_LINE_INFO);
+        VerifiedGitTreesCache corrupt(real_filesystem, cache_file);
+        CHECK(!corrupt.was_verified("a"));
+    }
+
+    SECTION ("a cache file written by another vcpkg is ignored")
+    {
+        real_filesystem.write_contents(cache_file,
+                                       R"json({"version": 1, "vcpkg-version": "other", "verified": ["a"]})json",
+                                       VCPKG_LINE_INFO);
+        VerifiedGitTreesCache other(real_filesystem, cache_file);
+        CHECK(!other.was_verified("a"));
+    }
+}
+
+TEST_CASE ("verify_git_trees_in_parallel", "[ci-verify-versions]")
+{
+    auto const root = Test::base_temporary_directory() / "verify-git-trees-in-parallel";
+    real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+    auto const cache_file = root / "verified-git-trees.json";
+
+    VersionDatabaseEntries database{32};
+    RecordingVerifier verifier{"port-3"};
+    auto run = [&](bool verbose, std::vector<std::string>& output) {
+        VerifiedGitTreesCache verified_cache(real_filesystem, cache_file);
+        LineBufferSink sink;
+        const auto verifications = database.verifications();
+        const bool result = verify_git_trees_in_parallel(
+            real_filesystem, sink, verified_cache, verifications, verbose, std::ref(verifier));
+        output = to_strings(sink.lines);
+        return result;
+    };
+
+    std::vector<std::string> all_ports = database.port_names;
+    Util::sort(all_ports);
+
+    std::vector<std::string> output;
+    CHECK(!run(true, output));
+    CHECK(verifier.sorted_verified_ports() == all_ports);
+
+    // Output is printed in the order of the version database, not in the order verification finishes
+    std::vector<std::string> expected_output;
+    for (auto&& port_name : database.port_names)
+    {
+        expected_output.push_back(port_name == "port-3" ? "error: port-3" : fmt::format("verified: {}", port_name));
+    }
+
+    CHECK(output == expected_output);
+
+    SECTION ("previously verified entries are not verified again")
+    {
+        CHECK(!run(false, output));
+        CHECK(verifier.sorted_verified_ports() == std::vector<std::string>{"port-3"});
+        CHECK(output == std::vector<std::string>{"error: port-3"});
+
+        // Entries that were not verified again still report success in verbose mode, in order
+        CHECK(!run(true, output));
+        CHECK(verifier.sorted_verified_ports() == std::vector<std::string>{"port-3"});
+        REQUIRE(output.size() == database.port_names.size());
+        CHECK(output[3] == "error: port-3");
+        for (size_t idx = 0; idx < output.size(); ++idx)
+        {
+            if (idx != 3)
+            {
+                CHECK(StringView{output[idx]}.contains(database.port_names[idx]));
+            }
+        }
+    }
+
+    SECTION ("entries whose git tree changed are verified again")
+    {
+        database.version_entries[5].git_tree = "0000000000000000000000000000000000000000";
+        CHECK(!run(false, output));
+        CHECK(verifier.sorted_verified_ports() == std::vector<std::string>{"port-3", "port-5"});
+        CHECK(output == std::vector<std::string>{"error: port-3"});
+    }
+
+    SECTION ("entries whose version changed are verified again")
+    {
+        database.version_entries[6].version.version = Version{"1.0", 1};
+        database.version_entries[7].version.scheme = VersionScheme::String;
+        CHECK(!run(false, output));
+        CHECK(verifier.sorted_verified_ports() == std::vector<std::string>{"port-3", "port-6", "port-7"});
+    }
+
+    SECTION ("entries that are fixed are remembered")
+    {
+        verifier.failing_port = "port-none";
+        CHECK(run(false, output));
+        CHECK(verifier.sorted_verified_ports() == std::vector<std::string>{"port-3"});
+        CHECK(output.empty());
+
+        CHECK(run(false, output));
+        CHECK(verifier.sorted_verified_ports().empty());
+    }
+}
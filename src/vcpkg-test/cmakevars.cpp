@@ -0,0 +1,390 @@
+#include <vcpkg-test/util.h>
+
+#include <vcpkg/base/contractual-constants.h>
+#include <vcpkg/base/file-hash-cache.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/system.h>
+
+#include <vcpkg/cmakevars.h>
+#include <vcpkg/triplet.h>
+
+using namespace vcpkg;
+using namespace vcpkg::CMakeVars;
+
+namespace
+{
+    using VarList = std::vector<std::pair<std::string, std::string>>;
+
+    constexpr StringLiteral port_start = "d8187afd-ea4a-4fc3-9aa4-a6782e1ed9af";
+    constexpr StringLiteral port_end = "8c504940-be29-4cba-9f8f-6cd83e9d87b7";
+    constexpr StringLiteral block_start = "c35112b6-d1ba-415b-aa5d-81de856ef8eb";
+    constexpr StringLiteral block_end = "e1e74b5c-18cb-4474-a6bd-5c1c8bc81f3f";
+
+    // The output of a spec with one block for each of `blocks`, each holding the given lines
+    std::string port_output(std::initializer_list<StringView> blocks)
+    {
+        std::string result = fmt::format("{}\n", port_start);
+        for (auto&& block : blocks)
+        {
+            fmt::format_to(std::back_inserter(result), "{}\n{}\n{}\n", block_start, block, block_end);
+        }
+
+        fmt::format_to(std::back_inserter(result), "{}\n", port_end);
+        return result;
+    }
+
+    struct EnvironmentVariableResetter
+    {
+        explicit EnvironmentVariableResetter(ZStringView varname)
+            : varname(varname), old_value(get_environment_variable(varname))
+        {
+        }
+
+        ~EnvironmentVariableResetter() { set_environment_variable(varname, old_value); }
+
+        EnvironmentVariableResetter(const EnvironmentVariableResetter&) = delete;
+        EnvironmentVariableResetter& operator=(const EnvironmentVariableResetter&) = delete;
+
+    private:
+        ZStringView varname;
+        Optional<std::string> old_value;
+    };
+
+    std::string common_key(std::vector<std::string> environment,
+                           const std::map<std::string, std::string>& script_hashes = {{"vcpkg.cmake", "1234"}},
+                           int64_t cmake_last_write_time = 100)
+    {
+        FileMetadata cmake_metadata;
+        cmake_metadata.size = 42;
+        cmake_metadata.last_write_time = cmake_last_write_time;
+        cmake_metadata.inode = 7;
+        const std::pair<Path, FileMetadata> cmake_candidates[] = {{"/usr/bin/cmake", cmake_metadata}};
+        return get_common_cmake_vars_cache_key("abcd", script_hashes, cmake_candidates, std::move(environment));
+    }
+}
+
+TEST_CASE ("parse_cmake_vars_output splits well formed output", "[cmakevars]")
+{
+    const auto output = "-- a message from CMake\n" + port_output({"A=1\nB=", "C=3"}) +
+                        port_output({"D=4\r\nE=five\r"}) + "-- another message\n";
+    std::vector<VarList> vars(2);
+    REQUIRE(parse_cmake_vars_output(output, vars).has_value());
+    CHECK(vars[0] == VarList{{"A", "1"}, {"B", ""}, {"C", "3"}});
+    CHECK(vars[1] == VarList{{"D", "4"}, {"E", "five"}});
+}
+
+TEST_CASE ("parse_cmake_vars_output keeps stray text between markers", "[cmakevars]")
+{
+    std::vector<VarList> vars(1);
+    CMakeVarsOutputParser parser{vars};
+    for (auto&& line : {port_start.to_string(),
+                        std::string("stray before the block"),
+                        block_start.to_string(),
+                        std::string("A=1"),
+                        block_end.to_string(),
+                        std::string("stray after the block"),
+                        port_end.to_string(),
+                        std::string("stray after the port")})
+    {
+        parser.parse_line(line);
+    }
+
+    REQUIRE(parser.finish().has_value());
+    CHECK(vars[0] == VarList{{"A", "1"}});
+    CHECK(parser.other_lines() ==
+          std::vector<std::string>{"stray before the block", "stray after the block", "stray after the port"});
+}
+
+TEST_CASE ("parse_cmake_vars_output rejects malformed output", "[cmakevars]")
+{
+    SECTION ("missing section")
+    {
+        std::vector<VarList> vars(2);
+        CHECK(!parse_cmake_vars_output(port_output({"A=1"}), vars).has_value());
+    }
+
+    SECTION ("extra section")
+    {
+        std::vector<VarList> vars(1);
+        CHECK(!parse_cmake_vars_output(port_output({"A=1"}) + port_output({"B=2"}), vars).has_value());
+    }
+
+    SECTION ("section without blocks")
+    {
+        std::vector<VarList> vars(1);
+        CHECK(!parse_cmake_vars_output(fmt::format("{}\n{}\n", port_start, port_end), vars).has_value());
+    }
+
+    SECTION ("unterminated port")
+    {
+        std::vector<VarList> vars(1);
+        CHECK(!parse_cmake_vars_output(fmt::format("{}\n{}\nA=1\n{}\n", port_start, block_start, block_end), vars)
+                   .has_value());
+    }
+
+    SECTION ("unterminated block")
+    {
+        std::vector<VarList> vars(1);
+        CHECK(!parse_cmake_vars_output(fmt::format("{}\n{}\nA=1\n", port_start, block_start), vars).has_value());
+    }
+
+    SECTION ("malformed variable")
+    {
+        std::vector<VarList> vars(1);
+        auto result = parse_cmake_vars_output(port_output({"A=1=2"}), vars);
+        REQUIRE(!result.has_value());
+        CHECK(result.error().data().find("A=1=2") != std::string::npos);
+    }
+
+    SECTION ("no output")
+    {
+        std::vector<VarList> vars(1);
+        CHECK(!parse_cmake_vars_output("", vars).has_value());
+    }
+}
+
+TEST_CASE ("extraction_shard_ends", "[cmakevars]")
+{
+    CHECK(extraction_shard_ends(0, 8) == std::vector<size_t>{0});
+    CHECK(extraction_shard_ends(10, 8) == std::vector<size_t>{10});
+    CHECK(extraction_shard_ends(64, 8) == std::vector<size_t>{32, 64});
+    CHECK(extraction_shard_ends(100, 8) == std::vector<size_t>{25, 50, 75, 100});
+    CHECK(extraction_shard_ends(1000, 3) == std::vector<size_t>{333, 666, 1000});
+    CHECK(extraction_shard_ends(1000, 0) == std::vector<size_t>{1000});
+}
+
+TEST_CASE ("parse_cmake_vars_output merges sharded output", "[cmakevars]")
+{
+    // Each shard's script prints the variables of its own specs, which are parsed into that shard's part of the
+    // variables of all specs
+    constexpr size_t spec_count = 100;
+    std::vector<VarList> vars(spec_count);
+    size_t first = 0;
+    for (const size_t last : extraction_shard_ends(spec_count, 3))
+    {
+        std::string shard_output;
+        for (size_t spec = first; spec < last; ++spec)
+        {
+            shard_output += port_output({fmt::format("SPEC={}", spec)});
+        }
+
+        REQUIRE(parse_cmake_vars_output(shard_output, Span<VarList>{vars.data() + first, last - first}).has_value());
+        first = last;
+    }
+
+    CHECK(first == spec_count);
+    for (size_t spec = 0; spec < spec_count; ++spec)
+    {
+        INFO(spec);
+        CHECK(vars[spec] == VarList{{"SPEC", std::to_string(spec)}});
+    }
+}
+
+TEST_CASE ("CMakeVarsCache remembers variables across invocations", "[cmakevars]")
+{
+    auto const root = Test::base_temporary_directory() / "cmake-vars-cache";
+    real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+    auto const cache_file = root / "cmake-vars-cache.json";
+    const VarList vars{{"VCPKG_TARGET_ARCHITECTURE", "x64"}, {"VCPKG_CRT_LINKAGE", ""}};
+
+    {
+        CMakeVarsCache cache(real_filesystem, cache_file);
+        CHECK(cache.find("key") == nullptr);
+        cache.store("key", vars);
+        auto found = cache.find("key");
+        REQUIRE(found);
+        CHECK(*found == vars);
+        cache.save(real_filesystem);
+    }
+
+    {
+        CMakeVarsCache cache(real_filesystem, cache_file);
+        auto found = cache.find("key");
+        REQUIRE(found);
+        CHECK(*found == vars);
+        CHECK(cache.find("other key") == nullptr);
+    }
+
+    SECTION ("corrupt cache files are ignored")
+    {
+        real_filesystem.write_contents(cache_file, "{\"version\": 1, \"entries\": [", VCPKG_LINE_INFO);
+        CMakeVarsCache cache(real_filesystem, cache_file);
+        CHECK(cache.find("key") == nullptr);
+    }
+
+    SECTION ("cache files of other versions are ignored")
+    {
+        real_filesystem.write_contents(
+            cache_file, R"({"version": 2, "entries": {"key": {"VCPKG_TARGET_ARCHITECTURE": "x64"}}})", VCPKG_LINE_INFO);
+        CMakeVarsCache cache(real_filesystem, cache_file);
+        CHECK(cache.find("key") == nullptr);
+    }
+
+    SECTION ("unused entries are evicted")
+    {
+        {
+            CMakeVarsCache cache(real_filesystem, cache_file);
+            cache.store("a", vars);
+            cache.store("b", vars);
+            cache.save(real_filesystem);
+        }
+
+        {
+            // "b" and "c" are used by this invocation, so "a" and "key" are dropped
+            CMakeVarsCache cache(real_filesystem, cache_file, 2);
+            CHECK(cache.find("b") != nullptr);
+            cache.store("c", vars);
+            cache.save(real_filesystem);
+        }
+
+        CMakeVarsCache cache(real_filesystem, cache_file);
+        CHECK(cache.find("key") == nullptr);
+        CHECK(cache.find("a") == nullptr);
+        CHECK(cache.find("b") != nullptr);
+        CHECK(cache.find("c") != nullptr);
+    }
+
+    SECTION ("nothing is remembered without a cache file")
+    {
+        real_filesystem.remove(cache_file, VCPKG_LINE_INFO);
+        CMakeVarsCache cache(real_filesystem, nullopt);
+        cache.store("key", vars);
+        CHECK(cache.find("key") == nullptr);
+        cache.save(real_filesystem);
+        CHECK(!real_filesystem.exists(cache_file, VCPKG_LINE_INFO));
+    }
+}
+
+TEST_CASE ("X_VCPKG_CMAKE_VARS_CACHE turns off the CMake variables cache", "[cmakevars]")
+{
+    EnvironmentVariableResetter resetter{EnvironmentVariableXVcpkgCMakeVarsCache};
+    const Path buildtrees = Test::base_temporary_directory() / "buildtrees";
+    set_environment_variable(EnvironmentVariableXVcpkgCMakeVarsCache, nullopt);
+    CHECK(get_cmake_vars_cache_file(buildtrees).value_or_exit(VCPKG_LINE_INFO) ==
+          buildtrees / FileCMakeVarsCacheDotJson);
+    set_environment_variable(EnvironmentVariableXVcpkgCMakeVarsCache, "on");
+    CHECK(get_cmake_vars_cache_file(buildtrees).has_value());
+    set_environment_variable(EnvironmentVariableXVcpkgCMakeVarsCache, "off");
+    CHECK(!get_cmake_vars_cache_file(buildtrees).has_value());
+    set_environment_variable(EnvironmentVariableXVcpkgCMakeVarsCache, "OFF");
+    CHECK(!get_cmake_vars_cache_file(buildtrees).has_value());
+}
+
+TEST_CASE ("get_common_cmake_vars_cache_key", "[cmakevars]")
+{
+    const auto key = common_key({"PATH=/usr/bin", "CC=gcc", "SHLVL=1"});
+    CHECK(key == common_key({"CC=gcc", "SHLVL=1", "PATH=/usr/bin"}));
+    // Variables that neither vcpkg nor CMake read are ignored, like those that change between shells or CI runs
+    CHECK(key == common_key({"PATH=/usr/bin", "CC=gcc", "SHLVL=2", "OLDPWD=/tmp", "BUILD_BUILDID=1234"}));
+    CHECK(key != common_key({"PATH=/usr/bin", "CC=clang", "SHLVL=1"}));
+    CHECK(key != common_key({"PATH=/usr/bin", "SHLVL=1"}));
+    CHECK(key != common_key({"PATH=/usr/bin", "CC=gcc", "CXX=g++", "SHLVL=1"}));
+    CHECK(key != common_key({"PATH=/usr/bin", "CC=gcc", "SHLVL=1", "VCPKG_FEATURE_FLAGS=-binarycaching"}));
+    CHECK(key != common_key({"PATH=/usr/bin", "CC=gcc", "SHLVL=1", "CMAKE_GENERATOR=Ninja"}));
+    // ... unless they are passed through to builds
+    const auto keep_key = common_key({"PATH=/usr/bin", "CC=gcc", "VCPKG_KEEP_ENV_VARS=MY_SDK;BUILD_BUILDID"});
+    CHECK(keep_key != common_key({"PATH=/usr/bin", "CC=gcc", "VCPKG_KEEP_ENV_VARS=MY_SDK;BUILD_BUILDID", "MY_SDK=1"}));
+    CHECK(key != common_key({"PATH=/usr/bin", "CC=gcc", "SHLVL=1"}, {{"vcpkg.cmake", "5678"}}));
+    CHECK(key != common_key({"PATH=/usr/bin", "CC=gcc", "SHLVL=1"}, {{"vcpkg.cmake", "1234"}}, 101));
+}
+
+TEST_CASE ("get_triplet_cmake_vars_cache_key", "[cmakevars]")
+{
+    auto const root = Test::base_temporary_directory() / "cmake-vars-cache-key";
+    real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+    auto const triplets = root / "triplets";
+    auto const triplet_file = triplets / "x64-test.cmake";
+    auto const sibling_file = triplets / "x64-sibling.cmake";
+    auto const common_file = root / "common" / "settings.cmake";
+    auto const nested_file = root / "common" / "nested.cmake";
+    real_filesystem.write_contents_and_dirs(triplet_file,
+                                            "include_guard(GLOBAL)\n"
+                                            "include(CMakePrintHelpers)\n"
+                                            "include(\"${CMAKE_CURRENT_LIST_DIR}/../common/settings.cmake\")\n"
+                                            "set(VCPKG_TARGET_ARCHITECTURE x64)\n",
+                                            VCPKG_LINE_INFO);
+    real_filesystem.write_contents(sibling_file, "set(VCPKG_TARGET_ARCHITECTURE x86)\n", VCPKG_LINE_INFO);
+    real_filesystem.write_contents(triplets / "README.md", "triplets\n", VCPKG_LINE_INFO);
+    real_filesystem.write_contents_and_dirs(
+        common_file, "INCLUDE( ${CMAKE_CURRENT_LIST_DIR}/nested.cmake )\n", VCPKG_LINE_INFO);
+    real_filesystem.write_contents(nested_file, "set(VCPKG_CRT_LINKAGE dynamic)\n", VCPKG_LINE_INFO);
+
+    FileHashCache file_hash_cache(real_filesystem, FileHashCacheMode::Disabled, nullopt);
+    const auto triplet = Triplet::from_canonical_name("x64-test");
+    auto get_key = [&](StringView common = "common") {
+        return get_triplet_cmake_vars_cache_key(real_filesystem, file_hash_cache, common, triplet, triplet_file);
+    };
+
+    const auto original_key = get_key().value_or_exit(VCPKG_LINE_INFO);
+    CHECK(get_key().value_or_exit(VCPKG_LINE_INFO) == original_key);
+    CHECK(get_key("other common").value_or_exit(VCPKG_LINE_INFO) != original_key);
+
+    // Files that are not triplets do not affect the key
+    real_filesystem.write_contents(triplets / "README.md", "all of the triplets\n", VCPKG_LINE_INFO);
+    CHECK(get_key().value_or_exit(VCPKG_LINE_INFO) == original_key);
+
+    SECTION ("the triplet changes")
+    {
+        real_filesystem.write_contents(
+            triplet_file, real_filesystem.read_contents(triplet_file, VCPKG_LINE_INFO) + "\n", VCPKG_LINE_INFO);
+        CHECK(get_key().value_or_exit(VCPKG_LINE_INFO) != original_key);
+    }
+
+    SECTION ("a sibling triplet changes")
+    {
+        real_filesystem.write_contents(sibling_file, "set(VCPKG_TARGET_ARCHITECTURE arm64)\n", VCPKG_LINE_INFO);
+        CHECK(get_key().value_or_exit(VCPKG_LINE_INFO) != original_key);
+    }
+
+    SECTION ("an included file changes")
+    {
+        real_filesystem.write_contents(
+            common_file, "include(${CMAKE_CURRENT_LIST_DIR}/nested.cmake)\n", VCPKG_LINE_INFO);
+        CHECK(get_key().value_or_exit(VCPKG_LINE_INFO) != original_key);
+    }
+
+    SECTION ("a file included by an included file changes")
+    {
+        real_filesystem.write_contents(nested_file, "set(VCPKG_CRT_LINKAGE static)\n", VCPKG_LINE_INFO);
+        CHECK(get_key().value_or_exit(VCPKG_LINE_INFO) != original_key);
+    }
+
+    SECTION ("an included file is removed")
+    {
+        real_filesystem.remove(nested_file, VCPKG_LINE_INFO);
+        CHECK(get_key().value_or_exit(VCPKG_LINE_INFO) != original_key);
+    }
+
+    SECTION ("an environment variable read by an included file changes")
+    {
+        EnvironmentVariableResetter resetter{"VCPKG_TEST_TRIPLET_SETTING"};
+        set_environment_variable("VCPKG_TEST_TRIPLET_SETTING", nullopt);
+        real_filesystem.write_contents(nested_file,
+                                       "if(DEFINED ENV{VCPKG_TEST_TRIPLET_SETTING})\n"
+                                       "    set(VCPKG_CRT_LINKAGE $ENV{VCPKG_TEST_TRIPLET_SETTING})\n"
+                                       "endif()\n",
+                                       VCPKG_LINE_INFO);
+        const auto unset_key = get_key().value_or_exit(VCPKG_LINE_INFO);
+        set_environment_variable("VCPKG_TEST_TRIPLET_SETTING", "static");
+        const auto static_key = get_key().value_or_exit(VCPKG_LINE_INFO);
+        CHECK(static_key != unset_key);
+        set_environment_variable("VCPKG_TEST_TRIPLET_SETTING", "dynamic");
+        CHECK(get_key().value_or_exit(VCPKG_LINE_INFO) != static_key);
+        set_environment_variable("VCPKG_TEST_TRIPLET_SETTING", "static");
+        CHECK(get_key().value_or_exit(VCPKG_LINE_INFO) == static_key);
+    }
+
+    SECTION ("environment variables whose names cannot be tracked")
+    {
+        real_filesystem.write_contents(nested_file, "set(VCPKG_CRT_LINKAGE $ENV{${SETTING_NAME}})\n", VCPKG_LINE_INFO);
+        CHECK(!get_key().has_value());
+    }
+
+    SECTION ("included files that cannot be tracked")
+    {
+        real_filesystem.write_contents(common_file, "include(\"${VCPKG_ROOT_DIR}/settings.cmake\")\n", VCPKG_LINE_INFO);
+        CHECK(!get_key().has_value());
+        real_filesystem.write_contents(common_file, "include(relative/settings.cmake)\n", VCPKG_LINE_INFO);
+        CHECK(!get_key().has_value());
+    }
+}
@@ -1,9 +1,39 @@
 #include <vcpkg-test/util.h>
 
+#include <vcpkg/base/file-hash-cache.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/json.h>
+#include <vcpkg/base/system.h>
+
 #include <vcpkg/commands.build.h>
+#include <vcpkg/statusparagraphs.h>
+#include <vcpkg/triplet.h>
+
+#include <thread>
+#include <vector>
 
 using namespace vcpkg;
 
+namespace
+{
+    struct EnvironmentVariableResetter
+    {
+        explicit EnvironmentVariableResetter(ZStringView varname)
+            : varname(varname), old_value(get_environment_variable(varname))
+        {
+        }
+
+        ~EnvironmentVariableResetter() { set_environment_variable(varname, old_value); }
+
+        EnvironmentVariableResetter(const EnvironmentVariableResetter&) = delete;
+        EnvironmentVariableResetter& operator=(const EnvironmentVariableResetter&) = delete;
+
+    private:
+        ZStringView varname;
+        Optional<std::string> old_value;
+    };
+}
+
 TEST_CASE ("PackagesDirAssigner_generate", "[build]")
 {
     Path prefix{"example_prefix"};
@@ -45,3 +75,292 @@ TEST_CASE ("is_package_dir_match", "[build]")
     REQUIRE(!is_package_dir_match("non_empty", ""));
     REQUIRE(!is_package_dir_match("anotherpackage_123", "another"));
 }
+
+TEST_CASE ("get_compiler_info_cache_key", "[build]")
+{
+    auto const root = Test::base_temporary_directory() / "compiler-info-cache-key";
+    real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+    auto const detect_compiler_dir = root / "detect_compiler";
+    auto const compiler = root / "bin" / "cc";
+    real_filesystem.write_contents_and_dirs(
+        detect_compiler_dir / "CMakeLists.txt", "project(detect_compiler)\n", VCPKG_LINE_INFO);
+    real_filesystem.write_contents_and_dirs(compiler, "compiler 1", VCPKG_LINE_INFO);
+
+    EnvironmentVariableResetter resetter{"CC"};
+    set_environment_variable("CC", nullopt);
+    FileHashCache file_hash_cache(real_filesystem, FileHashCacheMode::Disabled, nullopt);
+    const auto triplet = Triplet::from_canonical_name("x64-test");
+    const std::vector<std::string> passthrough_env_vars;
+    Toolset toolset;
+    auto get_key = [&](StringView toolchain_hash = "toolchain", StringView cmake_version = "3.30.1") {
+        return get_compiler_info_cache_key(real_filesystem,
+                                           file_hash_cache,
+                                           detect_compiler_dir,
+                                           cmake_version,
+                                           "ports.cmake",
+                                           triplet,
+                                           passthrough_env_vars,
+                                           toolset,
+                                           "triplet",
+                                           toolchain_hash,
+                                           View<Path>{&compiler, 1});
+    };
+
+    const auto original_key = get_key();
+    CHECK(get_key() == original_key);
+
+    SECTION ("the toolchain file changes")
+    {
+        CHECK(get_key("other toolchain") != original_key);
+    }
+
+    SECTION ("CMake is upgraded")
+    {
+        CHECK(get_key("toolchain", "3.31.0") != original_key);
+    }
+
+    SECTION ("the compiler is replaced in place")
+    {
+        real_filesystem.write_contents(compiler, "compiler 2.0", VCPKG_LINE_INFO);
+        CHECK(get_key() != original_key);
+    }
+
+    SECTION ("the compiler detection project changes")
+    {
+        real_filesystem.write_contents(
+            detect_compiler_dir / "CMakeLists.txt", "project(detect_compiler C)\n", VCPKG_LINE_INFO);
+        CHECK(get_key() != original_key);
+    }
+
+    SECTION ("a compiler environment variable changes")
+    {
+        set_environment_variable("CC", "clang");
+        CHECK(get_key() != original_key);
+    }
+
+    SECTION ("the toolset changes")
+    {
+        toolset.version = "v143";
+        CHECK(get_key() != original_key);
+    }
+}
+
+TEST_CASE ("compiler info cache file", "[build]")
+{
+    auto const root = Test::base_temporary_directory() / "compiler-info-cache";
+    real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+    auto const cache_file = root / "compiler-info-cache.json";
+    auto const compiler = root / "bin" / "cc";
+    real_filesystem.write_contents_and_dirs(compiler, "compiler 1", VCPKG_LINE_INFO);
+
+    CompilerInfo compiler_info;
+    compiler_info.id = "GNU";
+    compiler_info.version = "13.2.0";
+    compiler_info.hash = "compiler-hash";
+    compiler_info.path = compiler.native();
+
+    // A missing cache file has no entries
+    CHECK(load_compiler_info_cache_entries(real_filesystem, cache_file).size() == 0);
+
+    save_cached_compiler_info(real_filesystem, cache_file, "key", compiler_info);
+    auto entries = load_compiler_info_cache_entries(real_filesystem, cache_file);
+    REQUIRE(entries.size() == 1);
+    auto found = find_cached_compiler_info(real_filesystem, entries, "key").value_or_exit(VCPKG_LINE_INFO);
+    CHECK(found.id == compiler_info.id);
+    CHECK(found.version == compiler_info.version);
+    CHECK(found.hash == compiler_info.hash);
+    CHECK(found.path == compiler_info.path);
+    CHECK(!find_cached_compiler_info(real_filesystem, entries, "other key").has_value());
+
+    SECTION ("the most recently used entry comes first")
+    {
+        auto other_info = compiler_info;
+        other_info.hash = "other-compiler-hash";
+        save_cached_compiler_info(real_filesystem, cache_file, "other key", other_info);
+        entries = load_compiler_info_cache_entries(real_filesystem, cache_file);
+        REQUIRE(entries.size() == 2);
+        CHECK(entries[0].object(VCPKG_LINE_INFO).get("key")->string(VCPKG_LINE_INFO) == "other key");
+        CHECK(find_cached_compiler_info(real_filesystem, entries, "key").value_or_exit(VCPKG_LINE_INFO).hash ==
+              "compiler-hash");
+        CHECK(find_cached_compiler_info(real_filesystem, entries, "other key").value_or_exit(VCPKG_LINE_INFO).hash ==
+              "other-compiler-hash");
+
+        // Saving an existing key replaces its entry
+        save_cached_compiler_info(real_filesystem, cache_file, "key", compiler_info);
+        entries = load_compiler_info_cache_entries(real_filesystem, cache_file);
+        REQUIRE(entries.size() == 2);
+        CHECK(entries[0].object(VCPKG_LINE_INFO).get("key")->string(VCPKG_LINE_INFO) == "key");
+    }
+
+    SECTION ("entries saved at once are all kept")
+    {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 8; ++i)
+        {
+            threads.emplace_back([&, i] {
+                save_cached_compiler_info(real_filesystem, cache_file, fmt::format("key {}", i), compiler_info);
+            });
+        }
+
+        for (auto&& thread : threads)
+        {
+            thread.join();
+        }
+
+        entries = load_compiler_info_cache_entries(real_filesystem, cache_file);
+        CHECK(entries.size() == 9);
+        for (int i = 0; i < 8; ++i)
+        {
+            CHECK(find_cached_compiler_info(real_filesystem, entries, fmt::format("key {}", i)).has_value());
+        }
+    }
+
+    SECTION ("entries whose compiler was replaced are rejected")
+    {
+        real_filesystem.write_contents(compiler, "compiler 2.0", VCPKG_LINE_INFO);
+        CHECK(!find_cached_compiler_info(real_filesystem, entries, "key").has_value());
+    }
+
+    SECTION ("entries whose compiler was removed are rejected")
+    {
+        real_filesystem.remove(compiler, VCPKG_LINE_INFO);
+        CHECK(!find_cached_compiler_info(real_filesystem, entries, "key").has_value());
+    }
+
+    SECTION ("entries without a compiler hash are rejected")
+    {
+        compiler_info.hash.clear();
+        save_cached_compiler_info(real_filesystem, cache_file, "key", compiler_info);
+        entries = load_compiler_info_cache_entries(real_filesystem, cache_file);
+        REQUIRE(entries.size() == 1);
+        CHECK(!find_cached_compiler_info(real_filesystem, entries, "key").has_value());
+    }
+
+    SECTION ("entries with missing fields are rejected")
+    {
+        real_filesystem.write_contents(cache_file,
+                                       R"json({"version": 1, "entries": [{"key": "key", "id": "GNU"}]})json",
+                                       VCPKG_LINE_INFO);
+        entries = load_compiler_info_cache_entries(real_filesystem, cache_file);
+        REQUIRE(entries.size() == 1);
+        CHECK(!find_cached_compiler_info(real_filesystem, entries, "key").has_value());
+    }
+
+    SECTION ("a corrupt cache file falls back to detection")
+    {
+        real_filesystem.write_contents(cache_file, "{\"version\": 1, \"entries\": [", VCPKG_LINE_INFO);
+        entries = load_compiler_info_cache_entries(real_filesystem, cache_file);
+        CHECK(entries.size() == 0);
+        CHECK(!find_cached_compiler_info(real_filesystem, entries, "key").has_value());
+
+        // The result of detection replaces the corrupt file
+        save_cached_compiler_info(real_filesystem, cache_file, "key", compiler_info);
+        entries = load_compiler_info_cache_entries(real_filesystem, cache_file);
+        CHECK(find_cached_compiler_info(real_filesystem, entries, "key").has_value());
+    }
+
+    SECTION ("a cache file of another version is ignored")
+    {
+        real_filesystem.write_contents(
+            cache_file, R"json({"version": 2, "entries": [{"key": "key"}]})json", VCPKG_LINE_INFO);
+        CHECK(load_compiler_info_cache_entries(real_filesystem, cache_file).size() == 0);
+    }
+}
+
+TEST_CASE ("AbiDependencyIndex", "[build]")
+{
+    std::vector<std::unique_ptr<StatusParagraph>> status_pghs;
+    status_pghs.push_back(Test::make_status_pgh("zlib", "", "", "x64-linux"));
+    status_pghs.push_back(Test::make_status_feature_pgh("zlib", "bzip2", "", "x64-linux"));
+    status_pghs.push_back(Test::make_status_feature_pgh("fmt", "core-only", "", "x64-linux"));
+    StatusParagraphs status_db{std::move(status_pghs)};
+
+    const auto triplet = Triplet::from_canonical_name("x64-linux");
+    const PackageSpec zlib{"zlib", triplet};
+    const PackageSpec fmt{"fmt", triplet};
+    const PackageSpec curl{"curl", triplet};
+
+    AbiDependencyIndex index{status_db};
+    CHECK(index.find_action(zlib) == SIZE_MAX);
+    index.add_action(curl, 0);
+    index.add_action(zlib, 1);
+    CHECK(index.find_action(curl) == 0);
+    CHECK(index.find_action(zlib) == 1);
+    CHECK(index.find_action(PackageSpec{"curl", Triplet::from_canonical_name("x64-windows")}) == SIZE_MAX);
+
+    auto installed_zlib = index.find_installed(zlib);
+    REQUIRE(installed_zlib != nullptr);
+    CHECK(installed_zlib == status_db.find(zlib)->get());
+    CHECK(installed_zlib->package.feature.empty());
+    // Feature paragraphs without a core paragraph are not installed packages
+    CHECK(index.find_installed(fmt) == nullptr);
+    CHECK(index.find_installed(curl) == nullptr);
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("AbiDependencyIndex -- benchmarks", "[build][!benchmark]")
+{
+    // Resolves the dependencies of every action of synthetic plans, where each port depends on a few earlier ports
+    // and on an installed port. The time per plan should grow linearly with the plan size.
+    const auto triplet = Triplet::from_canonical_name("x64-linux");
+    std::vector<std::unique_ptr<StatusParagraph>> status_pghs;
+    for (size_t idx = 0; idx < 100; ++idx)
+    {
+        const auto name = fmt::format("installed-{}", idx);
+        status_pghs.push_back(Test::make_status_pgh(name.c_str(), "", "", "x64-linux"));
+    }
+
+    StatusParagraphs status_db{std::move(status_pghs)};
+
+    struct
+    {
+        const StatusParagraphs& status_db;
+        Triplet triplet;
+
+        void operator()(Catch::Benchmark::Chronometer& meter, size_t plan_size) const
+        {
+            std::vector<PackageSpec> specs;
+            std::vector<std::vector<PackageSpec>> dependencies(plan_size);
+            for (size_t idx = 0; idx < plan_size; ++idx)
+            {
+                specs.emplace_back(fmt::format("port-{}", idx), triplet);
+                for (size_t dependency_idx : {idx / 2, idx / 3, idx / 5})
+                {
+                    if (dependency_idx != idx)
+                    {
+                        dependencies[idx].push_back(specs[dependency_idx]);
+                    }
+                }
+
+                dependencies[idx].emplace_back(fmt::format("installed-{}", idx % 100), triplet);
+            }
+
+            meter.measure([&] {
+                AbiDependencyIndex index{status_db};
+                size_t found = 0;
+                for (size_t idx = 0; idx < plan_size; ++idx)
+                {
+                    index.add_action(specs[idx], idx);
+                    for (auto&& dependency : dependencies[idx])
+                    {
+                        if (index.find_action(dependency) != SIZE_MAX || index.find_installed(dependency))
+                        {
+                            ++found;
+                        }
+                    }
+                }
+
+                return found;
+            });
+        }
+    } do_benchmark = {status_db, triplet};
+
+    BENCHMARK_ADVANCED("500 actions")(Catch::Benchmark::Chronometer meter) { do_benchmark(meter, 500); };
+
+    BENCHMARK_ADVANCED("1000 actions")(Catch::Benchmark::Chronometer meter) { do_benchmark(meter, 1000); };
+
+    BENCHMARK_ADVANCED("2000 actions")(Catch::Benchmark::Chronometer meter) { do_benchmark(meter, 2000); };
+
+    BENCHMARK_ADVANCED("4000 actions")(Catch::Benchmark::Chronometer meter) { do_benchmark(meter, 4000); };
+}
+#endif
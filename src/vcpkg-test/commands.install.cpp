@@ -1,9 +1,41 @@
 #include <vcpkg-test/util.h>
 
 #include <vcpkg/commands.install.h>
+#include <vcpkg/dependencies.h>
+#include <vcpkg/sourceparagraph.h>
+
+#include <deque>
+#include <set>
+#include <string>
 
 using namespace vcpkg;
 
+namespace
+{
+    struct TestInstallPlan
+    {
+        TestInstallPlan() : scfl{Test::make_control_file("test", ""), Path()}, packages_dir_assigner{"packages"} { }
+
+        void add(const PackageSpec& spec, std::vector<PackageSpec> dependencies = {})
+        {
+            actions.emplace_back(spec,
+                                 scfl,
+                                 packages_dir_assigner,
+                                 RequestType::USER_REQUESTED,
+                                 UseHeadVersion::No,
+                                 Editable::No,
+                                 std::map<std::string, std::vector<FeatureSpec>>{},
+                                 std::vector<DiagnosticLine>{},
+                                 std::vector<std::string>{});
+            actions.back().package_dependencies = std::move(dependencies);
+        }
+
+        SourceControlFileAndLocation scfl;
+        PackagesDirAssigner packages_dir_assigner;
+        std::vector<InstallPlanAction> actions;
+    };
+}
+
 TEST_CASE ("get_cmake_add_library_names", "[install]")
 {
     constexpr static StringLiteral fmt_targets = R"cmake(
@@ -163,3 +195,161 @@ cmake_policy(POP)
     CHECK(get_cmake_find_package_name("Pro", "ProjConfig.cmake") == "");
     CHECK(get_cmake_find_package_name("proj", "Findproj.cmake") == "");
 }
+
+TEST_CASE ("InstallPlanScheduler runs actions after their dependencies", "[install]")
+{
+    const PackageSpec a{"a", Test::X64_WINDOWS};
+    const PackageSpec b{"b", Test::X64_WINDOWS};
+    const PackageSpec c{"c", Test::X64_WINDOWS};
+    const PackageSpec d{"d", Test::X64_WINDOWS};
+    TestInstallPlan plan;
+    plan.add(a);
+    plan.add(b, {a});
+    plan.add(c, {a, b});
+    plan.add(d);
+
+    InstallPlanScheduler scheduler(plan.actions);
+    CHECK(!scheduler.done());
+    CHECK(scheduler.start_next() == Optional<size_t>{0});
+    // b and c wait for a, but d does not depend on anything
+    CHECK(scheduler.start_next() == Optional<size_t>{3});
+    CHECK(scheduler.start_next() == nullopt);
+
+    scheduler.finish(0);
+    CHECK(scheduler.start_next() == Optional<size_t>{1});
+    CHECK(scheduler.start_next() == nullopt);
+
+    scheduler.finish(3);
+    CHECK(scheduler.start_next() == nullopt);
+
+    scheduler.finish(1);
+    CHECK(scheduler.start_next() == Optional<size_t>{2});
+    CHECK(!scheduler.done());
+
+    scheduler.finish(2);
+    CHECK(scheduler.start_next() == nullopt);
+    CHECK(scheduler.done());
+}
+
+TEST_CASE ("InstallPlanScheduler ignores dependencies outside the plan", "[install]")
+{
+    TestInstallPlan plan;
+    plan.add(PackageSpec{"a", Test::X64_WINDOWS}, {PackageSpec{"installed", Test::X64_WINDOWS}});
+
+    InstallPlanScheduler scheduler(plan.actions);
+    CHECK(scheduler.start_next() == Optional<size_t>{0});
+    scheduler.finish(0);
+    CHECK(scheduler.done());
+
+    InstallPlanScheduler empty_scheduler(View<InstallPlanAction>{});
+    CHECK(empty_scheduler.start_next() == nullopt);
+    CHECK(empty_scheduler.done());
+}
+
+TEST_CASE ("InstallPlanScheduler never runs two actions for the same port", "[install]")
+{
+    TestInstallPlan plan;
+    plan.add(PackageSpec{"zlib", Test::X64_WINDOWS});
+    plan.add(PackageSpec{"zlib", Test::X86_WINDOWS});
+    plan.add(PackageSpec{"zlib", Test::ARM64_WINDOWS});
+    plan.add(PackageSpec{"other", Test::X64_WINDOWS});
+
+    InstallPlanScheduler scheduler(plan.actions);
+    CHECK(scheduler.start_next() == Optional<size_t>{0});
+    CHECK(scheduler.start_next() == Optional<size_t>{3});
+    CHECK(scheduler.start_next() == nullopt);
+
+    scheduler.finish(3);
+    CHECK(scheduler.start_next() == nullopt);
+
+    scheduler.finish(0);
+    CHECK(scheduler.start_next() == Optional<size_t>{1});
+    CHECK(scheduler.start_next() == nullopt);
+
+    scheduler.finish(1);
+    CHECK(scheduler.start_next() == Optional<size_t>{2});
+    scheduler.finish(2);
+    CHECK(scheduler.done());
+}
+
+TEST_CASE ("InstallPlanScheduler stops starting actions after a failure", "[install]")
+{
+    const PackageSpec a{"a", Test::X64_WINDOWS};
+    TestInstallPlan plan;
+    plan.add(a);
+    plan.add(PackageSpec{"b", Test::X64_WINDOWS});
+    plan.add(PackageSpec{"c", Test::X64_WINDOWS}, {a});
+    plan.add(PackageSpec{"d", Test::X64_WINDOWS});
+
+    InstallPlanScheduler scheduler(plan.actions);
+    CHECK(scheduler.start_next() == Optional<size_t>{0});
+    CHECK(scheduler.start_next() == Optional<size_t>{1});
+
+    // a fails while b is still running
+    scheduler.stop();
+    scheduler.finish(0);
+    CHECK(scheduler.start_next() == nullopt);
+    CHECK(!scheduler.done());
+
+    // b still finishes, but neither c nor d is started
+    scheduler.finish(1);
+    CHECK(scheduler.start_next() == nullopt);
+    CHECK(scheduler.done());
+}
+
+TEST_CASE ("InstallPlanScheduler runs large plans", "[install]")
+{
+    const Triplet triplets[] = {Test::X64_WINDOWS, Test::X86_WINDOWS, Test::ARM64_WINDOWS, Test::X64_LINUX};
+    TestInstallPlan plan;
+    for (size_t port = 0; port < 500; ++port)
+    {
+        for (auto&& triplet : triplets)
+        {
+            std::vector<PackageSpec> dependencies;
+            if (port != 0)
+            {
+                dependencies.emplace_back(fmt::format("port-{}", port / 2), triplet);
+            }
+
+            plan.add(PackageSpec{fmt::format("port-{}", port), triplet}, std::move(dependencies));
+        }
+    }
+
+    InstallPlanScheduler scheduler(plan.actions);
+    std::set<PackageSpec> finished;
+    std::set<std::string> running_ports;
+    std::deque<size_t> running;
+    size_t started = 0;
+    while (!scheduler.done())
+    {
+        while (running.size() < 8)
+        {
+            auto next = scheduler.start_next();
+            auto idx = next.get();
+            if (!idx)
+            {
+                break;
+            }
+
+            const auto& action = plan.actions[*idx];
+            for (auto&& dependency : action.package_dependencies)
+            {
+                CHECK(finished.count(dependency) == 1);
+            }
+
+            CHECK(running_ports.insert(action.spec.name()).second);
+            running.push_back(*idx);
+            ++started;
+        }
+
+        REQUIRE(!running.empty());
+        const auto& action = plan.actions[running.front()];
+        running_ports.erase(action.spec.name());
+        finished.insert(action.spec);
+        scheduler.finish(running.front());
+        running.pop_front();
+    }
+
+    CHECK(started == plan.actions.size());
+    CHECK(finished.size() == plan.actions.size());
+}
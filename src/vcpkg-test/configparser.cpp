@@ -311,6 +311,42 @@ TEST_CASE ("BinaryConfigParser interactive provider", "[binaryconfigparser]")
     }
 }
 
+TEST_CASE ("BinaryConfigParser x-concurrent-fetch", "[binaryconfigparser]")
+{
+    {
+        auto parsed = parse_binary_provider_configs("x-concurrent-fetch", {});
+        REQUIRE(parsed.has_value());
+        CHECK(parsed.value_or_exit(VCPKG_LINE_INFO).concurrent_fetch);
+    }
+    {
+        auto parsed = parse_binary_provider_configs("x-concurrent-fetch;clear", {});
+        REQUIRE(parsed.has_value());
+        CHECK(!parsed.value_or_exit(VCPKG_LINE_INFO).concurrent_fetch);
+    }
+    {
+        auto parsed = parse_binary_provider_configs("x-concurrent-fetch,read", {});
+        REQUIRE(!parsed.has_value());
+    }
+}
+
+TEST_CASE ("BinaryConfigParser x-direct-restore", "[binaryconfigparser]")
+{
+    {
+        auto parsed = parse_binary_provider_configs("x-direct-restore", {});
+        REQUIRE(parsed.has_value());
+        CHECK(parsed.value_or_exit(VCPKG_LINE_INFO).direct_restore);
+    }
+    {
+        auto parsed = parse_binary_provider_configs("x-direct-restore;clear", {});
+        REQUIRE(parsed.has_value());
+        CHECK(!parsed.value_or_exit(VCPKG_LINE_INFO).direct_restore);
+    }
+    {
+        auto parsed = parse_binary_provider_configs("x-direct-restore,read", {});
+        REQUIRE(!parsed.has_value());
+    }
+}
+
 TEST_CASE ("BinaryConfigParser multiple providers", "[binaryconfigparser]")
 {
     {
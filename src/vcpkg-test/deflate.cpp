@@ -0,0 +1,190 @@
+#include <vcpkg-test/util.h>
+
+#include <vcpkg/base/deflate.h>
+
+#include <random>
+#include <string>
+
+using namespace vcpkg;
+
+namespace
+{
+    constexpr StringLiteral quick_brown_fox = "The quick brown fox jumps over the lazy dog";
+
+    std::string make_test_data(size_t size, int alphabet_size)
+    {
+        std::mt19937 urbg(static_cast<std::mt19937::result_type>(size));
+        std::uniform_int_distribution<int> distribution(0, alphabet_size - 1);
+        std::string result;
+        result.reserve(size);
+        while (result.size() < size)
+        {
+            if (!result.empty() && distribution(urbg) == 0)
+            {
+                // add a back reference to exercise matching
+                const auto length = (std::min)(static_cast<size_t>(distribution(urbg) * 7 + 3), size - result.size());
+                const auto distance = (std::min)(result.size(), static_cast<size_t>(urbg() % 40000 + 1));
+                for (size_t i = 0; i < length; ++i)
+                {
+                    result.push_back(result[result.size() - distance]);
+                }
+            }
+            else
+            {
+                result.push_back(static_cast<char>('a' + distribution(urbg)));
+            }
+        }
+
+        return result;
+    }
+
+    struct ChunkedSource final : Deflate::InflateSource
+    {
+        ChunkedSource(StringView data, size_t chunk_size) : data(data), chunk_size(chunk_size) { }
+
+        size_t read(void* buffer, size_t size) override
+        {
+            const auto this_read = (std::min)({size, chunk_size, data.size()});
+            memcpy(buffer, data.data(), this_read);
+            data = data.substr(this_read);
+            return this_read;
+        }
+
+        StringView data;
+        size_t chunk_size;
+    };
+
+    struct StringSink final : Deflate::InflateSink
+    {
+        bool write(const void* buffer, size_t size) override
+        {
+            result.append(static_cast<const char*>(buffer), size);
+            return true;
+        }
+
+        std::string result;
+    };
+}
+
+TEST_CASE ("crc32 and adler32", "[deflate]")
+{
+    CHECK(Deflate::crc32(0, quick_brown_fox.begin(), quick_brown_fox.begin()) == 0);
+    CHECK(Deflate::crc32(0, quick_brown_fox.begin(), quick_brown_fox.end()) == 0x414fa339u);
+    CHECK(Deflate::adler32(1, quick_brown_fox.begin(), quick_brown_fox.end()) == 0x5bdc0fdau);
+
+    // checksums can be continued across calls
+    const auto middle = quick_brown_fox.begin() + 13;
+    CHECK(Deflate::crc32(Deflate::crc32(0, quick_brown_fox.begin(), middle), middle, quick_brown_fox.end()) ==
+          0x414fa339u);
+    CHECK(Deflate::adler32(Deflate::adler32(1, quick_brown_fox.begin(), middle), middle, quick_brown_fox.end()) ==
+          0x5bdc0fdau);
+}
+
+TEST_CASE ("inflate streams produced by zlib", "[deflate]")
+{
+    static constexpr StringLiteral zlib_stream =
+        "\x78\xda\x0b\xc9\x48\x55\x28\x2c\xcd\x4c\xce\x56\x48\x2a\xca\x2f\xcf\x53\x48\xcb\xaf\x50\xc8\x2a\xcd\x2d\x28"
+        "\x56\xc8\x2f\x4b\x2d\x52\x28\x01\x4a\xe7\x24\x56\x55\x2a\xa4\xe4\xa7\x87\xd0\x44\x29\x00\x10\x74\x2f\x8c";
+    std::string expected;
+    for (int i = 0; i < 3; ++i)
+    {
+        expected.append(quick_brown_fox.data(), quick_brown_fox.size());
+    }
+
+    CHECK(Deflate::inflate_zlib(zlib_stream).value_or_exit(VCPKG_LINE_INFO) == expected);
+
+    static constexpr StringLiteral raw_stream = "\xcb\x48\xcd\xc9\xc9\x57\xc8\x40\x27\x01";
+    CHECK(Deflate::inflate(raw_stream).value_or_exit(VCPKG_LINE_INFO) == "hello hello hello hello");
+
+    // a stored block
+    static constexpr char stored_stream[] = "\x01\x05\x00\xfa\xff" "abcde";
+    CHECK(Deflate::inflate(StringView{stored_stream, sizeof(stored_stream) - 1}).value_or_exit(VCPKG_LINE_INFO) ==
+          "abcde");
+}
+
+TEST_CASE ("inflate rejects corrupt streams", "[deflate]")
+{
+    const auto data = make_test_data(10000, 4);
+    const auto compressed = Deflate::compress_zlib(data);
+    REQUIRE(Deflate::inflate_zlib(compressed).value_or_exit(VCPKG_LINE_INFO) == data);
+
+    // truncated
+    CHECK(!Deflate::inflate_zlib(StringView{compressed}.substr(0, compressed.size() - 1)).has_value());
+    CHECK(!Deflate::inflate_zlib(StringView{compressed}.substr(0, compressed.size() / 2)).has_value());
+
+    // bad checksum
+    auto bad_checksum = compressed;
+    bad_checksum.back() ^= 1;
+    CHECK(!Deflate::inflate_zlib(bad_checksum).has_value());
+
+    // reserved block type
+    static constexpr char reserved_block[] = "\x07\x00";
+    CHECK(!Deflate::inflate(StringView{reserved_block, 2}).has_value());
+
+    // stored block length doesn't match its complement
+    static constexpr char bad_stored_length[] = "\x01\x05\x00\xfa\xfe" "abcde";
+    CHECK(!Deflate::inflate(StringView{bad_stored_length, sizeof(bad_stored_length) - 1}).has_value());
+}
+
+TEST_CASE ("compress round trips", "[deflate]")
+{
+    for (size_t size : {0, 1, 2, 3, 100, 65535, 65536, 300000})
+    {
+        for (int alphabet_size : {1, 4, 26})
+        {
+            const auto data = make_test_data(size, alphabet_size);
+            const auto compressed = Deflate::compress(data);
+            CHECK(Deflate::inflate(compressed).value_or_exit(VCPKG_LINE_INFO) == data);
+            if (size > 1000)
+            {
+                CHECK(compressed.size() < data.size() / 2);
+            }
+
+            CHECK(Deflate::inflate_zlib(Deflate::compress_zlib(data)).value_or_exit(VCPKG_LINE_INFO) == data);
+        }
+    }
+
+    // incompressible data should not expand significantly
+    std::mt19937 urbg(42);
+    std::string random_data;
+    for (int i = 0; i < 200000; ++i)
+    {
+        random_data.push_back(static_cast<char>(urbg()));
+    }
+
+    const auto compressed = Deflate::compress(random_data);
+    CHECK(compressed.size() < random_data.size() + random_data.size() / 1000 + 16);
+    CHECK(Deflate::inflate(compressed).value_or_exit(VCPKG_LINE_INFO) == random_data);
+}
+
+TEST_CASE ("streaming compress and inflate", "[deflate]")
+{
+    const auto data = make_test_data(200000, 8);
+    Deflate::Compressor compressor;
+    std::string compressed;
+    for (size_t offset = 0; offset < data.size(); offset += 777)
+    {
+        const auto chunk = (std::min)(data.size() - offset, size_t{777});
+        compressor.add_bytes(data.data() + offset, data.data() + offset + chunk, compressed);
+    }
+
+    compressor.finish(compressed);
+    CHECK(compressed == Deflate::compress(data));
+
+    // trailing data after the stream is not consumed
+    const auto compressed_size = compressed.size();
+    compressed.append("trailing");
+    ChunkedSource source{compressed, 13};
+    StringSink sink;
+    const auto outcome = Deflate::inflate(source, sink);
+    CHECK(outcome.result == Deflate::InflateResult::Success);
+    CHECK(outcome.consumed == compressed_size);
+    CHECK(sink.result == data);
+
+    // the compressor can be reused after clear
+    compressor.clear();
+    std::string compressed_again;
+    compressor.add_bytes(data.data(), data.data() + data.size(), compressed_again);
+    compressor.finish(compressed_again);
+    CHECK(compressed_again == compressed.substr(0, compressed_size));
+}
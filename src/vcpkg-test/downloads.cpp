@@ -1,12 +1,27 @@
 #include <vcpkg-test/util.h>
 
+#include <vcpkg/base/curl.h>
 #include <vcpkg/base/downloads.h>
 #include <vcpkg/base/expected.h>
+#include <vcpkg/base/hash.h>
 #include <vcpkg/base/system.h>
 #include <vcpkg/base/util.h>
 
 #include <random>
 
+#if !defined(_WIN32)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#endif
+
 using namespace vcpkg;
 
 #define CHECK_EC_ON_FILE(file, ec)                                                                                     \
@@ -18,6 +33,198 @@ using namespace vcpkg;
         }                                                                                                              \
     } while (0)
 
+#if !defined(_WIN32)
+namespace
+{
+#if defined(MSG_NOSIGNAL)
+    constexpr int send_flags = MSG_NOSIGNAL;
+#else
+    constexpr int send_flags = 0;
+#endif
+
+    struct TestHttpResponse
+    {
+        int status;
+        std::string body;
+    };
+
+    // A minimal HTTP/1.1 server on the loopback interface. Each request for a path is answered with the next of the
+    // responses added for that path, repeating the last one once the others are used up, and unknown paths are
+    // answered with 404. Every response is delayed a little so that the transfers of a bulk operation overlap.
+    struct TestHttpServer
+    {
+        TestHttpServer()
+        {
+            m_listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            REQUIRE(m_listen_fd >= 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = 0;
+            REQUIRE(::bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+            REQUIRE(::listen(m_listen_fd, 64) == 0);
+            socklen_t addr_size = sizeof(addr);
+            REQUIRE(::getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_size) == 0);
+            m_port = ntohs(addr.sin_port);
+            m_accept_thread = std::thread([this] { accept_connections(); });
+        }
+
+        TestHttpServer(const TestHttpServer&) = delete;
+        TestHttpServer& operator=(const TestHttpServer&) = delete;
+
+        ~TestHttpServer()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mtx);
+                m_stopping = true;
+                for (auto fd : m_connection_fds)
+                {
+                    ::shutdown(fd, SHUT_RDWR);
+                }
+            }
+
+            // wake the accept thread with a connection of our own
+            const int wake_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(m_port);
+            ::connect(wake_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            m_accept_thread.join();
+            ::close(wake_fd);
+            for (auto&& connection_thread : m_connection_threads)
+            {
+                connection_thread.join();
+            }
+
+            ::close(m_listen_fd);
+        }
+
+        std::string url(StringView path) const { return fmt::format("http://127.0.0.1:{}{}", m_port, path); }
+
+        void add(std::string path, std::vector<TestHttpResponse> responses)
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_responses[std::move(path)] = std::move(responses);
+        }
+
+        size_t requests(const std::string& path)
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_requests[path];
+        }
+
+        size_t max_requests_in_flight()
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return m_max_in_flight;
+        }
+
+    private:
+        void accept_connections()
+        {
+            for (;;)
+            {
+                const int fd = ::accept(m_listen_fd, nullptr, nullptr);
+                std::lock_guard<std::mutex> lock(m_mtx);
+                if (m_stopping)
+                {
+                    if (fd >= 0)
+                    {
+                        ::close(fd);
+                    }
+
+                    return;
+                }
+
+                if (fd >= 0)
+                {
+#if defined(SO_NOSIGPIPE)
+                    int no_sigpipe = 1;
+                    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+                    m_connection_fds.push_back(fd);
+                    m_connection_threads.emplace_back([this, fd] { serve_connection(fd); });
+                }
+            }
+        }
+
+        void serve_connection(int fd)
+        {
+            std::string buffer;
+            char chunk[4096];
+            for (;;)
+            {
+                const auto headers_end = buffer.find("\r\n\r\n");
+                if (headers_end == std::string::npos)
+                {
+                    const auto received = ::recv(fd, chunk, sizeof(chunk), 0);
+                    if (received <= 0)
+                    {
+                        break;
+                    }
+
+                    buffer.append(chunk, static_cast<size_t>(received));
+                    continue;
+                }
+
+                // METHOD SP path SP version
+                const auto method_end = buffer.find(' ');
+                const auto path_end = buffer.find(' ', method_end + 1);
+                const bool is_head = buffer.compare(0, method_end, "HEAD") == 0;
+                const auto path = buffer.substr(method_end + 1, path_end - method_end - 1);
+                buffer.erase(0, headers_end + 4);
+
+                TestHttpResponse response{404, "not found"};
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    const auto request_index = m_requests[path]++;
+                    auto it = m_responses.find(path);
+                    if (it != m_responses.end() && !it->second.empty())
+                    {
+                        response = it->second[(std::min)(request_index, it->second.size() - 1)];
+                    }
+
+                    m_max_in_flight = (std::max)(m_max_in_flight, ++m_in_flight);
+                }
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    --m_in_flight;
+                }
+
+                auto reply = fmt::format(
+                    "HTTP/1.1 {} Test\r\nContent-Length: {}\r\n\r\n", response.status, response.body.size());
+                if (!is_head)
+                {
+                    reply.append(response.body);
+                }
+
+                if (::send(fd, reply.data(), reply.size(), send_flags) != static_cast<ssize_t>(reply.size()))
+                {
+                    break;
+                }
+            }
+
+            ::close(fd);
+        }
+
+        int m_listen_fd = -1;
+        uint16_t m_port = 0;
+        std::thread m_accept_thread;
+        std::mutex m_mtx;
+        bool m_stopping = false;
+        std::vector<int> m_connection_fds;
+        std::vector<std::thread> m_connection_threads;
+        std::map<std::string, std::vector<TestHttpResponse>> m_responses;
+        std::map<std::string, size_t> m_requests;
+        size_t m_in_flight = 0;
+        size_t m_max_in_flight = 0;
+    };
+}
+#endif // ^^^ !_WIN32
+
 TEST_CASE ("download_files", "[downloads]")
 {
     auto const dst = Test::base_temporary_directory() / "download_files";
@@ -39,6 +246,237 @@ TEST_CASE ("download_files", "[downloads]")
              all_errors[1] == "error: curl operation failed with error code 7 (Couldn't connect to server)."));
 }
 
+TEST_CASE ("download_file_asset_cached verifies sha512 while downloading", "[downloads]")
+{
+    auto const dst = Test::base_temporary_directory() / "download_verify_sha512";
+    real_filesystem.remove_all(dst, VCPKG_LINE_INFO);
+    real_filesystem.create_directories(dst, VCPKG_LINE_INFO);
+    auto const source = dst / "source.txt";
+    std::string contents;
+    for (int i = 0; i < 100000; ++i)
+    {
+        contents.append("download contents ");
+    }
+
+    real_filesystem.write_contents(source, contents, VCPKG_LINE_INFO);
+    auto const url = "file://" + source.generic_u8string();
+    auto const expected_sha512 = Hash::get_string_hash(contents, Hash::Algorithm::Sha512);
+    AssetCachingSettings settings;
+
+    {
+        FullyBufferedDiagnosticContext bdc;
+        auto const target = dst / "good.txt";
+        CHECK(download_file_asset_cached(
+            bdc, null_sink, settings, real_filesystem, url, {}, target, "good.txt", expected_sha512));
+        CHECK(real_filesystem.read_contents(target, VCPKG_LINE_INFO) == contents);
+    }
+
+    {
+        FullyBufferedDiagnosticContext bdc;
+        auto const target = dst / "bad.txt";
+        CHECK(!download_file_asset_cached(
+            bdc, null_sink, settings, real_filesystem, url, {}, target, "bad.txt", std::string(128, 'a')));
+        CHECK(!real_filesystem.exists(target, VCPKG_LINE_INFO));
+        CHECK(bdc.to_string().find(expected_sha512) != std::string::npos);
+    }
+}
+
+TEST_CASE ("download_files_no_cache downloads more files than transfers in flight", "[downloads]")
+{
+    auto const dst = Test::base_temporary_directory() / "download_files_bulk";
+    real_filesystem.remove_all(dst, VCPKG_LINE_INFO);
+    real_filesystem.create_directories(dst / "sources", VCPKG_LINE_INFO);
+
+    // more transfers than are allowed in flight at once, so that later transfers wait for earlier ones
+    std::vector<std::pair<std::string, Path>> url_pairs;
+    for (int i = 0; i < 40; ++i)
+    {
+        auto const source = dst / "sources" / fmt::format("{}.txt", i);
+        real_filesystem.write_contents(source, fmt::format("contents of {}", i), VCPKG_LINE_INFO);
+        url_pairs.emplace_back("file://" + source.generic_u8string(), dst / fmt::format("{}.txt", i));
+    }
+
+    url_pairs[7].second = dst / "missing-directory" / "7.txt";
+    url_pairs[23].first = "file://" + (dst / "sources" / "missing.txt").generic_u8string();
+
+    FullyBufferedDiagnosticContext bdc;
+    auto results = download_files_no_cache(bdc, url_pairs, {});
+    REQUIRE(results.size() == url_pairs.size());
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        INFO(i);
+        if (i == 7 || i == 23)
+        {
+            CHECK(results[i] == -1);
+        }
+        else
+        {
+            CHECK(results[i] == 0);
+            CHECK(real_filesystem.read_contents(url_pairs[i].second, VCPKG_LINE_INFO) ==
+                  fmt::format("contents of {}", i));
+        }
+    }
+
+    auto all_errors = Strings::split(bdc.to_string(), '\n');
+    REQUIRE(all_errors.size() == 2);
+    CHECK(all_errors[0].find("missing-directory") != std::string::npos);
+    CHECK(Strings::starts_with(all_errors[1], "error: curl operation failed with error code 37"));
+
+    FullyBufferedDiagnosticContext heads_bdc;
+    const std::vector<std::string> head_urls{url_pairs[0].first, url_pairs[1].first};
+    CHECK(url_heads(heads_bdc, head_urls, {}) == std::vector<int>{0, 0});
+    CHECK(heads_bdc.empty());
+}
+
+TEST_CASE ("transient transfer failures are retried", "[downloads]")
+{
+    CHECK(is_transient_response_code("https://example.com/file", 408));
+    CHECK(is_transient_response_code("https://example.com/file", 429));
+    CHECK(is_transient_response_code("https://example.com/file", 500));
+    CHECK(is_transient_response_code("https://example.com/file", 502));
+    CHECK(is_transient_response_code("https://example.com/file", 503));
+    CHECK(is_transient_response_code("https://example.com/file", 504));
+    CHECK(!is_transient_response_code("https://example.com/file", 200));
+    CHECK(!is_transient_response_code("https://example.com/file", 404));
+    CHECK(!is_transient_response_code("https://example.com/file", 501));
+    CHECK(is_transient_response_code("ftp://example.com/file", 421));
+    CHECK(!is_transient_response_code("ftp://example.com/file", 530));
+    CHECK(!is_transient_response_code("file:///file", 0));
+
+    CHECK(should_retry_transfer("https://example.com/file", CURLE_OPERATION_TIMEDOUT, -1));
+    CHECK(should_retry_transfer("https://example.com/file", CURLE_OK, 503));
+    CHECK(!should_retry_transfer("https://example.com/file", CURLE_OK, 200));
+    CHECK(!should_retry_transfer("https://example.com/file", CURLE_OK, 404));
+    CHECK(!should_retry_transfer("https://example.com/file", CURLE_COULDNT_CONNECT, -1));
+    CHECK(!should_retry_transfer("https://example.com/file", CURLE_COULDNT_CONNECT, 503));
+}
+
+#if !defined(_WIN32)
+TEST_CASE ("download_files_no_cache retries transient failures", "[downloads]")
+{
+    auto const dst = Test::base_temporary_directory() / "download_files_retry";
+    real_filesystem.remove_all(dst, VCPKG_LINE_INFO);
+    real_filesystem.create_directories(dst, VCPKG_LINE_INFO);
+
+    TestHttpServer server;
+    // the body of the failed attempt is longer than the final one, so it must be truncated rather than overwritten
+    server.add("/flaky", {{503, "service unavailable, please try again later"}, {200, "flaky contents"}});
+    server.add("/unavailable", {{503, "service unavailable"}});
+    std::vector<std::pair<std::string, Path>> url_pairs{
+        {server.url("/flaky"), dst / "flaky.txt"},
+        {server.url("/unavailable"), dst / "unavailable.txt"},
+        {server.url("/missing"), dst / "missing.txt"},
+    };
+
+    for (int i = 0; i < 40; ++i)
+    {
+        auto path = fmt::format("/files/{}", i);
+        server.add(path, {{200, fmt::format("contents of {}", i)}});
+        url_pairs.emplace_back(server.url(path), dst / fmt::format("{}.txt", i));
+    }
+
+    FullyBufferedDiagnosticContext bdc;
+    auto results = download_files_no_cache(bdc, url_pairs, {});
+    CHECK(bdc.empty());
+    REQUIRE(results.size() == url_pairs.size());
+    CHECK(results[0] == 200);
+    CHECK(real_filesystem.read_contents(dst / "flaky.txt", VCPKG_LINE_INFO) == "flaky contents");
+    CHECK(server.requests("/flaky") == 2);
+    // one attempt and two retries
+    CHECK(results[1] == 503);
+    CHECK(server.requests("/unavailable") == 3);
+    CHECK(results[2] == 404);
+    CHECK(server.requests("/missing") == 1);
+    for (size_t i = 3; i < results.size(); ++i)
+    {
+        INFO(i);
+        CHECK(results[i] == 200);
+        CHECK(real_filesystem.read_contents(url_pairs[i].second, VCPKG_LINE_INFO) ==
+              fmt::format("contents of {}", i - 3));
+    }
+
+    // transfers beyond the per host connection limit wait for a connection
+    CHECK(server.max_requests_in_flight() <= 6);
+
+    FullyBufferedDiagnosticContext heads_bdc;
+    const std::vector<std::string> head_urls{server.url("/files/0"), server.url("/missing")};
+    CHECK(url_heads(heads_bdc, head_urls, {}) == std::vector<int>{200, 404});
+    CHECK(heads_bdc.empty());
+}
+
+TEST_CASE ("download_files_no_cache abandons downloads no longer needed", "[downloads]")
+{
+    auto const dst = Test::base_temporary_directory() / "download_files_listener";
+    real_filesystem.remove_all(dst, VCPKG_LINE_INFO);
+    real_filesystem.create_directories(dst, VCPKG_LINE_INFO);
+
+    TestHttpServer server;
+    std::vector<std::pair<std::string, Path>> url_pairs;
+    for (int i = 0; i < 40; ++i)
+    {
+        auto path = fmt::format("/files/{}", i);
+        server.add(path, {{200, fmt::format("contents of {}", i)}});
+        url_pairs.emplace_back(server.url(path), dst / fmt::format("{}.txt", i));
+    }
+
+    // Odd downloads are never needed, and none are needed once 4 have finished
+    struct Listener final : BulkDownloadListener
+    {
+        bool still_needed(size_t idx) override { return idx % 2 == 0 && finished_indices.size() < 4; }
+        void finished(size_t idx, int code) override
+        {
+            CHECK(code == 200);
+            finished_indices.push_back(idx);
+        }
+
+        std::vector<size_t> finished_indices;
+    } listener;
+
+    FullyBufferedDiagnosticContext bdc;
+    auto results = download_files_no_cache(bdc, url_pairs, {}, listener);
+    CHECK(bdc.empty());
+    REQUIRE(results.size() == url_pairs.size());
+    CHECK(listener.finished_indices.size() >= 4);
+    // at most the transfers in flight when the 4th finished may also finish
+    CHECK(listener.finished_indices.size() < 20);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        INFO(i);
+        const bool finished = Util::Vectors::contains(listener.finished_indices, i);
+        CHECK(results[i] == (finished ? 200 : -1));
+        CHECK(real_filesystem.exists(url_pairs[i].second, IgnoreErrors{}) == finished);
+        if (i % 2 == 1)
+        {
+            CHECK(!finished);
+            CHECK(server.requests(fmt::format("/files/{}", i)) == 0);
+        }
+    }
+}
+
+TEST_CASE ("download_file_asset_cached rehashes retried downloads", "[downloads]")
+{
+    auto const dst = Test::base_temporary_directory() / "download_asset_retry";
+    real_filesystem.remove_all(dst, VCPKG_LINE_INFO);
+    real_filesystem.create_directories(dst, VCPKG_LINE_INFO);
+
+    TestHttpServer server;
+    server.add("/asset", {{503, "service unavailable, please try again later"}, {200, "asset contents"}});
+    FullyBufferedDiagnosticContext bdc;
+    auto const target = dst / "asset.txt";
+    CHECK(download_file_asset_cached(bdc,
+                                     null_sink,
+                                     AssetCachingSettings{},
+                                     real_filesystem,
+                                     server.url("/asset"),
+                                     {},
+                                     target,
+                                     "asset.txt",
+                                     Hash::get_string_hash("asset contents", Hash::Algorithm::Sha512)));
+    CHECK(real_filesystem.read_contents(target, VCPKG_LINE_INFO) == "asset contents");
+    CHECK(server.requests("/asset") == 2);
+}
+#endif // ^^^ !_WIN32
+
 TEST_CASE ("url_encode_spaces", "[downloads]")
 {
     REQUIRE(url_encode_spaces("https://example.com?query=value&query2=value2") ==
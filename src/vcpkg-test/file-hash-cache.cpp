@@ -0,0 +1,114 @@
+#include <vcpkg-test/util.h>
+
+#include <vcpkg/base/file-hash-cache.h>
+#include <vcpkg/base/hash.h>
+
+using namespace vcpkg;
+
+namespace
+{
+    // Replaces the contents of `path` without changing its size, inode, or last write time, which the cache
+    // cannot notice.
+    void overwrite_preserving_metadata(const Path& path, StringView contents, int64_t last_write_time)
+    {
+        real_filesystem.write_contents(path, contents, VCPKG_LINE_INFO);
+        FullyBufferedDiagnosticContext bdc;
+        REQUIRE(real_filesystem.last_write_time(bdc, path, last_write_time));
+    }
+}
+
+TEST_CASE ("file hash cache reuses hashes of unchanged files", "[file-hash-cache]")
+{
+    auto const dir = Test::base_temporary_directory() / "file-hash-cache-reuse";
+    real_filesystem.remove_all(dir, VCPKG_LINE_INFO);
+    real_filesystem.create_directories(dir, VCPKG_LINE_INFO);
+    auto const file = dir / "file.txt";
+    auto const cache_file = dir / "cache.json";
+    auto const old_time = real_filesystem.last_write_time(dir, VCPKG_LINE_INFO) - int64_t{1'000'000'000} * 60;
+    overwrite_preserving_metadata(file, "aaaa", old_time);
+    auto const original_hash = Hash::get_string_sha256("aaaa");
+    auto const modified_hash = Hash::get_string_sha256("bbbb");
+
+    {
+        FileHashCache cache(real_filesystem, FileHashCacheMode::Enabled, cache_file);
+        CHECK(cache.get_file_sha256(real_filesystem, file).value_or_exit(VCPKG_LINE_INFO) == original_hash);
+        cache.save(real_filesystem);
+    }
+
+    REQUIRE(real_filesystem.is_regular_file(cache_file));
+    overwrite_preserving_metadata(file, "bbbb", old_time);
+
+    {
+        FileHashCache cache(real_filesystem, FileHashCacheMode::Enabled, cache_file);
+        // The file is not read again, so the modification is not seen
+        CHECK(cache.get_file_sha256(real_filesystem, file).value_or_exit(VCPKG_LINE_INFO) == original_hash);
+        CHECK(cache.get_contents_sha256(real_filesystem, file, "bbbb") == original_hash);
+    }
+
+    {
+        FileHashCache cache(real_filesystem, FileHashCacheMode::Strict, cache_file);
+        CHECK(cache.get_file_sha256(real_filesystem, file).value_or_exit(VCPKG_LINE_INFO) == modified_hash);
+        cache.save(real_filesystem);
+    }
+
+    {
+        FileHashCache cache(real_filesystem, FileHashCacheMode::Enabled, cache_file);
+        CHECK(cache.get_file_sha256(real_filesystem, file).value_or_exit(VCPKG_LINE_INFO) == modified_hash);
+    }
+
+    overwrite_preserving_metadata(file, "ccccc", old_time);
+
+    {
+        FileHashCache cache(real_filesystem, FileHashCacheMode::Enabled, cache_file);
+        CHECK(cache.get_file_sha256(real_filesystem, file).value_or_exit(VCPKG_LINE_INFO) ==
+              Hash::get_string_sha256("ccccc"));
+    }
+
+    {
+        FileHashCache cache(real_filesystem, FileHashCacheMode::Disabled, cache_file);
+        overwrite_preserving_metadata(file, "ddddd", old_time);
+        CHECK(cache.get_file_sha256(real_filesystem, file).value_or_exit(VCPKG_LINE_INFO) ==
+              Hash::get_string_sha256("ddddd"));
+    }
+}
+
+TEST_CASE ("file hash cache does not remember recently modified files", "[file-hash-cache]")
+{
+    auto const dir = Test::base_temporary_directory() / "file-hash-cache-racy";
+    real_filesystem.remove_all(dir, VCPKG_LINE_INFO);
+    real_filesystem.create_directories(dir, VCPKG_LINE_INFO);
+    auto const file = dir / "file.txt";
+    auto const cache_file = dir / "cache.json";
+    real_filesystem.write_contents(file, "aaaa", VCPKG_LINE_INFO);
+    auto const write_time = real_filesystem.last_write_time(file, VCPKG_LINE_INFO);
+
+    {
+        FileHashCache cache(real_filesystem, FileHashCacheMode::Enabled, cache_file);
+        CHECK(cache.get_file_sha256(real_filesystem, file).value_or_exit(VCPKG_LINE_INFO) ==
+              Hash::get_string_sha256("aaaa"));
+        cache.save(real_filesystem);
+    }
+
+    overwrite_preserving_metadata(file, "bbbb", write_time);
+
+    {
+        FileHashCache cache(real_filesystem, FileHashCacheMode::Enabled, cache_file);
+        CHECK(cache.get_file_sha256(real_filesystem, file).value_or_exit(VCPKG_LINE_INFO) ==
+              Hash::get_string_sha256("bbbb"));
+    }
+}
+
+TEST_CASE ("file hash cache ignores invalid cache files", "[file-hash-cache]")
+{
+    auto const dir = Test::base_temporary_directory() / "file-hash-cache-invalid";
+    real_filesystem.remove_all(dir, VCPKG_LINE_INFO);
+    real_filesystem.create_directories(dir, VCPKG_LINE_INFO);
+    auto const file = dir / "file.txt";
+    auto const cache_file = dir / "cache.json";
+    real_filesystem.write_contents(file, "aaaa", VCPKG_LINE_INFO);
+    real_filesystem.write_contents(cache_file, "{ not json", VCPKG_LINE_INFO);
+
+    FileHashCache cache(real_filesystem, FileHashCacheMode::Enabled, cache_file);
+    CHECK(cache.get_file_sha256(real_filesystem, file).value_or_exit(VCPKG_LINE_INFO) ==
+          Hash::get_string_sha256("aaaa"));
+}
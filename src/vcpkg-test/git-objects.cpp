@@ -0,0 +1,196 @@
+#include <vcpkg-test/util.h>
+
+#include <vcpkg/base/deflate.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/git-objects.h>
+
+using namespace vcpkg;
+
+namespace
+{
+    // The reader does not verify that ids match the hashes of objects, so these tests use made up ids
+    std::string make_id(char digit) { return std::string(40, digit); }
+
+    std::string raw_id(char digit)
+    {
+        const int value = digit <= '9' ? digit - '0' : digit - 'a' + 10;
+        return std::string(20, static_cast<char>(value * 17));
+    }
+
+    void write_loose_object(const Path& git_dir, char id_digit, StringView type, StringView data)
+    {
+        const auto id = make_id(id_digit);
+        auto contents = fmt::format("{} {}", type, data.size());
+        contents.push_back('\0');
+        contents.append(data.data(), data.size());
+        real_filesystem.write_contents_and_dirs(git_dir / "objects" / id.substr(0, 2) / id.substr(2),
+                                                Deflate::compress_zlib(contents),
+                                                VCPKG_LINE_INFO);
+    }
+
+    std::string tree_entry(StringView mode, StringView name, char id_digit)
+    {
+        auto result = fmt::format("{} {}", mode, name);
+        result.push_back('\0');
+        result.append(raw_id(id_digit));
+        return result;
+    }
+
+    void append_be32(std::string& out, uint32_t value)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            out.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+
+    void append_varint(std::string& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>(0x80 | (value & 0x7F)));
+            value >>= 7;
+        }
+
+        out.push_back(static_cast<char>(value));
+    }
+
+    void append_pack_entry_header(std::string& out, int type, uint64_t size)
+    {
+        auto first = static_cast<unsigned char>((type << 4) | (size & 0xF));
+        size >>= 4;
+        out.push_back(static_cast<char>(first | (size ? 0x80 : 0)));
+        if (size)
+        {
+            append_varint(out, size);
+        }
+    }
+
+    std::string make_delta(StringView base, size_t copy_size, StringView insert)
+    {
+        std::string delta;
+        append_varint(delta, base.size());
+        append_varint(delta, copy_size + insert.size());
+        // Copy from offset 0 with a one byte size, then insert
+        delta.push_back(static_cast<char>(0x90));
+        delta.push_back(static_cast<char>(copy_size));
+        delta.push_back(static_cast<char>(insert.size()));
+        delta.append(insert.data(), insert.size());
+        return delta;
+    }
+
+    // Writes a pack holding a blob, a blob stored as an offset delta against it, and a blob stored as a reference
+    // delta against the loose object `ref_base`
+    void write_pack(const Path& git_dir, StringView base, StringView ref_base, char ref_base_digit)
+    {
+        std::string pack = "PACK";
+        append_be32(pack, 2);
+        append_be32(pack, 3);
+
+        const uint32_t base_offset = static_cast<uint32_t>(pack.size());
+        append_pack_entry_header(pack, 3, base.size());
+        pack.append(Deflate::compress_zlib(base));
+
+        const uint32_t ofs_delta_offset = static_cast<uint32_t>(pack.size());
+        const auto ofs_delta = make_delta(base, 21, "delta\n");
+        append_pack_entry_header(pack, 6, ofs_delta.size());
+        append_varint(pack, ofs_delta_offset - base_offset);
+        pack.append(Deflate::compress_zlib(ofs_delta));
+
+        const uint32_t ref_delta_offset = static_cast<uint32_t>(pack.size());
+        const auto ref_delta = make_delta(ref_base, 5, " again\n");
+        append_pack_entry_header(pack, 7, ref_delta.size());
+        pack.append(raw_id(ref_base_digit));
+        pack.append(Deflate::compress_zlib(ref_delta));
+        pack.append(std::string(20, '\0'));
+
+        const std::pair<char, uint32_t> objects[] = {
+            {'b', base_offset}, {'c', ofs_delta_offset}, {'d', ref_delta_offset}};
+        std::string index = "\377tOc";
+        append_be32(index, 2);
+        for (int byte = 0; byte < 256; ++byte)
+        {
+            append_be32(index,
+                        static_cast<uint32_t>(std::count_if(std::begin(objects), std::end(objects), [&](auto&& object) {
+                            return static_cast<unsigned char>(raw_id(object.first)[0]) <= byte;
+                        })));
+        }
+
+        for (auto&& object : objects)
+        {
+            index.append(raw_id(object.first));
+        }
+
+        for (size_t idx = 0; idx < std::size(objects); ++idx)
+        {
+            append_be32(index, 0);
+        }
+
+        for (auto&& object : objects)
+        {
+            append_be32(index, object.second);
+        }
+
+        index.append(std::string(40, '\0'));
+        real_filesystem.write_contents_and_dirs(git_dir / "objects" / "pack" / "pack-test.pack", pack, VCPKG_LINE_INFO);
+        real_filesystem.write_contents(git_dir / "objects" / "pack" / "pack-test.idx", index, VCPKG_LINE_INFO);
+    }
+}
+
+TEST_CASE ("git object database reads loose objects", "[git-objects]")
+{
+    auto const root = Test::base_temporary_directory() / "git-objects-loose";
+    auto const git_dir = root / ".git";
+    real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+    write_loose_object(git_dir, '1', "blob", "file contents\n");
+    write_loose_object(git_dir, '2', "blob", "#!/bin/sh\n");
+    write_loose_object(git_dir, '3', "tree", tree_entry("100755", "script.sh", '2'));
+    write_loose_object(
+        git_dir, '4', "tree", tree_entry("100644", "file.txt", '1') + tree_entry("40000", "sub", '3'));
+    write_loose_object(
+        git_dir, '5', "commit", fmt::format("tree {}\nauthor a <a> 0 +0000\n\nmessage\n", make_id('4')));
+    write_loose_object(git_dir, '6', "tree", tree_entry("120000", "link", '1'));
+
+    GitObjectDatabase objects(real_filesystem, git_dir);
+    CHECK(objects.read_blob(make_id('5') + ":file.txt").value_or("") == "file contents\n");
+    CHECK(objects.read_blob(make_id('4') + ":sub/script.sh").value_or("") == "#!/bin/sh\n");
+    CHECK(objects.resolve(make_id('5') + ":sub").value_or("") == make_id('3'));
+    CHECK(objects.resolve(make_id('5') + ":").value_or("") == make_id('4'));
+    CHECK(!objects.read_blob(make_id('5') + ":sub").has_value());
+    CHECK(!objects.read_blob(make_id('5') + ":missing.txt").has_value());
+    CHECK(!objects.read_blob(make_id('9') + ":file.txt").has_value());
+    CHECK(!objects.read_blob("HEAD:file.txt").has_value());
+    {
+        auto maybe_commit = objects.read_object(make_id('5'));
+        auto commit = maybe_commit.get();
+        REQUIRE(commit);
+        CHECK(commit->type == GitObjectType::Commit);
+    }
+
+    auto const destination = root / "extracted";
+    REQUIRE(objects.extract_tree(real_filesystem, make_id('5'), destination));
+    CHECK(real_filesystem.read_contents(destination / "file.txt", VCPKG_LINE_INFO) == "file contents\n");
+    CHECK(real_filesystem.read_contents(destination / "sub" / "script.sh", VCPKG_LINE_INFO) == "#!/bin/sh\n");
+
+    // Symbolic links are left to git
+    auto const link_destination = root / "link";
+    CHECK(!objects.extract_tree(real_filesystem, make_id('6'), link_destination));
+    CHECK(!real_filesystem.exists(link_destination, IgnoreErrors{}));
+}
+
+TEST_CASE ("git object database reads packed objects", "[git-objects]")
+{
+    auto const git_dir = Test::base_temporary_directory() / "git-objects-packed";
+    real_filesystem.remove_all(git_dir, VCPKG_LINE_INFO);
+    write_loose_object(git_dir, 'a', "blob", "loose object\n");
+    GitObjectDatabase objects(real_filesystem, git_dir);
+    CHECK(!objects.read_object(make_id('b')).has_value());
+
+    // Packs added after the first lookup are found
+    write_pack(git_dir, "hello world, this is the base\n", "loose object\n", 'a');
+    CHECK(objects.read_blob(make_id('b')).value_or("") == "hello world, this is the base\n");
+    CHECK(objects.read_blob(make_id('c')).value_or("") == "hello world, this is delta\n");
+    CHECK(objects.read_blob(make_id('d')).value_or("") == "loose again\n");
+    CHECK(objects.read_blob(make_id('c')).value_or("") == "hello world, this is delta\n");
+    CHECK(!objects.read_blob(make_id('e')).has_value());
+}
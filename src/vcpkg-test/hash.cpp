@@ -6,6 +6,8 @@
 #include <iostream>
 #include <iterator>
 #include <map>
+#include <random>
+#include <vector>
 
 namespace Hash = vcpkg::Hash;
 using vcpkg::StringView;
@@ -126,6 +128,39 @@ TEST_CASE ("SHA512: NIST test cases (small)", "[hash][sha512]")
                "1161798015052893a48c3d161");
 }
 
+TEST_CASE ("SHA: default hasher matches the portable implementation", "[hash][sha256][sha512]")
+{
+    std::mt19937 urbg(1729);
+    std::vector<unsigned char> data(20000);
+    std::generate(data.begin(), data.end(), [&] { return static_cast<unsigned char>(urbg()); });
+
+    for (auto algorithm : {Hash::Algorithm::Sha256, Hash::Algorithm::Sha512})
+    {
+        auto hasher = Hash::get_hasher_for(algorithm);
+        auto portable = Hash::get_portable_hasher_for(algorithm);
+        for (std::size_t size : {0, 1, 55, 56, 63, 64, 65, 111, 112, 127, 128, 129, 1000, 4096, 20000})
+        {
+            // feed the bytes in uneven pieces so that partial and whole chunks are both exercised
+            std::size_t offset = 0;
+            std::size_t piece = 1;
+            while (offset != size)
+            {
+                const auto this_piece = (std::min)(piece, size - offset);
+                hasher->add_bytes(data.data() + offset, data.data() + offset + this_piece);
+                offset += this_piece;
+                piece = piece * 3 + 1;
+            }
+
+            portable->add_bytes(data.data(), data.data() + size);
+            const auto expected = portable->get_hash();
+            CHECK(hasher->get_hash() == expected);
+            CHECK(Hash::get_bytes_hash(data.data(), data.data() + size, algorithm) == expected);
+            hasher->clear();
+            portable->clear();
+        }
+    }
+}
+
 TEST_CASE ("SHA256: NIST test cases (large)", "[.][hash-expensive][sha256-expensive]")
 {
     auto hasher = Hash::get_hasher_for(Hash::Algorithm::Sha256);
@@ -228,4 +263,29 @@ TEST_CASE ("SHA512: large -- benchmark", "[.][hash][sha512][!benchmark]")
         benchmark_hasher(meter, *hasher, 0x6000'003E, 'B');
     };
 }
+
+TEST_CASE ("SHA: throughput -- benchmark", "[.][hash][sha256][sha512][!benchmark]")
+{
+    auto sha256 = Hash::get_hasher_for(Hash::Algorithm::Sha256);
+    auto sha256_portable = Hash::get_portable_hasher_for(Hash::Algorithm::Sha256);
+    auto sha512 = Hash::get_hasher_for(Hash::Algorithm::Sha512);
+    auto sha512_portable = Hash::get_portable_hasher_for(Hash::Algorithm::Sha512);
+
+    BENCHMARK_ADVANCED("SHA256 64 MiB")(Catch::Benchmark::Chronometer meter)
+    {
+        benchmark_hasher(meter, *sha256, 0x400'0000, 'Z');
+    };
+    BENCHMARK_ADVANCED("SHA256 (portable) 64 MiB")(Catch::Benchmark::Chronometer meter)
+    {
+        benchmark_hasher(meter, *sha256_portable, 0x400'0000, 'Z');
+    };
+    BENCHMARK_ADVANCED("SHA512 64 MiB")(Catch::Benchmark::Chronometer meter)
+    {
+        benchmark_hasher(meter, *sha512, 0x400'0000, 'Z');
+    };
+    BENCHMARK_ADVANCED("SHA512 (portable) 64 MiB")(Catch::Benchmark::Chronometer meter)
+    {
+        benchmark_hasher(meter, *sha512_portable, 0x400'0000, 'Z');
+    };
+}
 #endif
@@ -0,0 +1,197 @@
+#include <vcpkg-test/util.h>
+
+#include <vcpkg/base/files.h>
+
+#include <vcpkg/installeddatabase.h>
+#include <vcpkg/installedpaths.h>
+#include <vcpkg/statusparagraphs.h>
+
+using namespace vcpkg;
+
+namespace
+{
+    std::vector<std::string> owners_of(const InstalledFileIndex& index, StringView file)
+    {
+        std::vector<std::string> result;
+        for (auto&& owner : index.find(file))
+        {
+            result.push_back(fmt::format("{} {}", owner.owner_display_name, owner.file));
+        }
+
+        return result;
+    }
+
+    std::vector<std::string> owners_of_prefix(InstalledFileIndex& index, StringView prefix)
+    {
+        std::vector<std::string> result;
+        for (auto&& owner : index.find_prefix(prefix))
+        {
+            result.push_back(fmt::format("{} {}", owner.owner_display_name, owner.file));
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE ("installed file index", "[installeddatabase]")
+{
+    auto const root = Test::base_temporary_directory() / "installed-file-index";
+    real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+    InstalledPaths installed{Path{root}};
+    installed.create_directories(real_filesystem);
+
+    std::vector<std::unique_ptr<StatusParagraph>> pghs;
+    pghs.push_back(Test::make_status_pgh("zlib", "", "", "x64-linux"));
+    pghs.push_back(Test::make_status_pgh("bzip2", "", "", "x64-linux"));
+    pghs.push_back(Test::make_status_feature_pgh("bzip2", "tool", "", "x64-linux"));
+    StatusParagraphs status_db(std::move(pghs));
+    const auto& zlib = (*status_db.find("zlib", Test::X64_LINUX))->package;
+    const auto& bzip2 = (*status_db.find("bzip2", Test::X64_LINUX))->package;
+
+    real_filesystem.write_lines(
+        installed.listfile_path(zlib),
+        {"x64-linux/", "x64-linux/include/", "x64-linux/include/zlib.h", "x64-linux/lib/", "x64-linux/lib/libz.a"},
+        VCPKG_LINE_INFO);
+    real_filesystem.write_lines(installed.listfile_path(bzip2),
+                                {"x64-linux/", "x64-linux/include/", "x64-linux/include/bzlib.h"},
+                                VCPKG_LINE_INFO);
+
+    {
+        auto index = InstalledFileIndex::load(real_filesystem, installed, status_db);
+        CHECK(owners_of(index, "x64-linux/include/zlib.h") ==
+              std::vector<std::string>{"zlib:x64-linux x64-linux/include/zlib.h"});
+        CHECK(owners_of(index, "X64-Linux/Include/BZLIB.h") ==
+              std::vector<std::string>{"bzip2:x64-linux x64-linux/include/bzlib.h"});
+        // Directories are not owned by any one package
+        CHECK(owners_of(index, "x64-linux/include/").empty());
+        CHECK(owners_of(index, "x64-linux/include").empty());
+        CHECK(index.all_files().size() == 3);
+
+        // Prefixes match the whole path or any part of it after a '/'
+        CHECK(owners_of_prefix(index, "x64-linux/include/") ==
+              std::vector<std::string>{"bzip2:x64-linux x64-linux/include/bzlib.h",
+                                       "zlib:x64-linux x64-linux/include/zlib.h"});
+        CHECK(owners_of_prefix(index, "Lib") == std::vector<std::string>{"zlib:x64-linux x64-linux/lib/libz.a"});
+        CHECK(owners_of_prefix(index, "zlib.h") == std::vector<std::string>{"zlib:x64-linux x64-linux/include/zlib.h"});
+        CHECK(owners_of_prefix(index, "x64-linux").size() == 3);
+        CHECK(owners_of_prefix(index, "ib.h").empty());
+        CHECK(owners_of_prefix(index, "x64-windows").empty());
+        index.save(real_filesystem, installed);
+
+        auto zstd = Test::make_status_pgh("zstd", "", "", "x64-linux");
+        real_filesystem.write_lines(
+            installed.listfile_path(zstd->package), {"x64-linux/", "x64-linux/lib/libzstd.a"}, VCPKG_LINE_INFO);
+        index.add_package(real_filesystem, installed, zstd->package);
+        CHECK(owners_of_prefix(index, "libz") == std::vector<std::string>{"zlib:x64-linux x64-linux/lib/libz.a",
+                                                                          "zstd:x64-linux x64-linux/lib/libzstd.a"});
+        real_filesystem.remove(installed.listfile_path(zstd->package), VCPKG_LINE_INFO);
+    }
+
+    REQUIRE(real_filesystem.is_regular_file(installed.installed_file_index_path()));
+
+    SECTION ("listfiles that changed are read again")
+    {
+        real_filesystem.write_lines(installed.listfile_path(bzip2),
+                                    {"x64-linux/", "x64-linux/include/", "x64-linux/include/bzlib2.h"},
+                                    VCPKG_LINE_INFO);
+        auto index = InstalledFileIndex::load(real_filesystem, installed, status_db);
+        CHECK(owners_of(index, "x64-linux/include/bzlib.h").empty());
+        CHECK(owners_of(index, "x64-linux/include/bzlib2.h") ==
+              std::vector<std::string>{"bzip2:x64-linux x64-linux/include/bzlib2.h"});
+        CHECK(owners_of(index, "x64-linux/lib/libz.a") ==
+              std::vector<std::string>{"zlib:x64-linux x64-linux/lib/libz.a"});
+    }
+
+    SECTION ("packages that are no longer installed are dropped")
+    {
+        auto zlib_removed = std::make_unique<StatusParagraph>(*status_db.find("zlib", Test::X64_LINUX)->get());
+        zlib_removed->status = StatusLine{Want::PURGE, InstallState::NOT_INSTALLED};
+        status_db.insert(std::move(zlib_removed));
+        auto index = InstalledFileIndex::load(real_filesystem, installed, status_db);
+        CHECK(owners_of(index, "x64-linux/include/zlib.h").empty());
+        CHECK(index.all_files().size() == 1);
+    }
+
+    SECTION ("newly installed packages are added")
+    {
+        auto index = InstalledFileIndex::load(real_filesystem, installed, status_db);
+        auto zstd = Test::make_status_pgh("zstd", "", "", "x64-linux");
+        real_filesystem.write_lines(installed.listfile_path(zstd->package),
+                                    {"x64-linux/", "x64-linux/include/", "x64-linux/include/zlib.h"},
+                                    VCPKG_LINE_INFO);
+        index.add_package(real_filesystem, installed, zstd->package);
+        CHECK(owners_of(index, "x64-linux/include/zlib.h").size() == 2);
+        status_db.insert(std::move(zstd));
+        index.save(real_filesystem, installed);
+
+        auto reloaded = InstalledFileIndex::load(real_filesystem, installed, status_db);
+        CHECK(owners_of(reloaded, "x64-linux/include/zlib.h").size() == 2);
+        CHECK(reloaded.all_files().size() == 4);
+    }
+}
+
+TEST_CASE ("status snapshot", "[installeddatabase]")
+{
+    auto const root = Test::base_temporary_directory() / "status-snapshot";
+    real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+    InstalledPaths installed{Path{root}};
+    InstalledDatabaseLock lock(real_filesystem, installed, nullopt, nullopt);
+    real_filesystem.create_directory(installed.vcpkg_dir_updates(), VCPKG_LINE_INFO);
+
+    std::vector<std::unique_ptr<StatusParagraph>> pghs;
+    pghs.push_back(Test::make_status_pgh("zlib", "", "", "x64-linux"));
+    pghs.push_back(Test::make_status_pgh("bzip2", "zlib", "tool", "x64-linux"));
+    pghs.push_back(Test::make_status_feature_pgh("bzip2", "tool", "zlib:x64-windows", "x64-linux"));
+    pghs.back()->package.description = {"first line", "second line"};
+    const auto original_status = Strings::serialize(StatusParagraphs{std::move(pghs)});
+    real_filesystem.write_contents(installed.vcpkg_dir_status_file(), original_status, VCPKG_LINE_INFO);
+
+    CHECK(Strings::serialize(database_sync(real_filesystem, installed, lock)) == original_status);
+    REQUIRE(real_filesystem.is_regular_file(installed.vcpkg_dir_status_snapshot_file()));
+    CHECK(Strings::serialize(database_load(real_filesystem, installed, lock)) == original_status);
+
+    auto zlib_removed = Test::make_status_pgh("zlib", "", "", "x64-linux");
+    zlib_removed->status = StatusLine{Want::PURGE, InstallState::NOT_INSTALLED};
+    database_write_update(real_filesystem, installed, *zlib_removed);
+    database_write_update(real_filesystem, installed, *Test::make_status_pgh("zstd", "", "", "x64-linux"));
+    const auto snapshot_size = real_filesystem.file_size(installed.vcpkg_dir_status_snapshot_file(), VCPKG_LINE_INFO);
+    const auto synced_status = Strings::serialize(database_sync(real_filesystem, installed, lock));
+    CHECK(real_filesystem.read_contents(installed.vcpkg_dir_status_file(), VCPKG_LINE_INFO) == synced_status);
+    // The updates are appended to the snapshot rather than rewriting it
+    CHECK(real_filesystem.file_size(installed.vcpkg_dir_status_snapshot_file(), VCPKG_LINE_INFO) > snapshot_size);
+    auto status_db = database_load(real_filesystem, installed, lock);
+    CHECK(Strings::serialize(status_db) == synced_status);
+    CHECK(!status_db.is_installed(PackageSpec{"zlib", Test::X64_LINUX}));
+    CHECK(status_db.is_installed(PackageSpec{"zstd", Test::X64_LINUX}));
+
+    SECTION ("the snapshot is used while it matches the status file")
+    {
+        // Replaces the status file's contents without changing its metadata, which only the snapshot would miss
+        const auto status_file = installed.vcpkg_dir_status_file();
+        const auto last_write_time = real_filesystem.last_write_time(status_file, VCPKG_LINE_INFO);
+        auto replaced = synced_status;
+        Strings::inplace_replace_all(replaced, "zstd", "zzzz");
+        real_filesystem.write_contents(status_file, replaced, VCPKG_LINE_INFO);
+        FullyBufferedDiagnosticContext bdc;
+        REQUIRE(real_filesystem.last_write_time(bdc, status_file, last_write_time));
+        CHECK(Strings::serialize(database_load(real_filesystem, installed, lock)) == synced_status);
+    }
+
+    SECTION ("the status file is authoritative when it changes")
+    {
+        real_filesystem.write_contents(installed.vcpkg_dir_status_file(), original_status, VCPKG_LINE_INFO);
+        CHECK(Strings::serialize(database_load(real_filesystem, installed, lock)) == original_status);
+    }
+
+    SECTION ("corrupt snapshots are ignored")
+    {
+        const auto snapshot_file = installed.vcpkg_dir_status_snapshot_file();
+        auto snapshot = real_filesystem.read_contents(snapshot_file, VCPKG_LINE_INFO);
+        snapshot.back() ^= 1;
+        real_filesystem.write_contents(snapshot_file, snapshot, VCPKG_LINE_INFO);
+        CHECK(Strings::serialize(database_load(real_filesystem, installed, lock)) == synced_status);
+        snapshot.pop_back();
+        real_filesystem.write_contents(snapshot_file, snapshot, VCPKG_LINE_INFO);
+        CHECK(Strings::serialize(database_load(real_filesystem, installed, lock)) == synced_status);
+    }
+}
@@ -252,13 +252,206 @@ TEST_CASE ("JSON parse objects", "[json]")
     REQUIRE(val.object(VCPKG_LINE_INFO).size() == 0);
 }
 
-TEST_CASE ("JSON parse full file", "[json]")
+static std::string make_large_object(size_t size)
+{
+    std::string result = "{";
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (i != 0)
+        {
+            result.push_back(',');
+        }
+
+        fmt::format_to(std::back_inserter(result), R"("port-{}": {{"baseline": "1.0.{}", "port-version": 0}})", i, i);
+    }
+
+    result.push_back('}');
+    return result;
+}
+
+static std::vector<std::string> make_large_object_keys(size_t size)
+{
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < size; ++i)
+    {
+        keys.push_back(fmt::format("port-{}", i));
+    }
+
+    return keys;
+}
+
+TEST_CASE ("JSON large objects", "[json]")
 {
-    StringView json =
+    const auto keys = make_large_object_keys(100);
+    auto res = Json::parse_object(make_large_object(100), "test");
+    REQUIRE(res);
+    auto& obj = *res.get();
+    REQUIRE(obj.size() == 100);
+    std::vector<std::string> member_keys;
+    for (auto&& member : obj)
+    {
+        member_keys.push_back(member.first.to_string());
+    }
+
+    CHECK(member_keys == keys);
+    CHECK(obj["port-57"].object(VCPKG_LINE_INFO)["baseline"].string(VCPKG_LINE_INFO) == "1.0.57");
+    CHECK(!obj.contains("port-100"));
+
+    CHECK(obj.remove("port-3"));
+    CHECK(!obj.remove("port-3"));
+    CHECK(!obj.contains("port-3"));
+    CHECK(obj.contains("port-99"));
+    {
+        // Removing entries keeps the others found, with or without an index
+        auto shrinking = obj;
+        for (size_t i = 99; i > 4; --i)
+        {
+            INFO(i);
+            CHECK(shrinking.remove(keys[i]));
+            CHECK(!shrinking.contains(keys[i]));
+            CHECK(shrinking.contains(keys[i - 1]));
+            CHECK(shrinking.contains(keys[0]));
+        }
+
+        CHECK(shrinking.size() == 4);
+    }
+
+    obj.insert("port-3", Json::Value::integer(3));
+    CHECK(obj["port-3"].integer(VCPKG_LINE_INFO) == 3);
+    obj.insert_or_replace("port-3", Json::Value::integer(4));
+    CHECK(obj["port-3"].integer(VCPKG_LINE_INFO) == 4);
+    obj.insert_or_replace("port-100", Json::Value::integer(100));
+    CHECK(obj.size() == 101);
+
+    obj.sort_keys();
+    CHECK((*obj.begin()).first == "port-0");
+    CHECK((*++obj.begin()).first == "port-1");
+    CHECK((*++++obj.begin()).first == "port-10");
+    auto copy = obj;
+    CHECK(copy == obj);
+    CHECK(std::all_of(keys.begin(), keys.end(), [&](const std::string& key) { return copy.contains(key); }));
+
+    auto duplicated = make_large_object(100);
+    duplicated.back() = ',';
+    duplicated.append(R"("port-42": 0})");
+    auto dup_res = Json::parse(duplicated, "test");
+    REQUIRE(!dup_res);
+    REQUIRE_THAT(dup_res.error().data(), Catch::Contains("Duplicated key \"port-42\""));
+}
+
+TEST_CASE ("JSON pull reader", "[json]")
+{
+    {
+        Json::PullReader parser(R"json({"skipped": {"a": [1, {"b": null}], "c": "\u00e9"}, "read": [true, 2, "x"],
+            "streamed": {"one": 1, "two": [2]}})json",
+                                "test");
+        REQUIRE(parser.begin_object());
+        std::string key;
+        REQUIRE(parser.next_member(key));
+        CHECK(key == "skipped");
+        parser.skip_value();
+        REQUIRE(parser.next_member(key));
+        CHECK(key == "read");
+        CHECK(!parser.begin_object());
+        REQUIRE(parser.begin_array());
+        REQUIRE(parser.next_element());
+        CHECK(parser.read_value() == Json::Value::boolean(true));
+        REQUIRE(parser.next_element());
+        parser.skip_value();
+        REQUIRE(parser.next_element());
+        CHECK(parser.read_value() == Json::Value::string("x"));
+        CHECK(!parser.next_element());
+        REQUIRE(parser.next_member(key));
+        CHECK(key == "streamed");
+        REQUIRE(parser.begin_object());
+        REQUIRE(parser.next_member(key));
+        CHECK(key == "one");
+        CHECK(parser.read_value() == Json::Value::integer(1));
+        REQUIRE(parser.next_member(key));
+        CHECK(key == "two");
+        CHECK(parser.read_value().array(VCPKG_LINE_INFO).size() == 1);
+        CHECK(!parser.next_member(key));
+        CHECK(!parser.next_member(key));
+        CHECK(parser.finish());
+    }
+
+    // skipped values are checked like parsed values
+    {
+        Json::PullReader parser(R"json({"skipped": {"a": 1, "a": 2}})json", "test");
+        REQUIRE(parser.begin_object());
+        std::string key;
+        REQUIRE(parser.next_member(key));
+        parser.skip_value();
+        CHECK(!parser.next_member(key));
+        auto finished = parser.finish();
+        REQUIRE(!finished);
+        REQUIRE_THAT(finished.error().data(), Catch::Contains("Duplicated key \"a\""));
+    }
+
+    {
+        Json::PullReader parser(R"json({"a": 1, "a": 2})json", "test");
+        REQUIRE(parser.begin_object());
+        std::string key;
+        REQUIRE(parser.next_member(key));
+        parser.skip_value();
+        CHECK(!parser.next_member(key));
+        REQUIRE(!parser.finish());
+    }
+
+    {
+        Json::PullReader parser(R"json([1, [2, 3,]])json", "test");
+        REQUIRE(parser.begin_array());
+        while (parser.next_element())
+        {
+            parser.skip_value();
+        }
+
+        auto finished = parser.finish();
+        REQUIRE(!finished);
+        REQUIRE_THAT(finished.error().data(), Catch::Contains("Trailing comma"));
+    }
+
+    {
+        Json::PullReader parser("[] []", "test");
+        parser.skip_value();
+        REQUIRE(!parser.finish());
+    }
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("JSON large objects -- benchmarks", "[json][!benchmark]")
+{
+    // about the size of baseline.json
+    const auto text = make_large_object(2500);
+    const auto keys = make_large_object_keys(2500);
+    BENCHMARK("parse") { return Json::parse_object(text, "test"); };
+
+    const auto obj = Json::parse_object(text, "test").value_or_exit(VCPKG_LINE_INFO);
+    BENCHMARK("lookup")
+    {
+        return std::count_if(keys.begin(), keys.end(), [&](const std::string& key) { return obj.contains(key); });
+    };
+
+    BENCHMARK("construct")
+    {
+        Json::Object result;
+        for (auto&& key : keys)
+        {
+            result.insert(key, Json::Value::integer(0));
+        }
+
+        return result;
+    };
+}
+#endif
+
+static constexpr StringLiteral large_json_document =
 #include "large-json-document.json.inc"
-        ;
+    ;
 
-    auto res = Json::parse(json, "test");
+TEST_CASE ("JSON parse full file", "[json]")
+{
+    auto res = Json::parse(large_json_document, "test");
     if (!res)
     {
         std::cerr << res.error() << '\n';
@@ -266,6 +459,17 @@ TEST_CASE ("JSON parse full file", "[json]")
     REQUIRE(res);
 }
 
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("JSON parse full file -- benchmarks", "[json][!benchmark]")
+{
+    BENCHMARK("parse") { return Json::parse(large_json_document, "test"); };
+
+    auto doc = Json::parse(large_json_document, "test").value_or_exit(VCPKG_LINE_INFO).value;
+    BENCHMARK("copy") { return Json::Value(doc); };
+    BENCHMARK("stringify") { return Json::stringify(doc); };
+}
+#endif
+
 TEST_CASE ("JSON track newlines", "[json]")
 {
     auto res = Json::parse("{\n,", "filename");
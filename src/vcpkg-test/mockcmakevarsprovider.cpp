@@ -38,6 +38,19 @@ namespace vcpkg::Test
         return Util::lookup_value(dep_info_vars, spec);
     }
 
+    const PlatformExpression::ContextIdentifiers* MockCMakeVarProvider::get_dep_info_identifiers(
+        const PackageSpec& spec) const
+    {
+        auto vars = Util::lookup_value(dep_info_vars, spec);
+        if (!vars)
+        {
+            return nullptr;
+        }
+
+        auto reduced = PlatformExpression::ContextIdentifiers::reduce(*vars);
+        return &dep_info_identifiers.insert_or_assign(spec, std::move(reduced)).first->second;
+    }
+
     const std::unordered_map<std::string, std::string>* MockCMakeVarProvider::get_tag_vars(
         const PackageSpec& spec) const
     {
@@ -602,3 +602,189 @@ TEST_CASE ("simplify expression", "[platform-expression]")
     CHECK(simplyfy("!(uwp & uwp)") == "!uwp");
     CHECK(simplyfy("!(!uwp & !uwp)") == "uwp");
 }
+
+TEST_CASE ("platform-expression-override-vars", "[platform-expression]")
+{
+    auto m_expr = parse_expr("windows & !uwp & mycustomos");
+    REQUIRE(m_expr);
+    auto& expr = *m_expr.get();
+
+    CHECK(expr.evaluate(
+        {{"VCPKG_CMAKE_SYSTEM_NAME", "Linux"}, {"VCPKG_DEP_INFO_OVERRIDE_VARS", "windows;!uwp;mycustomos"}}));
+    CHECK(expr.evaluate({{"VCPKG_CMAKE_SYSTEM_NAME", ""}, {"VCPKG_DEP_INFO_OVERRIDE_VARS", "mycustomos"}}));
+    CHECK_FALSE(expr.evaluate({{"VCPKG_CMAKE_SYSTEM_NAME", ""}, {"VCPKG_DEP_INFO_OVERRIDE_VARS", "!mycustomos"}}));
+    CHECK_FALSE(expr.evaluate(
+        {{"VCPKG_CMAKE_SYSTEM_NAME", "WindowsStore"}, {"VCPKG_DEP_INFO_OVERRIDE_VARS", "mycustomos"}}));
+    // the first override of an identifier wins
+    CHECK(expr.evaluate(
+        {{"VCPKG_CMAKE_SYSTEM_NAME", ""}, {"VCPKG_DEP_INFO_OVERRIDE_VARS", ";mycustomos;!mycustomos;;windows"}}));
+    CHECK_FALSE(expr.evaluate(
+        {{"VCPKG_CMAKE_SYSTEM_NAME", ""}, {"VCPKG_DEP_INFO_OVERRIDE_VARS", "mycustomos;!windows;windows"}}));
+
+    // native needs Z_VCPKG_IS_NATIVE, unless it is overridden
+    auto m_native = parse_expr("native | x64");
+    REQUIRE(m_native);
+    CHECK(m_native.get()->evaluate({{"VCPKG_DEP_INFO_OVERRIDE_VARS", "native"}}));
+    CHECK_FALSE(m_native.get()->evaluate({{"VCPKG_DEP_INFO_OVERRIDE_VARS", "!native"}}));
+}
+
+TEST_CASE ("platform-expression-context-identifiers", "[platform-expression]")
+{
+    // custom is only defined by overrides
+    const Context contexts[] = {
+        {{"VCPKG_CMAKE_SYSTEM_NAME", ""},
+         {"VCPKG_TARGET_ARCHITECTURE", "x64"},
+         {"Z_VCPKG_IS_NATIVE", "1"},
+         {"VCPKG_DEP_INFO_OVERRIDE_VARS", "!custom"}},
+        {{"VCPKG_CMAKE_SYSTEM_NAME", "WindowsStore"},
+         {"VCPKG_TARGET_ARCHITECTURE", "arm64"},
+         {"VCPKG_LIBRARY_LINKAGE", "static"},
+         {"Z_VCPKG_IS_NATIVE", "0"},
+         {"VCPKG_DEP_INFO_OVERRIDE_VARS", "!custom"}},
+        {{"VCPKG_CMAKE_SYSTEM_NAME", "MinGW"},
+         {"VCPKG_TARGET_ARCHITECTURE", "x86"},
+         {"VCPKG_CRT_LINKAGE", "static"},
+         {"Z_VCPKG_IS_NATIVE", "0"},
+         {"VCPKG_DEP_INFO_OVERRIDE_VARS", "!custom"}},
+        {{"VCPKG_CMAKE_SYSTEM_NAME", "Linux"},
+         {"VCPKG_TARGET_ARCHITECTURE", "arm"},
+         {"VCPKG_LIBRARY_LINKAGE", "static"},
+         {"Z_VCPKG_IS_NATIVE", "1"},
+         {"VCPKG_DEP_INFO_OVERRIDE_VARS", "!custom"}},
+        {{"VCPKG_CMAKE_SYSTEM_NAME", "Darwin"},
+         {"VCPKG_TARGET_ARCHITECTURE", "arm64"},
+         {"VCPKG_XBOX_CONSOLE_TARGET", "scarlett"},
+         {"Z_VCPKG_IS_NATIVE", "1"},
+         {"VCPKG_DEP_INFO_OVERRIDE_VARS", "!custom"}},
+        {{"VCPKG_CMAKE_SYSTEM_NAME", "FreeBSD"},
+         {"VCPKG_TARGET_ARCHITECTURE", "x64"},
+         {"Z_VCPKG_IS_NATIVE", "0"},
+         {"VCPKG_DEP_INFO_OVERRIDE_VARS", "!bsd;linux;custom"}},
+    };
+
+    const bool expected[][std::size(contexts)] = {
+        {true, true, true, false, false, false},
+        {false, true, true, true, true, true},
+        {true, false, false, false, false, false},
+        {true, true, true, false, true, false},
+        {false, true, false, false, false, true},
+        {false, true, false, false, false, true},
+        {true, false, false, true, true, true},
+        {true, false, false, false, true, false},
+    };
+
+    const StringView expressions[] = {
+        "windows",
+        "!(windows & !uwp & !mingw)",
+        "windows & !uwp & !mingw & x64 & native",
+        "(!linux & !osx) | xbox | (!bsd & !linux)",
+        "(static & !native) | (custom & linux)",
+        "(arm64 & !osx) | (!x64 & !x86 & !arm64 & !native) | custom",
+        "native | (linux & !static)",
+        "(x64 & native) | osx",
+    };
+    static_assert(std::size(expressions) == std::size(expected), "each expression needs expected results");
+
+    for (size_t expr_idx = 0; expr_idx < std::size(expressions); ++expr_idx)
+    {
+        auto m_expr = parse_expr(expressions[expr_idx]);
+        REQUIRE(m_expr);
+        auto& expr = *m_expr.get();
+        auto negated = expr;
+        negated.negate();
+        auto simplified = expr;
+        simplified.simplify();
+        for (size_t context_idx = 0; context_idx < std::size(contexts); ++context_idx)
+        {
+            INFO(expressions[expr_idx].to_string() << " in context " << context_idx);
+            const auto identifiers = ContextIdentifiers::reduce(contexts[context_idx]);
+            const bool result = expected[expr_idx][context_idx];
+            CHECK(expr.evaluate(contexts[context_idx]) == result);
+            CHECK(expr.evaluate(identifiers) == result);
+            CHECK(negated.evaluate(identifiers) == !result);
+            CHECK(simplified.evaluate(identifiers) == result);
+        }
+    }
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("platform-expression evaluate -- benchmarks", "[platform-expression][!benchmark]")
+{
+    // platform and supports expressions as they are commonly written in ports, repeated to about the size of the
+    // curated registry
+    const StringView common_expressions[] = {
+        "windows",
+        "!windows",
+        "!uwp",
+        "linux",
+        "osx",
+        "!(windows & static)",
+        "!osx & !ios",
+        "windows & !mingw",
+        "!(uwp | arm)",
+        "x64 | arm64",
+        "(windows & !uwp) | linux | osx",
+        "native",
+        "!android & !emscripten",
+        "!(windows & arm & !arm64ec)",
+        "linux | freebsd | openbsd | netbsd",
+        "!xbox & !uwp & !(windows & arm)",
+    };
+
+    std::vector<Expr> exprs;
+    for (int repeat = 0; repeat < 1000; ++repeat)
+    {
+        for (auto&& text : common_expressions)
+        {
+            exprs.push_back(parse_expr(text).value_or_exit(VCPKG_LINE_INFO));
+        }
+    }
+
+    const Context contexts[] = {
+        {{"VCPKG_CMAKE_SYSTEM_NAME", ""},
+         {"VCPKG_TARGET_ARCHITECTURE", "x64"},
+         {"VCPKG_LIBRARY_LINKAGE", "dynamic"},
+         {"VCPKG_CRT_LINKAGE", "dynamic"},
+         {"Z_VCPKG_IS_NATIVE", "1"}},
+        {{"VCPKG_CMAKE_SYSTEM_NAME", "Linux"},
+         {"VCPKG_TARGET_ARCHITECTURE", "x64"},
+         {"VCPKG_LIBRARY_LINKAGE", "static"},
+         {"VCPKG_CRT_LINKAGE", "dynamic"},
+         {"Z_VCPKG_IS_NATIVE", "1"}},
+        {{"VCPKG_CMAKE_SYSTEM_NAME", "Darwin"},
+         {"VCPKG_TARGET_ARCHITECTURE", "arm64"},
+         {"VCPKG_LIBRARY_LINKAGE", "static"},
+         {"VCPKG_CRT_LINKAGE", "dynamic"},
+         {"Z_VCPKG_IS_NATIVE", "0"}},
+    };
+
+    BENCHMARK("evaluate against cmake variables")
+    {
+        size_t supported = 0;
+        for (auto&& context : contexts)
+        {
+            for (auto&& expr : exprs)
+            {
+                supported += expr.evaluate(context);
+            }
+        }
+
+        return supported;
+    };
+
+    BENCHMARK("evaluate against reduced identifiers")
+    {
+        size_t supported = 0;
+        for (auto&& context : contexts)
+        {
+            const auto identifiers = ContextIdentifiers::reduce(context);
+            for (auto&& expr : exprs)
+            {
+                supported += expr.evaluate(identifiers);
+            }
+        }
+
+        return supported;
+    };
+}
+#endif
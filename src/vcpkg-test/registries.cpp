@@ -1,11 +1,15 @@
 #include <vcpkg-test/util.h>
 
+#include <vcpkg/base/files.h>
 #include <vcpkg/base/jsonreader.h>
 #include <vcpkg/base/strings.h>
+#include <vcpkg/base/util.h>
 
 #include <vcpkg/configuration.h>
 #include <vcpkg/documentation.h>
+#include <vcpkg/paragraphs.h>
 #include <vcpkg/registries-parsing.h>
+#include <vcpkg/sourceparagraph.h>
 
 using namespace vcpkg;
 
@@ -75,6 +79,42 @@ namespace
 
     // test functions which parse string literals, so no concerns about failure
     Json::Value parse_json(StringView sv) { return Json::parse(sv, "test").value(VCPKG_LINE_INFO).value; }
+
+    // Writes a filesystem registry holding `port_count` ports named port-0, port-1, ... whose names are in the baseline.
+    // The manifests of the ports in `broken_ports` are invalid.
+    void write_filesystem_registry(const Path& root, size_t port_count, const std::vector<size_t>& broken_ports)
+    {
+        real_filesystem.remove_all(root, VCPKG_LINE_INFO);
+        Json::Object baseline;
+        for (size_t idx = 0; idx < port_count; ++idx)
+        {
+            const auto name = fmt::format("port-{}", idx);
+            const bool broken = Util::contains(broken_ports, idx);
+            real_filesystem.write_contents_and_dirs(
+                root / "ports" / name / "vcpkg.json",
+                broken ? R"json({"name": 5})json"
+                       : fmt::format(R"json({{"name": "{}", "version": "1.0", "dependencies": ["zlib"]}})json", name),
+                VCPKG_LINE_INFO);
+            real_filesystem.write_contents_and_dirs(
+                root / "versions" / "p-" / (name + ".json"),
+                fmt::format(R"json({{"versions": [{{"version": "1.0", "path": "$/ports/{}"}}]}})json", name),
+                VCPKG_LINE_INFO);
+            Json::Object entry;
+            entry.insert("baseline", "1.0");
+            entry.insert("port-version", Json::Value::integer(0));
+            baseline.insert(name, std::move(entry));
+        }
+
+        Json::Object baseline_doc;
+        baseline_doc.insert("default", std::move(baseline));
+        real_filesystem.write_contents(
+            root / "versions" / "baseline.json", Json::stringify(baseline_doc), VCPKG_LINE_INFO);
+    }
+
+    RegistrySet make_filesystem_registry_set(const Path& root)
+    {
+        return RegistrySet{make_filesystem_registry(real_filesystem, root, "default"), {}};
+    }
 }
 
 TEST_CASE ("registry_set_selects_registry", "[registries]")
@@ -845,3 +885,114 @@ TEST_CASE ("get_all_port_names", "[registries]")
               std::vector<std::string>{"hello", "notpresent", "twoOld", "world"});
     }
 }
+
+TEST_CASE ("try_load_all_registry_ports", "[registries]")
+{
+    auto const root = Test::base_temporary_directory() / "registry-load-all-ports";
+    write_filesystem_registry(root, 40, {7, 31});
+    auto registries = make_filesystem_registry_set(root);
+    auto results = Paragraphs::try_load_all_registry_ports(registries);
+
+    // Results are in the order of the port names no matter which thread loaded them
+    std::vector<std::string> expected_names;
+    for (size_t idx = 0; idx < 40; ++idx)
+    {
+        if (idx != 7 && idx != 31)
+        {
+            expected_names.push_back(fmt::format("port-{}", idx));
+        }
+    }
+
+    Util::sort(expected_names);
+    CHECK(Util::fmap(results.paragraphs, [](const SourceControlFileAndLocation& scfl) {
+              return scfl.source_control_file->core_paragraph->name;
+          }) == expected_names);
+    REQUIRE(results.errors.size() == 2);
+    CHECK(results.errors[0].first == "port-31");
+    CHECK(results.errors[1].first == "port-7");
+}
+
+TEST_CASE ("filesystem registry baseline and versions files", "[registries]")
+{
+    auto const root = Test::base_temporary_directory() / "registry-baseline-versions";
+    write_filesystem_registry(root, 3, {});
+    auto const baseline_path = root / "versions" / "baseline.json";
+    auto const versions_path = root / "versions" / "p-" / "port-1.json";
+    auto get_baseline_version = [&](StringView port_name) {
+        return make_filesystem_registry(real_filesystem, root, "default")->get_baseline_version(port_name);
+    };
+
+    CHECK(get_baseline_version("port-1").value_or_exit(VCPKG_LINE_INFO) == Version{"1.0", 0});
+    CHECK(!get_baseline_version("port-3").value_or_exit(VCPKG_LINE_INFO).has_value());
+    CHECK(make_filesystem_registry(real_filesystem, root, "default")->get_port_entry("port-1").has_value());
+
+    // only the requested baseline is read, but the whole file must be valid
+    real_filesystem.write_contents(
+        baseline_path,
+        R"json({"other": {"port-1": 5}, "default": {"port-1": {"baseline": "2.0", "port-version": 1}}})json",
+        VCPKG_LINE_INFO);
+    CHECK(get_baseline_version("port-1").value_or_exit(VCPKG_LINE_INFO) == Version{"2.0", 1});
+    real_filesystem.write_contents(
+        baseline_path, R"json({"other": {"port-1": [}, "default": {}})json", VCPKG_LINE_INFO);
+    CHECK(!get_baseline_version("port-1").has_value());
+    real_filesystem.write_contents(
+        baseline_path, R"json({"default": {"port-1": {"baseline": "2.0"}, "port-1": 5}})json", VCPKG_LINE_INFO);
+    CHECK(!get_baseline_version("port-1").has_value());
+
+    real_filesystem.write_contents(baseline_path, R"json({"default": []})json", VCPKG_LINE_INFO);
+    auto not_an_object = get_baseline_version("port-1");
+    REQUIRE(!not_an_object.has_value());
+    CHECK_THAT(not_an_object.error().data(), Catch::Contains("$.default: mismatched type: expected a baseline object"));
+
+    real_filesystem.write_contents(baseline_path, R"json({"default": {"port-1": 5}})json", VCPKG_LINE_INFO);
+    auto bad_entry = get_baseline_version("port-1");
+    REQUIRE(!bad_entry.has_value());
+    CHECK_THAT(bad_entry.error().data(), Catch::Contains("$.default.port-1"));
+
+    real_filesystem.write_contents(baseline_path, R"json({"other": {}})json", VCPKG_LINE_INFO);
+    CHECK(!get_baseline_version("port-1").has_value());
+
+    real_filesystem.write_contents(versions_path, R"json({"versions": {}})json", VCPKG_LINE_INFO);
+    auto no_versions = make_filesystem_registry(real_filesystem, root, "default")->get_port_entry("port-1");
+    REQUIRE(!no_versions.has_value());
+    CHECK_THAT(no_versions.error().data(), Catch::Contains("expected a 'versions' array"));
+
+    real_filesystem.write_contents(
+        versions_path, R"json({"versions": [{"version": "1.0", "path": "$/ports/port-1"}, 5]})json", VCPKG_LINE_INFO);
+    auto bad_version = make_filesystem_registry(real_filesystem, root, "default")->get_port_entry("port-1");
+    REQUIRE(!bad_version.has_value());
+    CHECK_THAT(bad_version.error().data(), Catch::Contains("$.versions[1]"));
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING)
+TEST_CASE ("try_load_all_registry_ports -- benchmarks", "[registries][!benchmark]")
+{
+    auto const root = Test::base_temporary_directory() / "registry-load-all-ports-bench";
+    write_filesystem_registry(root, 2000, {});
+
+    // Each run uses a new registry set so that nothing is served from the registries' caches
+    BENCHMARK_ADVANCED("2000 ports")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<RegistrySet> registry_sets;
+        for (int run = 0; run < meter.runs(); ++run)
+        {
+            registry_sets.push_back(make_filesystem_registry_set(root));
+        }
+
+        meter.measure([&](int run) { return Paragraphs::try_load_all_registry_ports(registry_sets[run]); });
+    };
+}
+
+TEST_CASE ("filesystem registry baseline -- benchmarks", "[registries][!benchmark]")
+{
+    auto const root = Test::base_temporary_directory() / "registry-baseline-bench";
+    write_filesystem_registry(root, 2500, {});
+    auto const baseline = real_filesystem.read_contents(root / "versions" / "baseline.json", VCPKG_LINE_INFO);
+
+    BENCHMARK("parse baseline.json as a DOM") { return Json::parse(baseline, "baseline.json"); };
+    BENCHMARK("get_baseline_version")
+    {
+        return make_filesystem_registry(real_filesystem, root, "default")->get_baseline_version("port-42");
+    };
+}
+#endif
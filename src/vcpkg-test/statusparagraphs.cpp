@@ -144,3 +144,43 @@ Status: install ok installed
     auto it = status_db.find_installed({{"ffmpeg", Test::X64_WINDOWS}, "openssl"});
     REQUIRE(it != status_db.end());
 }
+
+TEST_CASE ("find and insert prefer the most recent paragraph", "[statusparagraphs]")
+{
+    std::vector<std::unique_ptr<StatusParagraph>> pghs;
+    pghs.push_back(make_status_pgh("a", "", "", "x64-windows"));
+    pghs.push_back(make_status_pgh("b", "", "", "x64-windows"));
+    pghs.push_back(make_status_feature_pgh("a", "f", "", "x64-windows"));
+    pghs.push_back(make_status_pgh("a", "", "", "x64-linux"));
+    // A stale duplicate of the first paragraph, as can be read from an uncollapsed status database
+    pghs.push_back(make_status_pgh("a", "", "", "x64-windows"));
+    pghs.back()->status = StatusLine{Want::PURGE, InstallState::NOT_INSTALLED};
+    StatusParagraphs status_db(std::move(pghs));
+
+    auto it = status_db.find("a", X64_WINDOWS);
+    REQUIRE(it != status_db.end());
+    CHECK((*it)->status.state == InstallState::NOT_INSTALLED);
+    CHECK(status_db.find_installed({"a", X64_WINDOWS}) == status_db.end());
+    CHECK(status_db.find_installed({{"a", X64_WINDOWS}, "f"}) != status_db.end());
+    CHECK(status_db.find_installed({"a", X64_LINUX}) != status_db.end());
+    CHECK(status_db.find("a", X64_WINDOWS, "core") == it);
+    CHECK(status_db.find("a", X64_WINDOWS, "g") == status_db.end());
+    CHECK(status_db.find("c", X64_WINDOWS) == status_db.end());
+
+    auto all = status_db.find_all("a", X64_WINDOWS);
+    // Every matching paragraph is returned, core paragraphs first
+    REQUIRE(all.size() == 3);
+    CHECK((*all[0])->package.feature.empty());
+    CHECK((*all[1])->package.feature.empty());
+    CHECK((*all[2])->package.feature == "f");
+
+    // Replaces the most recent paragraph in place
+    auto inserted = status_db.insert(make_status_pgh("a", "", "", "x64-windows"));
+    CHECK(inserted == it);
+    CHECK(status_db.is_installed(PackageSpec{"a", X64_WINDOWS}));
+
+    status_db.insert(make_status_pgh("c", "", "", "x64-windows"));
+    REQUIRE(status_db.begin() != status_db.end());
+    CHECK((*status_db.begin())->package.spec.name() == "c");
+    CHECK(status_db.find_installed({"c", X64_WINDOWS}) == status_db.begin());
+}
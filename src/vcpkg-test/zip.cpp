@@ -0,0 +1,330 @@
+#include <vcpkg-test/util.h>
+
+#include <vcpkg/base/deflate.h>
+#include <vcpkg/base/diagnostics.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.process.h>
+#include <vcpkg/base/zip.h>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#endif // ^^^ !_WIN32
+
+#include <random>
+#include <string>
+
+using namespace vcpkg;
+using Test::base_temporary_directory;
+
+namespace
+{
+    Path make_clean_directory(const Filesystem& fs, StringView name)
+    {
+        auto dir = base_temporary_directory() / name;
+        fs.remove_all(dir, VCPKG_LINE_INFO);
+        fs.create_directories(dir, VCPKG_LINE_INFO);
+        return dir;
+    }
+
+    void append_le16(std::string& out, uint32_t value)
+    {
+        out.push_back(static_cast<char>(value & 0xFF));
+        out.push_back(static_cast<char>((value >> 8) & 0xFF));
+    }
+
+    void append_le32(std::string& out, uint32_t value)
+    {
+        append_le16(out, value & 0xFFFF);
+        append_le16(out, value >> 16);
+    }
+
+    // Builds a zip archive containing a single stored entry, as another zip writer might produce.
+    std::string make_single_entry_zip(StringView name, StringView content)
+    {
+        const auto crc = Deflate::crc32(0, content.begin(), content.end());
+        std::string result;
+        append_le32(result, 0x04034b50);
+        append_le16(result, 20);
+        append_le16(result, 0);
+        append_le16(result, 0);
+        append_le32(result, 0);
+        append_le32(result, crc);
+        append_le32(result, static_cast<uint32_t>(content.size()));
+        append_le32(result, static_cast<uint32_t>(content.size()));
+        append_le16(result, static_cast<uint32_t>(name.size()));
+        append_le16(result, 0);
+        result.append(name.data(), name.size());
+        result.append(content.data(), content.size());
+
+        const auto central_directory_offset = static_cast<uint32_t>(result.size());
+        append_le32(result, 0x02014b50);
+        append_le16(result, 20);
+        append_le16(result, 20);
+        append_le16(result, 0);
+        append_le16(result, 0);
+        append_le32(result, 0);
+        append_le32(result, crc);
+        append_le32(result, static_cast<uint32_t>(content.size()));
+        append_le32(result, static_cast<uint32_t>(content.size()));
+        append_le16(result, static_cast<uint32_t>(name.size()));
+        append_le16(result, 0);
+        append_le16(result, 0);
+        append_le16(result, 0);
+        append_le16(result, 0);
+        append_le32(result, 0);
+        append_le32(result, 0);
+        result.append(name.data(), name.size());
+        const auto central_directory_size = static_cast<uint32_t>(result.size()) - central_directory_offset;
+
+        append_le32(result, 0x06054b50);
+        append_le16(result, 0);
+        append_le16(result, 0);
+        append_le16(result, 1);
+        append_le16(result, 1);
+        append_le32(result, central_directory_size);
+        append_le32(result, central_directory_offset);
+        append_le16(result, 0);
+        return result;
+    }
+
+    std::string make_file_contents(std::mt19937& urbg, size_t size)
+    {
+        std::string result;
+        result.reserve(size);
+        while (result.size() < size)
+        {
+            // mix compressible text with random bytes
+            if (urbg() % 4 == 0)
+            {
+                result.push_back(static_cast<char>(urbg()));
+            }
+            else
+            {
+                result.append("#include <vcpkg/base/zip.h>\n", (std::min)(size_t{28}, size - result.size()));
+            }
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE ("zip round trip", "[zip]")
+{
+    auto& fs = real_filesystem;
+    const auto root = make_clean_directory(fs, "zip_round_trip");
+    const auto source = root / "source";
+    std::mt19937 urbg(1234);
+    const auto large_contents = make_file_contents(urbg, 1024 * 1024 + 17);
+    fs.write_contents_and_dirs(source / "include" / "header.h", "#pragma once\n", VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(source / "lib" / "large.a", large_contents, VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(source / "share" / "port" / "empty", "", VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(source / "share" / "port" / ".DS_Store", "excluded", VCPKG_LINE_INFO);
+    fs.write_contents_and_dirs(source / "tools" / "tool", "#!/bin/sh\n", VCPKG_LINE_INFO);
+    fs.create_directories(source / "empty_directory", VCPKG_LINE_INFO);
+    fs.set_executable(console_diagnostic_context, source / "tools" / "tool");
+#if !defined(_WIN32)
+    fs.create_symlink("large.a", source / "lib" / "link.a", VCPKG_LINE_INFO);
+#endif // ^^^ !_WIN32
+
+    const auto archive = root / "archive.zip";
+    FullyBufferedDiagnosticContext compress_context;
+    REQUIRE(Zip::compress_directory(compress_context, fs, source, archive));
+    REQUIRE(compress_context.empty());
+
+    FullyBufferedDiagnosticContext read_context;
+    auto entries = Zip::read_central_directory(read_context, fs, archive).value_or_exit(VCPKG_LINE_INFO);
+    std::vector<std::string> names;
+    for (auto&& entry : entries)
+    {
+        names.push_back(entry.name);
+        if (entry.name == "lib/large.a")
+        {
+            CHECK(entry.kind == Zip::EntryKind::RegularFile);
+            CHECK(entry.uncompressed_size == large_contents.size());
+            CHECK(entry.compressed_size < entry.uncompressed_size);
+            CHECK(entry.crc32 ==
+                  Deflate::crc32(0, large_contents.data(), large_contents.data() + large_contents.size()));
+        }
+        else if (entry.name == "empty_directory")
+        {
+            CHECK(entry.kind == Zip::EntryKind::Directory);
+        }
+    }
+
+    std::vector<std::string> expected_names{"empty_directory",
+                                            "include",
+                                            "include/header.h",
+                                            "lib",
+                                            "lib/large.a",
+#if !defined(_WIN32)
+                                            "lib/link.a",
+#endif // ^^^ !_WIN32
+                                            "share",
+                                            "share/port",
+                                            "share/port/empty",
+                                            "tools",
+                                            "tools/tool"};
+    CHECK(names == expected_names);
+
+    const auto destination = root / "destination";
+    fs.create_directories(destination, VCPKG_LINE_INFO);
+    FullyBufferedDiagnosticContext extract_context;
+    REQUIRE(Zip::extract(extract_context, fs, archive, destination, 4));
+    REQUIRE(extract_context.empty());
+
+    CHECK(fs.read_contents(destination / "include" / "header.h", VCPKG_LINE_INFO) == "#pragma once\n");
+    CHECK(fs.read_contents(destination / "lib" / "large.a", VCPKG_LINE_INFO) == large_contents);
+    CHECK(fs.read_contents(destination / "share" / "port" / "empty", VCPKG_LINE_INFO).empty());
+    CHECK(!fs.exists(destination / "share" / "port" / ".DS_Store", VCPKG_LINE_INFO));
+    CHECK(fs.is_directory(destination / "empty_directory"));
+#if !defined(_WIN32)
+    CHECK(fs.symlink_status(destination / "lib" / "link.a", VCPKG_LINE_INFO) == FileType::symlink);
+    CHECK(fs.read_contents(destination / "lib" / "link.a", VCPKG_LINE_INFO) == large_contents);
+    struct stat s;
+    REQUIRE(::stat((destination / "tools" / "tool").c_str(), &s) == 0);
+    CHECK((s.st_mode & 0100) != 0);
+    REQUIRE(::stat((destination / "include" / "header.h").c_str(), &s) == 0);
+    CHECK((s.st_mode & 0100) == 0);
+#endif // ^^^ !_WIN32
+
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("zip extract reads archives from other writers", "[zip]")
+{
+    auto& fs = real_filesystem;
+    const auto root = make_clean_directory(fs, "zip_other_writers");
+    const auto archive = root / "archive.zip";
+    fs.write_contents(archive, make_single_entry_zip("a/b/c.txt", "hello"), VCPKG_LINE_INFO);
+    const auto destination = root / "destination";
+    fs.create_directories(destination, VCPKG_LINE_INFO);
+    FullyBufferedDiagnosticContext context;
+    REQUIRE(Zip::extract(context, fs, archive, destination));
+    CHECK(fs.read_contents(destination / "a" / "b" / "c.txt", VCPKG_LINE_INFO) == "hello");
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("zip extract rejects entries outside the destination", "[zip]")
+{
+    auto& fs = real_filesystem;
+    const auto root = make_clean_directory(fs, "zip_bad_names");
+    const auto archive = root / "archive.zip";
+    for (StringView bad_name : {"../escape.txt", "/absolute.txt", "a/../../escape.txt", "a//b.txt", "./a.txt"})
+    {
+        INFO(bad_name.to_string());
+        fs.write_contents(archive, make_single_entry_zip(bad_name, "evil"), VCPKG_LINE_INFO);
+        FullyBufferedDiagnosticContext context;
+        CHECK(!Zip::read_central_directory(context, fs, archive).has_value());
+        CHECK(!Zip::extract(context, fs, archive, root / "destination"));
+        CHECK(!context.empty());
+    }
+
+    CHECK(!fs.exists(root / "escape.txt", VCPKG_LINE_INFO));
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
+
+TEST_CASE ("zip extract rejects corrupt archives", "[zip]")
+{
+    auto& fs = real_filesystem;
+    const auto root = make_clean_directory(fs, "zip_corrupt");
+    const auto archive = root / "archive.zip";
+    const auto good = make_single_entry_zip("file.txt", "some file contents");
+    const auto destination = root / "destination";
+    fs.create_directories(destination, VCPKG_LINE_INFO);
+
+    // not a zip at all
+    fs.write_contents(archive, "this is not a zip file", VCPKG_LINE_INFO);
+    {
+        FullyBufferedDiagnosticContext context;
+        CHECK(!Zip::extract(context, fs, archive, destination));
+        CHECK(StringView{context.to_string()}.contains("corrupt"));
+    }
+
+    // truncated
+    fs.write_contents(archive, StringView{good}.substr(0, good.size() - 5), VCPKG_LINE_INFO);
+    {
+        FullyBufferedDiagnosticContext context;
+        CHECK(!Zip::extract(context, fs, archive, destination));
+    }
+
+    // damaged data fails the checksum
+    auto damaged = good;
+    damaged[30 + 8 + 3] ^= 0x20;
+    fs.write_contents(archive, damaged, VCPKG_LINE_INFO);
+    {
+        FullyBufferedDiagnosticContext context;
+        CHECK(!Zip::extract(context, fs, archive, destination));
+        CHECK(StringView{context.to_string()}.contains("file.txt"));
+    }
+
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
+
+#if defined(CATCH_CONFIG_ENABLE_BENCHMARKING) && !defined(_WIN32)
+static void create_package_tree(const Filesystem& fs, const Path& root, size_t file_count)
+{
+    std::mt19937 urbg(static_cast<std::mt19937::result_type>(file_count));
+    for (size_t i = 0; i < file_count; ++i)
+    {
+        auto file = root / fmt::format("dir{}/sub{}/file{}.txt", i % 7, i % 3, i);
+        fs.write_contents_and_dirs(file, make_file_contents(urbg, (urbg() % 4096) * (i % 5 + 1)), VCPKG_LINE_INFO);
+    }
+}
+
+TEST_CASE ("zip -- benchmark against zip and unzip", "[.][zip][!benchmark]")
+{
+    auto& fs = real_filesystem;
+    const auto root = make_clean_directory(fs, "zip_benchmark");
+    const auto source = root / "source";
+    create_package_tree(fs, source, 2000);
+    const auto archive = root / "archive.zip";
+    const auto destination = root / "destination";
+
+    auto run_tool = [&](Command cmd, const Path& working_directory) {
+        RedirectedProcessLaunchSettings settings;
+        settings.working_directory = working_directory;
+        auto maybe_output = cmd_execute_and_capture_output(console_diagnostic_context, cmd, settings);
+        REQUIRE(check_zero_exit_code(console_diagnostic_context, cmd, maybe_output));
+    };
+
+    BENCHMARK_ADVANCED("compress: built in")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&] {
+            fs.remove(archive, VCPKG_LINE_INFO);
+            return Zip::compress_directory(console_diagnostic_context, fs, source, archive);
+        });
+    };
+
+    BENCHMARK_ADVANCED("compress: zip -r")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&] {
+            fs.remove(archive, VCPKG_LINE_INFO);
+            run_tool(Command{"zip"}.string_arg("--quiet").string_arg("-y").string_arg("-r").string_arg(archive).raw_arg(
+                         "*"),
+                     source);
+        });
+    };
+
+    BENCHMARK_ADVANCED("extract: built in")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&] {
+            fs.remove_all(destination, VCPKG_LINE_INFO);
+            fs.create_directories(destination, VCPKG_LINE_INFO);
+            return Zip::extract(console_diagnostic_context, fs, archive, destination);
+        });
+    };
+
+    BENCHMARK_ADVANCED("extract: unzip")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&] {
+            fs.remove_all(destination, VCPKG_LINE_INFO);
+            fs.create_directories(destination, VCPKG_LINE_INFO);
+            run_tool(Command{"unzip"}.string_arg("-qq").string_arg(archive).string_arg("-d" + destination.native()),
+                     root);
+        });
+    };
+
+    fs.remove_all(root, VCPKG_LINE_INFO);
+}
+#endif // ^^^ CATCH_CONFIG_ENABLE_BENCHMARKING && !_WIN32
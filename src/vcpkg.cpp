@@ -16,6 +16,7 @@
 
 #include <vcpkg/bundlesettings.h>
 #include <vcpkg/cgroup-parser.h>
+#include <vcpkg/cmakevars.h>
 #include <vcpkg/commands.h>
 #include <vcpkg/commands.version.h>
 #include <vcpkg/metrics.h>
@@ -171,6 +172,7 @@ namespace vcpkg::Checks
         const auto elapsed_us_inner = g_total_time.microseconds();
         bool debugging = Debug::g_debugging;
 
+        CMakeVars::save_cmake_vars_caches();
         get_global_metrics_collector().track_elapsed_us(elapsed_us_inner);
         Debug::g_debugging = false;
         flush_global_metrics(real_filesystem);
@@ -7,6 +7,7 @@
 #include <vcpkg/base/system.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
+#include <vcpkg/base/zip.h>
 
 #include <vcpkg/archives.h>
 #include <vcpkg/tools.h>
@@ -43,6 +44,30 @@ namespace
     }
 
 #if defined(_WIN32)
+    bool directory_last_write_time(DiagnosticContext& context, const Filesystem& fs, const Path& dir)
+    {
+        auto now = fs.file_time_now();
+        auto maybe_paths = fs.try_get_files_recursive(context, dir);
+        if (auto paths = maybe_paths.get())
+        {
+            bool all_success = true;
+            for (auto&& path : *paths)
+            {
+                if (!fs.last_write_time(context, path, now))
+                {
+                    all_success = false;
+                }
+            }
+
+            if (all_success)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     bool win32_extract_nupkg(DiagnosticContext& context,
                              const Filesystem& fs,
                              const ToolCache& tools,
@@ -344,18 +369,13 @@ namespace vcpkg
         auto output = cmd_execute_and_capture_output(context, seven_zip_command, settings);
         return check_zero_exit_code(context, seven_zip_command, output) != nullptr;
 #else
-        RedirectedProcessLaunchSettings settings;
-        settings.working_directory = source;
-        Command zip_command{"zip"};
-        zip_command.string_arg("--quiet")
-            .string_arg("-y")
-            .string_arg("-r")
-            .string_arg(destination)
-            .raw_arg("*")
-            .string_arg("--exclude")
-            .string_arg(FileDotDsStore);
-        auto output = cmd_execute_and_capture_output(context, zip_command, settings);
-        return check_zero_exit_code(context, zip_command, output) != nullptr;
+        if (Zip::compress_directory(context, fs, source, destination))
+        {
+            return true;
+        }
+
+        fs.remove(destination, IgnoreErrors{});
+        return false;
 #endif
     }
 
@@ -378,22 +398,22 @@ namespace vcpkg
 #endif
     }
 
-    Command ZipTool::decompress_zip_archive_cmd(const Path& dst, const Path& archive_path) const
+    bool ZipTool::decompress_zip_archive(DiagnosticContext& context,
+                                         const Filesystem& fs,
+                                         const Path& dst,
+                                         const Path& archive_path,
+                                         size_t max_concurrency) const
     {
-        Command cmd;
 #if defined(_WIN32)
-        cmd.string_arg(seven_zip.value_or_exit(VCPKG_LINE_INFO))
-            .string_arg("x")
-            .string_arg(archive_path)
-            .string_arg("-o" + dst.native())
-            .string_arg("-y");
+        Command cmd{seven_zip.value_or_exit(VCPKG_LINE_INFO)};
+        cmd.string_arg("x").string_arg(archive_path).string_arg("-o" + dst.native()).string_arg("-y");
+        auto maybe_output = cmd_execute_and_capture_output(context, cmd);
+        // On windows the ziptool does restore file times, we don't want that because this breaks file
+        // time based change detection.
+        (void)max_concurrency;
+        return check_zero_exit_code(context, cmd, maybe_output) && directory_last_write_time(context, fs, dst);
 #else
-        cmd.string_arg("unzip")
-            .string_arg("-DD")
-            .string_arg("-qq")
-            .string_arg(archive_path)
-            .string_arg("-d" + dst.native());
+        return Zip::extract(context, fs, archive_path, dst, max_concurrency);
 #endif
-        return cmd;
     }
 }
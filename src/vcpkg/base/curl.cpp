@@ -1,6 +1,8 @@
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/curl.h>
 
+#include <algorithm>
+
 #ifdef VCPKG_LIBCURL_DLSYM
 #include <dlfcn.h>
 
@@ -20,6 +22,11 @@ decltype(&curl_multi_remove_handle) vcpkg_curl_multi_remove_handle;
 decltype(&curl_multi_strerror) vcpkg_curl_multi_strerror;
 decltype(&curl_multi_perform) vcpkg_curl_multi_perform;
 decltype(&curl_multi_wait) vcpkg_curl_multi_poll; // or _wait, if _poll is not present
+decltype(&curl_multi_setopt) vcpkg_curl_multi_setopt;
+
+decltype(&curl_share_cleanup) vcpkg_curl_share_cleanup;
+decltype(&curl_share_init) vcpkg_curl_share_init;
+decltype(&curl_share_setopt) vcpkg_curl_share_setopt;
 
 decltype(&curl_slist_append) vcpkg_curl_slist_append;
 decltype(&curl_slist_free_all) vcpkg_curl_slist_free_all;
@@ -89,6 +96,12 @@ void vcpkg_curl_global_init(long flags)
         load_symbol(vcpkg_curl_multi_poll, handle, "curl_multi_wait");
     }
 
+    load_symbol(vcpkg_curl_multi_setopt, handle, "curl_multi_setopt");
+
+    load_symbol(vcpkg_curl_share_cleanup, handle, "curl_share_cleanup");
+    load_symbol(vcpkg_curl_share_init, handle, "curl_share_init");
+    load_symbol(vcpkg_curl_share_setopt, handle, "curl_share_setopt");
+
     load_symbol(vcpkg_curl_slist_append, handle, "curl_slist_append");
     load_symbol(vcpkg_curl_slist_free_all, handle, "curl_slist_free_all");
 
@@ -164,6 +177,17 @@ namespace vcpkg
             Checks::unreachable(VCPKG_LINE_INFO);
         }
     }
+    void CurlMultiHandle::remove_easy_handle(CurlEasyHandle& easy_handle)
+    {
+        auto* handle = easy_handle.get();
+        auto it = std::find(m_easy_handles.begin(), m_easy_handles.end(), handle);
+        if (it == m_easy_handles.end() || vcpkg_curl_multi_remove_handle(this->get(), handle) != CURLM_OK)
+        {
+            Checks::unreachable(VCPKG_LINE_INFO);
+        }
+
+        m_easy_handles.erase(it);
+    }
     CURLM* CurlMultiHandle::get()
     {
         if (!m_ptr)
@@ -177,6 +201,30 @@ namespace vcpkg
         return m_ptr;
     }
 
+    CurlShareHandle::CurlShareHandle() : m_ptr(vcpkg_curl_share_init())
+    {
+        if (!m_ptr)
+        {
+            Checks::unreachable(VCPKG_LINE_INFO);
+        }
+
+        vcpkg_curl_share_setopt(m_ptr, CURLSHOPT_LOCKFUNC, &CurlShareHandle::lock);
+        vcpkg_curl_share_setopt(m_ptr, CURLSHOPT_UNLOCKFUNC, &CurlShareHandle::unlock);
+        vcpkg_curl_share_setopt(m_ptr, CURLSHOPT_USERDATA, static_cast<void*>(this));
+        vcpkg_curl_share_setopt(m_ptr, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        vcpkg_curl_share_setopt(m_ptr, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+    CurlShareHandle::~CurlShareHandle() { vcpkg_curl_share_cleanup(m_ptr); }
+    CURLSH* CurlShareHandle::get() { return m_ptr; }
+    void CurlShareHandle::lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+    {
+        static_cast<CurlShareHandle*>(userptr)->m_mutexes[data].lock();
+    }
+    void CurlShareHandle::unlock(CURL*, curl_lock_data data, void* userptr)
+    {
+        static_cast<CurlShareHandle*>(userptr)->m_mutexes[data].unlock();
+    }
+
     CurlHeaders::CurlHeaders(View<std::string> headers)
     {
         for (const auto& header : headers)
@@ -209,4 +257,21 @@ namespace vcpkg
         swap(m_headers, other.m_headers);
     }
     curl_slist* CurlHeaders::get() const { return m_headers; }
+
+    bool is_transient_response_code(StringView raw_url, long response_code)
+    {
+        return (raw_url.starts_with("ftp://") && response_code >= 400 && response_code < 500) ||
+               (response_code == 429 || response_code == 408 || response_code == 500 || response_code == 502 ||
+                response_code == 503 || response_code == 504);
+    }
+
+    bool should_retry_transfer(StringView raw_url, CURLcode curl_code, long response_code)
+    {
+        if (curl_code == CURLE_OPERATION_TIMEDOUT)
+        {
+            return true;
+        }
+
+        return curl_code == CURLE_OK && is_transient_response_code(raw_url, response_code);
+    }
 }
@@ -0,0 +1,1557 @@
+#include <vcpkg/base/checks.h>
+#include <vcpkg/base/deflate.h>
+#include <vcpkg/base/optional.h>
+
+#include <string.h>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace
+{
+    using namespace vcpkg;
+    using namespace vcpkg::Deflate;
+
+    using uchar = unsigned char;
+
+    constexpr std::array<std::array<uint32_t, 256>, 8> make_crc32_tables() noexcept
+    {
+        std::array<std::array<uint32_t, 256>, 8> result{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+            {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+
+            result[0][i] = c;
+        }
+
+        for (size_t table = 1; table < result.size(); ++table)
+        {
+            for (size_t i = 0; i < 256; ++i)
+            {
+                const auto previous = result[table - 1][i];
+                result[table][i] = (previous >> 8) ^ result[0][previous & 0xFF];
+            }
+        }
+
+        return result;
+    }
+
+    constexpr auto CRC32_TABLES = make_crc32_tables();
+
+    uint32_t load_le32(const uchar* p) noexcept
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    // DEFLATE format constants; see RFC 1951 section 3.2.5
+    constexpr size_t WINDOW_SIZE = 32768;
+    constexpr size_t WINDOW_MASK = WINDOW_SIZE - 1;
+    constexpr unsigned MIN_MATCH = 3;
+    constexpr unsigned MAX_MATCH = 258;
+    constexpr unsigned MIN_LOOKAHEAD = MAX_MATCH + MIN_MATCH + 1;
+    constexpr size_t MAX_DISTANCE = WINDOW_SIZE - MIN_LOOKAHEAD;
+    constexpr size_t LITERAL_LENGTH_CODES = 286;
+    constexpr size_t DISTANCE_CODES = 30;
+    constexpr size_t CODE_LENGTH_CODES = 19;
+    constexpr int MAX_BITS = 15;
+    constexpr int MAX_CODE_LENGTH_BITS = 7;
+    constexpr unsigned END_OF_BLOCK = 256;
+
+    constexpr uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                          31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    constexpr uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    constexpr uint16_t DISTANCE_BASE[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,
+                                            33,  49,  65,  97,  129, 193,  257,  385,  513,  769,
+                                            1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    constexpr uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    constexpr uint8_t CODE_LENGTH_ORDER[CODE_LENGTH_CODES] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    struct CodeTables
+    {
+        // length - MIN_MATCH -> length code
+        uint8_t length_code[256];
+        // distance - 1 -> distance code, for distances up to 256; then (distance - 1) >> 7 offset by 256
+        uint8_t distance_code[512];
+        uint8_t fixed_literal_lengths[288];
+        uint8_t fixed_distance_lengths[DISTANCE_CODES];
+    };
+
+    constexpr CodeTables make_code_tables() noexcept
+    {
+        CodeTables result{};
+        for (uint8_t code = 0; code < 28; ++code)
+        {
+            for (unsigned n = 0; n < (1u << LENGTH_EXTRA[code]); ++n)
+            {
+                result.length_code[LENGTH_BASE[code] - MIN_MATCH + n] = code;
+            }
+        }
+
+        // 258 has its own code even though it would be representable with code 27
+        result.length_code[255] = 28;
+
+        for (uint8_t code = 0; code < DISTANCE_CODES; ++code)
+        {
+            for (unsigned n = 0; n < (1u << DISTANCE_EXTRA[code]); ++n)
+            {
+                const unsigned distance_minus_one = DISTANCE_BASE[code] - 1u + n;
+                if (distance_minus_one < 256)
+                {
+                    result.distance_code[distance_minus_one] = code;
+                }
+                else
+                {
+                    result.distance_code[256 + (distance_minus_one >> 7)] = code;
+                }
+            }
+        }
+
+        for (size_t n = 0; n < 288; ++n)
+        {
+            result.fixed_literal_lengths[n] = n < 144 ? 8 : n < 256 ? 9 : n < 280 ? 7 : 8;
+        }
+
+        for (auto& length : result.fixed_distance_lengths)
+        {
+            length = 5;
+        }
+
+        return result;
+    }
+
+    constexpr CodeTables CODE_TABLES = make_code_tables();
+
+    unsigned distance_code_for(unsigned distance) noexcept
+    {
+        const unsigned distance_minus_one = distance - 1;
+        return distance_minus_one < 256 ? CODE_TABLES.distance_code[distance_minus_one]
+                                        : CODE_TABLES.distance_code[256 + (distance_minus_one >> 7)];
+    }
+
+    unsigned reverse_bits(unsigned code, int length) noexcept
+    {
+        unsigned result = 0;
+        for (int i = 0; i < length; ++i)
+        {
+            result = (result << 1) | (code & 1);
+            code >>= 1;
+        }
+
+        return result;
+    }
+
+    // Computes canonical Huffman codes (RFC 1951 section 3.2.2) from `lengths`, stored bit reversed as DEFLATE
+    // transmits them least significant bit first.
+    void make_codes(const uint8_t* lengths, size_t count, uint16_t* codes) noexcept
+    {
+        uint16_t length_counts[MAX_BITS + 1] = {};
+        for (size_t n = 0; n < count; ++n)
+        {
+            ++length_counts[lengths[n]];
+        }
+
+        length_counts[0] = 0;
+        uint16_t next_code[MAX_BITS + 1] = {};
+        unsigned code = 0;
+        for (int bits = 1; bits <= MAX_BITS; ++bits)
+        {
+            code = (code + length_counts[bits - 1]) << 1;
+            next_code[bits] = static_cast<uint16_t>(code);
+        }
+
+        for (size_t n = 0; n < count; ++n)
+        {
+            const auto length = lengths[n];
+            if (length != 0)
+            {
+                codes[n] = static_cast<uint16_t>(reverse_bits(next_code[length]++, length));
+            }
+            else
+            {
+                codes[n] = 0;
+            }
+        }
+    }
+
+    // Computes length limited Huffman code lengths for `freqs`.
+    void make_code_lengths(const uint32_t* freqs, size_t count, int max_bits, uint8_t* lengths)
+    {
+        std::fill(lengths, lengths + count, uint8_t{0});
+        std::vector<std::pair<uint32_t, uint16_t>> leaves;
+        for (size_t n = 0; n < count; ++n)
+        {
+            if (freqs[n] != 0)
+            {
+                leaves.emplace_back(freqs[n], static_cast<uint16_t>(n));
+            }
+        }
+
+        if (leaves.size() < 2)
+        {
+            // A Huffman code needs at least 2 symbols to be complete; some decoders reject incomplete codes.
+            size_t used = leaves.empty() ? 0 : leaves[0].second;
+            lengths[used] = 1;
+            lengths[used == 0 ? 1 : 0] = 1;
+            return;
+        }
+
+        std::sort(leaves.begin(), leaves.end());
+
+        // Two-queue Huffman construction: the leaves are sorted, and internal nodes are created in nondecreasing
+        // frequency order, so the two smallest nodes are always at the front of one of the queues.
+        const size_t leaf_count = leaves.size();
+        std::vector<uint32_t> node_freqs(2 * leaf_count - 1);
+        std::vector<size_t> parents(2 * leaf_count - 1);
+        for (size_t n = 0; n < leaf_count; ++n)
+        {
+            node_freqs[n] = leaves[n].first;
+        }
+
+        size_t next_leaf = 0;
+        size_t next_internal = leaf_count;
+        size_t next_node = leaf_count;
+        auto pick_smallest = [&]() {
+            if (next_leaf < leaf_count &&
+                (next_internal >= next_node || node_freqs[next_leaf] <= node_freqs[next_internal]))
+            {
+                return next_leaf++;
+            }
+
+            return next_internal++;
+        };
+
+        while (next_node < node_freqs.size())
+        {
+            const auto a = pick_smallest();
+            const auto b = pick_smallest();
+            node_freqs[next_node] = node_freqs[a] + node_freqs[b];
+            parents[a] = next_node;
+            parents[b] = next_node;
+            ++next_node;
+        }
+
+        // parents always have larger indices than their children, so walking down from the root visits each
+        // node's parent before the node
+        std::vector<int> depths(node_freqs.size());
+        depths.back() = 0;
+        int length_counts[MAX_BITS + 2] = {};
+        for (size_t n = node_freqs.size() - 1; n-- > 0;)
+        {
+            depths[n] = depths[parents[n]] + 1;
+            if (n < leaf_count)
+            {
+                ++length_counts[(std::min)(depths[n], max_bits)];
+            }
+        }
+
+        // Clamping to max_bits may have made the code over-subscribed; restore the Kraft equality
+        // sum(2^(max_bits - length)) == 2^max_bits by pushing leaves deeper, then filling any resulting gap by
+        // pulling leaves back up.
+        const long long kraft_target = 1ll << max_bits;
+        long long kraft = 0;
+        for (int bits = 1; bits <= max_bits; ++bits)
+        {
+            kraft += static_cast<long long>(length_counts[bits]) << (max_bits - bits);
+        }
+
+        while (kraft > kraft_target)
+        {
+            int bits = max_bits - 1;
+            while (length_counts[bits] == 0)
+            {
+                --bits;
+            }
+
+            --length_counts[bits];
+            ++length_counts[bits + 1];
+            kraft -= 1ll << (max_bits - bits - 1);
+        }
+
+        while (kraft < kraft_target)
+        {
+            int bits = max_bits;
+            while (length_counts[bits] == 0 || (1ll << (max_bits - bits)) > kraft_target - kraft)
+            {
+                --bits;
+            }
+
+            --length_counts[bits];
+            ++length_counts[bits - 1];
+            kraft += 1ll << (max_bits - bits);
+        }
+
+        // assign the longest lengths to the least frequent symbols
+        size_t leaf = 0;
+        for (int bits = max_bits; bits > 0; --bits)
+        {
+            for (int n = 0; n < length_counts[bits]; ++n)
+            {
+                lengths[leaves[leaf++].second] = static_cast<uint8_t>(bits);
+            }
+        }
+    }
+
+    struct BitWriter
+    {
+        explicit BitWriter(std::string& out) : out(out) { }
+
+        void write(uint64_t value, int bits)
+        {
+            m_buffer |= value << m_count;
+            m_count += bits;
+            if (m_count >= 32)
+            {
+                char bytes[4];
+                for (auto& byte : bytes)
+                {
+                    byte = static_cast<char>(m_buffer & 0xFF);
+                    m_buffer >>= 8;
+                }
+
+                out.append(bytes, 4);
+                m_count -= 32;
+            }
+        }
+
+        // Writes out any buffered bits, padding with zeroes to a byte boundary.
+        void align()
+        {
+            while (m_count > 0)
+            {
+                out.push_back(static_cast<char>(m_buffer & 0xFF));
+                m_buffer >>= 8;
+                m_count = (std::max)(m_count - 8, 0);
+            }
+
+            m_buffer = 0;
+        }
+
+        std::string& out;
+
+        uint64_t m_buffer = 0;
+        int m_count = 0;
+    };
+}
+
+namespace vcpkg::Deflate
+{
+    uint32_t crc32(uint32_t crc, const void* first, const void* last) noexcept
+    {
+        auto p = static_cast<const uchar*>(first);
+        const auto end = static_cast<const uchar*>(last);
+        crc = ~crc;
+        while (end - p >= 8)
+        {
+            const uint32_t one = load_le32(p) ^ crc;
+            const uint32_t two = load_le32(p + 4);
+            crc = CRC32_TABLES[7][one & 0xFF] ^ CRC32_TABLES[6][(one >> 8) & 0xFF] ^
+                  CRC32_TABLES[5][(one >> 16) & 0xFF] ^ CRC32_TABLES[4][one >> 24] ^ CRC32_TABLES[3][two & 0xFF] ^
+                  CRC32_TABLES[2][(two >> 8) & 0xFF] ^ CRC32_TABLES[1][(two >> 16) & 0xFF] ^
+                  CRC32_TABLES[0][two >> 24];
+            p += 8;
+        }
+
+        for (; p != end; ++p)
+        {
+            crc = CRC32_TABLES[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+        }
+
+        return ~crc;
+    }
+
+    uint32_t adler32(uint32_t adler, const void* first, const void* last) noexcept
+    {
+        // the largest n such that 255n(n+1)/2 + (n+1)(65521-1) <= 2^32-1; see zlib
+        constexpr size_t NMAX = 5552;
+        constexpr uint32_t BASE = 65521;
+        auto p = static_cast<const uchar*>(first);
+        const auto end = static_cast<const uchar*>(last);
+        uint32_t a = adler & 0xFFFF;
+        uint32_t b = adler >> 16;
+        while (p != end)
+        {
+            const auto chunk_end = p + (std::min)(static_cast<size_t>(end - p), NMAX);
+            for (; p != chunk_end; ++p)
+            {
+                a += *p;
+                b += a;
+            }
+
+            a %= BASE;
+            b %= BASE;
+        }
+
+        return (b << 16) | a;
+    }
+
+    // The compressor follows the structure of zlib's "deflate_slow" strategy: LZ77 with hash chains and lazy match
+    // evaluation, emitting each block with whichever of stored, fixed, or dynamic Huffman coding is smallest.
+    struct CompressorState
+    {
+        static constexpr unsigned HASH_BITS = 15;
+        static constexpr size_t HASH_SIZE = size_t{1} << HASH_BITS;
+        static constexpr size_t SYMBOL_BUFFER_SIZE = 16384;
+        // tuning parameters equivalent to zlib's level 6
+        static constexpr unsigned GOOD_LENGTH = 8;
+        static constexpr unsigned MAX_LAZY = 16;
+        static constexpr unsigned NICE_LENGTH = 128;
+        static constexpr unsigned MAX_CHAIN = 128;
+        static constexpr long TOO_FAR = 4096;
+
+        CompressorState() : window(2 * WINDOW_SIZE + MAX_MATCH), head(HASH_SIZE, -1), prev(WINDOW_SIZE, -1)
+        {
+            symbol_lengths.reserve(SYMBOL_BUFFER_SIZE);
+            symbol_distances.reserve(SYMBOL_BUFFER_SIZE);
+            window_end = 0;
+            window_slid = false;
+            clear();
+        }
+
+        void clear() noexcept
+        {
+            if (window_slid || window_end > HASH_SIZE / 4)
+            {
+                std::fill(head.begin(), head.end(), -1);
+                std::fill(prev.begin(), prev.end(), -1);
+            }
+            else
+            {
+                // Only positions before window_end can have been inserted, and their bytes are still in the window,
+                // so the touched hash chains can be found again. This keeps reuse for many small inputs cheap.
+                for (size_t position = 0; position < window_end; ++position)
+                {
+                    head[hash_at(static_cast<long>(position))] = -1;
+                }
+
+                std::fill(prev.begin(), prev.begin() + static_cast<std::ptrdiff_t>(window_end), -1);
+            }
+
+            window_end = 0;
+            window_slid = false;
+            strstart = 0;
+            block_start = 0;
+            lookahead = 0;
+            match_start = 0;
+            match_length = MIN_MATCH - 1;
+            prev_length = MIN_MATCH - 1;
+            match_available = false;
+            finished = false;
+            bit_buffer = 0;
+            bit_count = 0;
+            reset_block();
+        }
+
+        void reset_block() noexcept
+        {
+            std::fill(std::begin(literal_freqs), std::end(literal_freqs), 0u);
+            std::fill(std::begin(distance_freqs), std::end(distance_freqs), 0u);
+            symbol_lengths.clear();
+            symbol_distances.clear();
+        }
+
+        uint32_t hash_at(long position) const noexcept
+        {
+            const uchar* p = window.data() + position;
+            const uint32_t value =
+                static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16);
+            return (value * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        // Inserts the string at `position` into the hash chains, returning the previous head of its chain.
+        long insert_string(long position) noexcept
+        {
+            auto& chain_head = head[hash_at(position)];
+            const long previous = chain_head;
+            prev[static_cast<size_t>(position) & WINDOW_MASK] = static_cast<int32_t>(previous);
+            chain_head = static_cast<int32_t>(position);
+            return previous;
+        }
+
+        unsigned longest_match(long current_match) noexcept
+        {
+            unsigned chain_length = MAX_CHAIN;
+            const uchar* const scan = window.data() + strstart;
+            unsigned best_length = prev_length;
+            unsigned nice_length = (std::min)(NICE_LENGTH, lookahead);
+            const unsigned max_length = (std::min)(MAX_MATCH, lookahead);
+            const long limit = strstart > static_cast<long>(MAX_DISTANCE) ? strstart - static_cast<long>(MAX_DISTANCE)
+                                                                         : -1;
+            if (prev_length >= GOOD_LENGTH)
+            {
+                chain_length >>= 2;
+            }
+
+            long found_start = match_start;
+            do
+            {
+                const uchar* const match = window.data() + current_match;
+                if (match[best_length] != scan[best_length] || match[best_length - 1] != scan[best_length - 1] ||
+                    match[0] != scan[0] || match[1] != scan[1])
+                {
+                    continue;
+                }
+
+                unsigned length = 2;
+                while (length < max_length && match[length] == scan[length])
+                {
+                    ++length;
+                }
+
+                if (length > best_length)
+                {
+                    found_start = current_match;
+                    best_length = length;
+                    if (length >= nice_length)
+                    {
+                        break;
+                    }
+                }
+            } while ((current_match = prev[static_cast<size_t>(current_match) & WINDOW_MASK]) > limit &&
+                     --chain_length != 0);
+
+            match_start = found_start;
+            return (std::min)(best_length, lookahead);
+        }
+
+        bool tally_literal(uchar c)
+        {
+            symbol_lengths.push_back(c);
+            symbol_distances.push_back(0);
+            ++literal_freqs[c];
+            return symbol_lengths.size() == SYMBOL_BUFFER_SIZE - 1;
+        }
+
+        bool tally_match(unsigned distance, unsigned length)
+        {
+            symbol_lengths.push_back(static_cast<uint16_t>(length - MIN_MATCH));
+            symbol_distances.push_back(static_cast<uint16_t>(distance));
+            ++literal_freqs[CODE_TABLES.length_code[length - MIN_MATCH] + END_OF_BLOCK + 1];
+            ++distance_freqs[distance_code_for(distance)];
+            return symbol_lengths.size() == SYMBOL_BUFFER_SIZE - 1;
+        }
+
+        void slide_window() noexcept
+        {
+            window_slid = true;
+            memcpy(window.data(), window.data() + WINDOW_SIZE, WINDOW_SIZE);
+            match_start -= static_cast<long>(WINDOW_SIZE);
+            strstart -= static_cast<long>(WINDOW_SIZE);
+            block_start -= static_cast<long>(WINDOW_SIZE);
+            window_end -= WINDOW_SIZE;
+            auto slide = [](int32_t& position) {
+                position = position >= static_cast<int32_t>(WINDOW_SIZE) ? position - static_cast<int32_t>(WINDOW_SIZE)
+                                                                          : -1;
+            };
+
+            std::for_each(head.begin(), head.end(), slide);
+            std::for_each(prev.begin(), prev.end(), slide);
+        }
+
+        void add_bytes(const uchar* first, const uchar* last, std::string& out)
+        {
+            Checks::check_exit(VCPKG_LINE_INFO, !finished);
+            while (first != last)
+            {
+                if (strstart >= static_cast<long>(2 * WINDOW_SIZE - MIN_LOOKAHEAD))
+                {
+                    slide_window();
+                }
+
+                const auto chunk = (std::min)(static_cast<size_t>(last - first), 2 * WINDOW_SIZE - window_end);
+                memcpy(window.data() + window_end, first, chunk);
+                window_end += chunk;
+                lookahead += static_cast<unsigned>(chunk);
+                first += chunk;
+                compress_window(out, false);
+            }
+        }
+
+        void finish(std::string& out)
+        {
+            Checks::check_exit(VCPKG_LINE_INFO, !finished);
+            compress_window(out, true);
+            if (match_available)
+            {
+                tally_literal(window[strstart - 1]);
+                match_available = false;
+            }
+
+            flush_block(out, true);
+            finished = true;
+        }
+
+        void compress_window(std::string& out, bool flushing)
+        {
+            for (;;)
+            {
+                if (lookahead < MIN_LOOKAHEAD && (!flushing || lookahead == 0))
+                {
+                    return;
+                }
+
+                long hash_head = -1;
+                if (lookahead >= MIN_MATCH)
+                {
+                    hash_head = insert_string(strstart);
+                }
+
+                prev_length = match_length;
+                const long prev_match = match_start;
+                match_length = MIN_MATCH - 1;
+                if (hash_head != -1 && prev_length < MAX_LAZY &&
+                    strstart - hash_head <= static_cast<long>(MAX_DISTANCE))
+                {
+                    match_length = longest_match(hash_head);
+                    if (match_length == MIN_MATCH && strstart - match_start > TOO_FAR)
+                    {
+                        // a short match far away costs more than the literals it replaces
+                        match_length = MIN_MATCH - 1;
+                    }
+                }
+
+                if (prev_length >= MIN_MATCH && match_length <= prev_length)
+                {
+                    // the match found at the previous position is at least as good as this one; emit it
+                    const long max_insert = strstart + static_cast<long>(lookahead) - static_cast<long>(MIN_MATCH);
+                    const bool block_full =
+                        tally_match(static_cast<unsigned>(strstart - 1 - prev_match), prev_length);
+                    lookahead -= prev_length - 1;
+                    for (unsigned remaining = prev_length - 2; remaining != 0; --remaining)
+                    {
+                        if (++strstart <= max_insert)
+                        {
+                            insert_string(strstart);
+                        }
+                    }
+
+                    match_available = false;
+                    match_length = MIN_MATCH - 1;
+                    ++strstart;
+                    if (block_full)
+                    {
+                        flush_block(out, false);
+                    }
+                }
+                else if (match_available)
+                {
+                    // the previous match was not better than this one, so emit a literal for the previous position
+                    if (tally_literal(window[strstart - 1]))
+                    {
+                        flush_block(out, false);
+                    }
+
+                    ++strstart;
+                    --lookahead;
+                }
+                else
+                {
+                    // defer the decision for this position until the match at the next position is known
+                    match_available = true;
+                    ++strstart;
+                    --lookahead;
+                }
+            }
+        }
+
+        uint64_t data_bits(const uint8_t* literal_lengths, const uint8_t* distance_lengths) const noexcept
+        {
+            uint64_t bits = 0;
+            for (size_t n = 0; n < LITERAL_LENGTH_CODES; ++n)
+            {
+                auto code_bits = static_cast<uint64_t>(literal_lengths[n]);
+                if (n > END_OF_BLOCK)
+                {
+                    code_bits += LENGTH_EXTRA[n - END_OF_BLOCK - 1];
+                }
+
+                bits += literal_freqs[n] * code_bits;
+            }
+
+            for (size_t n = 0; n < DISTANCE_CODES; ++n)
+            {
+                bits += distance_freqs[n] * static_cast<uint64_t>(distance_lengths[n] + DISTANCE_EXTRA[n]);
+            }
+
+            return bits;
+        }
+
+        void write_symbols(BitWriter& writer,
+                           const uint8_t* literal_lengths,
+                           const uint16_t* literal_codes,
+                           const uint8_t* distance_lengths,
+                           const uint16_t* distance_codes) const
+        {
+            for (size_t n = 0; n < symbol_lengths.size(); ++n)
+            {
+                const auto distance = symbol_distances[n];
+                if (distance == 0)
+                {
+                    const auto literal = symbol_lengths[n];
+                    writer.write(literal_codes[literal], literal_lengths[literal]);
+                    continue;
+                }
+
+                const auto length_offset = symbol_lengths[n];
+                const unsigned length_code = CODE_TABLES.length_code[length_offset];
+                const unsigned length_symbol = length_code + END_OF_BLOCK + 1;
+                writer.write(literal_codes[length_symbol], literal_lengths[length_symbol]);
+                if (LENGTH_EXTRA[length_code] != 0)
+                {
+                    writer.write(length_offset + MIN_MATCH - LENGTH_BASE[length_code], LENGTH_EXTRA[length_code]);
+                }
+
+                const unsigned distance_code = distance_code_for(distance);
+                writer.write(distance_codes[distance_code], distance_lengths[distance_code]);
+                if (DISTANCE_EXTRA[distance_code] != 0)
+                {
+                    writer.write(distance - DISTANCE_BASE[distance_code], DISTANCE_EXTRA[distance_code]);
+                }
+            }
+
+            writer.write(literal_codes[END_OF_BLOCK], literal_lengths[END_OF_BLOCK]);
+        }
+
+        void write_stored(BitWriter& writer, bool last)
+        {
+            const uchar* data = window.data() + block_start;
+            size_t remaining = static_cast<size_t>(strstart - block_start);
+            do
+            {
+                const auto chunk = (std::min)(remaining, size_t{0xFFFF});
+                remaining -= chunk;
+                writer.write((last && remaining == 0) ? 1 : 0, 3);
+                writer.align();
+                const char header[4] = {static_cast<char>(chunk & 0xFF),
+                                        static_cast<char>(chunk >> 8),
+                                        static_cast<char>(~chunk & 0xFF),
+                                        static_cast<char>((~chunk >> 8) & 0xFF)};
+                writer.out.append(header, 4);
+                writer.out.append(reinterpret_cast<const char*>(data), chunk);
+                data += chunk;
+            } while (remaining != 0);
+        }
+
+        void flush_block(std::string& out, bool last)
+        {
+            ++literal_freqs[END_OF_BLOCK];
+
+            uint8_t literal_lengths[LITERAL_LENGTH_CODES];
+            uint8_t distance_lengths[DISTANCE_CODES];
+            make_code_lengths(literal_freqs, LITERAL_LENGTH_CODES, MAX_BITS, literal_lengths);
+            make_code_lengths(distance_freqs, DISTANCE_CODES, MAX_BITS, distance_lengths);
+
+            size_t literal_count = LITERAL_LENGTH_CODES;
+            while (literal_count > 257 && literal_lengths[literal_count - 1] == 0)
+            {
+                --literal_count;
+            }
+
+            size_t distance_count = DISTANCE_CODES;
+            while (distance_count > 1 && distance_lengths[distance_count - 1] == 0)
+            {
+                --distance_count;
+            }
+
+            // run length encode the code lengths with the code length alphabet (RFC 1951 section 3.2.7)
+            uint8_t all_lengths[LITERAL_LENGTH_CODES + DISTANCE_CODES];
+            std::copy(literal_lengths, literal_lengths + literal_count, all_lengths);
+            std::copy(distance_lengths, distance_lengths + distance_count, all_lengths + literal_count);
+            const size_t all_count = literal_count + distance_count;
+            std::vector<std::pair<uint8_t, uint8_t>> length_symbols; // symbol, extra bits value
+            uint32_t length_freqs[CODE_LENGTH_CODES] = {};
+            auto emit = [&](uint8_t symbol, uint8_t extra) {
+                length_symbols.emplace_back(symbol, extra);
+                ++length_freqs[symbol];
+            };
+
+            for (size_t n = 0; n < all_count;)
+            {
+                const auto current = all_lengths[n];
+                size_t run = 1;
+                while (n + run < all_count && all_lengths[n + run] == current)
+                {
+                    ++run;
+                }
+
+                n += run;
+                if (current == 0)
+                {
+                    while (run >= 11)
+                    {
+                        const auto chunk = (std::min)(run, size_t{138});
+                        emit(18, static_cast<uint8_t>(chunk - 11));
+                        run -= chunk;
+                    }
+
+                    if (run >= 3)
+                    {
+                        emit(17, static_cast<uint8_t>(run - 3));
+                        run = 0;
+                    }
+                }
+                else
+                {
+                    emit(current, 0);
+                    --run;
+                    while (run >= 3)
+                    {
+                        const auto chunk = (std::min)(run, size_t{6});
+                        emit(16, static_cast<uint8_t>(chunk - 3));
+                        run -= chunk;
+                    }
+                }
+
+                for (; run != 0; --run)
+                {
+                    emit(current, 0);
+                }
+            }
+
+            uint8_t code_length_lengths[CODE_LENGTH_CODES];
+            make_code_lengths(length_freqs, CODE_LENGTH_CODES, MAX_CODE_LENGTH_BITS, code_length_lengths);
+            size_t code_length_count = CODE_LENGTH_CODES;
+            while (code_length_count > 4 && code_length_lengths[CODE_LENGTH_ORDER[code_length_count - 1]] == 0)
+            {
+                --code_length_count;
+            }
+
+            uint64_t dynamic_bits = 3 + 5 + 5 + 4 + 3 * code_length_count;
+            for (auto&& symbol : length_symbols)
+            {
+                dynamic_bits += code_length_lengths[symbol.first];
+                dynamic_bits += symbol.first == 16 ? 2 : symbol.first == 17 ? 3 : symbol.first == 18 ? 7 : 0;
+            }
+
+            dynamic_bits += data_bits(literal_lengths, distance_lengths);
+            const uint64_t fixed_bits =
+                3 + data_bits(CODE_TABLES.fixed_literal_lengths, CODE_TABLES.fixed_distance_lengths);
+            uint64_t stored_bits = UINT64_MAX;
+            if (block_start >= 0)
+            {
+                const auto stored_length = static_cast<uint64_t>(strstart - block_start);
+                stored_bits = (stored_length + 5 * (stored_length / 0xFFFF + 1)) * 8 + 7;
+            }
+
+            BitWriter writer{out};
+            writer.m_buffer = bit_buffer;
+            writer.m_count = bit_count;
+            if (stored_bits <= fixed_bits && stored_bits <= dynamic_bits)
+            {
+                write_stored(writer, last);
+            }
+            else if (fixed_bits <= dynamic_bits)
+            {
+                uint16_t literal_codes[288];
+                uint16_t distance_codes[DISTANCE_CODES];
+                make_codes(CODE_TABLES.fixed_literal_lengths, 288, literal_codes);
+                make_codes(CODE_TABLES.fixed_distance_lengths, DISTANCE_CODES, distance_codes);
+                writer.write(last ? 3 : 2, 3);
+                write_symbols(writer,
+                              CODE_TABLES.fixed_literal_lengths,
+                              literal_codes,
+                              CODE_TABLES.fixed_distance_lengths,
+                              distance_codes);
+            }
+            else
+            {
+                uint16_t literal_codes[LITERAL_LENGTH_CODES];
+                uint16_t distance_codes[DISTANCE_CODES];
+                uint16_t code_length_codes[CODE_LENGTH_CODES];
+                make_codes(literal_lengths, LITERAL_LENGTH_CODES, literal_codes);
+                make_codes(distance_lengths, DISTANCE_CODES, distance_codes);
+                make_codes(code_length_lengths, CODE_LENGTH_CODES, code_length_codes);
+                writer.write(last ? 5 : 4, 3);
+                writer.write(literal_count - 257, 5);
+                writer.write(distance_count - 1, 5);
+                writer.write(code_length_count - 4, 4);
+                for (size_t n = 0; n < code_length_count; ++n)
+                {
+                    writer.write(code_length_lengths[CODE_LENGTH_ORDER[n]], 3);
+                }
+
+                for (auto&& symbol : length_symbols)
+                {
+                    writer.write(code_length_codes[symbol.first], code_length_lengths[symbol.first]);
+                    switch (symbol.first)
+                    {
+                        case 16: writer.write(symbol.second, 2); break;
+                        case 17: writer.write(symbol.second, 3); break;
+                        case 18: writer.write(symbol.second, 7); break;
+                        default: break;
+                    }
+                }
+
+                write_symbols(writer, literal_lengths, literal_codes, distance_lengths, distance_codes);
+            }
+
+            if (last)
+            {
+                writer.align();
+            }
+
+            bit_buffer = writer.m_buffer;
+            bit_count = writer.m_count;
+            block_start = strstart;
+            reset_block();
+        }
+
+        std::vector<uchar> window;
+        std::vector<int32_t> head;
+        std::vector<int32_t> prev;
+        size_t window_end;
+        bool window_slid;
+        long strstart;
+        long block_start;
+        unsigned lookahead;
+        long match_start;
+        unsigned match_length;
+        unsigned prev_length;
+        bool match_available;
+        bool finished;
+
+        uint32_t literal_freqs[LITERAL_LENGTH_CODES];
+        uint32_t distance_freqs[DISTANCE_CODES];
+        // for literals, the literal and 0; for matches, the length - MIN_MATCH and the distance
+        std::vector<uint16_t> symbol_lengths;
+        std::vector<uint16_t> symbol_distances;
+
+        uint64_t bit_buffer;
+        int bit_count;
+    };
+
+    Compressor::Compressor() : m_state(std::make_unique<CompressorState>()) { }
+    Compressor::~Compressor() = default;
+
+    void Compressor::add_bytes(const void* first, const void* last, std::string& out)
+    {
+        m_state->add_bytes(static_cast<const uchar*>(first), static_cast<const uchar*>(last), out);
+    }
+
+    void Compressor::finish(std::string& out) { m_state->finish(out); }
+
+    void Compressor::clear() noexcept { m_state->clear(); }
+
+    std::string compress(StringView data)
+    {
+        std::string result;
+        Compressor compressor;
+        compressor.add_bytes(data.begin(), data.end(), result);
+        compressor.finish(result);
+        return result;
+    }
+
+    std::string compress_zlib(StringView data)
+    {
+        // CMF: deflate with a 32K window; FLG: default compression level, with the check bits making the header a
+        // multiple of 31
+        std::string result{"\x78\x9C"};
+        Compressor compressor;
+        compressor.add_bytes(data.begin(), data.end(), result);
+        compressor.finish(result);
+        const auto checksum = adler32(1, data.begin(), data.end());
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            result.push_back(static_cast<char>((checksum >> shift) & 0xFF));
+        }
+
+        return result;
+    }
+}
+
+namespace
+{
+    // Huffman decoding table: codes no longer than FAST_BITS are resolved with one lookup, longer codes fall back to
+    // canonical decoding by counting as in zlib's "puff".
+    struct HuffmanDecoder
+    {
+        static constexpr int FAST_BITS = 10;
+        static constexpr uint16_t LENGTH_SHIFT = 9;
+
+        // Returns false if `lengths` does not describe a usable prefix code.
+        bool build(const uint8_t* lengths, size_t count, bool allow_incomplete) noexcept
+        {
+            std::fill(std::begin(m_counts), std::end(m_counts), uint16_t{0});
+            for (size_t n = 0; n < count; ++n)
+            {
+                ++m_counts[lengths[n]];
+            }
+
+            m_counts[0] = 0;
+            int max_length = 0;
+            int left = 1;
+            for (int bits = 1; bits <= MAX_BITS; ++bits)
+            {
+                left <<= 1;
+                left -= m_counts[bits];
+                if (left < 0)
+                {
+                    return false; // over-subscribed
+                }
+
+                if (m_counts[bits] != 0)
+                {
+                    max_length = bits;
+                }
+            }
+
+            // As in zlib, incomplete codes are only permitted if they consist of a single one bit code or no codes
+            // at all.
+            if (left > 0 && max_length > 1 && !allow_incomplete)
+            {
+                return false;
+            }
+
+            uint16_t offsets[MAX_BITS + 2];
+            offsets[1] = 0;
+            for (int bits = 1; bits <= MAX_BITS; ++bits)
+            {
+                offsets[bits + 1] = static_cast<uint16_t>(offsets[bits] + m_counts[bits]);
+            }
+
+            for (size_t n = 0; n < count; ++n)
+            {
+                if (lengths[n] != 0)
+                {
+                    m_symbols[offsets[lengths[n]]++] = static_cast<uint16_t>(n);
+                }
+            }
+
+            std::fill(std::begin(m_fast), std::end(m_fast), uint16_t{0});
+            uint16_t codes[LITERAL_LENGTH_CODES + 2];
+            make_codes(lengths, count, codes);
+            for (size_t n = 0; n < count; ++n)
+            {
+                const int length = lengths[n];
+                if (length != 0 && length <= FAST_BITS)
+                {
+                    const auto entry = static_cast<uint16_t>(n | (length << LENGTH_SHIFT));
+                    for (unsigned index = codes[n]; index < (1u << FAST_BITS); index += 1u << length)
+                    {
+                        m_fast[index] = entry;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        // Decodes one symbol from the low bits of `bits`, storing the length of the code in `length`; returns -1 if
+        // no code matches.
+        int decode(uint64_t bits, int& length) const noexcept
+        {
+            const auto entry = m_fast[bits & ((1u << FAST_BITS) - 1)];
+            if (entry != 0)
+            {
+                length = entry >> LENGTH_SHIFT;
+                return entry & ((1u << LENGTH_SHIFT) - 1);
+            }
+
+            int code = 0;
+            int first = 0;
+            int index = 0;
+            for (int len = 1; len <= MAX_BITS; ++len)
+            {
+                code |= static_cast<int>(bits & 1);
+                bits >>= 1;
+                const int count = m_counts[len];
+                if (code - count < first)
+                {
+                    length = len;
+                    return m_symbols[index + (code - first)];
+                }
+
+                index += count;
+                first += count;
+                first <<= 1;
+                code <<= 1;
+            }
+
+            return -1;
+        }
+
+        uint16_t m_fast[1u << FAST_BITS];
+        uint16_t m_counts[MAX_BITS + 1];
+        uint16_t m_symbols[LITERAL_LENGTH_CODES + 2];
+    };
+
+    // A pull based decoder: the input is read from an InflateSource as needed, and output is staged in a buffer that
+    // retains the last WINDOW_SIZE bytes for back references. Errors are sticky; after the first failure all reads
+    // return zero bits and the decoding loops unwind.
+    struct Inflater
+    {
+        static constexpr size_t INPUT_BUFFER_SIZE = 65536;
+        static constexpr size_t OUTPUT_BUFFER_SIZE = 262144;
+
+        Inflater(InflateSource& source, InflateSink& sink, bool zlib)
+            : m_source(source), m_sink(sink), m_zlib(zlib), m_input(INPUT_BUFFER_SIZE), m_output(OUTPUT_BUFFER_SIZE)
+        {
+        }
+
+        bool failed() const noexcept { return m_result != InflateResult::Success; }
+
+        void fail(InflateResult result) noexcept
+        {
+            if (!failed())
+            {
+                m_result = result;
+            }
+        }
+
+        bool fill_input()
+        {
+            if (m_input_position == m_input_end && !m_input_exhausted)
+            {
+                m_input_end = m_source.read(m_input.data(), m_input.size());
+                m_input_position = 0;
+                m_total_read += m_input_end;
+                m_input_exhausted = m_input_end == 0;
+            }
+
+            return m_input_position != m_input_end;
+        }
+
+        void refill()
+        {
+            while (m_bit_count <= 56)
+            {
+                if (fill_input())
+                {
+                    m_bit_buffer |= static_cast<uint64_t>(m_input[m_input_position++]) << m_bit_count;
+                }
+                else
+                {
+                    // pad with zeroes; consuming any padding is detected in consume()
+                    ++m_padding;
+                }
+
+                m_bit_count += 8;
+            }
+        }
+
+        void consume(int bits) noexcept
+        {
+            m_bit_buffer >>= bits;
+            m_bit_count -= bits;
+            if (m_padding != 0 && static_cast<size_t>(m_bit_count) < m_padding * 8)
+            {
+                fail(InflateResult::Truncated);
+            }
+        }
+
+        unsigned take(int bits)
+        {
+            if (m_bit_count < bits)
+            {
+                refill();
+            }
+
+            const auto result = static_cast<unsigned>(m_bit_buffer & ((uint64_t{1} << bits) - 1));
+            consume(bits);
+            return failed() ? 0 : result;
+        }
+
+        void align_to_byte() noexcept { consume(m_bit_count & 7); }
+
+        // Returns the decoded symbol, or -1 on failure.
+        int decode(const HuffmanDecoder& decoder)
+        {
+            int length;
+            const int symbol = decoder.decode(m_bit_buffer, length);
+            if (symbol < 0)
+            {
+                fail(InflateResult::Corrupt);
+                return -1;
+            }
+
+            consume(length);
+            return failed() ? -1 : symbol;
+        }
+
+        void flush_output()
+        {
+            const auto first = m_output.data() + m_output_flushed;
+            const auto size = m_output_position - m_output_flushed;
+            if (size == 0)
+            {
+                return;
+            }
+
+            if (m_zlib)
+            {
+                m_adler = adler32(m_adler, first, first + size);
+            }
+
+            if (!m_sink.write(first, size))
+            {
+                fail(InflateResult::SinkFailed);
+            }
+
+            m_output_flushed = m_output_position;
+        }
+
+        // Makes room for at least MAX_MATCH bytes of output, keeping the last window's worth for back references.
+        void reserve_output()
+        {
+            if (m_output_position + MAX_MATCH <= m_output.size())
+            {
+                return;
+            }
+
+            flush_output();
+            memmove(m_output.data(), m_output.data() + m_output_position - WINDOW_SIZE, WINDOW_SIZE);
+            m_output_position = WINDOW_SIZE;
+            m_output_flushed = WINDOW_SIZE;
+        }
+
+        void inflate_stored()
+        {
+            align_to_byte();
+            const unsigned length = take(16);
+            const unsigned complement = take(16);
+            if (length != (~complement & 0xFFFF))
+            {
+                fail(InflateResult::Corrupt);
+            }
+
+            unsigned remaining = length;
+            // first drain whole bytes remaining in the bit buffer, then copy directly from the input buffer
+            while (remaining != 0 && m_bit_count >= 8 && !failed())
+            {
+                reserve_output();
+                m_output[m_output_position++] = static_cast<uchar>(take(8));
+                ++m_total_output;
+                --remaining;
+            }
+
+            while (remaining != 0 && !failed())
+            {
+                if (!fill_input())
+                {
+                    fail(InflateResult::Truncated);
+                    return;
+                }
+
+                reserve_output();
+                const auto chunk = (std::min)({static_cast<size_t>(remaining),
+                                               m_input_end - m_input_position,
+                                               m_output.size() - m_output_position});
+                memcpy(m_output.data() + m_output_position, m_input.data() + m_input_position, chunk);
+                m_input_position += chunk;
+                m_output_position += chunk;
+                m_total_output += chunk;
+                remaining -= static_cast<unsigned>(chunk);
+            }
+        }
+
+        void inflate_codes(const HuffmanDecoder& literals, const HuffmanDecoder& distances)
+        {
+            while (!failed())
+            {
+                refill();
+                reserve_output();
+                const int symbol = decode(literals);
+                if (symbol < 0 || symbol == static_cast<int>(END_OF_BLOCK))
+                {
+                    return;
+                }
+
+                if (symbol < static_cast<int>(END_OF_BLOCK))
+                {
+                    m_output[m_output_position++] = static_cast<uchar>(symbol);
+                    ++m_total_output;
+                    continue;
+                }
+
+                const int length_code = symbol - static_cast<int>(END_OF_BLOCK) - 1;
+                if (length_code >= 29)
+                {
+                    fail(InflateResult::Corrupt);
+                    return;
+                }
+
+                const unsigned length = LENGTH_BASE[length_code] + take(LENGTH_EXTRA[length_code]);
+                const int distance_code = decode(distances);
+                if (distance_code < 0)
+                {
+                    return;
+                }
+
+                if (distance_code >= static_cast<int>(DISTANCE_CODES))
+                {
+                    fail(InflateResult::Corrupt);
+                    return;
+                }
+
+                const unsigned distance = DISTANCE_BASE[distance_code] + take(DISTANCE_EXTRA[distance_code]);
+                if (distance > m_total_output)
+                {
+                    fail(InflateResult::Corrupt);
+                    return;
+                }
+
+                uchar* destination = m_output.data() + m_output_position;
+                const uchar* source = destination - distance;
+                if (distance >= length)
+                {
+                    memcpy(destination, source, length);
+                }
+                else
+                {
+                    // overlapping copies repeat the most recent output
+                    for (unsigned n = 0; n < length; ++n)
+                    {
+                        destination[n] = source[n];
+                    }
+                }
+
+                m_output_position += length;
+                m_total_output += length;
+            }
+        }
+
+        void inflate_dynamic()
+        {
+            const unsigned literal_count = take(5) + 257;
+            const unsigned distance_count = take(5) + 1;
+            const unsigned code_length_count = take(4) + 4;
+            if (literal_count > LITERAL_LENGTH_CODES || distance_count > DISTANCE_CODES)
+            {
+                fail(InflateResult::Corrupt);
+                return;
+            }
+
+            uint8_t code_length_lengths[CODE_LENGTH_CODES] = {};
+            for (unsigned n = 0; n < code_length_count; ++n)
+            {
+                code_length_lengths[CODE_LENGTH_ORDER[n]] = static_cast<uint8_t>(take(3));
+            }
+
+            HuffmanDecoder& code_lengths = m_decoders[0];
+            if (failed() || !code_lengths.build(code_length_lengths, CODE_LENGTH_CODES, false))
+            {
+                fail(InflateResult::Corrupt);
+                return;
+            }
+
+            uint8_t lengths[LITERAL_LENGTH_CODES + DISTANCE_CODES];
+            for (unsigned n = 0; n < literal_count + distance_count;)
+            {
+                refill();
+                const int symbol = decode(code_lengths);
+                if (symbol < 0)
+                {
+                    return;
+                }
+
+                if (symbol < 16)
+                {
+                    lengths[n++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+
+                uint8_t repeated = 0;
+                unsigned repeat;
+                if (symbol == 16)
+                {
+                    if (n == 0)
+                    {
+                        fail(InflateResult::Corrupt);
+                        return;
+                    }
+
+                    repeated = lengths[n - 1];
+                    repeat = 3 + take(2);
+                }
+                else if (symbol == 17)
+                {
+                    repeat = 3 + take(3);
+                }
+                else
+                {
+                    repeat = 11 + take(7);
+                }
+
+                if (failed() || n + repeat > literal_count + distance_count)
+                {
+                    fail(InflateResult::Corrupt);
+                    return;
+                }
+
+                for (; repeat != 0; --repeat)
+                {
+                    lengths[n++] = repeated;
+                }
+            }
+
+            if (lengths[END_OF_BLOCK] == 0 || !m_decoders[1].build(lengths, literal_count, false) ||
+                !m_decoders[2].build(lengths + literal_count, distance_count, false))
+            {
+                fail(InflateResult::Corrupt);
+                return;
+            }
+
+            inflate_codes(m_decoders[1], m_decoders[2]);
+        }
+
+        void inflate_fixed()
+        {
+            static const HuffmanDecoder* const fixed = [] {
+                static HuffmanDecoder decoders[2];
+                decoders[0].build(CODE_TABLES.fixed_literal_lengths, 288, true);
+                decoders[1].build(CODE_TABLES.fixed_distance_lengths, DISTANCE_CODES, true);
+                return decoders;
+            }();
+
+            inflate_codes(fixed[0], fixed[1]);
+        }
+
+        InflateOutcome run()
+        {
+            if (m_zlib)
+            {
+                const unsigned cmf = take(8);
+                const unsigned flg = take(8);
+                if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20) != 0)
+                {
+                    fail(InflateResult::Corrupt);
+                }
+            }
+
+            bool last_block = false;
+            while (!last_block && !failed())
+            {
+                const unsigned header = take(3);
+                last_block = (header & 1) != 0;
+                switch (header >> 1)
+                {
+                    case 0: inflate_stored(); break;
+                    case 1: inflate_fixed(); break;
+                    case 2: inflate_dynamic(); break;
+                    default: fail(InflateResult::Corrupt); break;
+                }
+            }
+
+            flush_output();
+            align_to_byte();
+            if (m_zlib)
+            {
+                uint32_t expected = 0;
+                for (int n = 0; n < 4; ++n)
+                {
+                    expected = (expected << 8) | take(8);
+                }
+
+                if (expected != m_adler)
+                {
+                    fail(InflateResult::Corrupt);
+                }
+            }
+
+            if (failed())
+            {
+                return {m_result, 0};
+            }
+
+            const auto unread_bytes = static_cast<uint64_t>(m_input_end - m_input_position) +
+                                      static_cast<uint64_t>(m_bit_count / 8) - m_padding;
+            return {InflateResult::Success, m_total_read - unread_bytes};
+        }
+
+        InflateSource& m_source;
+        InflateSink& m_sink;
+        bool m_zlib;
+        InflateResult m_result = InflateResult::Success;
+        uint32_t m_adler = 1;
+
+        std::vector<uchar> m_input;
+        size_t m_input_position = 0;
+        size_t m_input_end = 0;
+        bool m_input_exhausted = false;
+        uint64_t m_total_read = 0;
+        size_t m_padding = 0;
+        uint64_t m_bit_buffer = 0;
+        int m_bit_count = 0;
+
+        std::vector<uchar> m_output;
+        size_t m_output_position = 0;
+        size_t m_output_flushed = 0;
+        uint64_t m_total_output = 0;
+
+        HuffmanDecoder m_decoders[3];
+    };
+
+    struct StringViewSource : InflateSource
+    {
+        explicit StringViewSource(StringView data) : m_data(data) { }
+
+        size_t read(void* buffer, size_t size) override
+        {
+            const auto chunk = (std::min)(size, m_data.size());
+            memcpy(buffer, m_data.data(), chunk);
+            m_data = m_data.substr(chunk);
+            return chunk;
+        }
+
+    private:
+        StringView m_data;
+    };
+
+    struct StringSink : InflateSink
+    {
+        bool write(const void* buffer, size_t size) override
+        {
+            result.append(static_cast<const char*>(buffer), size);
+            return true;
+        }
+
+        std::string result;
+    };
+}
+
+namespace vcpkg::Deflate
+{
+    InflateOutcome inflate(InflateSource& source, InflateSink& sink)
+    {
+        auto inflater = std::make_unique<Inflater>(source, sink, false);
+        return inflater->run();
+    }
+
+    InflateOutcome inflate_zlib(InflateSource& source, InflateSink& sink)
+    {
+        auto inflater = std::make_unique<Inflater>(source, sink, true);
+        return inflater->run();
+    }
+
+    Optional<std::string> inflate(StringView compressed)
+    {
+        StringViewSource source{compressed};
+        StringSink sink;
+        if (inflate(source, sink).result == InflateResult::Success)
+        {
+            return std::move(sink.result);
+        }
+
+        return nullopt;
+    }
+
+    Optional<std::string> inflate_zlib(StringView compressed)
+    {
+        StringViewSource source{compressed};
+        StringSink sink;
+        if (inflate_zlib(source, sink).result == InflateResult::Success)
+        {
+            return std::move(sink.result);
+        }
+
+        return nullopt;
+    }
+}
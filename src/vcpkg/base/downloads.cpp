@@ -82,77 +82,61 @@ namespace vcpkg
     }
 
     static bool check_downloaded_file_hash(DiagnosticContext& context,
-                                           const ReadOnlyFilesystem& fs,
                                            const SanitizedUrl& sanitized_url,
                                            const Path& downloaded_path,
-                                           StringView sha512,
+                                           const StringView* maybe_sha512,
+                                           std::string&& actual_hash,
                                            std::string* out_sha512)
     {
-        if (!std::all_of(sha512.begin(), sha512.end(), ParserBase::is_hex_digit_lower))
-        {
-            Checks::unreachable(VCPKG_LINE_INFO);
-        }
-
-        auto maybe_actual_hash =
-            vcpkg::Hash::get_file_hash_required(context, fs, downloaded_path, Hash::Algorithm::Sha512);
-        if (auto actual_hash = maybe_actual_hash.get())
+        bool success = true;
+        if (maybe_sha512)
         {
-            if (sha512 == *actual_hash)
+            const auto sha512 = *maybe_sha512;
+            if (!std::all_of(sha512.begin(), sha512.end(), ParserBase::is_hex_digit_lower))
             {
-                if (out_sha512)
-                {
-                    *out_sha512 = std::move(*actual_hash);
-                }
-
-                return true;
+                Checks::unreachable(VCPKG_LINE_INFO);
             }
 
-            context.report(DiagnosticLine{DiagKind::Error,
-                                          downloaded_path,
-                                          msg::format(msgDownloadFailedHashMismatch, msg::url = sanitized_url)});
-            context.report(DiagnosticLine{DiagKind::Note,
-                                          msg::format(msgDownloadFailedHashMismatchExpectedHash, msg::sha = sha512)});
-            context.report(DiagnosticLine{
-                DiagKind::Note, msg::format(msgDownloadFailedHashMismatchActualHash, msg::sha = *actual_hash)});
-
-            if (out_sha512)
+            if (sha512 != actual_hash)
             {
-                *out_sha512 = std::move(*actual_hash);
+                context.report(DiagnosticLine{DiagKind::Error,
+                                              downloaded_path,
+                                              msg::format(msgDownloadFailedHashMismatch, msg::url = sanitized_url)});
+                context.report(DiagnosticLine{
+                    DiagKind::Note, msg::format(msgDownloadFailedHashMismatchExpectedHash, msg::sha = sha512)});
+                context.report(DiagnosticLine{
+                    DiagKind::Note, msg::format(msgDownloadFailedHashMismatchActualHash, msg::sha = actual_hash)});
+                success = false;
             }
         }
 
-        return false;
-    }
-
-    static bool check_downloaded_file_hash(DiagnosticContext& context,
-                                           const ReadOnlyFilesystem& fs,
-                                           const SanitizedUrl& sanitized_url,
-                                           const Path& downloaded_path,
-                                           const StringView* maybe_sha512,
-                                           std::string* out_sha512)
-    {
-        if (maybe_sha512)
-        {
-            return check_downloaded_file_hash(context, fs, sanitized_url, downloaded_path, *maybe_sha512, out_sha512);
-        }
-
         if (out_sha512)
         {
-            auto maybe_actual_hash =
-                vcpkg::Hash::get_file_hash_required(context, fs, downloaded_path, Hash::Algorithm::Sha512);
-            if (auto actual_hash = maybe_actual_hash.get())
-            {
-                *out_sha512 = std::move(*actual_hash);
-            }
+            *out_sha512 = std::move(actual_hash);
         }
 
-        return true;
+        return success;
     }
 
-    static size_t write_file_callback(void* contents, size_t size, size_t nmemb, void* param)
+    struct HashingWriteFile
+    {
+        WriteFilePointer& file;
+        Hash::Hasher* hasher;
+    };
+
+    // Writes to `file`, also feeding the written bytes to `hasher` if it is not null so that the download doesn't need
+    // to be read back to be verified.
+    static size_t write_file_and_hash_callback(void* contents, size_t size, size_t nmemb, void* param)
     {
         if (!param) return 0;
-        return static_cast<WriteFilePointer*>(param)->write(contents, size, nmemb);
+        auto& target = *static_cast<HashingWriteFile*>(param);
+        const auto written = target.file.write(contents, size, nmemb);
+        if (target.hasher)
+        {
+            target.hasher->add_bytes(contents, static_cast<const char*>(contents) + written * size);
+        }
+
+        return written;
     }
 
     static int progress_callback(void* clientp, double dltotal, double dlnow, double ultotal, double ulnow)
@@ -168,125 +152,326 @@ namespace vcpkg
         return 0;
     }
 
-    static std::vector<int> libcurl_bulk_operation(DiagnosticContext& context,
-                                                   View<std::string> urls,
-                                                   View<Path> outputs,
-                                                   View<std::string> headers)
+    namespace
     {
-        if (!outputs.empty() && outputs.size() != urls.size())
-        {
-            Checks::unreachable(VCPKG_LINE_INFO);
-        }
+        // At most this many transfers of a bulk operation are in flight at once; the rest wait for a free slot.
+        constexpr size_t max_transfers_in_flight = 16;
+        // Transfers to one host beyond this many wait for a connection, or are multiplexed over an HTTP/2 connection,
+        // rather than each opening a connection of its own.
+        constexpr long max_host_connections = 6;
 
-        std::vector<int> return_codes(urls.size(), -1);
-
-        CurlHeaders request_headers(headers);
+        using namespace std::chrono_literals;
+        // The delays before retrying transfers which failed with transient errors.
+        constexpr std::array<std::chrono::milliseconds, 2> transfer_retry_delays = {1000ms, 2000ms};
 
-        std::vector<WriteFilePointer> write_pointers;
-        write_pointers.reserve(urls.size());
+        CurlShareHandle& shared_curl_sessions()
+        {
+            static CurlShareHandle share;
+            return share;
+        }
 
-        std::vector<CurlEasyHandle> easy_handles;
-        easy_handles.resize(urls.size());
+        struct CurlTransfer
+        {
+            StringView url;
+            // the file the response is written to; if null, only the headers of the response are requested
+            const Path* output = nullptr;
+            // if not null, cleared and then fed the response as it is written, for each attempt
+            Hash::Hasher* hasher = nullptr;
+            // if not null, receives the progress of the transfer
+            MessageSink* progress = nullptr;
+
+            // the outcome of the last attempt; if `output` could not be opened, this has been reported and
+            // `output_opened` is false
+            bool output_opened = false;
+            // set if the listener no longer needed the transfer, in which case it has no outcome
+            bool abandoned = false;
+            CURLcode curl_code = CURLE_OK;
+            long response_code = -1;
+        };
 
-        CurlMultiHandle multi_handle;
-        for (size_t request_index = 0; request_index < urls.size(); ++request_index)
+        struct CurlTransferState
         {
-            const auto& url = urls[request_index];
-            auto& easy_handle = easy_handles[request_index];
-            auto* curl = easy_handle.get();
+            CurlEasyHandle handle;
+            WriteFilePointer file;
+            HashingWriteFile write_target{file, nullptr};
+            size_t attempts = 0;
+            std::chrono::steady_clock::time_point retry_at;
+        };
 
-            set_common_curl_easy_options(easy_handle, url, request_headers);
-            if (outputs.empty())
+        // Performs `transfers` over one multi handle, with at most max_transfers_in_flight of them in flight at once.
+        // Each transfer which fails with a transient error is attempted up to `max_attempts` times in total. Failures
+        // are left to the caller to report, except for outputs which cannot be opened. If `listener` is not null,
+        // transfers it no longer needs are abandoned, and it is told about each transfer as soon as it finishes.
+        void perform_curl_transfers(DiagnosticContext& context,
+                                    Span<CurlTransfer> transfers,
+                                    const CurlHeaders& request_headers,
+                                    size_t max_attempts,
+                                    BulkDownloadListener* listener = nullptr)
+        {
+            if (max_attempts == 0 || max_attempts > transfer_retry_delays.size() + 1)
             {
-                vcpkg_curl_easy_setopt(
-                    curl, CURLOPT_PRIVATE, reinterpret_cast<void*>(static_cast<uintptr_t>(request_index)));
-                vcpkg_curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+                Checks::unreachable(VCPKG_LINE_INFO);
             }
-            else
-            {
-                const auto& output = outputs[request_index];
-                std::error_code ec;
-                auto& request_write_pointer = write_pointers.emplace_back(output, Append::NO, ec);
-                if (ec)
+
+            std::vector<CurlTransferState> states(transfers.size());
+            std::vector<size_t> retries;
+            size_t next_transfer = 0;
+            std::vector<size_t> in_flight;
+
+            CurlMultiHandle multi_handle;
+            vcpkg_curl_multi_setopt(multi_handle.get(), CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+            vcpkg_curl_multi_setopt(multi_handle.get(), CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+            auto abandon_transfer = [&](size_t idx) {
+                auto& transfer = transfers[idx];
+                transfer.abandoned = true;
+                transfer.output_opened = true;
+                states[idx].file.close();
+                states[idx].handle = CurlEasyHandle{};
+                if (transfer.output)
                 {
-                    context.report_error(format_filesystem_call_error(ec, "fopen", {output}));
-                    Checks::unreachable(VCPKG_LINE_INFO);
+                    real_filesystem.remove(*transfer.output, IgnoreErrors{});
                 }
+            };
 
-                vcpkg_curl_easy_setopt(curl, CURLOPT_PRIVATE, static_cast<void*>(&request_write_pointer));
-                // note explicit cast to void* necessary to go through ...
-                vcpkg_curl_easy_setopt(curl, CURLOPT_WRITEDATA, static_cast<void*>(&request_write_pointer));
-                vcpkg_curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &write_file_callback);
-            }
+            auto start_transfer = [&](size_t idx) {
+                auto& transfer = transfers[idx];
+                auto& state = states[idx];
+                if (listener && !listener->still_needed(idx))
+                {
+                    abandon_transfer(idx);
+                    return;
+                }
 
-            multi_handle.add_easy_handle(easy_handle);
-        }
+                ++state.attempts;
+                auto* curl = state.handle.get();
+                if (transfer.output)
+                {
+                    std::error_code ec;
+                    state.file = WriteFilePointer(*transfer.output, Append::NO, ec);
+                    if (ec)
+                    {
+                        context.report_error(format_filesystem_call_error(ec, "fopen", {*transfer.output}));
+                        transfer.output_opened = false;
+                        return;
+                    }
 
-        int still_running = 0;
-        for (;;)
-        {
-            CURLMcode mc = vcpkg_curl_multi_perform(multi_handle.get(), &still_running);
-            if (mc != CURLM_OK)
-            {
-                Debug::println("curl_multi_perform failed:");
-                Debug::println(msg::format(msgCurlFailedGeneric, msg::exit_code = static_cast<int>(mc))
-                                   .append_raw(fmt::format(" ({}).", vcpkg_curl_multi_strerror(mc))));
-                Checks::unreachable(VCPKG_LINE_INFO);
-            }
+                    if (transfer.hasher)
+                    {
+                        transfer.hasher->clear();
+                    }
 
-            if (still_running == 0)
-            {
-                break;
-            }
+                    state.write_target.hasher = transfer.hasher;
+                    vcpkg_curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &write_file_and_hash_callback);
+                    vcpkg_curl_easy_setopt(curl, CURLOPT_WRITEDATA, static_cast<void*>(&state.write_target));
+                }
+                else
+                {
+                    vcpkg_curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+                }
 
-            mc = vcpkg_curl_multi_poll(multi_handle.get(), nullptr, 0, 1000, nullptr);
-            if (mc != CURLM_OK)
-            {
-                Debug::println("curl_multi_wait/poll failed:");
-                Debug::println(msg::format(msgCurlFailedGeneric, msg::exit_code = static_cast<int>(mc))
-                                   .append_raw(fmt::format(" ({}).", vcpkg_curl_multi_strerror(mc))));
-                Checks::unreachable(VCPKG_LINE_INFO);
-            }
-        }
+                transfer.output_opened = true;
+                if (state.attempts == 1)
+                {
+                    set_common_curl_easy_options(state.handle, transfer.url, request_headers);
+                    vcpkg_curl_easy_setopt(curl, CURLOPT_PRIVATE, reinterpret_cast<void*>(static_cast<uintptr_t>(idx)));
+                    vcpkg_curl_easy_setopt(curl, CURLOPT_SHARE, shared_curl_sessions().get());
+                    // prefer waiting to multiplex over an HTTP/2 connection to opening another connection
+                    vcpkg_curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+                    if (transfer.progress)
+                    {
+                        vcpkg_curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L); // change from default to enable progress
+                        // curlopt_progressfunction is deprecated, but we want the values as doubles anyway and
+                        // the replacement isn't available on all versions of libcurl we support
+                        vcpkg_curl_easy_setopt(
+                            curl, CURLOPT_PROGRESSFUNCTION, static_cast<curl_progress_callback>(&progress_callback));
+                        vcpkg_curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, static_cast<void*>(transfer.progress));
+                    }
+                }
 
-        // drain all messages
-        int messages_in_queue = 0;
-        while (auto* msg = vcpkg_curl_multi_info_read(multi_handle.get(), &messages_in_queue))
-        {
-            if (msg->msg == CURLMSG_DONE)
+                multi_handle.add_easy_handle(state.handle);
+                in_flight.push_back(idx);
+            };
+
+            for (;;)
             {
-                CURL* handle = msg->easy_handle;
-                if (msg->data.result == CURLE_OK)
+                const auto now = std::chrono::steady_clock::now();
+                auto next_retry_at = std::chrono::steady_clock::time_point::max();
+                for (auto it = retries.begin(); it != retries.end();)
+                {
+                    if (in_flight.size() < max_transfers_in_flight && states[*it].retry_at <= now)
+                    {
+                        start_transfer(*it);
+                        it = retries.erase(it);
+                        continue;
+                    }
+
+                    next_retry_at = (std::min)(next_retry_at, states[*it].retry_at);
+                    ++it;
+                }
+
+                while (in_flight.size() < max_transfers_in_flight && next_transfer < transfers.size())
                 {
-                    size_t idx;
+                    start_transfer(next_transfer++);
+                }
+
+                if (in_flight.empty())
+                {
+                    if (retries.empty())
+                    {
+                        break;
+                    }
+
+                    std::this_thread::sleep_until(next_retry_at);
+                    continue;
+                }
+
+                int still_running = 0;
+                CURLMcode mc = vcpkg_curl_multi_perform(multi_handle.get(), &still_running);
+                if (mc != CURLM_OK)
+                {
+                    Debug::println("curl_multi_perform failed:");
+                    Debug::println(msg::format(msgCurlFailedGeneric, msg::exit_code = static_cast<int>(mc))
+                                       .append_raw(fmt::format(" ({}).", vcpkg_curl_multi_strerror(mc))));
+                    Checks::unreachable(VCPKG_LINE_INFO);
+                }
+
+                int messages_in_queue = 0;
+                while (auto* msg = vcpkg_curl_multi_info_read(multi_handle.get(), &messages_in_queue))
+                {
+                    if (msg->msg != CURLMSG_DONE)
+                    {
+                        continue;
+                    }
+
+                    CURL* handle = msg->easy_handle;
+                    const auto result = msg->data.result;
                     void* curlinfo_private;
                     vcpkg_curl_easy_getinfo(handle, CURLINFO_PRIVATE, &curlinfo_private);
-                    if (outputs.empty())
+                    const auto idx = static_cast<size_t>(reinterpret_cast<uintptr_t>(curlinfo_private));
+                    auto& transfer = transfers[idx];
+                    auto& state = states[idx];
+                    transfer.curl_code = result;
+                    transfer.response_code = -1;
+                    if (result == CURLE_OK)
+                    {
+                        vcpkg_curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &transfer.response_code);
+                    }
+
+                    // msg is invalidated by removing its easy handle
+                    multi_handle.remove_easy_handle(state.handle);
+                    Util::erase_remove(in_flight, idx);
+                    state.file.close();
+                    if (state.attempts < max_attempts &&
+                        should_retry_transfer(transfer.url, transfer.curl_code, transfer.response_code))
                     {
-                        idx = reinterpret_cast<uintptr_t>(curlinfo_private);
+                        state.retry_at = std::chrono::steady_clock::now() + transfer_retry_delays[state.attempts - 1];
+                        retries.push_back(idx);
                     }
                     else
                     {
-                        if (!curlinfo_private)
+                        state.handle = CurlEasyHandle{};
+                        if (listener)
                         {
-                            Checks::unreachable(VCPKG_LINE_INFO);
+                            listener->finished(
+                                idx, transfer.curl_code == CURLE_OK ? static_cast<int>(transfer.response_code) : -1);
                         }
-                        auto request_write_handle = static_cast<WriteFilePointer*>(curlinfo_private);
-                        idx = request_write_handle - write_pointers.data();
                     }
+                }
 
-                    long response_code;
-                    vcpkg_curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response_code);
-                    return_codes[idx] = static_cast<int>(response_code);
+                if (listener)
+                {
+                    for (auto it = in_flight.begin(); it != in_flight.end();)
+                    {
+                        if (listener->still_needed(*it))
+                        {
+                            ++it;
+                            continue;
+                        }
+
+                        multi_handle.remove_easy_handle(states[*it].handle);
+                        abandon_transfer(*it);
+                        it = in_flight.erase(it);
+                    }
                 }
-                else
+
+                if (in_flight.empty() ||
+                    (in_flight.size() < max_transfers_in_flight && next_transfer < transfers.size()))
                 {
-                    context.report_error(
-                        msg::format(msgCurlFailedGeneric, msg::exit_code = static_cast<int>(msg->data.result))
-                            .append_raw(fmt::format(" ({}).", vcpkg_curl_easy_strerror(msg->data.result))));
+                    // start the next transfers without waiting for the ones in flight
+                    continue;
+                }
+
+                // Transfers which the listener stops needing are noticed between polls
+                int timeout_ms = listener ? 100 : 1000;
+                if (!retries.empty())
+                {
+                    const auto until_retry = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                 next_retry_at - std::chrono::steady_clock::now())
+                                                 .count();
+                    if (until_retry < timeout_ms)
+                    {
+                        timeout_ms = until_retry < 0 ? 0 : static_cast<int>(until_retry);
+                    }
                 }
+
+                mc = vcpkg_curl_multi_poll(multi_handle.get(), nullptr, 0, timeout_ms, nullptr);
+                if (mc != CURLM_OK)
+                {
+                    Debug::println("curl_multi_wait/poll failed:");
+                    Debug::println(msg::format(msgCurlFailedGeneric, msg::exit_code = static_cast<int>(mc))
+                                       .append_raw(fmt::format(" ({}).", vcpkg_curl_multi_strerror(mc))));
+                    Checks::unreachable(VCPKG_LINE_INFO);
+                }
+            }
+        }
+    }
+
+    static std::vector<int> libcurl_bulk_operation(DiagnosticContext& context,
+                                                   View<std::string> urls,
+                                                   View<Path> outputs,
+                                                   View<std::string> headers,
+                                                   BulkDownloadListener* listener)
+    {
+        if (!outputs.empty() && outputs.size() != urls.size())
+        {
+            Checks::unreachable(VCPKG_LINE_INFO);
+        }
+
+        std::vector<CurlTransfer> transfers(urls.size());
+        for (size_t request_index = 0; request_index < urls.size(); ++request_index)
+        {
+            transfers[request_index].url = urls[request_index];
+            if (!outputs.empty())
+            {
+                transfers[request_index].output = &outputs[request_index];
+            }
+        }
+
+        CurlHeaders request_headers(headers);
+        perform_curl_transfers(context, transfers, request_headers, transfer_retry_delays.size() + 1, listener);
+
+        std::vector<int> return_codes(urls.size(), -1);
+        for (size_t request_index = 0; request_index < transfers.size(); ++request_index)
+        {
+            const auto& transfer = transfers[request_index];
+            if (!transfer.output_opened || transfer.abandoned)
+            {
+                continue;
+            }
+
+            if (transfer.curl_code == CURLE_OK)
+            {
+                return_codes[request_index] = static_cast<int>(transfer.response_code);
+            }
+            else
+            {
+                context.report_error(
+                    msg::format(msgCurlFailedGeneric, msg::exit_code = static_cast<int>(transfer.curl_code))
+                        .append_raw(fmt::format(" ({}).", vcpkg_curl_easy_strerror(transfer.curl_code))));
             }
         }
+
         return return_codes;
     }
 
@@ -297,7 +482,8 @@ namespace vcpkg
         return libcurl_bulk_operation(context,
                                       urls,
                                       {}, // no output
-                                      headers);
+                                      headers,
+                                      nullptr);
     }
 
     std::vector<int> url_heads(DiagnosticContext& context, View<std::string> urls, View<std::string> headers)
@@ -312,7 +498,20 @@ namespace vcpkg
         return libcurl_bulk_operation(context,
                                       Util::fmap(url_pairs, [](auto&& kv) -> std::string { return kv.first; }),
                                       Util::fmap(url_pairs, [](auto&& kv) -> Path { return kv.second; }),
-                                      headers);
+                                      headers,
+                                      nullptr);
+    }
+
+    std::vector<int> download_files_no_cache(DiagnosticContext& context,
+                                             View<std::pair<std::string, Path>> url_pairs,
+                                             View<std::string> headers,
+                                             BulkDownloadListener& listener)
+    {
+        return libcurl_bulk_operation(context,
+                                      Util::fmap(url_pairs, [](auto&& kv) -> std::string { return kv.first; }),
+                                      Util::fmap(url_pairs, [](auto&& kv) -> Path { return kv.second; }),
+                                      headers,
+                                      &listener);
     }
 
     bool submit_github_dependency_graph_snapshot(DiagnosticContext& context,
@@ -513,34 +712,29 @@ namespace vcpkg
         }
     }
 
+    // Downloads `raw_url` to `download_path`. If `hasher` is not null, it is cleared and then fed the downloaded
+    // bytes as they are written.
     static DownloadPrognosis perform_download(DiagnosticContext& context,
                                               MessageSink& machine_readable_progress,
                                               StringView raw_url,
                                               const Path& download_path,
-                                              View<std::string> headers)
+                                              View<std::string> headers,
+                                              Hash::Hasher* hasher)
     {
-        std::error_code ec;
-        WriteFilePointer fileptr(download_path, Append::NO, ec);
-        if (ec)
+        // Retries are left to the caller, which reports them
+        CurlTransfer transfer;
+        transfer.url = raw_url;
+        transfer.output = &download_path;
+        transfer.hasher = hasher;
+        transfer.progress = &machine_readable_progress;
+        CurlHeaders request_headers(headers);
+        perform_curl_transfers(context, {&transfer, 1}, request_headers, 1);
+        if (!transfer.output_opened)
         {
-            context.report_error(format_filesystem_call_error(ec, "fopen", {download_path}));
             return DownloadPrognosis::OtherError;
         }
 
-        CurlHeaders request_headers(headers);
-
-        CurlEasyHandle handle;
-        CURL* curl = handle.get();
-        set_common_curl_easy_options(handle, raw_url, request_headers);
-        vcpkg_curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &write_file_callback);
-        vcpkg_curl_easy_setopt(curl, CURLOPT_WRITEDATA, static_cast<void*>(&fileptr));
-        vcpkg_curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L); // change from default to enable progress
-        // curlopt_progressfunction is deprecated, but we want the values as doubles anyway and
-        // the replacement isn't available on all versions of libcurl we support
-        vcpkg_curl_easy_setopt(curl, CURLOPT_PROGRESSFUNCTION, static_cast<curl_progress_callback>(&progress_callback));
-        vcpkg_curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, static_cast<void*>(&machine_readable_progress));
-        auto curl_code = vcpkg_curl_easy_perform(curl);
-
+        const auto curl_code = transfer.curl_code;
         if (curl_code == CURLE_OPERATION_TIMEDOUT)
         {
             context.report_error(msgCurlDownloadTimeout);
@@ -554,15 +748,7 @@ namespace vcpkg
             return DownloadPrognosis::NetworkErrorProxyMightHelp;
         }
 
-        long response_code = -1;
-        auto get_info_code = vcpkg_curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-        if (get_info_code != CURLE_OK)
-        {
-            context.report_error(msg::format(msgCurlFailedGeneric, msg::exit_code = static_cast<int>(get_info_code))
-                                     .append_raw(fmt::format(" ({}).", vcpkg_curl_easy_strerror(get_info_code))));
-            return DownloadPrognosis::NetworkErrorProxyMightHelp;
-        }
-
+        const auto response_code = transfer.response_code;
         if ((response_code >= 200 && response_code < 300) || (raw_url.starts_with("file://") && response_code == 0))
         {
             return DownloadPrognosis::Success;
@@ -570,9 +756,7 @@ namespace vcpkg
 
         context.report_error(msg::format(msgCurlFailedResponse, msg::exit_code = static_cast<int>(response_code)));
 
-        if ((raw_url.starts_with("ftp://") && response_code >= 400 && response_code < 500) ||
-            (response_code == 429 || response_code == 408 || response_code == 500 || response_code == 502 ||
-             response_code == 503 || response_code == 504))
+        if (is_transient_response_code(raw_url, response_code))
         {
             return DownloadPrognosis::TransientNetworkError;
         }
@@ -611,10 +795,18 @@ namespace vcpkg
         // 504 response code. https://everything.curl.dev/usingcurl/downloads/retry.html#retry
         using namespace std::chrono_literals;
         static constexpr std::array<std::chrono::seconds, 2> attempt_delays = {1s, 2s};
+        // Each attempt rewrites the file from the beginning, so the hash is always computed as the data arrives.
+        std::unique_ptr<Hash::Hasher> hasher;
+        if (maybe_sha512 || out_sha512)
+        {
+            hasher = Hash::get_hasher_for(Hash::Algorithm::Sha512);
+        }
+
         DownloadPrognosis prognosis = DownloadPrognosis::NetworkErrorProxyMightHelp;
         for (size_t attempt_count = 0; attempt_count < attempt_delays.size(); attempt_count++)
         {
-            prognosis = perform_download(context, machine_readable_progress, raw_url, download_path_part_path, headers);
+            prognosis = perform_download(
+                context, machine_readable_progress, raw_url, download_path_part_path, headers, hasher.get());
             if (DownloadPrognosis::Success == prognosis)
             {
                 break;
@@ -639,7 +831,8 @@ namespace vcpkg
             return prognosis;
         }
 
-        if (!check_downloaded_file_hash(context, fs, sanitized_url, download_path_part_path, maybe_sha512, out_sha512))
+        if (hasher && !check_downloaded_file_hash(
+                          context, sanitized_url, download_path_part_path, maybe_sha512, hasher->get_hash(), out_sha512))
         {
             return DownloadPrognosis::OtherError;
         }
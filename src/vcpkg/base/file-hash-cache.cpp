@@ -0,0 +1,261 @@
+#include <vcpkg/base/file-hash-cache.h>
+#include <vcpkg/base/hash.h>
+#include <vcpkg/base/json.h>
+#include <vcpkg/base/messages.h>
+#include <vcpkg/base/system.h>
+
+namespace
+{
+    using namespace vcpkg;
+
+    constexpr int64_t file_hash_cache_version = 1;
+
+    // Files modified more recently than this, in units of last_write_time, are not remembered: a further
+    // modification within the resolution of the filesystem's timestamps would leave their metadata unchanged.
+#if defined(_WIN32)
+    constexpr int64_t racy_modification_window = 2 * 10'000'000;
+#else
+    constexpr int64_t racy_modification_window = 2 * 1'000'000'000;
+#endif
+
+    bool same_metadata(const FileMetadata& lhs, const FileMetadata& rhs) noexcept
+    {
+        return lhs.size == rhs.size && lhs.last_write_time == rhs.last_write_time && lhs.inode == rhs.inode;
+    }
+
+    constexpr StringLiteral JsonIdVersion = "version";
+    constexpr StringLiteral JsonIdFiles = "files";
+    constexpr StringLiteral JsonIdPath = "path";
+    constexpr StringLiteral JsonIdSize = "size";
+    constexpr StringLiteral JsonIdMtime = "mtime";
+    constexpr StringLiteral JsonIdInode = "inode";
+    constexpr StringLiteral JsonIdSha256 = "sha256";
+
+    const Json::Value* get_integer(const Json::Object& obj, StringView key)
+    {
+        auto value = obj.get(key);
+        if (value && value->is_integer())
+        {
+            return value;
+        }
+
+        return nullptr;
+    }
+}
+
+namespace vcpkg
+{
+    FileHashCache::FileHashCache(const ReadOnlyFilesystem& fs, FileHashCacheMode mode, Optional<Path> cache_file)
+        : m_mode(mode), m_cache_file(std::move(cache_file))
+    {
+        auto cache_file_path = m_cache_file.get();
+        if (mode == FileHashCacheMode::Disabled || !cache_file_path)
+        {
+            return;
+        }
+
+        std::error_code ec;
+        auto contents = fs.read_contents(*cache_file_path, ec);
+        if (ec)
+        {
+            return;
+        }
+
+        auto maybe_doc = Json::parse_object(contents, *cache_file_path);
+        auto doc = maybe_doc.get();
+        if (!doc)
+        {
+            return;
+        }
+
+        auto version = get_integer(*doc, JsonIdVersion);
+        auto files = doc->get(JsonIdFiles);
+        if (!version || version->integer(VCPKG_LINE_INFO) != file_hash_cache_version || !files || !files->is_array())
+        {
+            return;
+        }
+
+        for (auto&& file : files->array(VCPKG_LINE_INFO))
+        {
+            auto file_obj = file.maybe_object();
+            if (!file_obj) continue;
+            auto path = file_obj->get(JsonIdPath);
+            auto sha256 = file_obj->get(JsonIdSha256);
+            auto size = get_integer(*file_obj, JsonIdSize);
+            auto mtime = get_integer(*file_obj, JsonIdMtime);
+            auto inode = get_integer(*file_obj, JsonIdInode);
+            if (!path || !path->is_string() || !sha256 || !sha256->is_string() || !size || !mtime || !inode)
+            {
+                continue;
+            }
+
+            Entry entry;
+            // Sizes and inodes are stored as the bits of a signed integer, as that is what JSON numbers hold
+            entry.metadata.size = static_cast<std::uint64_t>(size->integer(VCPKG_LINE_INFO));
+            entry.metadata.last_write_time = mtime->integer(VCPKG_LINE_INFO);
+            entry.metadata.inode = static_cast<std::uint64_t>(inode->integer(VCPKG_LINE_INFO));
+            entry.sha256 = sha256->string(VCPKG_LINE_INFO).to_string();
+            m_entries.insert_or_assign(path->string(VCPKG_LINE_INFO).to_string(), std::move(entry));
+        }
+    }
+
+    ExpectedL<std::string> FileHashCache::get_file_sha256(const Filesystem& fs, const Path& path)
+    {
+        if (m_mode == FileHashCacheMode::Disabled)
+        {
+            return Hash::get_file_hash(fs, path, Hash::Algorithm::Sha256);
+        }
+
+        // The metadata is read before the contents, so that a modification while hashing is noticed next time
+        std::error_code ec;
+        const auto metadata = fs.file_metadata(path, ec);
+        if (ec)
+        {
+            return Hash::get_file_hash(fs, path, Hash::Algorithm::Sha256);
+        }
+
+        if (auto cached = lookup(path, metadata))
+        {
+            return std::move(*cached.get());
+        }
+
+        auto maybe_hash = Hash::get_file_hash(fs, path, Hash::Algorithm::Sha256);
+        if (auto hash = maybe_hash.get())
+        {
+            remember(fs, path, metadata, *hash);
+        }
+
+        return maybe_hash;
+    }
+
+    std::string FileHashCache::get_contents_sha256(const Filesystem& fs, const Path& path, StringView contents)
+    {
+        if (m_mode == FileHashCacheMode::Disabled)
+        {
+            return Hash::get_string_sha256(contents);
+        }
+
+        // If the file was modified after the caller read it, its last write time is too recent to be remembered
+        std::error_code ec;
+        const auto metadata = fs.file_metadata(path, ec);
+        if (ec)
+        {
+            return Hash::get_string_sha256(contents);
+        }
+
+        if (auto cached = lookup(path, metadata))
+        {
+            return std::move(*cached.get());
+        }
+
+        auto hash = Hash::get_string_sha256(contents);
+        remember(fs, path, metadata, hash);
+        return hash;
+    }
+
+    Optional<std::string> FileHashCache::lookup(const Path& path, const FileMetadata& metadata)
+    {
+        if (m_mode != FileHashCacheMode::Enabled)
+        {
+            return nullopt;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto it = m_entries.find(path.native());
+        if (it == m_entries.end() || !same_metadata(it->second.metadata, metadata))
+        {
+            return nullopt;
+        }
+
+        it->second.used = true;
+        return it->second.sha256;
+    }
+
+    void FileHashCache::remember(const Filesystem& fs,
+                                 const Path& path,
+                                 const FileMetadata& metadata,
+                                 const std::string& sha256)
+    {
+        const bool racy = fs.file_time_now() - metadata.last_write_time < racy_modification_window;
+        std::lock_guard<std::mutex> lock(m_mtx);
+        auto it = m_entries.find(path.native());
+        if (m_mode == FileHashCacheMode::Strict && it != m_entries.end() &&
+            same_metadata(it->second.metadata, metadata) && it->second.sha256 != sha256)
+        {
+            msg::println_warning(msgFileHashCacheStale, msg::path = path);
+        }
+
+        if (racy)
+        {
+            if (it != m_entries.end())
+            {
+                m_entries.erase(it);
+                m_dirty = true;
+            }
+
+            return;
+        }
+
+        if (it == m_entries.end())
+        {
+            it = m_entries.emplace(path.native(), Entry{}).first;
+        }
+
+        it->second.metadata = metadata;
+        it->second.sha256 = sha256;
+        it->second.used = true;
+        m_dirty = true;
+    }
+
+    void FileHashCache::save(const Filesystem& fs)
+    {
+        auto cache_file = m_cache_file.get();
+        if (m_mode == FileHashCacheMode::Disabled || !cache_file)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (!m_dirty)
+        {
+            return;
+        }
+
+        Json::Array files;
+        for (auto&& entry : m_entries)
+        {
+            // Forget files that no longer exist, so that the cache does not grow without bound
+            if (!entry.second.used && !fs.is_regular_file(entry.first))
+            {
+                continue;
+            }
+
+            auto& file_obj = files.push_back(Json::Object{});
+            file_obj.insert(JsonIdPath, entry.first);
+            file_obj.insert(JsonIdSize, Json::Value::integer(static_cast<int64_t>(entry.second.metadata.size)));
+            file_obj.insert(JsonIdMtime, Json::Value::integer(entry.second.metadata.last_write_time));
+            file_obj.insert(JsonIdInode, Json::Value::integer(static_cast<int64_t>(entry.second.metadata.inode)));
+            file_obj.insert(JsonIdSha256, entry.second.sha256);
+        }
+
+        Json::Object doc;
+        doc.insert(JsonIdVersion, Json::Value::integer(file_hash_cache_version));
+        doc.insert(JsonIdFiles, std::move(files));
+
+        std::error_code ec;
+        const Path temp_path = fmt::format("{}.{}.tmp", cache_file->native(), get_process_id());
+        fs.write_contents_and_dirs(temp_path, Json::stringify(doc, Json::JsonStyle::with_spaces(0)), ec);
+        if (!ec)
+        {
+            fs.rename(temp_path, *cache_file, ec);
+        }
+
+        if (ec)
+        {
+            fs.remove(temp_path, IgnoreErrors{});
+            return;
+        }
+
+        m_dirty = false;
+    }
+}
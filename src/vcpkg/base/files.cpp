@@ -4071,6 +4071,36 @@ namespace vcpkg
 #endif // ^^^ !_WIN32
         }
 
+        FileMetadata file_metadata(const Path& target, std::error_code& ec) const override
+        {
+            FileMetadata result;
+#if defined(_WIN32)
+            const auto native = to_stdfs_path(target);
+            result.size = stdfs::file_size(native, ec);
+            if (!ec)
+            {
+                result.last_write_time = stdfs::last_write_time(native, ec).time_since_epoch().count();
+            }
+#else // ^^^ _WIN32 // !_WIN32 vvv
+            struct stat s;
+            if (::stat(target.c_str(), &s) != 0)
+            {
+                ec.assign(errno, std::generic_category());
+                return result;
+            }
+
+            ec.clear();
+            result.size = static_cast<std::uint64_t>(s.st_size);
+#ifdef __APPLE__
+            result.last_write_time = int64_t{s.st_mtimespec.tv_sec} * 1'000'000'000 + s.st_mtimespec.tv_nsec;
+#else
+            result.last_write_time = int64_t{s.st_mtim.tv_sec} * 1'000'000'000 + s.st_mtim.tv_nsec;
+#endif
+            result.inode = static_cast<std::uint64_t>(s.st_ino);
+#endif // ^^^ !_WIN32
+            return result;
+        }
+
         virtual bool last_write_time(DiagnosticContext& context, const Path& target, int64_t new_time) const override
         {
             std::error_code ec;
@@ -4582,6 +4612,12 @@ namespace vcpkg
             return 0;
         }
 
+        FileMetadata file_metadata(const Path&, std::error_code& ec) const override
+        {
+            assign_not_supported(ec);
+            return {};
+        }
+
         bool last_write_time(DiagnosticContext& context, const Path&, int64_t) const override
         {
             context.report_system_error("last_write_time",
@@ -0,0 +1,917 @@
+#include <vcpkg/base/deflate.h>
+#include <vcpkg/base/diagnostics.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/fmt.h>
+#include <vcpkg/base/git-objects.h>
+#include <vcpkg/base/git.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.h>
+
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+
+// The formats read here are described in https://git-scm.com/docs/pack-format and
+// https://git-scm.com/book/en/v2/Git-Internals-Git-Objects
+
+namespace
+{
+    using namespace vcpkg;
+
+    using ObjectId = std::array<unsigned char, 20>;
+
+    // Types of entries in a packfile; 2 and 3 are trees and blobs
+    constexpr int PackedCommit = 1;
+    constexpr int PackedTag = 4;
+    constexpr int PackedOfsDelta = 6;
+    constexpr int PackedRefDelta = 7;
+
+    // git never writes delta chains anywhere near this long; the limit only guards against corrupt packs
+    constexpr size_t max_delta_chain = 10000;
+    // Reconstructed objects which were the base of a delta are kept, as neighbouring objects usually share bases
+    constexpr size_t delta_base_cache_limit = 64 * 1024 * 1024;
+    constexpr int max_tree_depth = 256;
+    constexpr int max_alternates_depth = 5;
+
+    constexpr StringLiteral PackIndexMagic = "\377tOc";
+    constexpr size_t pack_index_fanout_offset = 8;
+    constexpr size_t pack_index_ids_offset = pack_index_fanout_offset + 256 * 4;
+
+    int from_hex_digit(char ch) noexcept
+    {
+        if ('0' <= ch && ch <= '9') return ch - '0';
+        if ('a' <= ch && ch <= 'f') return ch - 'a' + 10;
+        if ('A' <= ch && ch <= 'F') return ch - 'A' + 10;
+        return -1;
+    }
+
+    Optional<ObjectId> parse_object_id(StringView hex)
+    {
+        ObjectId result;
+        if (hex.size() != result.size() * 2)
+        {
+            return nullopt;
+        }
+
+        for (size_t idx = 0; idx < result.size(); ++idx)
+        {
+            const int high = from_hex_digit(hex[idx * 2]);
+            const int low = from_hex_digit(hex[idx * 2 + 1]);
+            if (high < 0 || low < 0)
+            {
+                return nullopt;
+            }
+
+            result[idx] = static_cast<unsigned char>(high * 16 + low);
+        }
+
+        return result;
+    }
+
+    std::string format_object_id(const ObjectId& id)
+    {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string result;
+        result.reserve(id.size() * 2);
+        for (auto byte : id)
+        {
+            result.push_back(digits[byte >> 4]);
+            result.push_back(digits[byte & 0xF]);
+        }
+
+        return result;
+    }
+
+    uint32_t read_be32(const char* data) noexcept
+    {
+        const auto bytes = reinterpret_cast<const unsigned char*>(data);
+        return (uint32_t{bytes[0]} << 24) | (uint32_t{bytes[1]} << 16) | (uint32_t{bytes[2]} << 8) | bytes[3];
+    }
+
+    Optional<GitObjectType> parse_loose_object_type(StringView name)
+    {
+        if (name == "commit") return GitObjectType::Commit;
+        if (name == "tree") return GitObjectType::Tree;
+        if (name == "blob") return GitObjectType::Blob;
+        if (name == "tag") return GitObjectType::Tag;
+        return nullopt;
+    }
+
+    struct StringInflateSink final : Deflate::InflateSink
+    {
+        StringInflateSink(std::string& out, uint64_t limit) : out(out), limit(limit) { }
+
+        bool write(const void* buffer, size_t size) override
+        {
+            if (out.size() + size > limit)
+            {
+                return false;
+            }
+
+            out.append(static_cast<const char*>(buffer), size);
+            return true;
+        }
+
+        std::string& out;
+        uint64_t limit;
+    };
+
+    struct FileInflateSource final : Deflate::InflateSource
+    {
+        explicit FileInflateSource(const ReadFilePointer& file) : file(file) { }
+
+        size_t read(void* buffer, size_t size) override { return file.read(buffer, 1, size); }
+
+        const ReadFilePointer& file;
+    };
+
+    // Reads the little endian base 128 sizes at the start of a delta
+    bool read_delta_size(StringView delta, size_t& position, uint64_t& size)
+    {
+        size = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (position == delta.size())
+            {
+                return false;
+            }
+
+            const auto byte = static_cast<unsigned char>(delta[position++]);
+            size |= uint64_t{byte & 0x7Fu} << shift;
+            if (!(byte & 0x80))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    Optional<std::string> apply_delta(StringView base, StringView delta)
+    {
+        size_t position = 0;
+        uint64_t base_size;
+        uint64_t result_size;
+        if (!read_delta_size(delta, position, base_size) || base_size != base.size() ||
+            !read_delta_size(delta, position, result_size))
+        {
+            return nullopt;
+        }
+
+        std::string result;
+        result.reserve(static_cast<size_t>(result_size));
+        while (position < delta.size())
+        {
+            const auto op = static_cast<unsigned char>(delta[position++]);
+            if (op & 0x80)
+            {
+                // Copy from the base: the low 7 bits say which bytes of the offset and size are present
+                uint64_t values[2] = {0, 0};
+                for (int bit = 0; bit < 7; ++bit)
+                {
+                    if (!(op & (1 << bit)))
+                    {
+                        continue;
+                    }
+
+                    if (position == delta.size())
+                    {
+                        return nullopt;
+                    }
+
+                    const auto byte = static_cast<unsigned char>(delta[position++]);
+                    values[bit >= 4] |= uint64_t{byte} << (8 * (bit >= 4 ? bit - 4 : bit));
+                }
+
+                const uint64_t offset = values[0];
+                const uint64_t size = values[1] == 0 ? 0x10000 : values[1];
+                if (offset > base.size() || size > base.size() - offset)
+                {
+                    return nullopt;
+                }
+
+                result.append(base.data() + offset, static_cast<size_t>(size));
+            }
+            else if (op != 0)
+            {
+                // Insert the next `op` bytes of the delta
+                if (op > delta.size() - position)
+                {
+                    return nullopt;
+                }
+
+                result.append(delta.data() + position, op);
+                position += op;
+            }
+            else
+            {
+                return nullopt;
+            }
+        }
+
+        if (result.size() != result_size)
+        {
+            return nullopt;
+        }
+
+        return result;
+    }
+
+    struct TreeEntry
+    {
+        StringView mode;
+        StringView name;
+        ObjectId id;
+    };
+
+    bool parse_tree(StringView data, std::vector<TreeEntry>& entries)
+    {
+        entries.clear();
+        auto first = data.begin();
+        const auto last = data.end();
+        while (first != last)
+        {
+            const auto space = std::find(first, last, ' ');
+            const auto nul = std::find(space, last, '\0');
+            if (space == last || nul == last || static_cast<size_t>(last - nul - 1) < ObjectId{}.size())
+            {
+                return false;
+            }
+
+            auto& entry = entries.emplace_back();
+            entry.mode = StringView{first, space};
+            entry.name = StringView{space + 1, nul};
+            memcpy(entry.id.data(), nul + 1, entry.id.size());
+            first = nul + 1 + entry.id.size();
+        }
+
+        return true;
+    }
+
+    // Finds the id following `header` in the header lines of a commit or tag
+    Optional<ObjectId> find_header_id(StringView data, StringLiteral header)
+    {
+        for (auto&& line : Strings::split(data, '\n'))
+        {
+            if (line.empty())
+            {
+                break;
+            }
+
+            if (line.size() > header.size() && Strings::starts_with(line, header) && line[header.size()] == ' ')
+            {
+                return parse_object_id(StringView{line}.substr(header.size() + 1));
+            }
+        }
+
+        return nullopt;
+    }
+
+    // Whether `name` can be written as given; git itself refuses to check out trees containing other names
+    bool is_safe_tree_entry_name(StringView name)
+    {
+        return !name.empty() && name != "." && name != ".." && !Strings::case_insensitive_ascii_equals(name, ".git") &&
+               std::none_of(name.begin(), name.end(), [](char ch) { return ch == '/' || ch == '\\' || ch == ':'; });
+    }
+
+    void add_object_dir(const ReadOnlyFilesystem& fs, std::vector<Path>& object_dirs, Path dir, int depth)
+    {
+        if (depth > max_alternates_depth ||
+            std::any_of(object_dirs.begin(), object_dirs.end(), [&](const Path& existing) {
+                return existing.native() == dir.native();
+            }))
+        {
+            return;
+        }
+
+        object_dirs.push_back(dir);
+        std::error_code ec;
+        const auto alternates = fs.read_contents(dir / "info" / "alternates", ec);
+        if (ec)
+        {
+            return;
+        }
+
+        for (auto&& line : Strings::split(alternates, '\n'))
+        {
+            auto alternate = Strings::trim(StringView{line});
+            // Quoted paths are not supported
+            if (alternate.empty() || alternate[0] == '#' || alternate[0] == '"')
+            {
+                continue;
+            }
+
+            add_object_dir(fs, object_dirs, (dir / alternate).lexically_normal(), depth + 1);
+        }
+    }
+}
+
+namespace vcpkg
+{
+    struct GitObjectDatabase::Pack
+    {
+        Path pack_path;
+        std::string index;
+        uint32_t count = 0;
+        ReadFilePointer file;
+    };
+
+    GitObjectDatabase::GitObjectDatabase(const ReadOnlyFilesystem& fs, const Path& git_dir) : m_fs(fs)
+    {
+        // Linked worktrees share the object database of the repository named by their commondir file
+        Path common_dir = git_dir;
+        std::error_code ec;
+        auto commondir = fs.read_contents(git_dir / "commondir", ec);
+        if (!ec)
+        {
+            Strings::inplace_trim(commondir);
+            if (!commondir.empty())
+            {
+                common_dir = (git_dir / commondir).lexically_normal();
+            }
+        }
+
+        add_object_dir(fs, m_object_dirs, common_dir / "objects", 0);
+    }
+
+    GitObjectDatabase::~GitObjectDatabase() = default;
+
+    Optional<GitObject> GitObjectDatabase::read_object(StringView sha)
+    {
+        auto maybe_id = parse_object_id(sha);
+        if (auto id = maybe_id.get())
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            return read_object_locked(*id);
+        }
+
+        return nullopt;
+    }
+
+    Optional<std::string> GitObjectDatabase::resolve(StringView treeish)
+    {
+        const auto colon = std::find(treeish.begin(), treeish.end(), ':');
+        auto maybe_id = parse_object_id(StringView{treeish.begin(), colon});
+        auto id = maybe_id.get();
+        if (!id)
+        {
+            return nullopt;
+        }
+
+        if (colon == treeish.end())
+        {
+            return format_object_id(*id);
+        }
+
+        auto maybe_current = peel_to_tree(*id);
+        auto current = maybe_current.get();
+        if (!current)
+        {
+            return nullopt;
+        }
+
+        std::vector<TreeEntry> entries;
+        for (auto&& component : Strings::split(StringView{colon + 1, treeish.end()}, '/'))
+        {
+            if (component == "." || component == "..")
+            {
+                return nullopt;
+            }
+
+            auto maybe_tree = read_object(format_object_id(*current));
+            auto tree = maybe_tree.get();
+            if (!tree || tree->type != GitObjectType::Tree || !parse_tree(tree->data, entries))
+            {
+                return nullopt;
+            }
+
+            auto entry = std::find_if(
+                entries.begin(), entries.end(), [&](const TreeEntry& entry) { return entry.name == component; });
+            if (entry == entries.end())
+            {
+                return nullopt;
+            }
+
+            *current = entry->id;
+        }
+
+        return format_object_id(*current);
+    }
+
+    Optional<std::string> GitObjectDatabase::read_blob(StringView treeish)
+    {
+        auto maybe_id = resolve(treeish);
+        if (auto id = maybe_id.get())
+        {
+            auto maybe_object = read_object(*id);
+            if (auto object = maybe_object.get())
+            {
+                if (object->type == GitObjectType::Blob)
+                {
+                    return std::move(object->data);
+                }
+            }
+        }
+
+        return nullopt;
+    }
+
+    bool GitObjectDatabase::extract_tree(const Filesystem& fs, StringView treeish, const Path& destination)
+    {
+        auto maybe_id = resolve(treeish).then([](std::string&& id) { return parse_object_id(id); });
+        auto id = maybe_id.get();
+        if (!id)
+        {
+            return false;
+        }
+
+        auto maybe_tree = peel_to_tree(*id);
+        auto tree = maybe_tree.get();
+        if (!tree)
+        {
+            return false;
+        }
+
+        // Several threads may extract the same tree at once; only the first rename succeeds
+        static std::atomic<uint64_t> next_extraction{0};
+        Path temp = fmt::format("{}_{}_objects{}.tmp", destination, get_process_id(), next_extraction++);
+        temp.make_generic();
+        std::error_code ec;
+        auto parent = destination.parent_path();
+        if (!parent.empty())
+        {
+            fs.create_directories(parent, ec);
+        }
+
+        fs.remove_all(temp, ec);
+        if (ec || !fs.create_directory(temp, ec) || ec)
+        {
+            return false;
+        }
+
+        if (!write_tree(fs, *tree, temp, 0) || !fs.rename_or_delete(temp, destination, ec) || ec)
+        {
+            fs.remove_all(temp, IgnoreErrors{});
+            return false;
+        }
+
+        return true;
+    }
+
+    Optional<GitObject> GitObjectDatabase::read_object_locked(const ObjectId& id)
+    {
+        if (!m_packs_scanned)
+        {
+            scan_packs();
+            m_packs_scanned = true;
+        }
+
+        auto maybe_location = find_packed(id);
+        if (auto location = maybe_location.get())
+        {
+            return read_packed(*location);
+        }
+
+        auto maybe_loose = read_loose(id);
+        if (maybe_loose.has_value())
+        {
+            return maybe_loose;
+        }
+
+        // The object may have been packed since the packs were scanned, for example by a fetch or gc
+        if (scan_packs())
+        {
+            maybe_location = find_packed(id);
+            if (auto location = maybe_location.get())
+            {
+                return read_packed(*location);
+            }
+        }
+
+        return nullopt;
+    }
+
+    Optional<GitObject> GitObjectDatabase::read_loose(const ObjectId& id)
+    {
+        const auto hex = format_object_id(id);
+        for (auto&& object_dir : m_object_dirs)
+        {
+            std::error_code ec;
+            const auto compressed = m_fs.read_contents(object_dir / StringView{hex}.substr(0, 2) / hex.substr(2), ec);
+            if (ec)
+            {
+                continue;
+            }
+
+            auto maybe_contents = Deflate::inflate_zlib(compressed);
+            auto contents = maybe_contents.get();
+            if (!contents)
+            {
+                return nullopt;
+            }
+
+            // Loose objects start with a "type size\0" header
+            const auto nul = contents->find('\0');
+            const auto space = contents->find(' ');
+            if (nul == std::string::npos || space > nul)
+            {
+                return nullopt;
+            }
+
+            auto maybe_type = parse_loose_object_type(StringView{*contents}.substr(0, space));
+            auto maybe_size = Strings::strto<uint64_t>(StringView{*contents}.substr(space + 1, nul - space - 1));
+            auto type = maybe_type.get();
+            auto size = maybe_size.get();
+            if (!type || !size || *size != contents->size() - nul - 1)
+            {
+                return nullopt;
+            }
+
+            contents->erase(0, nul + 1);
+            return GitObject{*type, std::move(*contents)};
+        }
+
+        return nullopt;
+    }
+
+    Optional<GitObject> GitObjectDatabase::read_packed(PackLocation location)
+    {
+        // Deltas are collected walking down to a complete object, then applied in reverse
+        std::vector<std::pair<PackLocation, std::string>> deltas;
+        Optional<GitObject> maybe_base;
+        for (;;)
+        {
+            auto cached = m_delta_bases.find(location);
+            if (cached != m_delta_bases.end())
+            {
+                maybe_base = cached->second;
+                break;
+            }
+
+            if (deltas.size() > max_delta_chain)
+            {
+                return nullopt;
+            }
+
+            auto& pack = *m_packs[location.first];
+            std::error_code ec;
+            if (!pack.file)
+            {
+                pack.file = m_fs.open_for_read(pack.pack_path, ec);
+                if (ec)
+                {
+                    return nullopt;
+                }
+            }
+
+            // The entry header is a type and size, followed by the base of deltas
+            unsigned char header[32];
+            if (location.second > static_cast<uint64_t>(LLONG_MAX) ||
+                !pack.file.try_seek_to(static_cast<long long>(location.second)))
+            {
+                return nullopt;
+            }
+
+            const size_t header_size = pack.file.read(header, 1, sizeof(header));
+            size_t position = 0;
+            if (header_size == 0)
+            {
+                return nullopt;
+            }
+
+            unsigned char byte = header[position++];
+            const int type = (byte >> 4) & 7;
+            uint64_t size = byte & 0xF;
+            for (int shift = 4; byte & 0x80; shift += 7)
+            {
+                if (position == header_size || shift > 57)
+                {
+                    return nullopt;
+                }
+
+                byte = header[position++];
+                size |= uint64_t{byte & 0x7Fu} << shift;
+            }
+
+            Optional<PackLocation> base_location;
+            Optional<ObjectId> base_id;
+            if (type == PackedOfsDelta)
+            {
+                if (position == header_size)
+                {
+                    return nullopt;
+                }
+
+                byte = header[position++];
+                uint64_t distance = byte & 0x7F;
+                while (byte & 0x80)
+                {
+                    if (position == header_size || distance > (UINT64_MAX >> 8))
+                    {
+                        return nullopt;
+                    }
+
+                    byte = header[position++];
+                    distance = ((distance + 1) << 7) | (byte & 0x7F);
+                }
+
+                if (distance == 0 || distance > location.second)
+                {
+                    return nullopt;
+                }
+
+                base_location.emplace(location.first, location.second - distance);
+            }
+            else if (type == PackedRefDelta)
+            {
+                ObjectId id;
+                if (header_size - position < id.size())
+                {
+                    return nullopt;
+                }
+
+                memcpy(id.data(), header + position, id.size());
+                position += id.size();
+                base_id = id;
+            }
+            else if (type < PackedCommit || type > PackedTag)
+            {
+                return nullopt;
+            }
+
+            std::string data;
+            if (!pack.file.try_seek_to(static_cast<long long>(location.second + position)))
+            {
+                return nullopt;
+            }
+
+            FileInflateSource source{pack.file};
+            StringInflateSink sink{data, size};
+            if (Deflate::inflate_zlib(source, sink).result != Deflate::InflateResult::Success || data.size() != size)
+            {
+                return nullopt;
+            }
+
+            if (auto next = base_location.get())
+            {
+                deltas.emplace_back(location, std::move(data));
+                location = *next;
+                continue;
+            }
+
+            if (auto id = base_id.get())
+            {
+                deltas.emplace_back(location, std::move(data));
+                auto maybe_next = find_packed(*id);
+                if (auto next = maybe_next.get())
+                {
+                    location = *next;
+                    continue;
+                }
+
+                maybe_base = read_loose(*id);
+                break;
+            }
+
+            static constexpr GitObjectType types[] = {
+                GitObjectType::Commit, GitObjectType::Tree, GitObjectType::Blob, GitObjectType::Tag};
+            maybe_base.emplace(GitObject{types[type - PackedCommit], std::move(data)});
+            if (!deltas.empty())
+            {
+                remember_delta_base(location, *maybe_base.get());
+            }
+
+            break;
+        }
+
+        auto base = maybe_base.get();
+        if (!base)
+        {
+            return nullopt;
+        }
+
+        for (size_t idx = deltas.size(); idx != 0; --idx)
+        {
+            auto maybe_result = apply_delta(base->data, deltas[idx - 1].second);
+            auto result = maybe_result.get();
+            if (!result)
+            {
+                return nullopt;
+            }
+
+            base->data = std::move(*result);
+            if (idx != 1)
+            {
+                remember_delta_base(deltas[idx - 1].first, *base);
+            }
+        }
+
+        return maybe_base;
+    }
+
+    void GitObjectDatabase::remember_delta_base(PackLocation location, const GitObject& object)
+    {
+        if (m_delta_bases_size + object.data.size() > delta_base_cache_limit)
+        {
+            m_delta_bases.clear();
+            m_delta_bases_size = 0;
+        }
+
+        if (m_delta_bases.emplace(location, object).second)
+        {
+            m_delta_bases_size += object.data.size();
+        }
+    }
+
+    Optional<GitObjectDatabase::PackLocation> GitObjectDatabase::find_packed(const ObjectId& id) const
+    {
+        for (size_t pack_index = 0; pack_index < m_packs.size(); ++pack_index)
+        {
+            const auto& pack = *m_packs[pack_index];
+            const char* const index = pack.index.data();
+            uint32_t first = id[0] == 0 ? 0 : read_be32(index + pack_index_fanout_offset + (id[0] - 1) * 4);
+            uint32_t last = read_be32(index + pack_index_fanout_offset + id[0] * 4);
+            while (first < last)
+            {
+                const uint32_t middle = first + (last - first) / 2;
+                const char* const candidate = index + pack_index_ids_offset + size_t{middle} * id.size();
+                const int cmp = memcmp(candidate, id.data(), id.size());
+                if (cmp < 0)
+                {
+                    first = middle + 1;
+                }
+                else if (cmp > 0)
+                {
+                    last = middle;
+                }
+                else
+                {
+                    // Offsets with the high bit set are indexes into a table of 8 byte offsets for large packs
+                    const size_t offsets = pack_index_ids_offset + size_t{pack.count} * (id.size() + 4);
+                    const uint32_t offset = read_be32(index + offsets + size_t{middle} * 4);
+                    if (!(offset & 0x80000000u))
+                    {
+                        return PackLocation{pack_index, offset};
+                    }
+
+                    const size_t large_offset = offsets + size_t{pack.count} * 4 + size_t{offset & 0x7FFFFFFFu} * 8;
+                    if (large_offset + 8 > pack.index.size() - 40)
+                    {
+                        return nullopt;
+                    }
+
+                    const uint64_t high = read_be32(index + large_offset);
+                    return PackLocation{pack_index, (high << 32) | read_be32(index + large_offset + 4)};
+                }
+            }
+        }
+
+        return nullopt;
+    }
+
+    Optional<GitObjectDatabase::ObjectId> GitObjectDatabase::peel_to_tree(const ObjectId& id)
+    {
+        ObjectId current = id;
+        // Tags may point at other tags, but not forever
+        for (int depth = 0; depth < 16; ++depth)
+        {
+            auto maybe_object = read_object(format_object_id(current));
+            auto object = maybe_object.get();
+            if (!object)
+            {
+                return nullopt;
+            }
+
+            switch (object->type)
+            {
+                case GitObjectType::Tree: return current;
+                case GitObjectType::Commit: return find_header_id(object->data, "tree");
+                case GitObjectType::Tag:
+                {
+                    auto maybe_target = find_header_id(object->data, "object");
+                    if (auto target = maybe_target.get())
+                    {
+                        current = *target;
+                        continue;
+                    }
+
+                    return nullopt;
+                }
+                case GitObjectType::Blob: return nullopt;
+                default: Checks::unreachable(VCPKG_LINE_INFO);
+            }
+        }
+
+        return nullopt;
+    }
+
+    bool GitObjectDatabase::write_tree(const Filesystem& fs, const ObjectId& tree, const Path& destination, int depth)
+    {
+        auto maybe_object = read_object(format_object_id(tree));
+        auto object = maybe_object.get();
+        std::vector<TreeEntry> entries;
+        if (depth > max_tree_depth || !object || object->type != GitObjectType::Tree ||
+            !parse_tree(object->data, entries))
+        {
+            return false;
+        }
+
+        for (auto&& entry : entries)
+        {
+            // Attributes could ask for the contents to be converted, which git applies but this reader does not
+            if (!is_safe_tree_entry_name(entry.name) || entry.name == ".gitattributes")
+            {
+                return false;
+            }
+
+            const auto target = destination / entry.name;
+            std::error_code ec;
+            if (entry.mode == "40000")
+            {
+                if (!fs.create_directory(target, ec) || ec || !write_tree(fs, entry.id, target, depth + 1))
+                {
+                    return false;
+                }
+
+                continue;
+            }
+
+            const bool executable = entry.mode == "100755";
+            if (!executable && entry.mode != "100644" && entry.mode != "100664")
+            {
+                // Symbolic links and submodules
+                return false;
+            }
+
+            auto maybe_blob = read_object(format_object_id(entry.id));
+            auto blob = maybe_blob.get();
+            if (!blob || blob->type != GitObjectType::Blob)
+            {
+                return false;
+            }
+
+            fs.write_contents(target, blob->data, ec);
+            if (ec || (executable && !fs.set_executable(null_diagnostic_context, target)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool GitObjectDatabase::scan_packs()
+    {
+        bool added = false;
+        for (auto&& object_dir : m_object_dirs)
+        {
+            std::error_code ec;
+            auto files = m_fs.get_files_non_recursive(object_dir / "pack", ec);
+            if (ec)
+            {
+                continue;
+            }
+
+            std::sort(files.begin(), files.end());
+            for (auto&& file : files)
+            {
+                if (file.extension() != ".idx" || !m_scanned_pack_indexes.insert(file.native()).second)
+                {
+                    continue;
+                }
+
+                auto pack = std::make_unique<Pack>();
+                const auto& index_path = file.native();
+                pack->pack_path = fmt::format("{}.pack", StringView{index_path}.substr(0, index_path.size() - 4));
+                pack->index = m_fs.read_contents(file, ec);
+                if (ec || pack->index.size() < pack_index_ids_offset + 40 ||
+                    !Strings::starts_with(pack->index, PackIndexMagic) || read_be32(pack->index.data() + 4) != 2)
+                {
+                    continue;
+                }
+
+                // The fanout table must not decrease, and the index must hold a 20 byte id, a CRC, and an offset
+                // for each object, followed by the two trailing checksums
+                bool valid = true;
+                for (size_t idx = 1; idx < 256 && valid; ++idx)
+                {
+                    valid = read_be32(pack->index.data() + pack_index_fanout_offset + (idx - 1) * 4) <=
+                            read_be32(pack->index.data() + pack_index_fanout_offset + idx * 4);
+                }
+
+                pack->count = read_be32(pack->index.data() + pack_index_fanout_offset + 255 * 4);
+                if (!valid || pack->index.size() < pack_index_ids_offset + uint64_t{pack->count} * 28 + 40)
+                {
+                    continue;
+                }
+
+                m_packs.push_back(std::move(pack));
+                added = true;
+            }
+        }
+
+        return added;
+    }
+}
@@ -11,6 +11,7 @@
 #include <vcpkg/tools.h>
 
 #include <algorithm>
+#include <atomic>
 
 // When making changes to this file, check that the git command lines intended do what is expected on
 // vcpkg's current minimum supported git version (2.7.4). You can get a version of git that old with docker:
@@ -265,10 +266,12 @@ namespace vcpkg
                           const Path& destination,
                           StringView treeish)
     {
-        auto pid = get_process_id();
-        Path git_tree_temp = fmt::format("{}_{}.tmp", destination, pid);
+        // Several threads may extract the same tree at once; only the first rename succeeds
+        static std::atomic<uint64_t> next_extraction{0};
+        auto temp_suffix = fmt::format("{}_{}", get_process_id(), next_extraction++);
+        Path git_tree_temp = fmt::format("{}_{}.tmp", destination, temp_suffix);
         git_tree_temp.make_generic();
-        Path git_tree_index = fmt::format("{}_{}.index", destination, pid);
+        Path git_tree_index = fmt::format("{}_{}.index", destination, temp_suffix);
         auto parent = destination.parent_path();
         if (!parent.empty())
         {
@@ -17,6 +17,39 @@
 #define NT_SUCCESS(Status) (((NTSTATUS)(Status)) >= 0)
 #endif
 
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define VCPKG_HASH_SHA_NI
+#include <cpuid.h>
+#include <immintrin.h>
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+// clang only declares the crypto intrinsics when the extension is enabled for the whole translation unit, while gcc
+// declares them unconditionally and allows enabling the extension per function.
+#if defined(__ARM_FEATURE_SHA2)
+#define VCPKG_HASH_ARMV8_SHA256
+#define VCPKG_HASH_ARMV8_SHA256_TARGET
+#elif !defined(__clang__)
+#define VCPKG_HASH_ARMV8_SHA256
+#define VCPKG_HASH_ARMV8_SHA256_TARGET __attribute__((target("+sha2")))
+#endif
+#if defined(__ARM_FEATURE_SHA512)
+#define VCPKG_HASH_ARMV8_SHA512
+#define VCPKG_HASH_ARMV8_SHA512_TARGET
+#elif !defined(__clang__)
+#define VCPKG_HASH_ARMV8_SHA512
+#define VCPKG_HASH_ARMV8_SHA512_TARGET __attribute__((target("+sha3")))
+#endif
+#include <arm_neon.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_SHA2
+#define HWCAP_SHA2 (1 << 6)
+#endif
+#ifndef HWCAP_SHA512
+#define HWCAP_SHA512 (1 << 21)
+#endif
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
 #endif
 
 namespace vcpkg::Hash
@@ -179,7 +212,7 @@ namespace vcpkg::Hash
             BCRYPT_ALG_HANDLE alg_handle = nullptr;
         };
 
-#else
+#endif
 
         template<class WordTy>
         static WordTy shl(WordTy value, int by) noexcept
@@ -202,21 +235,39 @@ namespace vcpkg::Hash
         template<class ShaAlgorithm>
         struct ShaHasher final : Hasher
         {
-            ShaHasher() = default;
+            using BlockFunction = typename ShaAlgorithm::BlockFunction;
 
-            virtual void add_bytes(const void* start, const void* end) noexcept override
+            explicit ShaHasher(BlockFunction process_blocks = &ShaAlgorithm::process_blocks) noexcept
+                : m_process_blocks(process_blocks)
             {
-                for (;;)
+            }
+
+            virtual void add_bytes(const void* start_, const void* end_) noexcept override
+            {
+                const uchar* start = static_cast<const uchar*>(start_);
+                const uchar* const end = static_cast<const uchar*>(end_);
+                if (m_current_chunk_size != 0)
                 {
-                    start = add_to_unprocessed(start, end);
+                    start = static_cast<const uchar*>(add_to_unprocessed(start, end));
                     if (!start)
                     {
-                        break; // done
+                        return; // done
                     }
 
-                    m_impl.process_full_chunk(m_chunk);
+                    m_process_blocks(m_impl.begin(), m_chunk, 1);
                     m_current_chunk_size = 0;
                 }
+
+                // whole chunks are processed in place rather than being copied into m_chunk first
+                const std::size_t full_chunks = static_cast<std::size_t>(end - start) / chunk_size;
+                if (full_chunks != 0)
+                {
+                    m_process_blocks(m_impl.begin(), start, full_chunks);
+                    start += full_chunks * chunk_size;
+                    m_message_length += full_chunks * chunk_size * 8;
+                }
+
+                add_to_unprocessed(start, end);
             }
 
             virtual void clear() noexcept override
@@ -281,7 +332,7 @@ namespace vcpkg::Hash
                     // not enough space to add the message length
                     // just resize and process full chunk
                     std::fill(chunk_begin(), chunk_end, static_cast<uchar>(0));
-                    m_impl.process_full_chunk(m_chunk);
+                    m_process_blocks(m_impl.begin(), m_chunk, 1);
                     m_current_chunk_size = 0;
                 }
 
@@ -293,7 +344,7 @@ namespace vcpkg::Hash
                     return result;
                 });
 
-                m_impl.process_full_chunk(m_chunk);
+                m_process_blocks(m_impl.begin(), m_chunk, 1);
             }
 
             auto chunk_begin() { return m_chunk + m_current_chunk_size; }
@@ -303,6 +354,7 @@ namespace vcpkg::Hash
             constexpr static std::size_t chunk_size = ShaAlgorithm::chunk_size;
 
             ShaAlgorithm m_impl{};
+            BlockFunction m_process_blocks;
 
             uchar m_chunk[chunk_size] = {};
             std::size_t m_current_chunk_size = 0;
@@ -332,13 +384,24 @@ namespace vcpkg::Hash
 
             constexpr static std::size_t number_of_rounds = 64;
 
+            // processes `count` consecutive chunks starting at `chunks`, updating `digest`
+            using BlockFunction = void (*)(std::uint32_t* digest, const uchar* chunks, std::size_t count) noexcept;
+
             Sha256Algorithm() noexcept { clear(); }
 
-            void process_full_chunk(const uchar (&chunk)[chunk_size]) noexcept
+            static void process_blocks(std::uint32_t* digest, const uchar* chunks, std::size_t count) noexcept
+            {
+                for (; count != 0; --count, chunks += chunk_size)
+                {
+                    process_full_chunk(digest, chunks);
+                }
+            }
+
+            static void process_full_chunk(std::uint32_t* digest, const uchar* chunk) noexcept
             {
                 std::uint32_t words[64];
 
-                sha_fill_initial_words(&chunk[0], words);
+                sha_fill_initial_words(chunk, words);
 
                 for (std::size_t i = 16; i < number_of_rounds; ++i)
                 {
@@ -350,7 +413,7 @@ namespace vcpkg::Hash
                 }
 
                 std::uint32_t local[8];
-                std::copy(begin(), end(), std::begin(local));
+                std::copy(digest, digest + 8, std::begin(local));
 
                 for (std::size_t i = 0; i < number_of_rounds; ++i)
                 {
@@ -378,7 +441,7 @@ namespace vcpkg::Hash
 
                 for (std::size_t i = 0; i < 8; ++i)
                 {
-                    m_digest[i] += local[i];
+                    digest[i] += local[i];
                 }
             }
 
@@ -418,13 +481,24 @@ namespace vcpkg::Hash
 
             constexpr static std::size_t number_of_rounds = 80;
 
+            // processes `count` consecutive chunks starting at `chunks`, updating `digest`
+            using BlockFunction = void (*)(std::uint64_t* digest, const uchar* chunks, std::size_t count) noexcept;
+
             Sha512Algorithm() noexcept { clear(); }
 
-            void process_full_chunk(const uchar (&chunk)[chunk_size]) noexcept
+            static void process_blocks(std::uint64_t* digest, const uchar* chunks, std::size_t count) noexcept
+            {
+                for (; count != 0; --count, chunks += chunk_size)
+                {
+                    process_full_chunk(digest, chunks);
+                }
+            }
+
+            static void process_full_chunk(std::uint64_t* digest, const uchar* chunk) noexcept
             {
                 std::uint64_t words[80];
 
-                sha_fill_initial_words(&chunk[0], words);
+                sha_fill_initial_words(chunk, words);
 
                 for (std::size_t i = 16; i < number_of_rounds; ++i)
                 {
@@ -436,7 +510,7 @@ namespace vcpkg::Hash
                 }
 
                 std::uint64_t local[8];
-                std::copy(begin(), end(), std::begin(local));
+                std::copy(digest, digest + 8, std::begin(local));
 
                 for (std::size_t i = 0; i < number_of_rounds; ++i)
                 {
@@ -464,7 +538,7 @@ namespace vcpkg::Hash
 
                 for (std::size_t i = 0; i < 8; ++i)
                 {
-                    m_digest[i] += local[i];
+                    digest[i] += local[i];
                 }
             }
 
@@ -503,7 +577,271 @@ namespace vcpkg::Hash
 
             std::uint64_t m_digest[8];
         };
+
+#if defined(VCPKG_HASH_SHA_NI)
+        bool cpu_has_sha_ni() noexcept
+        {
+            unsigned int eax;
+            unsigned int ebx;
+            unsigned int ecx;
+            unsigned int edx;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            {
+                return false;
+            }
+
+            constexpr unsigned int ssse3 = 1u << 9;
+            if ((ecx & ssse3) == 0 || __get_cpuid_max(0, nullptr) < 7)
+            {
+                return false;
+            }
+
+            __cpuid_count(7, 0, eax, ebx, ecx, edx);
+            return (ebx & (1u << 29)) != 0;
+        }
+
+        // The sha256rnds2 instruction keeps the state as ABEF and CDGH rather than ABCD and EFGH, so the digest is
+        // shuffled on the way in and out. Intrinsics taking immediate byte shifts (palignr) are avoided because some
+        // toolchains cannot fold their operands in unoptimized builds.
+        __attribute__((target("sha,ssse3"))) void sha256_process_blocks_sha_ni(std::uint32_t* digest,
+                                                                               const uchar* chunks,
+                                                                               std::size_t count) noexcept
+        {
+            const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bll, 0x0405060700010203ll);
+            const __m128i abcd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digest));
+            const __m128i efgh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(digest + 4));
+            __m128i state0 = _mm_shuffle_epi32(_mm_unpacklo_epi64(efgh, abcd), 0xB1);
+            __m128i state1 = _mm_shuffle_epi32(_mm_unpackhi_epi64(efgh, abcd), 0xB1);
+
+            for (; count != 0; --count, chunks += Sha256Algorithm::chunk_size)
+            {
+                const __m128i saved0 = state0;
+                const __m128i saved1 = state1;
+
+                __m128i words[4];
+                for (std::size_t i = 0; i < 4; ++i)
+                {
+                    words[i] =
+                        _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(chunks + 16 * i)), byte_swap);
+                }
+
+                // each group of 4 rounds consumes words[group % 4], which is then replaced by the schedule 4 groups on
+                for (std::size_t group = 0; group < 16; ++group)
+                {
+                    __m128i& current = words[group % 4];
+                    const auto constants = Sha256Algorithm::round_constants + 4 * group;
+                    const __m128i message =
+                        _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<const __m128i*>(constants)));
+                    state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+                    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(message, 0x0E));
+                    if (group < 12)
+                    {
+                        const __m128i& next = words[(group + 1) % 4];
+                        const __m128i& third = words[(group + 2) % 4];
+                        const __m128i& last = words[(group + 3) % 4];
+                        // the last word of `third` and the first of `last`
+                        const __m128i middle = _mm_shuffle_epi32(
+                            _mm_castps_si128(_mm_move_ss(_mm_castsi128_ps(third), _mm_castsi128_ps(last))), 0x39);
+                        current = _mm_sha256msg2_epu32(
+                            _mm_add_epi32(_mm_sha256msg1_epu32(current, next), middle), last);
+                    }
+                }
+
+                state0 = _mm_add_epi32(state0, saved0);
+                state1 = _mm_add_epi32(state1, saved1);
+            }
+
+            state0 = _mm_shuffle_epi32(state0, 0xB1);
+            state1 = _mm_shuffle_epi32(state1, 0xB1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(digest), _mm_unpackhi_epi64(state0, state1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(digest + 4), _mm_unpacklo_epi64(state0, state1));
+        }
+#endif // ^^^ VCPKG_HASH_SHA_NI
+
+#if defined(VCPKG_HASH_ARMV8_SHA256)
+        VCPKG_HASH_ARMV8_SHA256_TARGET void sha256_process_blocks_armv8(std::uint32_t* digest,
+                                                                 const uchar* chunks,
+                                                                 std::size_t count) noexcept
+        {
+            uint32x4_t state0 = vld1q_u32(digest);
+            uint32x4_t state1 = vld1q_u32(digest + 4);
+            for (; count != 0; --count, chunks += Sha256Algorithm::chunk_size)
+            {
+                const uint32x4_t saved0 = state0;
+                const uint32x4_t saved1 = state1;
+
+                uint32x4_t words[4];
+                for (std::size_t i = 0; i < 4; ++i)
+                {
+                    words[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(chunks + 16 * i)));
+                }
+
+                for (std::size_t group = 0; group < 16; ++group)
+                {
+                    uint32x4_t& current = words[group % 4];
+                    const uint32x4_t message =
+                        vaddq_u32(current, vld1q_u32(Sha256Algorithm::round_constants + 4 * group));
+                    if (group < 12)
+                    {
+                        current = vsha256su1q_u32(vsha256su0q_u32(current, words[(group + 1) % 4]),
+                                                  words[(group + 2) % 4],
+                                                  words[(group + 3) % 4]);
+                    }
+
+                    const uint32x4_t abcd = state0;
+                    state0 = vsha256hq_u32(state0, state1, message);
+                    state1 = vsha256h2q_u32(state1, abcd, message);
+                }
+
+                state0 = vaddq_u32(state0, saved0);
+                state1 = vaddq_u32(state1, saved1);
+            }
+
+            vst1q_u32(digest, state0);
+            vst1q_u32(digest + 4, state1);
+        }
+#endif // ^^^ VCPKG_HASH_ARMV8_SHA256
+
+#if defined(VCPKG_HASH_ARMV8_SHA512)
+        // Each iteration performs 2 rounds, following the register usage of the sha512h and sha512h2 instructions.
+        VCPKG_HASH_ARMV8_SHA512_TARGET void sha512_process_blocks_armv8(std::uint64_t* digest,
+                                                                 const uchar* chunks,
+                                                                 std::size_t count) noexcept
+        {
+            uint64x2_t ab = vld1q_u64(digest);
+            uint64x2_t cd = vld1q_u64(digest + 2);
+            uint64x2_t ef = vld1q_u64(digest + 4);
+            uint64x2_t gh = vld1q_u64(digest + 6);
+            for (; count != 0; --count, chunks += Sha512Algorithm::chunk_size)
+            {
+                const uint64x2_t saved_ab = ab;
+                const uint64x2_t saved_cd = cd;
+                const uint64x2_t saved_ef = ef;
+                const uint64x2_t saved_gh = gh;
+
+                uint64x2_t words[8];
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    words[i] = vreinterpretq_u64_u8(vrev64q_u8(vld1q_u8(chunks + 16 * i)));
+                }
+
+                for (std::size_t pair = 0; pair < 40; ++pair)
+                {
+                    uint64x2_t& current = words[pair % 8];
+                    uint64x2_t message = vaddq_u64(current, vld1q_u64(Sha512Algorithm::round_constants + 2 * pair));
+                    message = vextq_u64(message, message, 1);
+                    const uint64x2_t fg = vextq_u64(ef, gh, 1);
+                    const uint64x2_t de = vextq_u64(cd, ef, 1);
+                    gh = vaddq_u64(gh, message);
+                    if (pair < 32)
+                    {
+                        const uint64x2_t w9_10 = vextq_u64(words[(pair + 4) % 8], words[(pair + 5) % 8], 1);
+                        current = vsha512su1q_u64(
+                            vsha512su0q_u64(current, words[(pair + 1) % 8]), words[(pair + 7) % 8], w9_10);
+                    }
+
+                    const uint64x2_t sum = vsha512hq_u64(gh, fg, de);
+                    const uint64x2_t new_ef = vaddq_u64(cd, sum);
+                    const uint64x2_t new_ab = vsha512h2q_u64(sum, cd, ab);
+                    gh = ef;
+                    ef = new_ef;
+                    cd = ab;
+                    ab = new_ab;
+                }
+
+                ab = vaddq_u64(ab, saved_ab);
+                cd = vaddq_u64(cd, saved_cd);
+                ef = vaddq_u64(ef, saved_ef);
+                gh = vaddq_u64(gh, saved_gh);
+            }
+
+            vst1q_u64(digest, ab);
+            vst1q_u64(digest + 2, cd);
+            vst1q_u64(digest + 4, ef);
+            vst1q_u64(digest + 6, gh);
+        }
+#endif // ^^^ VCPKG_HASH_ARMV8_SHA512
+
+#if defined(VCPKG_HASH_ARMV8_SHA256) || defined(VCPKG_HASH_ARMV8_SHA512)
+        bool cpu_has_armv8_sha(bool sha512) noexcept
+        {
+#if defined(__linux__)
+            return (getauxval(AT_HWCAP) & (sha512 ? HWCAP_SHA512 : HWCAP_SHA2)) != 0;
+#elif defined(__APPLE__)
+            if (!sha512)
+            {
+                return true; // every Apple arm64 processor has the SHA-256 instructions
+            }
+
+            int value = 0;
+            size_t size = sizeof(value);
+            return sysctlbyname("hw.optional.armv8_2_sha512", &value, &size, nullptr, 0) == 0 && value != 0;
+#else
+            (void)sha512;
+            return false;
+#endif
+        }
 #endif
+
+#if !defined(_WIN32)
+        // Guards against a kernel that the compiler or processor gets wrong by checking it against the portable
+        // implementation once before use.
+        template<class ShaAlgorithm>
+        bool kernel_matches_portable(typename ShaAlgorithm::BlockFunction kernel) noexcept
+        {
+            uchar chunks[ShaAlgorithm::chunk_size * 3];
+            for (std::size_t i = 0; i < sizeof(chunks); ++i)
+            {
+                chunks[i] = static_cast<uchar>(i * 7 + 3);
+            }
+
+            ShaAlgorithm expected;
+            ShaAlgorithm::process_blocks(expected.begin(), chunks, 3);
+            ShaAlgorithm actual;
+            kernel(actual.begin(), chunks, 3);
+            return std::equal(expected.begin(), expected.end(), actual.begin());
+        }
+
+        Sha256Algorithm::BlockFunction select_sha256_kernel() noexcept
+        {
+#if defined(VCPKG_HASH_SHA_NI)
+            if (cpu_has_sha_ni() && kernel_matches_portable<Sha256Algorithm>(&sha256_process_blocks_sha_ni))
+            {
+                return &sha256_process_blocks_sha_ni;
+            }
+#endif
+#if defined(VCPKG_HASH_ARMV8_SHA256)
+            if (cpu_has_armv8_sha(false) && kernel_matches_portable<Sha256Algorithm>(&sha256_process_blocks_armv8))
+            {
+                return &sha256_process_blocks_armv8;
+            }
+#endif
+            return &Sha256Algorithm::process_blocks;
+        }
+
+        Sha512Algorithm::BlockFunction select_sha512_kernel() noexcept
+        {
+#if defined(VCPKG_HASH_ARMV8_SHA512)
+            if (cpu_has_armv8_sha(true) && kernel_matches_portable<Sha512Algorithm>(&sha512_process_blocks_armv8))
+            {
+                return &sha512_process_blocks_armv8;
+            }
+#endif
+            return &Sha512Algorithm::process_blocks;
+        }
+
+        Sha256Algorithm::BlockFunction sha256_kernel() noexcept
+        {
+            static const auto kernel = select_sha256_kernel();
+            return kernel;
+        }
+
+        Sha512Algorithm::BlockFunction sha512_kernel() noexcept
+        {
+            static const auto kernel = select_sha512_kernel();
+            return kernel;
+        }
+#endif // ^^^ !_WIN32
     }
 
     std::unique_ptr<Hasher> get_hasher_for(Algorithm algo)
@@ -511,13 +849,23 @@ namespace vcpkg::Hash
 #if defined(_WIN32)
         return std::make_unique<BCryptHasher>(algo);
 #else
+        switch (algo)
+        {
+            case Algorithm::Sha256: return std::make_unique<ShaHasher<Sha256Algorithm>>(sha256_kernel());
+            case Algorithm::Sha512: return std::make_unique<ShaHasher<Sha512Algorithm>>(sha512_kernel());
+            default: Checks::unreachable(VCPKG_LINE_INFO);
+        }
+#endif
+    }
+
+    std::unique_ptr<Hasher> get_portable_hasher_for(Algorithm algo)
+    {
         switch (algo)
         {
             case Algorithm::Sha256: return std::make_unique<ShaHasher<Sha256Algorithm>>();
             case Algorithm::Sha512: return std::make_unique<ShaHasher<Sha512Algorithm>>();
             default: Checks::unreachable(VCPKG_LINE_INFO);
         }
-#endif
     }
 
     template<class ReturnType, class F>
@@ -530,11 +878,11 @@ namespace vcpkg::Hash
         {
             case Algorithm::Sha256:
             {
-                return f(ShaHasher<Sha256Algorithm>());
+                return f(ShaHasher<Sha256Algorithm>(sha256_kernel()));
             }
             case Algorithm::Sha512:
             {
-                return f(ShaHasher<Sha512Algorithm>());
+                return f(ShaHasher<Sha512Algorithm>(sha512_kernel()));
             }
             default: Checks::unreachable(VCPKG_LINE_INFO);
         }
@@ -12,7 +12,11 @@
 
 #include <math.h>
 
+#include <algorithm>
 #include <atomic>
+#include <functional>
+#include <string_view>
+#include <unordered_set>
 #include <type_traits>
 
 namespace vcpkg::Json
@@ -22,102 +26,7 @@ namespace vcpkg::Json
     using VK = ValueKind;
 
     // struct Value {
-    namespace impl
-    {
-        // TODO: add a value_kind value template once we get rid of VS2015 support
-        template<ValueKind Vk>
-        using ValueKindConstant = std::integral_constant<ValueKind, Vk>;
-
-        struct ValueImpl
-        {
-            VK tag;
-            union
-            {
-                std::nullptr_t null;
-                bool boolean;
-                int64_t integer;
-                double number;
-                std::string string;
-                Array array;
-                Object object;
-            };
-
-            ValueImpl(ValueKindConstant<VK::Null> vk, std::nullptr_t) : tag(vk), null() { }
-            ValueImpl(ValueKindConstant<VK::Boolean> vk, bool b) : tag(vk), boolean(b) { }
-            ValueImpl(ValueKindConstant<VK::Integer> vk, int64_t i) : tag(vk), integer(i) { }
-            ValueImpl(ValueKindConstant<VK::Number> vk, double d) : tag(vk), number(d) { }
-            ValueImpl(ValueKindConstant<VK::String> vk, std::string&& s) : tag(vk), string(std::move(s)) { }
-            ValueImpl(ValueKindConstant<VK::String> vk, const std::string& s) : tag(vk), string(s) { }
-            ValueImpl(ValueKindConstant<VK::Array> vk, Array&& arr) : tag(vk), array(std::move(arr)) { }
-            ValueImpl(ValueKindConstant<VK::Array> vk, const Array& arr) : tag(vk), array(arr) { }
-            ValueImpl(ValueKindConstant<VK::Object> vk, Object&& obj) : tag(vk), object(std::move(obj)) { }
-            ValueImpl(ValueKindConstant<VK::Object> vk, const Object& obj) : tag(vk), object(obj) { }
-
-            ValueImpl& operator=(ValueImpl&& other) noexcept
-            {
-                switch (other.tag)
-                {
-                    case VK::Null: return internal_assign(VK::Null, &ValueImpl::null, other);
-                    case VK::Boolean: return internal_assign(VK::Boolean, &ValueImpl::boolean, other);
-                    case VK::Integer: return internal_assign(VK::Integer, &ValueImpl::integer, other);
-                    case VK::Number: return internal_assign(VK::Number, &ValueImpl::number, other);
-                    case VK::String: return internal_assign(VK::String, &ValueImpl::string, other);
-                    case VK::Array: return internal_assign(VK::Array, &ValueImpl::array, other);
-                    case VK::Object: return internal_assign(VK::Object, &ValueImpl::object, other);
-                    default: Checks::unreachable(VCPKG_LINE_INFO);
-                }
-            }
-
-            ~ValueImpl() { destroy_underlying(); }
-
-        private:
-            template<class T>
-            ValueImpl& internal_assign(ValueKind vk, T ValueImpl::* mp, ValueImpl& other) noexcept
-            {
-                if (tag == vk)
-                {
-                    this->*mp = std::move(other.*mp);
-                }
-                else
-                {
-                    destroy_underlying();
-                    auto* address = &(this->*mp);
-                    new (address) T(std::move(other.*mp));
-                    tag = vk;
-                }
-
-                return *this;
-            }
-
-            void destroy_underlying() noexcept
-            {
-                switch (tag)
-                {
-                    case VK::String: string.~basic_string(); break;
-                    case VK::Array: array.~Array(); break;
-                    case VK::Object: object.~Object(); break;
-                    default: break;
-                }
-                new (&null) std::nullptr_t();
-                tag = VK::Null;
-            }
-        };
-    }
-
-    using impl::ValueImpl;
-    using impl::ValueKindConstant;
-
-    VK Value::kind() const noexcept
-    {
-        if (underlying_)
-        {
-            return underlying_->tag;
-        }
-        else
-        {
-            return VK::Null;
-        }
-    }
+    VK Value::kind() const noexcept { return static_cast<VK>(underlying_.index()); }
 
     bool Value::is_null() const noexcept { return kind() == VK::Null; }
     bool Value::is_boolean() const noexcept { return kind() == VK::Boolean; }
@@ -133,20 +42,21 @@ namespace vcpkg::Json
 
     bool Value::boolean(LineInfo li) const noexcept
     {
-        vcpkg::Checks::check_exit(li, is_boolean());
-        return underlying_->boolean;
+        auto b = std::get_if<bool>(&underlying_);
+        vcpkg::Checks::check_exit(li, b != nullptr);
+        return *b;
     }
     int64_t Value::integer(LineInfo li) const noexcept
     {
-        vcpkg::Checks::check_exit(li, is_integer());
-        return underlying_->integer;
+        auto i = std::get_if<int64_t>(&underlying_);
+        vcpkg::Checks::check_exit(li, i != nullptr);
+        return *i;
     }
     double Value::number(LineInfo li) const noexcept
     {
-        auto k = kind();
-        if (k == VK::Number)
+        if (auto d = std::get_if<double>(&underlying_))
         {
-            return underlying_->number;
+            return *d;
         }
         else
         {
@@ -155,47 +65,34 @@ namespace vcpkg::Json
     }
     StringView Value::string(LineInfo li) const noexcept
     {
-        vcpkg::Checks::msg_check_exit(li, is_string(), msgJsonValueNotString);
-        return underlying_->string;
+        auto s = maybe_string();
+        vcpkg::Checks::msg_check_exit(li, s != nullptr, msgJsonValueNotString);
+        return *s;
     }
 
-    std::string* Value::maybe_string() noexcept
-    {
-        if (underlying_ && underlying_->tag == VK::String)
-        {
-            return &underlying_->string;
-        }
+    std::string* Value::maybe_string() noexcept { return std::get_if<std::string>(&underlying_); }
 
-        return nullptr;
-    }
-
-    const std::string* Value::maybe_string() const noexcept
-    {
-        if (underlying_ && underlying_->tag == VK::String)
-        {
-            return &underlying_->string;
-        }
-
-        return nullptr;
-    }
+    const std::string* Value::maybe_string() const noexcept { return std::get_if<std::string>(&underlying_); }
 
     const Array& Value::array(LineInfo li) const& noexcept
     {
-        vcpkg::Checks::msg_check_exit(li, is_array(), msgJsonValueNotArray);
-        return underlying_->array;
+        auto arr = maybe_array();
+        vcpkg::Checks::msg_check_exit(li, arr != nullptr, msgJsonValueNotArray);
+        return *arr;
     }
     Array& Value::array(LineInfo li) & noexcept
     {
-        vcpkg::Checks::msg_check_exit(li, is_array(), msgJsonValueNotArray);
-        return underlying_->array;
+        auto arr = maybe_array();
+        vcpkg::Checks::msg_check_exit(li, arr != nullptr, msgJsonValueNotArray);
+        return *arr;
     }
     Array&& Value::array(LineInfo li) && noexcept { return std::move(this->array(li)); }
 
     Array* Value::maybe_array() noexcept
     {
-        if (underlying_ && underlying_->tag == VK::Array)
+        if (auto arr = std::get_if<std::unique_ptr<Array>>(&underlying_))
         {
-            return &underlying_->array;
+            return arr->get();
         }
 
         return nullptr;
@@ -203,9 +100,9 @@ namespace vcpkg::Json
 
     const Array* Value::maybe_array() const noexcept
     {
-        if (underlying_ && underlying_->tag == VK::Array)
+        if (auto arr = std::get_if<std::unique_ptr<Array>>(&underlying_))
         {
-            return &underlying_->array;
+            return arr->get();
         }
 
         return nullptr;
@@ -213,21 +110,23 @@ namespace vcpkg::Json
 
     const Object& Value::object(LineInfo li) const& noexcept
     {
-        vcpkg::Checks::msg_check_exit(li, is_object(), msgJsonValueNotObject);
-        return underlying_->object;
+        auto obj = maybe_object();
+        vcpkg::Checks::msg_check_exit(li, obj != nullptr, msgJsonValueNotObject);
+        return *obj;
     }
     Object& Value::object(LineInfo li) & noexcept
     {
-        vcpkg::Checks::msg_check_exit(li, is_object(), msgJsonValueNotObject);
-        return underlying_->object;
+        auto obj = maybe_object();
+        vcpkg::Checks::msg_check_exit(li, obj != nullptr, msgJsonValueNotObject);
+        return *obj;
     }
     Object&& Value::object(LineInfo li) && noexcept { return std::move(this->object(li)); }
 
     Object* Value::maybe_object() noexcept
     {
-        if (underlying_ && underlying_->tag == VK::Object)
+        if (auto obj = std::get_if<std::unique_ptr<Object>>(&underlying_))
         {
-            return &underlying_->object;
+            return obj->get();
         }
 
         return nullptr;
@@ -235,94 +134,78 @@ namespace vcpkg::Json
 
     const Object* Value::maybe_object() const noexcept
     {
-        if (underlying_ && underlying_->tag == VK::Object)
+        if (auto obj = std::get_if<std::unique_ptr<Object>>(&underlying_))
         {
-            return &underlying_->object;
+            return obj->get();
         }
 
         return nullptr;
     }
 
+    template<class T>
+    static T copy_underlying(const T& value)
+    {
+        return value;
+    }
+
+    static std::unique_ptr<Array> copy_underlying(const std::unique_ptr<Array>& arr)
+    {
+        return std::make_unique<Array>(*arr);
+    }
+
+    static std::unique_ptr<Object> copy_underlying(const std::unique_ptr<Object>& obj)
+    {
+        return std::make_unique<Object>(*obj);
+    }
+
     Value::Value() noexcept = default;
-    Value::Value(Value&&) noexcept = default;
-    Value& Value::operator=(Value&&) noexcept = default;
 
-    Value::Value(const Value& other)
+    // leaves other null, as moved from values have always been
+    Value::Value(Value&& other) noexcept : underlying_(std::move(other.underlying_))
     {
-        switch (other.kind())
-        {
-            case ValueKind::Null: return; // default construct underlying_
-            case ValueKind::Boolean:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Boolean>(), other.underlying_->boolean);
-                break;
-            case ValueKind::Integer:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Integer>(), other.underlying_->integer);
-                break;
-            case ValueKind::Number:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Number>(), other.underlying_->number);
-                break;
-            case ValueKind::String:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::String>(), other.underlying_->string);
-                break;
-            case ValueKind::Array:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Array>(), other.underlying_->array);
-                break;
-            case ValueKind::Object:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Object>(), other.underlying_->object);
-                break;
-            default: Checks::unreachable(VCPKG_LINE_INFO);
-        }
+        other.underlying_.emplace<std::nullptr_t>();
     }
 
-    Value& Value::operator=(const Value& other)
+    Value::Value(const Value& other)
+        : underlying_(std::visit(
+              [](const auto& alternative) {
+                  return underlying_t{std::in_place_type<std::decay_t<decltype(alternative)>>,
+                                      copy_underlying(alternative)};
+              },
+              other.underlying_))
     {
-        switch (other.kind())
-        {
-            case ValueKind::Null: underlying_.reset(); break;
-            case ValueKind::Boolean:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Boolean>(), other.underlying_->boolean);
-                break;
-            case ValueKind::Integer:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Integer>(), other.underlying_->integer);
-                break;
-            case ValueKind::Number:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Number>(), other.underlying_->number);
-                break;
-            case ValueKind::String:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::String>(), other.underlying_->string);
-                break;
-            case ValueKind::Array:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Array>(), other.underlying_->array);
-                break;
-            case ValueKind::Object:
-                underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Object>(), other.underlying_->object);
-                break;
-            default: Checks::unreachable(VCPKG_LINE_INFO);
-        }
+    }
 
+    Value& Value::operator=(Value&& other) noexcept
+    {
+        // other may be owned by this value, so it is moved out before this value is replaced
+        Value tmp(std::move(other));
+        underlying_ = std::move(tmp.underlying_);
         return *this;
     }
 
+    Value& Value::operator=(const Value& other) { return *this = Value(other); }
+
     Value::~Value() = default;
 
     Value Value::null(std::nullptr_t) noexcept { return Value(); }
     Value Value::boolean(bool b) noexcept
     {
         Value val;
-        val.underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Boolean>(), b);
+        val.underlying_.emplace<bool>(b);
         return val;
     }
     Value Value::integer(int64_t i) noexcept
     {
         Value val;
-        val.underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Integer>(), i);
+        val.underlying_.emplace<int64_t>(i);
         return val;
     }
     Value Value::number(double d) noexcept
     {
         vcpkg::Checks::check_exit(VCPKG_LINE_INFO, isfinite(d));
         Value val;
-        val.underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Number>(), d);
+        val.underlying_.emplace<double>(d);
         return val;
     }
     Value Value::string(std::string&& s) noexcept
@@ -333,31 +216,31 @@ namespace vcpkg::Json
             vcpkg::Checks::msg_exit_with_message(VCPKG_LINE_INFO, msgInvalidString);
         }
         Value val;
-        val.underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::String>(), std::move(s));
+        val.underlying_.emplace<std::string>(std::move(s));
         return val;
     }
     Value Value::array(Array&& arr) noexcept
     {
         Value val;
-        val.underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Array>(), std::move(arr));
+        val.underlying_.emplace<std::unique_ptr<Array>>(std::make_unique<Array>(std::move(arr)));
         return val;
     }
     Value Value::array(const Array& arr) noexcept
     {
         Value val;
-        val.underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Array>(), arr);
+        val.underlying_.emplace<std::unique_ptr<Array>>(std::make_unique<Array>(arr));
         return val;
     }
     Value Value::object(Object&& obj) noexcept
     {
         Value val;
-        val.underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Object>(), std::move(obj));
+        val.underlying_.emplace<std::unique_ptr<Object>>(std::make_unique<Object>(std::move(obj)));
         return val;
     }
     Value Value::object(const Object& obj) noexcept
     {
         Value val;
-        val.underlying_ = std::make_unique<ValueImpl>(ValueKindConstant<VK::Object>(), obj);
+        val.underlying_.emplace<std::unique_ptr<Object>>(std::make_unique<Object>(obj));
         return val;
     }
 
@@ -367,14 +250,9 @@ namespace vcpkg::Json
 
         switch (lhs.kind())
         {
-            case ValueKind::Null: return true;
-            case ValueKind::Boolean: return lhs.underlying_->boolean == rhs.underlying_->boolean;
-            case ValueKind::Integer: return lhs.underlying_->integer == rhs.underlying_->integer;
-            case ValueKind::Number: return lhs.underlying_->number == rhs.underlying_->number;
-            case ValueKind::String: return lhs.underlying_->string == rhs.underlying_->string;
-            case ValueKind::Array: return lhs.underlying_->array == rhs.underlying_->array;
-            case ValueKind::Object: return lhs.underlying_->object == rhs.underlying_->object;
-            default: Checks::unreachable(VCPKG_LINE_INFO);
+            case ValueKind::Array: return *lhs.maybe_array() == *rhs.maybe_array();
+            case ValueKind::Object: return *lhs.maybe_object() == *rhs.maybe_object();
+            default: return lhs.underlying_ == rhs.underlying_;
         }
     }
     // } struct Value
@@ -400,6 +278,15 @@ namespace vcpkg::Json
     bool operator==(const Array& lhs, const Array& rhs) { return lhs.underlying_ == rhs.underlying_; }
     // } struct Array
     // struct Object {
+    // Objects with more members than this index their keys, so that building or searching objects as large as
+    // baseline.json does not take quadratic time
+    static constexpr size_t object_index_threshold = 16;
+
+    static size_t hash_object_key(StringView key) noexcept
+    {
+        return std::hash<std::string_view>{}(std::string_view{key.data(), key.size()});
+    }
+
     Value& Object::insert(StringView key, std::string&& value) { return insert(key, Value::string(std::move(value))); }
     Value& Object::insert(StringView key, Value&& value)
     {
@@ -409,7 +296,9 @@ namespace vcpkg::Json
                                 fmt::format("attempted to insert duplicate key {} into JSON object", key));
         }
 
-        return underlying_.emplace_back(key.to_string(), std::move(value)).second;
+        underlying_.emplace_back(key.to_string(), std::move(value));
+        internal_index_back();
+        return underlying_.back().second;
     }
     Value& Object::insert(StringView key, const Value& value)
     {
@@ -419,7 +308,9 @@ namespace vcpkg::Json
                                 fmt::format("attempted to insert duplicate key {} into JSON object", key));
         }
 
-        return underlying_.emplace_back(key.to_string(), value).second;
+        underlying_.emplace_back(key.to_string(), value);
+        internal_index_back();
+        return underlying_.back().second;
     }
     Array& Object::insert(StringView key, Array&& value)
     {
@@ -452,7 +343,9 @@ namespace vcpkg::Json
         }
         else
         {
-            return underlying_.emplace_back(key, std::move(value)).second;
+            underlying_.emplace_back(key, std::move(value));
+            internal_index_back();
+            return underlying_.back().second;
         }
     }
     Value& Object::insert_or_replace(StringView key, const Value& value)
@@ -465,7 +358,9 @@ namespace vcpkg::Json
         }
         else
         {
-            return underlying_.emplace_back(key, value).second;
+            underlying_.emplace_back(key, value);
+            internal_index_back();
+            return underlying_.back().second;
         }
     }
     Array& Object::insert_or_replace(StringView key, Array&& value)
@@ -487,8 +382,95 @@ namespace vcpkg::Json
 
     auto Object::internal_find_key(StringView key) const noexcept -> underlying_t::const_iterator
     {
-        return std::find_if(
-            underlying_.begin(), underlying_.end(), [key](const auto& pair) { return pair.first == key; });
+        if (index_.empty())
+        {
+            return std::find_if(
+                underlying_.begin(), underlying_.end(), [key](const auto& pair) { return pair.first == key; });
+        }
+
+        const size_t mask = index_.size() - 1;
+        for (size_t slot = hash_object_key(key) & mask;; slot = (slot + 1) & mask)
+        {
+            const size_t entry = index_[slot];
+            if (entry == 0)
+            {
+                return underlying_.end();
+            }
+
+            auto it = underlying_.begin() + (entry - 1);
+            if (it->first == key)
+            {
+                return it;
+            }
+        }
+    }
+
+    void Object::internal_index_back()
+    {
+        if (underlying_.size() <= object_index_threshold)
+        {
+            return;
+        }
+
+        // keep the table at most half full
+        if (underlying_.size() * 2 > index_.size())
+        {
+            internal_rebuild_index();
+        }
+        else
+        {
+            internal_index_insert(underlying_.size() - 1);
+        }
+    }
+
+    void Object::internal_rebuild_index()
+    {
+        if (underlying_.size() <= object_index_threshold)
+        {
+            index_.clear();
+            return;
+        }
+
+        size_t capacity = 64;
+        while (capacity < underlying_.size() * 4)
+        {
+            capacity *= 2;
+        }
+
+        index_.assign(capacity, 0);
+        for (size_t position = 0; position < underlying_.size(); ++position)
+        {
+            internal_index_insert(position);
+        }
+    }
+
+    void Object::internal_reindex_in_place() noexcept
+    {
+        if (underlying_.size() <= object_index_threshold)
+        {
+            index_.clear();
+            return;
+        }
+
+        // There are no more entries than when the table was sized, so it is reused rather than reallocated
+        std::fill(index_.begin(), index_.end(), size_t{0});
+        for (size_t position = 0; position < underlying_.size(); ++position)
+        {
+            internal_index_insert(position);
+        }
+    }
+
+    void Object::internal_index_insert(size_t position) noexcept
+    {
+        const size_t mask = index_.size() - 1;
+        for (size_t slot = hash_object_key(underlying_[position].first) & mask;; slot = (slot + 1) & mask)
+        {
+            if (index_[slot] == 0)
+            {
+                index_[slot] = position + 1;
+                return;
+            }
+        }
     }
 
     // returns whether the key existed
@@ -502,6 +484,7 @@ namespace vcpkg::Json
         else
         {
             underlying_.erase(it);
+            internal_reindex_in_place();
             return true;
         }
     }
@@ -536,6 +519,7 @@ namespace vcpkg::Json
         std::sort(underlying_.begin(), underlying_.end(), [](const value_type& lhs, const value_type& rhs) {
             return lhs.first < rhs.first;
         });
+        internal_rebuild_index();
     }
 
     bool operator==(const Object& lhs, const Object& rhs) { return lhs.underlying_ == rhs.underlying_; }
@@ -856,177 +840,212 @@ namespace vcpkg::Json
                 return val;
             }
 
-            Value parse_array() noexcept
+            // reads the separator before the next element of an array whose opening bracket has been read
+            // returns true if an element follows, or false after reading the closing bracket or finding an error
+            bool parse_next_element(bool& first) noexcept
             {
-                Checks::check_exit(VCPKG_LINE_INFO, cur() == '[');
-                next();
+                skip_whitespace();
 
-                Array arr;
-                bool first = true;
-                for (;;)
+                char32_t current = cur();
+                if (current == Unicode::end_of_file)
                 {
-                    skip_whitespace();
+                    add_error(msg::format(msgUnexpectedEOFMidArray));
+                    return false;
+                }
+                if (current == ']')
+                {
+                    next();
+                    return false;
+                }
 
-                    char32_t current = cur();
+                if (first)
+                {
+                    first = false;
+                }
+                else if (current == ',')
+                {
+                    auto comma_loc = cur_loc();
+                    next();
+                    skip_whitespace();
+                    current = cur();
                     if (current == Unicode::end_of_file)
                     {
                         add_error(msg::format(msgUnexpectedEOFMidArray));
-                        return Value();
+                        return false;
                     }
                     if (current == ']')
                     {
-                        next();
-                        return Value::array(std::move(arr));
+                        add_error(msg::format(msgTrailingCommaInArray), comma_loc);
+                        return false;
                     }
+                }
+                else if (current == '/')
+                {
+                    add_error(std::move(
+                        msg::format(msgUnexpectedCharMidArray).append_raw('\n').append(msgInvalidCommentStyle)));
+                    return false;
+                }
+                else
+                {
+                    add_error(msg::format(msgUnexpectedCharMidArray));
+                    return false;
+                }
 
-                    if (first)
-                    {
-                        first = false;
-                    }
-                    else if (current == ',')
-                    {
-                        auto comma_loc = cur_loc();
-                        next();
-                        skip_whitespace();
-                        current = cur();
-                        if (current == Unicode::end_of_file)
-                        {
-                            add_error(msg::format(msgUnexpectedEOFMidArray));
-                            return Value();
-                        }
-                        if (current == ']')
-                        {
-                            add_error(msg::format(msgTrailingCommaInArray), comma_loc);
-                            return Value::array(std::move(arr));
-                        }
-                    }
-                    else if (current == '/')
-                    {
-                        add_error(std::move(
-                            msg::format(msgUnexpectedCharMidArray).append_raw('\n').append(msgInvalidCommentStyle)));
-                    }
-                    else
-                    {
-                        add_error(msg::format(msgUnexpectedCharMidArray));
-                        return Value();
-                    }
+                return true;
+            }
+
+            Value parse_array() noexcept
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, cur() == '[');
+                next();
 
+                Array arr;
+                bool first = true;
+                while (parse_next_element(first))
+                {
                     arr.push_back(parse_value());
                 }
+
+                return Value::array(std::move(arr));
             }
 
-            std::pair<std::string, Value> parse_kv_pair() noexcept
+            void skip_array() noexcept
             {
-                skip_whitespace();
-
-                auto current = cur();
+                Checks::check_exit(VCPKG_LINE_INFO, cur() == '[');
+                next();
 
-                std::pair<std::string, Value> res = {std::string(""), Value()};
+                bool first = true;
+                while (parse_next_element(first))
+                {
+                    skip_value();
+                }
+            }
 
+            // reads the key and colon of the next member of an object whose opening brace has been read
+            // returns true if a member follows, or false after reading the closing brace or finding an error
+            bool parse_next_member(bool& first, std::string& key, SourceLoc& key_loc) noexcept
+            {
+                skip_whitespace();
+                char32_t current = cur();
                 if (current == Unicode::end_of_file)
                 {
-                    add_error(msg::format(msgUnexpectedEOFExpectedName));
-                    return res;
+                    add_error(msg::format(msgUnexpectedEOFExpectedCloseBrace));
+                    return false;
+                }
+                else if (current == '}')
+                {
+                    next();
+                    return false;
+                }
+
+                if (first)
+                {
+                    first = false;
+                }
+                else if (current == ',')
+                {
+                    auto comma_loc = cur_loc();
+                    next();
+                    skip_whitespace();
+                    current = cur();
+                    if (current == Unicode::end_of_file)
+                    {
+                        add_error(msg::format(msgUnexpectedEOFExpectedProp));
+                        return false;
+                    }
+                    else if (current == '}')
+                    {
+                        add_error(msg::format(msgTrailingCommaInObj), comma_loc);
+                        return false;
+                    }
+                }
+                else if (current == '/')
+                {
+                    add_error(std::move(
+                        msg::format(msgUnexpectedCharExpectedColon).append_raw('\n').append(msgInvalidCommentStyle)));
+                    return false;
                 }
+                else
+                {
+                    add_error(msg::format(msgUnexpectedCharExpectedCloseBrace));
+                    return false;
+                }
+
+                key_loc = cur_loc();
+                current = cur();
                 if (current != '"')
                 {
                     add_error(msg::format(msgUnexpectedCharExpectedName));
-                    return res;
+                    return false;
                 }
-                res.first = parse_string();
+
+                key = parse_string();
 
                 skip_whitespace();
                 current = cur();
                 if (current == ':')
                 {
                     next();
+                    return true;
                 }
                 else if (current == Unicode::end_of_file)
                 {
                     add_error(msg::format(msgUnexpectedEOFExpectedColon));
-                    return res;
                 }
                 else if (current == '/')
                 {
                     add_error(std::move(
                         msg::format(msgUnexpectedCharExpectedColon).append_raw('\n').append(msgInvalidCommentStyle)));
-                    return res;
                 }
                 else
                 {
                     add_error(msg::format(msgUnexpectedCharExpectedColon));
-                    return res;
                 }
 
-                res.second = parse_value();
-
-                return res;
+                return false;
             }
 
             Value parse_object() noexcept
             {
-                char32_t current = cur();
-
-                Checks::check_exit(VCPKG_LINE_INFO, current == '{');
+                Checks::check_exit(VCPKG_LINE_INFO, cur() == '{');
                 next();
 
                 Object obj;
                 bool first = true;
-                for (;;)
+                std::string key;
+                SourceLoc key_loc = cur_loc();
+                while (parse_next_member(first, key, key_loc))
                 {
-                    skip_whitespace();
-                    current = cur();
-                    if (current == Unicode::end_of_file)
+                    if (obj.contains(key))
                     {
-                        add_error(msg::format(msgUnexpectedEOFExpectedCloseBrace));
+                        add_error(msg::format(msgDuplicatedKeyInObj, msg::value = key), key_loc);
                         return Value();
                     }
-                    else if (current == '}')
-                    {
-                        next();
-                        return Value::object(std::move(obj));
-                    }
 
-                    if (first)
-                    {
-                        first = false;
-                    }
-                    else if (current == ',')
-                    {
-                        auto comma_loc = cur_loc();
-                        next();
-                        skip_whitespace();
-                        current = cur();
-                        if (current == Unicode::end_of_file)
-                        {
-                            add_error(msg::format(msgUnexpectedEOFExpectedProp));
-                            return Value();
-                        }
-                        else if (current == '}')
-                        {
-                            add_error(msg::format(msgTrailingCommaInObj), comma_loc);
-                            return Value();
-                        }
-                    }
-                    else if (current == '/')
-                    {
-                        add_error(std::move(msg::format(msgUnexpectedCharExpectedColon)
-                                                .append_raw('\n')
-                                                .append(msgInvalidCommentStyle)));
-                    }
-                    else
-                    {
-                        add_error(msg::format(msgUnexpectedCharExpectedCloseBrace));
-                    }
+                    obj.insert(key, parse_value());
+                }
+
+                return Value::object(std::move(obj));
+            }
 
-                    auto keyPairLoc = cur_loc();
-                    auto val = parse_kv_pair();
-                    if (obj.contains(val.first))
+            void skip_object() noexcept
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, cur() == '{');
+                next();
+
+                bool first = true;
+                std::string key;
+                SourceLoc key_loc = cur_loc();
+                std::unordered_set<std::string> keys;
+                while (parse_next_member(first, key, key_loc))
+                {
+                    if (!keys.insert(key).second)
                     {
-                        add_error(msg::format(msgDuplicatedKeyInObj, msg::value = val.first), keyPairLoc);
-                        return Value();
+                        add_error(msg::format(msgDuplicatedKeyInObj, msg::value = key), key_loc);
+                        return;
                     }
-                    obj.insert(val.first, std::move(val.second));
+
+                    skip_value();
                 }
             }
 
@@ -1075,6 +1094,126 @@ namespace vcpkg::Json
                 }
             }
 
+            void skip_value() noexcept
+            {
+                skip_whitespace();
+                char32_t current = cur();
+                if (current == Unicode::end_of_file)
+                {
+                    add_error(msg::format(msgUnexpectedEOFExpectedValue));
+                    return;
+                }
+
+                if (depth_ == max_depth + 1)
+                {
+                    add_error(msg::format(msgJsonDepthLimitExceeded, msg::count = max_depth));
+                    return;
+                }
+
+                DepthGuard depth_guard(depth_);
+                switch (current)
+                {
+                    case '{': return skip_object();
+                    case '[': return skip_array();
+                    case '"': parse_string(); return;
+                    case 'n':
+                    case 't':
+                    case 'f': parse_keyword(); return;
+                    case '/':
+                    {
+                        add_error(std::move(msg::format(msgUnexpectedCharExpectedValue)
+                                                .append_raw('\n')
+                                                .append(msgInvalidCommentStyle)));
+                        return;
+                    }
+                    default:
+                        if (is_number_start(current))
+                        {
+                            parse_number();
+                        }
+                        else
+                        {
+                            add_error(msg::format(msgUnexpectedCharExpectedValue));
+                        }
+                }
+            }
+
+            // used by PullReader, which reads the objects and arrays it begins one member or element at a time
+            bool begin_streamed(char32_t open) noexcept
+            {
+                skip_whitespace();
+                if (cur() != open)
+                {
+                    return false;
+                }
+
+                if (depth_ == max_depth + 1)
+                {
+                    add_error(msg::format(msgJsonDepthLimitExceeded, msg::count = max_depth));
+                    return false;
+                }
+
+                ++depth_;
+                next();
+                streamed_.emplace_back();
+                return true;
+            }
+
+            bool next_streamed_member(std::string& key) noexcept
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, !streamed_.empty());
+                auto& streamed = streamed_.back();
+                SourceLoc key_loc = cur_loc();
+                if (parse_next_member(streamed.first, key, key_loc))
+                {
+                    if (streamed.keys.insert(key).second)
+                    {
+                        return true;
+                    }
+
+                    add_error(msg::format(msgDuplicatedKeyInObj, msg::value = key), key_loc);
+                }
+
+                end_streamed();
+                return false;
+            }
+
+            bool next_streamed_element() noexcept
+            {
+                Checks::check_exit(VCPKG_LINE_INFO, !streamed_.empty());
+                if (parse_next_element(streamed_.back().first))
+                {
+                    return true;
+                }
+
+                end_streamed();
+                return false;
+            }
+
+            void end_streamed() noexcept
+            {
+                streamed_.pop_back();
+                --depth_;
+            }
+
+            ExpectedL<Unit> finish()
+            {
+                skip_whitespace();
+                if (!at_eof())
+                {
+                    add_error(msg::format(msgUnexpectedEOFExpectedChar));
+                }
+
+                if (messages().any_errors())
+                {
+                    return messages().join();
+                }
+
+                // every object and array that was begun must have been read to its end
+                Checks::check_exit(VCPKG_LINE_INFO, streamed_.empty());
+                return Unit{};
+            }
+
             static ExpectedL<ParsedJson> parse(StringView json, StringView origin)
             {
                 StatsTimer t(g_json_parsing_stats);
@@ -1127,11 +1266,39 @@ namespace vcpkg::Json
             JsonStyle style() const noexcept { return style_; }
 
         private:
+            struct Streamed
+            {
+                bool first = true;
+                std::unordered_set<std::string> keys;
+            };
+
             JsonStyle style_{};
             size_t depth_ = 0;
+            std::vector<Streamed> streamed_;
         };
     }
 
+    struct PullReader::Impl : Parser
+    {
+        using Parser::Parser;
+    };
+
+    PullReader::PullReader(StringView text, StringView origin)
+    {
+        text.remove_bom();
+        impl_ = std::make_unique<Impl>(text, origin, TextRowCol{1, 1});
+    }
+
+    PullReader::~PullReader() = default;
+
+    bool PullReader::begin_object() { return impl_->begin_streamed('{'); }
+    bool PullReader::next_member(std::string& key) { return impl_->next_streamed_member(key); }
+    bool PullReader::begin_array() { return impl_->begin_streamed('['); }
+    bool PullReader::next_element() { return impl_->next_streamed_element(); }
+    Value PullReader::read_value() { return impl_->parse_value(); }
+    void PullReader::skip_value() { impl_->skip_value(); }
+    ExpectedL<Unit> PullReader::finish() { return impl_->finish(); }
+
     Optional<std::string> StringDeserializer::visit_string(Reader&, StringView sv) const { return sv.to_string(); }
 
     LocalizedString UntypedStringDeserializer::type_name() const { return msg::format(msgAString); }
@@ -293,6 +293,10 @@ namespace vcpkg
         m_second.println(color, std::move(line));
     }
 
+    void LineBufferSink::println(const MessageLine& line) { lines.push_back(line); }
+
+    void LineBufferSink::println(MessageLine&& line) { lines.push_back(std::move(line)); }
+
     void BGMessageSink::println(const MessageLine& line)
     {
         std::lock_guard<std::mutex> lk(m_published_lock);
@@ -0,0 +1,1284 @@
+#include <vcpkg/base/system-headers.h>
+
+#include <vcpkg/base/contractual-constants.h>
+#include <vcpkg/base/deflate.h>
+#include <vcpkg/base/files.h>
+#include <vcpkg/base/messages.h>
+#include <vcpkg/base/optional.h>
+#include <vcpkg/base/parallel-algorithms.h>
+#include <vcpkg/base/span.h>
+#include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.h>
+#include <vcpkg/base/util.h>
+#include <vcpkg/base/zip.h>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif // ^^^ !_WIN32
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+
+namespace
+{
+    using namespace vcpkg;
+    using namespace vcpkg::Zip;
+
+    constexpr uint32_t LOCAL_FILE_HEADER_SIGNATURE = 0x04034b50;
+    constexpr uint32_t DATA_DESCRIPTOR_SIGNATURE = 0x08074b50;
+    constexpr uint32_t CENTRAL_DIRECTORY_HEADER_SIGNATURE = 0x02014b50;
+    constexpr uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+    constexpr uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06064b50;
+    constexpr uint32_t ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE = 0x07064b50;
+    constexpr uint16_t ZIP64_EXTRA_FIELD_ID = 0x0001;
+
+    constexpr size_t LOCAL_FILE_HEADER_SIZE = 30;
+    constexpr size_t CENTRAL_DIRECTORY_HEADER_SIZE = 46;
+    constexpr size_t END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+    constexpr size_t ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE = 56;
+    constexpr size_t ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE = 20;
+    constexpr size_t MAX_COMMENT_SIZE = 0xFFFF;
+
+    constexpr uint16_t METHOD_STORED = 0;
+    constexpr uint16_t METHOD_DEFLATED = 8;
+    constexpr uint16_t FLAG_ENCRYPTED = 0x0001;
+    constexpr uint16_t FLAG_DATA_DESCRIPTOR = 0x0008;
+    constexpr uint16_t FLAG_UTF8 = 0x0800;
+    constexpr uint16_t VERSION_DEFAULT = 20;
+    constexpr uint16_t VERSION_ZIP64 = 45;
+    constexpr uint16_t HOST_MSDOS = 0;
+    constexpr uint16_t HOST_UNIX = 3;
+
+    constexpr uint32_t UNIX_TYPE_MASK = 0170000;
+    constexpr uint32_t UNIX_TYPE_DIRECTORY = 0040000;
+    constexpr uint32_t UNIX_TYPE_REGULAR = 0100000;
+    constexpr uint32_t UNIX_TYPE_SYMLINK = 0120000;
+    constexpr uint32_t UNIX_PERMISSIONS_MASK = 07777;
+    constexpr uint32_t UNIX_EXECUTABLE_BITS = 0111;
+    constexpr uint32_t MSDOS_DIRECTORY_ATTRIBUTE = 0x10;
+
+    constexpr uint16_t MAX_16 = 0xFFFF;
+    constexpr uint32_t MAX_32 = 0xFFFFFFFF;
+    // Regular files at least this large get zip64 local headers; the margin leaves room for deflate's worst case
+    // expansion of incompressible data.
+    constexpr uint64_t ZIP64_LOCAL_THRESHOLD = 0xF0000000;
+    // MS-DOS date for 1980-01-01, the earliest representable time.
+    constexpr uint16_t DOS_EPOCH_DATE = (1 << 5) | 1;
+
+    constexpr size_t IO_BUFFER_SIZE = 1024 * 64;
+
+    uint16_t load_le16(const unsigned char* p) noexcept { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+
+    uint32_t load_le32(const unsigned char* p) noexcept
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    uint64_t load_le64(const unsigned char* p) noexcept
+    {
+        return static_cast<uint64_t>(load_le32(p)) | (static_cast<uint64_t>(load_le32(p + 4)) << 32);
+    }
+
+    void append_le16(std::string& out, uint16_t value)
+    {
+        out.push_back(static_cast<char>(value & 0xFF));
+        out.push_back(static_cast<char>(value >> 8));
+    }
+
+    void append_le32(std::string& out, uint32_t value)
+    {
+        append_le16(out, static_cast<uint16_t>(value & 0xFFFF));
+        append_le16(out, static_cast<uint16_t>(value >> 16));
+    }
+
+    void append_le64(std::string& out, uint64_t value)
+    {
+        append_le32(out, static_cast<uint32_t>(value & MAX_32));
+        append_le32(out, static_cast<uint32_t>(value >> 32));
+    }
+
+    uint32_t clamp_32(uint64_t value) noexcept { return value >= MAX_32 ? MAX_32 : static_cast<uint32_t>(value); }
+
+    bool is_valid_entry_name(StringView name) noexcept
+    {
+        if (name.empty())
+        {
+            return false;
+        }
+
+        auto first = name.begin();
+        const auto last = name.end();
+        for (;;)
+        {
+            const auto slash = std::find(first, last, '/');
+            const StringView component{first, slash};
+            if (component.empty() || component == "." || component == "..")
+            {
+                return false;
+            }
+
+#if defined(_WIN32)
+            if (Util::any_of(component, [](char ch) { return ch == '\\' || ch == ':'; }))
+            {
+                return false;
+            }
+#endif // ^^^ _WIN32
+
+            if (slash == last)
+            {
+                return true;
+            }
+
+            first = slash + 1;
+        }
+    }
+
+    void report_corrupt_archive(DiagnosticContext& context, const Path& archive)
+    {
+        context.report(DiagnosticLine{DiagKind::Error, archive, msg::format(msgZipCorruptArchive)});
+    }
+
+    void report_corrupt_entry(DiagnosticContext& context, const Path& archive, const Entry& entry)
+    {
+        context.report(
+            DiagnosticLine{DiagKind::Error, archive, msg::format(msgZipCorruptEntry, msg::path = entry.name)});
+    }
+
+#if !defined(_WIN32)
+    void report_posix_error(DiagnosticContext& context, StringLiteral system_api, const Path& path)
+    {
+        const auto local_errno = errno;
+        context.report(DiagnosticLine{DiagKind::Error,
+                                      path,
+                                      msg::format(msgSystemApiErrorMessage,
+                                                  msg::system_api = system_api,
+                                                  msg::exit_code = local_errno,
+                                                  msg::error_msg = std::generic_category().message(local_errno))});
+    }
+#endif // ^^^ !_WIN32
+
+    struct SourceMetadata
+    {
+        EntryKind kind;
+        uint32_t permissions;
+        uint16_t dos_time;
+        uint16_t dos_date;
+        std::string symlink_target;
+    };
+
+    // Reads the metadata of `full_path` into `out`. Leaves `out` disengaged for file system objects which can't be
+    // represented in a zip archive, such as sockets.
+    bool read_source_metadata(DiagnosticContext& context,
+                              const Filesystem& fs,
+                              const Path& full_path,
+                              Optional<SourceMetadata>& out)
+    {
+#if defined(_WIN32)
+        std::error_code ec;
+        const auto status = fs.symlink_status(full_path, ec);
+        if (ec)
+        {
+            context.report_error(format_filesystem_call_error(ec, "symlink_status", {full_path}));
+            return false;
+        }
+
+        // Symbolic links are not followed, and are skipped like the other non-representable types.
+        if (vcpkg::is_directory(status))
+        {
+            out.emplace(SourceMetadata{EntryKind::Directory, 0, 0, DOS_EPOCH_DATE, std::string()});
+        }
+        else if (vcpkg::is_regular_file(status))
+        {
+            out.emplace(SourceMetadata{EntryKind::RegularFile, 0, 0, DOS_EPOCH_DATE, std::string()});
+        }
+
+        return true;
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+        (void)fs;
+        struct stat s;
+        if (::lstat(full_path.c_str(), &s) != 0)
+        {
+            report_posix_error(context, "lstat", full_path);
+            return false;
+        }
+
+        SourceMetadata result;
+        result.permissions = static_cast<uint32_t>(s.st_mode) & UNIX_PERMISSIONS_MASK;
+        if (S_ISDIR(s.st_mode))
+        {
+            result.kind = EntryKind::Directory;
+        }
+        else if (S_ISREG(s.st_mode))
+        {
+            result.kind = EntryKind::RegularFile;
+        }
+        else if (S_ISLNK(s.st_mode))
+        {
+            result.kind = EntryKind::Symlink;
+            std::string buffer(static_cast<size_t>(s.st_size > 0 ? s.st_size : 256), '\0');
+            for (;;)
+            {
+                const auto length = ::readlink(full_path.c_str(), &buffer[0], buffer.size());
+                if (length < 0)
+                {
+                    report_posix_error(context, "readlink", full_path);
+                    return false;
+                }
+
+                if (static_cast<size_t>(length) < buffer.size())
+                {
+                    buffer.resize(static_cast<size_t>(length));
+                    break;
+                }
+
+                buffer.resize(buffer.size() * 2);
+            }
+
+            result.symlink_target = std::move(buffer);
+        }
+        else
+        {
+            return true;
+        }
+
+        struct tm local_time;
+        const time_t modified = s.st_mtime;
+        if (::localtime_r(&modified, &local_time) && local_time.tm_year >= 80 && local_time.tm_year <= 207)
+        {
+            result.dos_time = static_cast<uint16_t>((local_time.tm_hour << 11) | (local_time.tm_min << 5) |
+                                                    (local_time.tm_sec / 2));
+            result.dos_date = static_cast<uint16_t>(((local_time.tm_year - 80) << 9) |
+                                                    ((local_time.tm_mon + 1) << 5) | local_time.tm_mday);
+        }
+        else
+        {
+            result.dos_time = 0;
+            result.dos_date = DOS_EPOCH_DATE;
+        }
+
+        out.emplace(std::move(result));
+        return true;
+#endif // ^^^ !_WIN32
+    }
+
+    struct WrittenEntry
+    {
+        Entry entry;
+        uint16_t flags;
+        uint16_t dos_time;
+        uint16_t dos_date;
+        bool zip64_local;
+    };
+
+    struct ZipWriter
+    {
+        ZipWriter(WriteFilePointer&& file) : m_file(std::move(file)) { m_buffer.reserve(IO_BUFFER_SIZE * 2); }
+
+        bool add(DiagnosticContext& context, const Filesystem& fs, const Path& full_path, std::string&& name)
+        {
+            Optional<SourceMetadata> maybe_metadata;
+            if (!read_source_metadata(context, fs, full_path, maybe_metadata))
+            {
+                return false;
+            }
+
+            auto metadata = maybe_metadata.get();
+            if (!metadata)
+            {
+                return true;
+            }
+
+            WrittenEntry written;
+            written.entry.name = std::move(name);
+            written.entry.kind = metadata->kind;
+            written.entry.permissions = metadata->permissions;
+            written.entry.local_header_offset = m_offset;
+            written.dos_time = metadata->dos_time;
+            written.dos_date = metadata->dos_date;
+            written.flags = FLAG_UTF8;
+            written.zip64_local = false;
+            switch (metadata->kind)
+            {
+                case EntryKind::Directory:
+                    written.entry.name.push_back('/');
+                    write_local_header(written);
+                    written.entry.name.pop_back();
+                    break;
+                case EntryKind::Symlink:
+                {
+                    const auto& target = metadata->symlink_target;
+                    written.entry.crc32 = Deflate::crc32(0, target.data(), target.data() + target.size());
+                    written.entry.compressed_size = target.size();
+                    written.entry.uncompressed_size = target.size();
+                    write_local_header(written);
+                    m_buffer.append(target);
+                    m_offset += target.size();
+                    break;
+                }
+                case EntryKind::RegularFile:
+                    if (!write_regular_file(context, fs, full_path, written))
+                    {
+                        return false;
+                    }
+
+                    break;
+                default: Checks::unreachable(VCPKG_LINE_INFO);
+            }
+
+            m_entries.push_back(std::move(written));
+            return flush_if_full(context);
+        }
+
+        bool finish(DiagnosticContext& context)
+        {
+            const uint64_t central_directory_offset = m_offset;
+            for (auto&& written : m_entries)
+            {
+                write_central_directory_header(written);
+                if (!flush_if_full(context))
+                {
+                    return false;
+                }
+            }
+
+            const uint64_t central_directory_size = m_offset - central_directory_offset;
+            const uint64_t entry_count = m_entries.size();
+            if (entry_count >= MAX_16 || central_directory_offset >= MAX_32 || central_directory_size >= MAX_32)
+            {
+                const uint64_t zip64_end_offset = m_offset;
+                append_le32(m_buffer, ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE);
+                append_le64(m_buffer, ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE - 12);
+                append_le16(m_buffer, version_made_by());
+                append_le16(m_buffer, VERSION_ZIP64);
+                append_le32(m_buffer, 0); // number of this disk
+                append_le32(m_buffer, 0); // disk where the central directory starts
+                append_le64(m_buffer, entry_count);
+                append_le64(m_buffer, entry_count);
+                append_le64(m_buffer, central_directory_size);
+                append_le64(m_buffer, central_directory_offset);
+
+                append_le32(m_buffer, ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE);
+                append_le32(m_buffer, 0); // disk where the zip64 end of central directory record is
+                append_le64(m_buffer, zip64_end_offset);
+                append_le32(m_buffer, 1); // total number of disks
+                m_offset += ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE + ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE;
+            }
+
+            const auto entry_count_16 = static_cast<uint16_t>(entry_count >= MAX_16 ? MAX_16 : entry_count);
+            append_le32(m_buffer, END_OF_CENTRAL_DIRECTORY_SIGNATURE);
+            append_le16(m_buffer, 0); // number of this disk
+            append_le16(m_buffer, 0); // disk where the central directory starts
+            append_le16(m_buffer, entry_count_16);
+            append_le16(m_buffer, entry_count_16);
+            append_le32(m_buffer, clamp_32(central_directory_size));
+            append_le32(m_buffer, clamp_32(central_directory_offset));
+            append_le16(m_buffer, 0); // comment length
+            m_offset += END_OF_CENTRAL_DIRECTORY_SIZE;
+            if (!flush(context))
+            {
+                return false;
+            }
+
+            m_file.close();
+            return true;
+        }
+
+    private:
+        static uint16_t version_made_by() noexcept
+        {
+#if defined(_WIN32)
+            return static_cast<uint16_t>((HOST_MSDOS << 8) | VERSION_ZIP64);
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+            return static_cast<uint16_t>((HOST_UNIX << 8) | VERSION_ZIP64);
+#endif // ^^^ !_WIN32
+        }
+
+        static uint32_t external_attributes(const Entry& entry) noexcept
+        {
+            const uint32_t msdos_attributes = entry.kind == EntryKind::Directory ? MSDOS_DIRECTORY_ATTRIBUTE : 0;
+#if defined(_WIN32)
+            return msdos_attributes;
+#else  // ^^^ _WIN32 // !_WIN32 vvv
+            uint32_t unix_type;
+            switch (entry.kind)
+            {
+                case EntryKind::Directory: unix_type = UNIX_TYPE_DIRECTORY; break;
+                case EntryKind::Symlink: unix_type = UNIX_TYPE_SYMLINK; break;
+                case EntryKind::RegularFile: unix_type = UNIX_TYPE_REGULAR; break;
+                default: Checks::unreachable(VCPKG_LINE_INFO);
+            }
+
+            return ((unix_type | entry.permissions) << 16) | msdos_attributes;
+#endif // ^^^ !_WIN32
+        }
+
+        void write_local_header(const WrittenEntry& written)
+        {
+            const bool has_descriptor = (written.flags & FLAG_DATA_DESCRIPTOR) != 0;
+            const auto& entry = written.entry;
+            append_le32(m_buffer, LOCAL_FILE_HEADER_SIGNATURE);
+            append_le16(m_buffer, written.zip64_local ? VERSION_ZIP64 : VERSION_DEFAULT);
+            append_le16(m_buffer, written.flags);
+            append_le16(m_buffer, entry.method);
+            append_le16(m_buffer, written.dos_time);
+            append_le16(m_buffer, written.dos_date);
+            append_le32(m_buffer, has_descriptor ? 0 : entry.crc32);
+            if (written.zip64_local)
+            {
+                append_le32(m_buffer, MAX_32);
+                append_le32(m_buffer, MAX_32);
+            }
+            else
+            {
+                append_le32(m_buffer, has_descriptor ? 0 : static_cast<uint32_t>(entry.compressed_size));
+                append_le32(m_buffer, has_descriptor ? 0 : static_cast<uint32_t>(entry.uncompressed_size));
+            }
+
+            append_le16(m_buffer, static_cast<uint16_t>(entry.name.size()));
+            append_le16(m_buffer, written.zip64_local ? 20 : 0);
+            m_buffer.append(entry.name);
+            if (written.zip64_local)
+            {
+                // the real sizes are in the data descriptor
+                append_le16(m_buffer, ZIP64_EXTRA_FIELD_ID);
+                append_le16(m_buffer, 16);
+                append_le64(m_buffer, 0);
+                append_le64(m_buffer, 0);
+            }
+
+            m_offset += LOCAL_FILE_HEADER_SIZE + entry.name.size() + (written.zip64_local ? 20 : 0);
+        }
+
+        bool write_regular_file(DiagnosticContext& context,
+                                const Filesystem& fs,
+                                const Path& full_path,
+                                WrittenEntry& written)
+        {
+            std::error_code ec;
+            auto source = fs.open_for_read(full_path, ec);
+            if (ec)
+            {
+                context.report_error(format_filesystem_call_error(ec, "open_for_read", {full_path}));
+                return false;
+            }
+
+            const auto expected_size = source.size(ec);
+            if (ec)
+            {
+                context.report_error(format_filesystem_call_error(ec, "size", {full_path}));
+                return false;
+            }
+
+            auto& entry = written.entry;
+            entry.method = METHOD_DEFLATED;
+            written.flags |= FLAG_DATA_DESCRIPTOR;
+            written.zip64_local = expected_size >= ZIP64_LOCAL_THRESHOLD;
+            write_local_header(written);
+
+            m_compressor.clear();
+            const auto data_start = m_offset;
+            uint32_t crc = 0;
+            uint64_t uncompressed_size = 0;
+            for (;;)
+            {
+                const auto this_read = source.read(m_read_buffer, 1, sizeof(m_read_buffer));
+                if (this_read != 0)
+                {
+                    crc = Deflate::crc32(crc, m_read_buffer, m_read_buffer + this_read);
+                    uncompressed_size += this_read;
+                    const auto old_size = m_buffer.size();
+                    m_compressor.add_bytes(m_read_buffer, m_read_buffer + this_read, m_buffer);
+                    m_offset += m_buffer.size() - old_size;
+                    if (!flush_if_full(context))
+                    {
+                        return false;
+                    }
+                }
+                else if ((ec = source.error()))
+                {
+                    context.report_error(format_filesystem_call_error(ec, "read", {full_path}));
+                    return false;
+                }
+
+                if (source.eof())
+                {
+                    break;
+                }
+            }
+
+            const auto old_size = m_buffer.size();
+            m_compressor.finish(m_buffer);
+            m_offset += m_buffer.size() - old_size;
+
+            entry.crc32 = crc;
+            entry.uncompressed_size = uncompressed_size;
+            entry.compressed_size = m_offset - data_start;
+            if (!written.zip64_local && (entry.uncompressed_size >= MAX_32 || entry.compressed_size >= MAX_32))
+            {
+                // the file grew after we decided on the local header format
+                context.report(DiagnosticLine{
+                    DiagKind::Error, full_path, msg::format(msgZipCorruptEntry, msg::path = entry.name)});
+                return false;
+            }
+
+            append_le32(m_buffer, DATA_DESCRIPTOR_SIGNATURE);
+            append_le32(m_buffer, crc);
+            if (written.zip64_local)
+            {
+                append_le64(m_buffer, entry.compressed_size);
+                append_le64(m_buffer, entry.uncompressed_size);
+                m_offset += 24;
+            }
+            else
+            {
+                append_le32(m_buffer, static_cast<uint32_t>(entry.compressed_size));
+                append_le32(m_buffer, static_cast<uint32_t>(entry.uncompressed_size));
+                m_offset += 16;
+            }
+
+            return true;
+        }
+
+        void write_central_directory_header(const WrittenEntry& written)
+        {
+            const auto& entry = written.entry;
+            std::string zip64_extra;
+            if (entry.uncompressed_size >= MAX_32)
+            {
+                append_le64(zip64_extra, entry.uncompressed_size);
+            }
+
+            if (entry.compressed_size >= MAX_32)
+            {
+                append_le64(zip64_extra, entry.compressed_size);
+            }
+
+            if (entry.local_header_offset >= MAX_32)
+            {
+                append_le64(zip64_extra, entry.local_header_offset);
+            }
+
+            const bool needs_zip64 = written.zip64_local || !zip64_extra.empty();
+            const size_t extra_size = zip64_extra.empty() ? 0 : zip64_extra.size() + 4;
+            const bool is_directory = entry.kind == EntryKind::Directory;
+            append_le32(m_buffer, CENTRAL_DIRECTORY_HEADER_SIGNATURE);
+            append_le16(m_buffer, version_made_by());
+            append_le16(m_buffer, needs_zip64 ? VERSION_ZIP64 : VERSION_DEFAULT);
+            append_le16(m_buffer, written.flags);
+            append_le16(m_buffer, entry.method);
+            append_le16(m_buffer, written.dos_time);
+            append_le16(m_buffer, written.dos_date);
+            append_le32(m_buffer, entry.crc32);
+            append_le32(m_buffer, clamp_32(entry.compressed_size));
+            append_le32(m_buffer, clamp_32(entry.uncompressed_size));
+            append_le16(m_buffer, static_cast<uint16_t>(entry.name.size() + is_directory));
+            append_le16(m_buffer, static_cast<uint16_t>(extra_size));
+            append_le16(m_buffer, 0); // comment length
+            append_le16(m_buffer, 0); // disk where the entry starts
+            append_le16(m_buffer, 0); // internal attributes
+            append_le32(m_buffer, external_attributes(entry));
+            append_le32(m_buffer, clamp_32(entry.local_header_offset));
+            m_buffer.append(entry.name);
+            if (is_directory)
+            {
+                m_buffer.push_back('/');
+            }
+
+            if (!zip64_extra.empty())
+            {
+                append_le16(m_buffer, ZIP64_EXTRA_FIELD_ID);
+                append_le16(m_buffer, static_cast<uint16_t>(zip64_extra.size()));
+                m_buffer.append(zip64_extra);
+            }
+
+            m_offset += CENTRAL_DIRECTORY_HEADER_SIZE + entry.name.size() + is_directory + extra_size;
+        }
+
+        bool flush_if_full(DiagnosticContext& context)
+        {
+            if (m_buffer.size() < IO_BUFFER_SIZE)
+            {
+                return true;
+            }
+
+            return flush(context);
+        }
+
+        bool flush(DiagnosticContext& context)
+        {
+            if (m_file.write(m_buffer.data(), 1, m_buffer.size()) != m_buffer.size())
+            {
+                context.report_error(format_filesystem_call_error(m_file.error(), "write", {m_file.path()}));
+                return false;
+            }
+
+            m_buffer.clear();
+            return true;
+        }
+
+        WriteFilePointer m_file;
+        std::string m_buffer;
+        uint64_t m_offset = 0;
+        std::vector<WrittenEntry> m_entries;
+        Deflate::Compressor m_compressor;
+        char m_read_buffer[IO_BUFFER_SIZE];
+    };
+
+    // Supplies at most `remaining` bytes of an archive member's data from the current position of `file`.
+    struct EntryDataSource final : Deflate::InflateSource
+    {
+        EntryDataSource(ReadFilePointer& file, uint64_t remaining) : file(file), remaining(remaining) { }
+
+        size_t read(void* buffer, size_t size) override
+        {
+            if (size > remaining)
+            {
+                size = static_cast<size_t>(remaining);
+            }
+
+            if (size == 0)
+            {
+                return 0;
+            }
+
+            const auto this_read = file.read(buffer, 1, size);
+            remaining -= this_read;
+            return this_read;
+        }
+
+        ReadFilePointer& file;
+        uint64_t remaining;
+    };
+
+    // Tracks the size and checksum of an entry's decompressed data, rejecting data longer than the central directory
+    // claims.
+    struct CheckedSink : Deflate::InflateSink
+    {
+        CheckedSink(uint64_t expected_size) : expected_size(expected_size) { }
+
+        bool write(const void* buffer, size_t size) override final
+        {
+            written += size;
+            if (written > expected_size)
+            {
+                return false;
+            }
+
+            const auto first = static_cast<const char*>(buffer);
+            crc = Deflate::crc32(crc, first, first + size);
+            if (!write_checked(first, size))
+            {
+                write_failed = true;
+                return false;
+            }
+
+            return true;
+        }
+
+        virtual bool write_checked(const char* buffer, size_t size) = 0;
+
+        uint64_t expected_size;
+        uint64_t written = 0;
+        uint32_t crc = 0;
+        bool write_failed = false;
+
+    protected:
+        ~CheckedSink() = default;
+    };
+
+    struct FileSink final : CheckedSink
+    {
+        FileSink(const WriteFilePointer& file, uint64_t expected_size) : CheckedSink(expected_size), file(file) { }
+
+        bool write_checked(const char* buffer, size_t size) override { return file.write(buffer, 1, size) == size; }
+
+        const WriteFilePointer& file;
+    };
+
+    struct StringSink final : CheckedSink
+    {
+        using CheckedSink::CheckedSink;
+
+        bool write_checked(const char* buffer, size_t size) override
+        {
+            result.append(buffer, size);
+            return true;
+        }
+
+        std::string result;
+    };
+
+    // Reads the data of `entry` from `archive_file` into `sink`, validating it against the central directory. If
+    // the sink fails, returns false with `sink.write_failed` set and without reporting anything.
+    bool read_entry_data(DiagnosticContext& context,
+                         ReadFilePointer& archive_file,
+                         const Path& archive,
+                         const Entry& entry,
+                         CheckedSink& sink)
+    {
+        unsigned char header[LOCAL_FILE_HEADER_SIZE];
+        if (!archive_file.try_read_all_from(
+                static_cast<long long>(entry.local_header_offset), header, static_cast<uint32_t>(sizeof(header))) ||
+            load_le32(header) != LOCAL_FILE_HEADER_SIGNATURE ||
+            !archive_file.try_seek_to(static_cast<long long>(load_le16(header + 26)) + load_le16(header + 28),
+                                      SEEK_CUR))
+        {
+            report_corrupt_entry(context, archive, entry);
+            return false;
+        }
+
+        EntryDataSource source{archive_file, entry.compressed_size};
+        bool data_ok;
+        if (entry.method == METHOD_STORED)
+        {
+            char buffer[IO_BUFFER_SIZE];
+            data_ok = true;
+            while (data_ok && source.remaining != 0)
+            {
+                const auto this_read = source.read(buffer, sizeof(buffer));
+                data_ok = this_read != 0 && sink.write(buffer, this_read);
+            }
+        }
+        else
+        {
+            data_ok = Deflate::inflate(source, sink).result == Deflate::InflateResult::Success;
+        }
+
+        if (sink.write_failed)
+        {
+            return false;
+        }
+
+        if (!data_ok || sink.written != entry.uncompressed_size || sink.crc != entry.crc32)
+        {
+            report_corrupt_entry(context, archive, entry);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool extract_regular_file(DiagnosticContext& context,
+                              const Filesystem& fs,
+                              ReadFilePointer& archive_file,
+                              const Path& archive,
+                              const Entry& entry,
+                              const Path& target)
+    {
+        std::error_code ec;
+        auto output = fs.open_for_write(target, Append::NO, ec);
+        if (ec)
+        {
+            context.report_error(format_filesystem_call_error(ec, "open_for_write", {target}));
+            return false;
+        }
+
+        FileSink sink{output, entry.uncompressed_size};
+        if (!read_entry_data(context, archive_file, archive, entry, sink))
+        {
+            if (sink.write_failed)
+            {
+                context.report_error(format_filesystem_call_error(output.error(), "write", {target}));
+            }
+
+            return false;
+        }
+
+        output.close();
+        if ((entry.permissions & UNIX_EXECUTABLE_BITS) != 0)
+        {
+            return fs.set_executable(context, target);
+        }
+
+        return true;
+    }
+
+    bool extract_symlink(DiagnosticContext& context,
+                         const Filesystem& fs,
+                         ReadFilePointer& archive_file,
+                         const Path& archive,
+                         const Entry& entry,
+                         const Path& target)
+    {
+        StringSink sink{entry.uncompressed_size};
+        if (!read_entry_data(context, archive_file, archive, entry, sink))
+        {
+            return false;
+        }
+
+        std::error_code ec;
+        fs.create_symlink(sink.result, target, ec);
+        if (ec)
+        {
+            context.report_error(format_filesystem_call_error(ec, "create_symlink", {sink.result, target}));
+            return false;
+        }
+
+        return true;
+    }
+
+    // Parses the end of central directory record(s) from the last bytes of the archive, `tail`, which starts at
+    // `tail_offset`.
+    bool find_central_directory(const std::string& tail,
+                                uint64_t tail_offset,
+                                ReadFilePointer& archive_file,
+                                uint64_t& entry_count,
+                                uint64_t& central_directory_size,
+                                uint64_t& central_directory_offset)
+    {
+        if (tail.size() < END_OF_CENTRAL_DIRECTORY_SIZE)
+        {
+            return false;
+        }
+
+        const auto data = reinterpret_cast<const unsigned char*>(tail.data());
+        size_t end_position = tail.size() - END_OF_CENTRAL_DIRECTORY_SIZE;
+        for (;;)
+        {
+            if (load_le32(data + end_position) == END_OF_CENTRAL_DIRECTORY_SIGNATURE &&
+                end_position + END_OF_CENTRAL_DIRECTORY_SIZE + load_le16(data + end_position + 20) == tail.size())
+            {
+                break;
+            }
+
+            if (end_position == 0)
+            {
+                return false;
+            }
+
+            --end_position;
+        }
+
+        const auto end_record = data + end_position;
+        if (load_le16(end_record + 4) != 0 || load_le16(end_record + 6) != 0 ||
+            load_le16(end_record + 8) != load_le16(end_record + 10))
+        {
+            // multi-disk archive
+            return false;
+        }
+
+        entry_count = load_le16(end_record + 10);
+        central_directory_size = load_le32(end_record + 12);
+        central_directory_offset = load_le32(end_record + 16);
+        if (entry_count != MAX_16 && central_directory_size != MAX_32 && central_directory_offset != MAX_32)
+        {
+            return true;
+        }
+
+        if (end_position < ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE)
+        {
+            return false;
+        }
+
+        const auto locator = end_record - ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIZE;
+        if (load_le32(locator) != ZIP64_END_OF_CENTRAL_DIRECTORY_LOCATOR_SIGNATURE)
+        {
+            return false;
+        }
+
+        const auto zip64_end_offset = load_le64(locator + 8);
+        unsigned char zip64_end_buffer[ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE];
+        const unsigned char* zip64_end;
+        if (zip64_end_offset >= tail_offset &&
+            zip64_end_offset - tail_offset + ZIP64_END_OF_CENTRAL_DIRECTORY_SIZE <= end_position)
+        {
+            zip64_end = data + (zip64_end_offset - tail_offset);
+        }
+        else if (archive_file.try_read_all_from(static_cast<long long>(zip64_end_offset),
+                                                zip64_end_buffer,
+                                                static_cast<uint32_t>(sizeof(zip64_end_buffer))))
+        {
+            zip64_end = zip64_end_buffer;
+        }
+        else
+        {
+            return false;
+        }
+
+        if (load_le32(zip64_end) != ZIP64_END_OF_CENTRAL_DIRECTORY_SIGNATURE || load_le32(zip64_end + 16) != 0 ||
+            load_le32(zip64_end + 20) != 0 || load_le64(zip64_end + 24) != load_le64(zip64_end + 32))
+        {
+            return false;
+        }
+
+        entry_count = load_le64(zip64_end + 32);
+        central_directory_size = load_le64(zip64_end + 40);
+        central_directory_offset = load_le64(zip64_end + 48);
+        return true;
+    }
+
+    // Replaces the values in the zip64 extended information extra field of a central directory header that are
+    // saturated in the fixed part of the header.
+    bool apply_zip64_extra(const unsigned char* extra, size_t extra_size, Entry& entry)
+    {
+        while (extra_size >= 4)
+        {
+            const auto id = load_le16(extra);
+            const size_t field_size = load_le16(extra + 2);
+            if (field_size > extra_size - 4)
+            {
+                return false;
+            }
+
+            if (id == ZIP64_EXTRA_FIELD_ID)
+            {
+                auto field = extra + 4;
+                auto field_remaining = field_size;
+                for (auto value : {&entry.uncompressed_size, &entry.compressed_size, &entry.local_header_offset})
+                {
+                    if (*value == MAX_32)
+                    {
+                        if (field_remaining < 8)
+                        {
+                            return false;
+                        }
+
+                        *value = load_le64(field);
+                        field += 8;
+                        field_remaining -= 8;
+                    }
+                }
+
+                return true;
+            }
+
+            extra += 4 + field_size;
+            extra_size -= 4 + field_size;
+        }
+
+        return true;
+    }
+}
+
+namespace vcpkg::Zip
+{
+    Optional<std::vector<Entry>> read_central_directory(DiagnosticContext& context,
+                                                        const ReadOnlyFilesystem& fs,
+                                                        const Path& archive)
+    {
+        std::error_code ec;
+        auto archive_file = fs.open_for_read(archive, ec);
+        if (ec)
+        {
+            context.report_error(format_filesystem_call_error(ec, "open_for_read", {archive}));
+            return nullopt;
+        }
+
+        const auto archive_size = archive_file.size(ec);
+        if (ec)
+        {
+            context.report_error(format_filesystem_call_error(ec, "size", {archive}));
+            return nullopt;
+        }
+
+        const auto tail_size = static_cast<size_t>(
+            (std::min)(archive_size, static_cast<uint64_t>(END_OF_CENTRAL_DIRECTORY_SIZE + MAX_COMMENT_SIZE)));
+        const auto tail_offset = archive_size - tail_size;
+        std::string tail(tail_size, '\0');
+        uint64_t entry_count;
+        uint64_t central_directory_size;
+        uint64_t central_directory_offset;
+        if (!archive_file.try_read_all_from(
+                static_cast<long long>(tail_offset), &tail[0], static_cast<uint32_t>(tail_size)) ||
+            !find_central_directory(
+                tail, tail_offset, archive_file, entry_count, central_directory_size, central_directory_offset) ||
+            central_directory_offset > archive_size ||
+            central_directory_size > archive_size - central_directory_offset ||
+            entry_count > central_directory_size / CENTRAL_DIRECTORY_HEADER_SIZE)
+        {
+            report_corrupt_archive(context, archive);
+            return nullopt;
+        }
+
+        std::string central_directory(static_cast<size_t>(central_directory_size), '\0');
+        // zip64 central directories may be larger than a single read can be
+        for (uint64_t chunk_offset = 0; chunk_offset < central_directory_size; chunk_offset += MAX_32)
+        {
+            const auto chunk_size = static_cast<uint32_t>((std::min)(central_directory_size - chunk_offset,
+                                                                     static_cast<uint64_t>(MAX_32)));
+            if (!archive_file.try_read_all_from(static_cast<long long>(central_directory_offset + chunk_offset),
+                                                &central_directory[static_cast<size_t>(chunk_offset)],
+                                                chunk_size))
+            {
+                report_corrupt_archive(context, archive);
+                return nullopt;
+            }
+        }
+
+        std::vector<Entry> entries;
+        entries.reserve(static_cast<size_t>(entry_count));
+        std::set<StringView> names;
+        auto header = reinterpret_cast<const unsigned char*>(central_directory.data());
+        auto remaining = central_directory.size();
+        for (uint64_t index = 0; index < entry_count; ++index)
+        {
+            if (remaining < CENTRAL_DIRECTORY_HEADER_SIZE || load_le32(header) != CENTRAL_DIRECTORY_HEADER_SIGNATURE)
+            {
+                report_corrupt_archive(context, archive);
+                return nullopt;
+            }
+
+            const size_t name_size = load_le16(header + 28);
+            const size_t extra_size = load_le16(header + 30);
+            const size_t comment_size = load_le16(header + 32);
+            const size_t header_size = CENTRAL_DIRECTORY_HEADER_SIZE + name_size + extra_size + comment_size;
+            if (header_size > remaining)
+            {
+                report_corrupt_archive(context, archive);
+                return nullopt;
+            }
+
+            Entry& entry = entries.emplace_back();
+            entry.name.assign(reinterpret_cast<const char*>(header + CENTRAL_DIRECTORY_HEADER_SIZE), name_size);
+            const auto host = static_cast<uint16_t>(load_le16(header + 4) >> 8);
+            const auto flags = load_le16(header + 8);
+            entry.method = load_le16(header + 10);
+            entry.crc32 = load_le32(header + 16);
+            entry.compressed_size = load_le32(header + 20);
+            entry.uncompressed_size = load_le32(header + 24);
+            const auto external_attributes = load_le32(header + 38);
+            entry.local_header_offset = load_le32(header + 42);
+            if (!apply_zip64_extra(header + CENTRAL_DIRECTORY_HEADER_SIZE + name_size, extra_size, entry) ||
+                entry.local_header_offset > archive_size ||
+                entry.compressed_size > archive_size - entry.local_header_offset)
+            {
+                report_corrupt_archive(context, archive);
+                return nullopt;
+            }
+
+            if ((flags & FLAG_ENCRYPTED) != 0 || (entry.method != METHOD_STORED && entry.method != METHOD_DEFLATED))
+            {
+                context.report(DiagnosticLine{
+                    DiagKind::Error, archive, msg::format(msgZipUnsupportedEntry, msg::path = entry.name)});
+                return nullopt;
+            }
+
+            if (!entry.name.empty() && entry.name.back() == '/')
+            {
+                entry.name.pop_back();
+                entry.kind = EntryKind::Directory;
+            }
+            else if ((external_attributes & MSDOS_DIRECTORY_ATTRIBUTE) != 0 && host == HOST_MSDOS)
+            {
+                entry.kind = EntryKind::Directory;
+            }
+
+            if (host == HOST_UNIX)
+            {
+                const auto mode = external_attributes >> 16;
+                entry.permissions = mode & UNIX_PERMISSIONS_MASK;
+                switch (mode & UNIX_TYPE_MASK)
+                {
+                    case UNIX_TYPE_DIRECTORY: entry.kind = EntryKind::Directory; break;
+                    case UNIX_TYPE_SYMLINK: entry.kind = EntryKind::Symlink; break;
+                    default: break;
+                }
+            }
+
+            if (!is_valid_entry_name(entry.name))
+            {
+                context.report(DiagnosticLine{
+                    DiagKind::Error, archive, msg::format(msgZipInvalidEntryName, msg::path = entry.name)});
+                return nullopt;
+            }
+
+            header += header_size;
+            remaining -= header_size;
+        }
+
+        for (auto&& entry : entries)
+        {
+            if (!names.insert(entry.name).second)
+            {
+                context.report(DiagnosticLine{
+                    DiagKind::Error, archive, msg::format(msgZipInvalidEntryName, msg::path = entry.name)});
+                return nullopt;
+            }
+        }
+
+        return entries;
+    }
+
+    bool compress_directory(DiagnosticContext& context,
+                            const Filesystem& fs,
+                            const Path& source,
+                            const Path& destination)
+    {
+        std::error_code ec;
+        auto relative_paths = fs.get_files_recursive_lexically_proximate(source, ec);
+        if (ec)
+        {
+            context.report_error(format_filesystem_call_error(ec, "get_files_recursive_lexically_proximate", {source}));
+            return false;
+        }
+
+        std::vector<std::string> names;
+        names.reserve(relative_paths.size());
+        for (auto&& relative_path : relative_paths)
+        {
+            if (relative_path.filename() != FileDotDsStore)
+            {
+                names.push_back(relative_path.generic_u8string());
+            }
+        }
+
+        Util::sort(names);
+
+        auto destination_file = fs.open_for_write(destination, Append::NO, ec);
+        if (ec)
+        {
+            context.report_error(format_filesystem_call_error(ec, "open_for_write", {destination}));
+            return false;
+        }
+
+        auto writer = std::make_unique<ZipWriter>(std::move(destination_file));
+        for (auto&& name : names)
+        {
+            auto full_path = source / name;
+            if (!writer->add(context, fs, full_path, std::move(name)))
+            {
+                return false;
+            }
+        }
+
+        return writer->finish(context);
+    }
+
+    bool extract(DiagnosticContext& context,
+                 const Filesystem& fs,
+                 const Path& archive,
+                 const Path& destination,
+                 size_t max_concurrency)
+    {
+        auto maybe_entries = read_central_directory(context, fs, archive);
+        auto entries = maybe_entries.get();
+        if (!entries)
+        {
+            return false;
+        }
+
+        std::set<std::string> directories;
+        for (auto&& entry : *entries)
+        {
+            if (entry.kind == EntryKind::Directory)
+            {
+                directories.insert(entry.name);
+                continue;
+            }
+
+            const auto slash = entry.name.rfind('/');
+            if (slash != std::string::npos)
+            {
+                directories.insert(entry.name.substr(0, slash));
+            }
+        }
+
+        std::error_code ec;
+        for (auto&& directory : directories)
+        {
+            auto target = destination / directory;
+            fs.create_directories(target, ec);
+            if (ec)
+            {
+                context.report_error(format_filesystem_call_error(ec, "create_directories", {target}));
+                return false;
+            }
+        }
+
+        return extract_entries(context, fs, archive, *entries, destination, max_concurrency);
+    }
+
+    bool extract_entries(DiagnosticContext& context,
+                         const Filesystem& fs,
+                         const Path& archive,
+                         View<Entry> entries,
+                         const Path& destination,
+                         size_t max_concurrency)
+    {
+        std::vector<const Entry*> files;
+        std::vector<const Entry*> symlinks;
+        for (auto&& entry : entries)
+        {
+            if (entry.kind != EntryKind::Directory)
+            {
+                (entry.kind == EntryKind::Symlink ? symlinks : files).push_back(&entry);
+            }
+        }
+
+        // largest first so that the long poles start early
+        Util::sort(files,
+                   [](const Entry* lhs, const Entry* rhs) { return lhs->compressed_size > rhs->compressed_size; });
+
+        const auto worker_count = (std::min)({files.size(), max_concurrency, static_cast<size_t>(get_concurrency())});
+        std::vector<FullyBufferedDiagnosticContext> worker_contexts(worker_count);
+        std::atomic<size_t> next_file{0};
+        std::atomic<bool> failed{false};
+        execute_in_parallel(worker_count, [&](size_t worker) {
+            auto& worker_context = worker_contexts[worker];
+            std::error_code worker_ec;
+            auto archive_file = fs.open_for_read(archive, worker_ec);
+            if (worker_ec)
+            {
+                worker_context.report_error(format_filesystem_call_error(worker_ec, "open_for_read", {archive}));
+                failed.store(true, std::memory_order_relaxed);
+                return;
+            }
+
+            while (!failed.load(std::memory_order_relaxed))
+            {
+                const auto index = next_file.fetch_add(1, std::memory_order_relaxed);
+                if (index >= files.size())
+                {
+                    return;
+                }
+
+                const Entry& entry = *files[index];
+                if (!extract_regular_file(worker_context, fs, archive_file, archive, entry, destination / entry.name))
+                {
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+        });
+
+        for (auto&& worker_context : worker_contexts)
+        {
+            std::move(worker_context).report_to(context);
+        }
+
+        if (failed.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        // Symlinks are created last so that no other entry can be written through one of them.
+        if (!symlinks.empty())
+        {
+            std::error_code ec;
+            auto archive_file = fs.open_for_read(archive, ec);
+            if (ec)
+            {
+                context.report_error(format_filesystem_call_error(ec, "open_for_read", {archive}));
+                return false;
+            }
+
+            for (auto symlink : symlinks)
+            {
+                if (!extract_symlink(context, fs, archive_file, archive, *symlink, destination / symlink->name))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool extract(DiagnosticContext& context, const Filesystem& fs, const Path& archive, const Path& destination)
+    {
+        return extract(context, fs, archive, destination, get_concurrency());
+    }
+}
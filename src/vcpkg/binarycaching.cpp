@@ -28,6 +28,10 @@
 #include <vcpkg/vcpkgpaths.h>
 
 #include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_set>
 #include <utility>
 
 using namespace vcpkg;
@@ -37,6 +41,9 @@ namespace
     // The length of an ABI in the binary cache
     static constexpr size_t ABI_LENGTH = 64;
     static constexpr size_t OBJECT_STORAGE_DOWNLOAD_CONCURRENCY = 8;
+    // Listing a prefix costs a single request regardless of the number of ABIs being checked, but grows with the size
+    // of the cache, so it is only used for large batches.
+    static constexpr size_t OBJECT_STORAGE_LIST_THRESHOLD = 100;
 
     struct ConfigSegmentsParser : ParserBase
     {
@@ -213,35 +220,35 @@ namespace
         return false;
     }
 
-#ifdef _WIN32
-    bool directory_last_write_time(DiagnosticContext& context, const Filesystem& fs, const Path& dir)
+    // Reads the central directory of `zip` and extracts only the control files of the package it holds into
+    // `package_dir`. Returns nullopt if the built-in zip reader does not support the archive, in which case it is
+    // extracted in full as usual, which reports any problems.
+    Optional<DeferredArchive> try_defer_archive(const Filesystem& fs, const Path& package_dir, const ZipResource& zip)
     {
-        auto now = fs.file_time_now();
-        auto maybe_paths = fs.try_get_files_recursive(context, dir);
-        if (auto paths = maybe_paths.get())
+        auto maybe_entries = Zip::read_central_directory(null_diagnostic_context, fs, zip.path);
+        auto entries = maybe_entries.get();
+        if (!entries)
         {
-            bool all_success = true;
-            for (auto&& path : *paths)
-            {
-                if (!fs.last_write_time(context, path, now))
-                {
-                    all_success = false;
-                }
-            }
+            return nullopt;
+        }
 
-            if (all_success)
+        std::vector<Zip::Entry> control_entries;
+        for (auto&& entry : *entries)
+        {
+            if (entry.kind == Zip::EntryKind::RegularFile && (entry.name == FileControl || entry.name == FileBuildInfo))
             {
-                return true;
+                control_entries.push_back(entry);
             }
         }
 
-        return false;
-    }
-#endif // ^^^ _WIN32
+        if (!Util::any_of(control_entries, [](const Zip::Entry& entry) { return entry.name == FileControl; }) ||
+            !clean_prepare_dir(null_diagnostic_context, fs, package_dir) ||
+            !Zip::extract_entries(null_diagnostic_context, fs, zip.path, control_entries, package_dir, 1))
+        {
+            return nullopt;
+        }
 
-    Path make_temp_archive_path(const Path& buildtrees, const PackageSpec& spec, const std::string& abi)
-    {
-        return buildtrees / fmt::format("{}_{}.zip", spec.name(), abi);
+        return DeferredArchive{zip, std::move(*entries)};
     }
 
     Path files_archive_parent_path(const std::string& abi) { return Path(abi.substr(0, 2)); }
@@ -303,32 +310,19 @@ namespace
 
         bool needs_nuspec_data() const override { return false; }
         bool needs_zip_file() const override { return true; }
+        size_t max_concurrent_pushes() const override { return 4; }
 
     private:
         std::vector<Path> m_dirs;
     };
 
-    enum class RemoveWhen
-    {
-        nothing,
-        always,
-    };
-
-    struct ZipResource
-    {
-        ZipResource(Path&& p, RemoveWhen t) : path(std::move(p)), to_remove(t) { }
-
-        Path path;
-        RemoveWhen to_remove;
-    };
-
     // This middleware class contains logic for BinaryProviders that operate on zip files.
     // Derived classes must implement:
     // - acquire_zips()
     // - IReadBinaryProvider::precheck()
     struct ZipReadBinaryProvider : IReadBinaryProvider
     {
-        ZipReadBinaryProvider(const ZipTool& zip) : m_zip(zip) { }
+        ZipReadBinaryProvider(const ZipTool& zip) : m_zip(zip), m_instance(next_instance++) { }
 
         struct UnzipJob
         {
@@ -345,14 +339,31 @@ namespace
                    View<const InstallPlanAction*> actions,
                    Span<RestoreResult> out_status) const override
         {
-            const ElapsedTimer timer;
             std::vector<Optional<ZipResource>> zip_paths(actions.size(), nullopt);
             acquire_zips(context, fs, actions, zip_paths);
+            extract_zips(context, fs, actions, zip_paths, out_status);
+        }
+
+        bool try_acquire_zips(DiagnosticContext& context,
+                              const Filesystem& fs,
+                              View<const InstallPlanAction*> actions,
+                              Span<Optional<ZipResource>> out_zips) const override
+        {
+            acquire_zips(context, fs, actions, out_zips);
+            return true;
+        }
+
+        void extract_zips(DiagnosticContext& context,
+                          const Filesystem& fs,
+                          View<const InstallPlanAction*> actions,
+                          View<Optional<ZipResource>> zips,
+                          Span<RestoreResult> out_status) const override
+        {
             std::vector<UnzipJob> jobs;
             jobs.reserve(actions.size());
             for (size_t i = 0; i < actions.size(); ++i)
             {
-                if (auto zip_resource = zip_paths[i].get())
+                if (auto zip_resource = zips[i].get())
                 {
                     jobs.push_back(
                         {&actions[i]->package_dir, zip_resource, fs.file_size(zip_resource->path, IgnoreErrors{}), i});
@@ -362,19 +373,15 @@ namespace
             std::sort(
                 jobs.begin(), jobs.end(), [](const UnzipJob& l, const UnzipJob& r) { return l.zip_size > r.zip_size; });
 
-            parallel_for_each(jobs, [this, &fs, &out_status](UnzipJob& job) {
+            // Archives are already extracted in parallel with each other, so only a lone archive extracts its entries in
+            // parallel; otherwise every archive would start its own workers, each with the archive open.
+            const size_t entry_concurrency = jobs.size() == 1 ? static_cast<size_t>(get_concurrency()) : 1;
+            parallel_for_each(jobs, [this, &fs, &out_status, entry_concurrency](UnzipJob& job) {
                 WarningDiagnosticContext wdc{job.fbdc};
                 if (clean_prepare_dir(wdc, fs, *job.package_dir))
                 {
-                    auto cmd = m_zip.decompress_zip_archive_cmd(*job.package_dir, job.zip_resource->path);
-                    auto maybe_output = cmd_execute_and_capture_output(wdc, cmd);
-                    if (check_zero_exit_code(wdc, cmd, maybe_output)
-#ifdef _WIN32
-                        // On windows the ziptool does restore file times, we don't want that because this breaks file
-                        // time based change detection.
-                        && directory_last_write_time(wdc, fs, *job.package_dir)
-#endif // ^^^ _WIN32
-                    )
+                    if (m_zip.decompress_zip_archive(
+                            wdc, fs, *job.package_dir, job.zip_resource->path, entry_concurrency))
                     {
                         out_status[job.action_idx] = RestoreResult::restored;
                         job.success = true;
@@ -394,13 +401,12 @@ namespace
 
             for (auto&& job : jobs)
             {
-                job.fbdc.print_to(out_sink);
+                std::move(job.fbdc).report_to(context);
                 if (Debug::g_debugging && job.success)
                 {
-                    console_diagnostic_context.report(
-                        DiagnosticLine{DiagKind::Note,
-                                       job.zip_resource->path,
-                                       msg::format(msgExtractedInto, msg::path = *job.package_dir)});
+                    context.report(DiagnosticLine{DiagKind::Note,
+                                                  job.zip_resource->path,
+                                                  msg::format(msgExtractedInto, msg::path = *job.package_dir)});
                 }
             }
         }
@@ -417,9 +423,22 @@ namespace
                                   Span<Optional<ZipResource>> out_zips) const = 0;
 
     protected:
+        // Returns the path in `buildtrees` to download the archive for `spec` to. The path includes this provider's
+        // instance number so that several providers can download the same ABI at the same time.
+        Path make_temp_archive_path(const Path& buildtrees, const PackageSpec& spec, const std::string& abi) const
+        {
+            return buildtrees / fmt::format("{}_{}_{}.zip", spec.name(), abi, m_instance);
+        }
+
         ZipTool m_zip;
+        size_t m_instance;
+
+    private:
+        static std::atomic<size_t> next_instance;
     };
 
+    std::atomic<size_t> ZipReadBinaryProvider::next_instance{0};
+
     struct FilesReadBinaryProvider : ZipReadBinaryProvider
     {
         FilesReadBinaryProvider(const ZipTool& zip, Path&& dir) : ZipReadBinaryProvider(zip), m_dir(std::move(dir)) { }
@@ -440,6 +459,29 @@ namespace
             }
         }
 
+        bool try_acquire_zips_as_available(DiagnosticContext&,
+                                           const Filesystem& fs,
+                                           View<const InstallPlanAction*> actions,
+                                           AcquiredZipSink& sink) const override
+        {
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                if (!sink.wants(i))
+                {
+                    continue;
+                }
+
+                const auto& abi_tag = actions[i]->package_abi_or_exit(VCPKG_LINE_INFO);
+                auto archive_path = m_dir / files_archive_subpath(abi_tag);
+                if (fs.exists(archive_path, IgnoreErrors{}))
+                {
+                    sink.acquired(i, ZipResource{std::move(archive_path), RemoveWhen::nothing});
+                }
+            }
+
+            return true;
+        }
+
         void precheck(DiagnosticContext&,
                       const Filesystem& fs,
                       View<const InstallPlanAction*> actions,
@@ -502,6 +544,7 @@ namespace
 
         bool needs_nuspec_data() const override { return false; }
         bool needs_zip_file() const override { return true; }
+        size_t max_concurrent_pushes() const override { return 4; }
 
     private:
         std::vector<UrlTemplate> m_urls;
@@ -526,15 +569,7 @@ namespace
                           View<const InstallPlanAction*> actions,
                           Span<Optional<ZipResource>> out_zip_paths) const override
         {
-            std::vector<std::pair<std::string, Path>> url_paths;
-            for (size_t idx = 0; idx < actions.size(); ++idx)
-            {
-                auto&& action = *actions[idx];
-                auto read_info = BinaryPackageReadInfo{action};
-                url_paths.emplace_back(m_url_template.instantiate_variables(read_info),
-                                       make_temp_archive_path(m_buildtrees, read_info.spec, read_info.package_abi));
-            }
-
+            auto url_paths = make_url_paths(actions);
             WarningDiagnosticContext wdc{context};
             auto codes = download_files_no_cache(wdc, url_paths, m_url_template.headers);
             for (size_t i = 0; i < codes.size(); ++i)
@@ -546,6 +581,52 @@ namespace
             }
         }
 
+        bool try_acquire_zips_as_available(DiagnosticContext& context,
+                                           const Filesystem&,
+                                           View<const InstallPlanAction*> actions,
+                                           AcquiredZipSink& sink) const override
+        {
+            struct SinkListener final : BulkDownloadListener
+            {
+                SinkListener(AcquiredZipSink& sink, std::vector<std::pair<std::string, Path>>& url_paths)
+                    : sink(sink), url_paths(url_paths)
+                {
+                }
+
+                bool still_needed(size_t idx) override { return sink.wants(idx); }
+                void finished(size_t idx, int code) override
+                {
+                    if (code == 200)
+                    {
+                        sink.acquired(idx, ZipResource{std::move(url_paths[idx].second), RemoveWhen::always});
+                    }
+                }
+
+                AcquiredZipSink& sink;
+                std::vector<std::pair<std::string, Path>>& url_paths;
+            };
+
+            auto url_paths = make_url_paths(actions);
+            SinkListener listener{sink, url_paths};
+            WarningDiagnosticContext wdc{context};
+            download_files_no_cache(wdc, url_paths, m_url_template.headers, listener);
+            return true;
+        }
+
+        std::vector<std::pair<std::string, Path>> make_url_paths(View<const InstallPlanAction*> actions) const
+        {
+            std::vector<std::pair<std::string, Path>> url_paths;
+            for (size_t idx = 0; idx < actions.size(); ++idx)
+            {
+                auto&& action = *actions[idx];
+                auto read_info = BinaryPackageReadInfo{action};
+                url_paths.emplace_back(m_url_template.instantiate_variables(read_info),
+                                       make_temp_archive_path(m_buildtrees, read_info.spec, read_info.package_abi));
+            }
+
+            return url_paths;
+        }
+
         void precheck(DiagnosticContext& context,
                       const Filesystem&,
                       View<const InstallPlanAction*> actions,
@@ -623,6 +704,7 @@ namespace
 
         bool needs_nuspec_data() const override { return false; }
         bool needs_zip_file() const override { return true; }
+        size_t max_concurrent_pushes() const override { return 4; }
 
     private:
         std::vector<UrlTemplate> m_urls;
@@ -948,6 +1030,8 @@ namespace
 
         bool needs_nuspec_data() const override { return true; }
         bool needs_zip_file() const override { return false; }
+        // nuget pack writes its output to the shared buildtrees directory
+        size_t max_concurrent_pushes() const override { return 1; }
 
         size_t push_success(DiagnosticContext& context,
                             const Filesystem& fs,
@@ -1005,6 +1089,8 @@ namespace
         virtual LocalizedString restored_message(size_t count,
                                                  std::chrono::high_resolution_clock::duration elapsed) const = 0;
         virtual Optional<CacheAvailability> stat(DiagnosticContext& context, StringView url) const = 0;
+        // Returns the names of the objects directly under `prefix`, or nullopt if they could not be listed.
+        virtual Optional<std::vector<std::string>> list(DiagnosticContext& context, StringView prefix) const = 0;
         virtual Optional<RestoreResult> download_file(DiagnosticContext& context,
                                                       StringView object,
                                                       const Path& archive) const = 0;
@@ -1033,17 +1119,32 @@ namespace
         {
             std::vector<FullyBufferedDiagnosticContext> diagnostic_contexts(actions.size());
             execute_in_parallel(actions.size(), OBJECT_STORAGE_DOWNLOAD_CONCURRENCY, [&](size_t idx) {
-                auto&& action = *actions[idx];
-                const auto& abi = action.package_abi_or_exit(VCPKG_LINE_INFO);
-                auto tmp = make_temp_archive_path(m_buildtrees, action.spec, abi);
-                WarningDiagnosticContext wdc{diagnostic_contexts[idx]};
-                auto res = m_tool->download_file(wdc, make_object_path(m_prefix, abi), tmp);
-                if (auto cache_result = res.get())
+                out_zip_paths[idx] = download_zip(diagnostic_contexts[idx], *actions[idx]);
+            });
+
+            for (auto&& diagnostic_context : diagnostic_contexts)
+            {
+                std::move(diagnostic_context).report_to(context);
+            }
+        }
+
+        // Downloads already in flight cannot be abandoned, as each is a command of the storage tool
+        bool try_acquire_zips_as_available(DiagnosticContext& context,
+                                           const Filesystem&,
+                                           View<const InstallPlanAction*> actions,
+                                           AcquiredZipSink& sink) const override
+        {
+            std::vector<FullyBufferedDiagnosticContext> diagnostic_contexts(actions.size());
+            execute_in_parallel(actions.size(), OBJECT_STORAGE_DOWNLOAD_CONCURRENCY, [&](size_t idx) {
+                if (!sink.wants(idx))
                 {
-                    if (*cache_result == RestoreResult::restored)
-                    {
-                        out_zip_paths[idx].emplace(std::move(tmp), RemoveWhen::always);
-                    }
+                    return;
+                }
+
+                auto maybe_zip = download_zip(diagnostic_contexts[idx], *actions[idx]);
+                if (auto zip = maybe_zip.get())
+                {
+                    sink.acquired(idx, std::move(*zip));
                 }
             });
 
@@ -1051,6 +1152,25 @@ namespace
             {
                 std::move(diagnostic_context).report_to(context);
             }
+
+            return true;
+        }
+
+        Optional<ZipResource> download_zip(DiagnosticContext& context, const InstallPlanAction& action) const
+        {
+            const auto& abi = action.package_abi_or_exit(VCPKG_LINE_INFO);
+            auto tmp = make_temp_archive_path(m_buildtrees, action.spec, abi);
+            WarningDiagnosticContext wdc{context};
+            auto res = m_tool->download_file(wdc, make_object_path(m_prefix, abi), tmp);
+            if (auto cache_result = res.get())
+            {
+                if (*cache_result == RestoreResult::restored)
+                {
+                    return ZipResource{std::move(tmp), RemoveWhen::always};
+                }
+            }
+
+            return nullopt;
         }
 
         void precheck(DiagnosticContext& context,
@@ -1058,11 +1178,30 @@ namespace
                       View<const InstallPlanAction*> actions,
                       Span<CacheAvailability> cache_status) const override
         {
-            for (size_t idx = 0; idx < actions.size(); ++idx)
+            if (actions.size() >= OBJECT_STORAGE_LIST_THRESHOLD && Strings::ends_with(m_prefix, "/"))
             {
-                auto&& action = *actions[idx];
-                const auto& abi = action.package_abi_or_exit(VCPKG_LINE_INFO);
                 WarningDiagnosticContext wdc{context};
+                auto maybe_names = m_tool->list(wdc, m_prefix);
+                if (auto names = maybe_names.get())
+                {
+                    std::unordered_set<std::string> name_set(std::make_move_iterator(names->begin()),
+                                                             std::make_move_iterator(names->end()));
+                    for (size_t idx = 0; idx < actions.size(); ++idx)
+                    {
+                        const auto& abi = actions[idx]->package_abi_or_exit(VCPKG_LINE_INFO);
+                        cache_status[idx] = Util::Sets::contains(name_set, abi + ".zip")
+                                                ? CacheAvailability::available
+                                                : CacheAvailability::unavailable;
+                    }
+
+                    return;
+                }
+            }
+
+            std::vector<FullyBufferedDiagnosticContext> diagnostic_contexts(actions.size());
+            execute_in_parallel(actions.size(), OBJECT_STORAGE_DOWNLOAD_CONCURRENCY, [&](size_t idx) {
+                const auto& abi = actions[idx]->package_abi_or_exit(VCPKG_LINE_INFO);
+                WarningDiagnosticContext wdc{diagnostic_contexts[idx]};
                 auto maybe_res = m_tool->stat(wdc, make_object_path(m_prefix, abi));
                 if (auto res = maybe_res.get())
                 {
@@ -1072,6 +1211,11 @@ namespace
                 {
                     cache_status[idx] = CacheAvailability::unavailable;
                 }
+            });
+
+            for (auto&& diagnostic_context : diagnostic_contexts)
+            {
+                std::move(diagnostic_context).report_to(context);
             }
         }
 
@@ -1116,6 +1260,7 @@ namespace
 
         bool needs_nuspec_data() const override { return false; }
         bool needs_zip_file() const override { return true; }
+        size_t max_concurrent_pushes() const override { return 4; }
 
         std::vector<std::string> m_prefixes;
         std::shared_ptr<const IObjectStorageTool> m_tool;
@@ -1190,7 +1335,7 @@ namespace
                 abi_index_map[abi] = idx;
             }
 
-            const auto tmp_downloads_location = m_buildtrees / ".azcopy";
+            const auto tmp_downloads_location = m_buildtrees / fmt::format(".azcopy-{}", m_instance);
             auto base_cmd = Command{m_tool}
                                 .string_arg("copy")
                                 .string_arg("--from-to")
@@ -1306,6 +1451,8 @@ namespace
 
         bool needs_nuspec_data() const override { return false; }
         bool needs_zip_file() const override { return true; }
+        // azcopy parallelizes each transfer on its own
+        size_t max_concurrent_pushes() const override { return 2; }
 
         std::vector<AzCopyUrl> m_containers;
         Path m_tool;
@@ -1333,6 +1480,18 @@ namespace
             return nullopt;
         }
 
+        Optional<std::vector<std::string>> list(DiagnosticContext& context, StringView prefix) const override
+        {
+            auto cmd = Command{m_tool}.string_arg("ls").string_arg(prefix);
+            auto maybe_code_and_output = cmd_execute_and_capture_output(context, cmd);
+            if (check_zero_exit_code(context, cmd, maybe_code_and_output))
+            {
+                return parse_object_storage_listing(maybe_code_and_output.value_or_exit(VCPKG_LINE_INFO).output);
+            }
+
+            return nullopt;
+        }
+
         Optional<RestoreResult> download_file(DiagnosticContext& context,
                                               StringView object,
                                               const Path& archive) const override
@@ -1404,6 +1563,30 @@ namespace
             return nullopt;
         }
 
+        Optional<std::vector<std::string>> list(DiagnosticContext& context, StringView prefix) const override
+        {
+            auto cmd = Command{m_tool}.string_arg("s3").string_arg("ls").string_arg(prefix);
+            if (m_no_sign_request)
+            {
+                cmd.string_arg("--no-sign-request");
+            }
+
+            auto maybe_code_and_output = cmd_execute_and_capture_output(context, cmd);
+            if (auto code_and_output = maybe_code_and_output.get())
+            {
+                // As in stat(), an empty prefix results in no output and exit code 1.
+                if (code_and_output->exit_code == 0 ||
+                    (code_and_output->exit_code == 1 && Strings::trim(code_and_output->output).empty()))
+                {
+                    return parse_object_storage_listing(code_and_output->output);
+                }
+
+                report_nonzero_exit_code_and_output(context, cmd, *code_and_output);
+            }
+
+            return nullopt;
+        }
+
         Optional<RestoreResult> download_file(DiagnosticContext& context,
                                               StringView object,
                                               const Path& archive) const override
@@ -1474,6 +1657,9 @@ namespace
             return nullopt;
         }
 
+        // coscli prints listings as a formatted table, so the caller falls back to stat() for each object
+        Optional<std::vector<std::string>> list(DiagnosticContext&, StringView) const override { return nullopt; }
+
         Optional<RestoreResult> download_file(DiagnosticContext& context,
                                               StringView object,
                                               const Path& archive) const override
@@ -1609,6 +1795,8 @@ namespace
 
         bool needs_nuspec_data() const override { return false; }
         bool needs_zip_file() const override { return true; }
+        // concurrent az invocations contend on the same Azure CLI configuration directory
+        size_t max_concurrent_pushes() const override { return 1; }
 
     private:
         AzureUpkgTool m_azure_tool;
@@ -1647,31 +1835,62 @@ namespace
                           View<const InstallPlanAction*> actions,
                           Span<Optional<ZipResource>> out_zips) const override
         {
-            WarningDiagnosticContext wdc{context};
             for (size_t i = 0; i < actions.size(); ++i)
             {
-                const auto& action = *actions[i];
-                const auto info = BinaryPackageReadInfo{action};
-                const auto ref = make_feedref(info, "");
-
-                Path temp_dir = m_buildtrees / fmt::format("upkg_download_{}", info.package_abi);
-                Path temp_zip_path = temp_dir / fmt::format("{}.zip", ref.id);
-                Path final_zip_path = m_buildtrees / fmt::format("{}.zip", ref.id);
+                out_zips[i] = download_zip(context, fs, *actions[i]);
+            }
+        }
 
-                const auto result = m_azure_tool.download(wdc, m_source, ref.id, ref.version, temp_dir);
-                if (result && fs.exists(temp_zip_path, IgnoreErrors{}) && fs.rename(wdc, temp_zip_path, final_zip_path))
+        bool try_acquire_zips_as_available(DiagnosticContext& context,
+                                           const Filesystem& fs,
+                                           View<const InstallPlanAction*> actions,
+                                           AcquiredZipSink& sink) const override
+        {
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                if (!sink.wants(i))
                 {
-                    out_zips[i].emplace(std::move(final_zip_path), RemoveWhen::always);
+                    continue;
                 }
 
-                if (fs.exists(temp_dir, IgnoreErrors{}))
+                auto maybe_zip = download_zip(context, fs, *actions[i]);
+                if (auto zip = maybe_zip.get())
                 {
-                    fs.remove_all(temp_dir, IgnoreErrors{});
+                    sink.acquired(i, std::move(*zip));
                 }
             }
+
+            return true;
         }
 
     private:
+        Optional<ZipResource> download_zip(DiagnosticContext& context,
+                                           const Filesystem& fs,
+                                           const InstallPlanAction& action) const
+        {
+            WarningDiagnosticContext wdc{context};
+            const auto info = BinaryPackageReadInfo{action};
+            const auto ref = make_feedref(info, "");
+
+            Path temp_dir = m_buildtrees / fmt::format("upkg_download_{}_{}", info.package_abi, m_instance);
+            Path temp_zip_path = temp_dir / fmt::format("{}.zip", ref.id);
+            Path final_zip_path = m_buildtrees / fmt::format("{}_{}.zip", ref.id, m_instance);
+
+            Optional<ZipResource> zip;
+            const auto result = m_azure_tool.download(wdc, m_source, ref.id, ref.version, temp_dir);
+            if (result && fs.exists(temp_zip_path, IgnoreErrors{}) && fs.rename(wdc, temp_zip_path, final_zip_path))
+            {
+                zip.emplace(std::move(final_zip_path), RemoveWhen::always);
+            }
+
+            if (fs.exists(temp_dir, IgnoreErrors{}))
+            {
+                fs.remove_all(temp_dir, IgnoreErrors{});
+            }
+
+            return zip;
+        }
+
         AzureUpkgTool m_azure_tool;
         AzureUpkgSource m_source;
         const Path& m_buildtrees;
@@ -1872,6 +2091,28 @@ namespace
 
                 state->nuget_interactive = true;
             }
+            else if (segments[0].second == "x-concurrent-fetch")
+            {
+                if (segments.size() > 1)
+                {
+                    return add_error(msg::format(msgInvalidArgumentRequiresNoneArguments,
+                                                 msg::binary_source = "x-concurrent-fetch"),
+                                     segments[1].first);
+                }
+
+                state->concurrent_fetch = true;
+            }
+            else if (segments[0].second == "x-direct-restore")
+            {
+                if (segments.size() > 1)
+                {
+                    return add_error(msg::format(msgInvalidArgumentRequiresNoneArguments,
+                                                 msg::binary_source = "x-direct-restore"),
+                                     segments[1].first);
+                }
+
+                state->direct_restore = true;
+            }
             else if (segments[0].second == "nugetconfig")
             {
                 if (segments.size() < 2)
@@ -2346,6 +2587,28 @@ namespace
             }
         }
     };
+
+    size_t default_max_push_workers()
+    {
+        auto maybe_user_defined = get_environment_variable(EnvironmentVariableXVcpkgBinaryCachePushConcurrency);
+        if (auto user_defined = maybe_user_defined.get())
+        {
+            auto maybe_workers = Strings::strto<int>(*user_defined);
+            auto workers = maybe_workers.get();
+            if (!workers || *workers <= 0)
+            {
+                Checks::msg_exit_with_message(VCPKG_LINE_INFO,
+                                              msgEnvInvalidMaxConcurrency,
+                                              msg::env_var = EnvironmentVariableXVcpkgBinaryCachePushConcurrency,
+                                              msg::value = *user_defined);
+            }
+
+            return static_cast<size_t>(*workers);
+        }
+
+        // Compression competes with the build for CPU time, so only use a fraction of the available threads.
+        return (std::max)(size_t{1}, (std::min)(static_cast<size_t>(get_concurrency()) / 4, size_t{8}));
+    }
 }
 
 namespace vcpkg
@@ -2449,8 +2712,66 @@ namespace vcpkg
                 get_environment_variable(EnvironmentVariableGitHubSha).value_or("")};
     }
 
+    bool IReadBinaryProvider::try_acquire_zips(DiagnosticContext&,
+                                               const Filesystem&,
+                                               View<const InstallPlanAction*>,
+                                               Span<Optional<ZipResource>>) const
+    {
+        return false;
+    }
+
+    bool IReadBinaryProvider::try_acquire_zips_as_available(DiagnosticContext& context,
+                                                            const Filesystem& fs,
+                                                            View<const InstallPlanAction*> actions,
+                                                            AcquiredZipSink& sink) const
+    {
+        // Providers which only acquire archives in one batch deliver them once the batch is done
+        std::vector<const InstallPlanAction*> wanted_actions;
+        std::vector<size_t> wanted_indices;
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            if (sink.wants(i))
+            {
+                wanted_actions.push_back(actions[i]);
+                wanted_indices.push_back(i);
+            }
+        }
+
+        std::vector<Optional<ZipResource>> zips(wanted_actions.size());
+        if (!try_acquire_zips(context, fs, wanted_actions, zips))
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < zips.size(); ++i)
+        {
+            if (auto zip = zips[i].get())
+            {
+                sink.acquired(wanted_indices[i], std::move(*zip));
+            }
+        }
+
+        return true;
+    }
+
+    void IReadBinaryProvider::extract_zips(DiagnosticContext&,
+                                           const Filesystem&,
+                                           View<const InstallPlanAction*>,
+                                           View<Optional<ZipResource>>,
+                                           Span<RestoreResult>) const
+    {
+        Checks::unreachable(VCPKG_LINE_INFO);
+    }
+
     void ReadOnlyBinaryCache::fetch(DiagnosticContext& context, const Filesystem& fs, View<InstallPlanAction> actions)
     {
+        if (m_config.concurrent_fetch && m_config.read.size() > 1)
+        {
+            fetch_concurrently(context, fs, actions);
+        }
+
+        // Providers which can't acquire zips separately, and any packages which failed to extract after being acquired
+        // concurrently, are handled one provider at a time.
         std::vector<const InstallPlanAction*> action_ptrs;
         std::vector<RestoreResult> restores;
         std::vector<CacheStatus*> statuses;
@@ -2475,7 +2796,22 @@ namespace vcpkg
             if (action_ptrs.empty()) continue;
 
             ElapsedTimer timer;
-            provider->fetch(context, fs, action_ptrs, restores);
+            bool extracted = false;
+            if (m_config.direct_restore)
+            {
+                std::vector<Optional<ZipResource>> zips(action_ptrs.size());
+                if (provider->try_acquire_zips(context, fs, action_ptrs, zips))
+                {
+                    extract_zips(context, fs, *provider, action_ptrs, zips, statuses, restores);
+                    extracted = true;
+                }
+            }
+
+            if (!extracted)
+            {
+                provider->fetch(context, fs, action_ptrs, restores);
+            }
+
             size_t num_restored = 0;
             for (size_t i = 0; i < restores.size(); ++i)
             {
@@ -2494,6 +2830,222 @@ namespace vcpkg
         }
     }
 
+    void ReadOnlyBinaryCache::fetch_concurrently(DiagnosticContext& context,
+                                                 const Filesystem& fs,
+                                                 View<InstallPlanAction> actions)
+    {
+        enum class ZipOutcome
+        {
+            // The provider does not have the archive
+            missing,
+            // The provider did not request the archive, as another provider had already delivered it
+            skipped,
+            // The provider delivered the archive after another provider did
+            lost,
+            // The provider was the first to deliver the archive
+            won,
+        };
+
+        struct ProviderFetch;
+        struct ConcurrentFetch
+        {
+            const Filesystem* fs;
+            std::mutex mtx;
+            std::condition_variable cv;
+            // Statuses whose archive has been delivered by some provider. m_status is not modified until all providers
+            // have finished, so the CacheStatus pointers remain valid.
+            std::set<const CacheStatus*> claimed;
+            // Archives which were delivered first, waiting to be extracted
+            std::vector<std::pair<ProviderFetch*, size_t>> ready;
+            size_t providers_running = 0;
+        };
+
+        struct ProviderFetch final : AcquiredZipSink
+        {
+            ConcurrentFetch* shared;
+            const IReadBinaryProvider* provider;
+            std::vector<const InstallPlanAction*> actions;
+            std::vector<CacheStatus*> statuses;
+            // Each element is written under shared->mtx, and no longer changes once its archive is delivered
+            std::vector<Optional<ZipResource>> zips;
+            std::vector<ZipOutcome> outcomes;
+            // Only touched by the thread acquiring from this provider
+            FullyBufferedDiagnosticContext acquire_fbdc;
+            bool acquired_zips = false;
+            ElapsedTime acquire_elapsed;
+            // Only touched by the thread extracting archives
+            FullyBufferedDiagnosticContext extract_fbdc;
+            std::vector<RestoreResult> restores;
+            ElapsedTime extract_elapsed;
+
+            bool wants(size_t idx) override
+            {
+                std::lock_guard<std::mutex> lock(shared->mtx);
+                if (Util::Sets::contains(shared->claimed, statuses[idx]))
+                {
+                    outcomes[idx] = ZipOutcome::skipped;
+                    return false;
+                }
+
+                return true;
+            }
+
+            void acquired(size_t idx, ZipResource&& zip) override
+            {
+                std::unique_lock<std::mutex> lock(shared->mtx);
+                if (shared->claimed.insert(statuses[idx]).second)
+                {
+                    outcomes[idx] = ZipOutcome::won;
+                    zips[idx].emplace(std::move(zip));
+                    shared->ready.emplace_back(this, idx);
+                    shared->cv.notify_all();
+                    return;
+                }
+
+                outcomes[idx] = ZipOutcome::lost;
+                lock.unlock();
+                // Another provider was faster; discard the duplicate download
+                if (zip.to_remove == RemoveWhen::always)
+                {
+                    shared->fs->remove(zip.path, IgnoreErrors{});
+                }
+            }
+        };
+
+        ConcurrentFetch shared;
+        shared.fs = &fs;
+        std::vector<ProviderFetch> fetches(m_config.read.size());
+        for (size_t provider_idx = 0; provider_idx < m_config.read.size(); ++provider_idx)
+        {
+            auto& fetch = fetches[provider_idx];
+            fetch.shared = &shared;
+            fetch.provider = m_config.read[provider_idx].get();
+            for (auto&& action : actions)
+            {
+                if (auto abi = action.package_abi())
+                {
+                    CacheStatus& status = m_status[*abi];
+                    if (status.should_attempt_restore(fetch.provider))
+                    {
+                        fetch.actions.push_back(&action);
+                        fetch.statuses.push_back(&status);
+                    }
+                }
+            }
+
+            fetch.zips.resize(fetch.actions.size());
+            fetch.outcomes.resize(fetch.actions.size(), ZipOutcome::missing);
+            fetch.restores.resize(fetch.actions.size(), RestoreResult::unavailable);
+        }
+
+        Util::erase_remove_if(fetches, [](const ProviderFetch& fetch) { return fetch.actions.empty(); });
+        shared.providers_running = fetches.size();
+
+        ElapsedTimer timer;
+        std::vector<std::thread> threads;
+        threads.reserve(fetches.size());
+        for (auto&& fetch : fetches)
+        {
+            threads.emplace_back([&fs, &timer, &fetch] {
+                fetch.acquired_zips =
+                    fetch.provider->try_acquire_zips_as_available(fetch.acquire_fbdc, fs, fetch.actions, fetch);
+                fetch.acquire_elapsed = timer.elapsed();
+                std::lock_guard<std::mutex> lock(fetch.shared->mtx);
+                --fetch.shared->providers_running;
+                fetch.shared->cv.notify_all();
+            });
+        }
+
+        // Extract each archive as soon as it is delivered, while slower providers are still running. Providers skip,
+        // and where they can abandon, the archives which have already been delivered.
+        {
+            std::unique_lock<std::mutex> lock(shared.mtx);
+            for (;;)
+            {
+                shared.cv.wait(lock, [&] { return !shared.ready.empty() || shared.providers_running == 0; });
+                if (shared.ready.empty())
+                {
+                    break;
+                }
+
+                auto ready = std::move(shared.ready);
+                shared.ready.clear();
+                lock.unlock();
+                for (auto&& fetch : fetches)
+                {
+                    std::vector<const InstallPlanAction*> won_actions;
+                    std::vector<Optional<ZipResource>> won_zips;
+                    std::vector<CacheStatus*> won_statuses;
+                    std::vector<size_t> won_indices;
+                    for (auto&& ready_zip : ready)
+                    {
+                        if (ready_zip.first == &fetch)
+                        {
+                            const auto idx = ready_zip.second;
+                            won_actions.push_back(fetch.actions[idx]);
+                            // zips[idx] is not modified once the archive has been delivered
+                            won_zips.push_back(fetch.zips[idx]);
+                            won_statuses.push_back(fetch.statuses[idx]);
+                            won_indices.push_back(idx);
+                        }
+                    }
+
+                    if (won_actions.empty())
+                    {
+                        continue;
+                    }
+
+                    std::vector<RestoreResult> won_restores(won_actions.size(), RestoreResult::unavailable);
+                    extract_zips(
+                        fetch.extract_fbdc, fs, *fetch.provider, won_actions, won_zips, won_statuses, won_restores);
+                    for (size_t i = 0; i < won_indices.size(); ++i)
+                    {
+                        fetch.restores[won_indices[i]] = won_restores[i];
+                    }
+
+                    fetch.extract_elapsed = timer.elapsed();
+                }
+
+                lock.lock();
+            }
+        }
+
+        for (auto&& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (auto&& fetch : fetches)
+        {
+            std::move(fetch.acquire_fbdc).report_to(context);
+            std::move(fetch.extract_fbdc).report_to(context);
+            if (!fetch.acquired_zips)
+            {
+                continue;
+            }
+
+            size_t num_restored = 0;
+            for (size_t i = 0; i < fetch.actions.size(); ++i)
+            {
+                if (fetch.restores[i] == RestoreResult::restored)
+                {
+                    fetch.statuses[i]->mark_restored();
+                    ++num_restored;
+                }
+                else if (fetch.outcomes[i] == ZipOutcome::missing || fetch.outcomes[i] == ZipOutcome::won)
+                {
+                    // Providers which skipped the archive or lost the race are not marked, so that they can be tried
+                    // again if the winner's copy fails to extract.
+                    fetch.statuses[i]->mark_unavailable(fetch.provider);
+                }
+            }
+
+            const auto elapsed = (std::max)(fetch.acquire_elapsed.as<std::chrono::high_resolution_clock::duration>(),
+                                            fetch.extract_elapsed.as<std::chrono::high_resolution_clock::duration>());
+            context.statusln(fetch.provider->restored_message(num_restored, elapsed));
+        }
+    }
+
     bool ReadOnlyBinaryCache::is_restored(const InstallPlanAction& action) const
     {
         if (auto abi = action.package_abi())
@@ -2504,11 +3056,84 @@ namespace vcpkg
         return false;
     }
 
+    const DeferredArchive* ReadOnlyBinaryCache::deferred_archive(const InstallPlanAction& action) const
+    {
+        if (auto abi = action.package_abi())
+        {
+            auto it = m_status.find(*abi);
+            if (it != m_status.end()) return it->second.deferred_archive();
+        }
+        return nullptr;
+    }
+
+    void ReadOnlyBinaryCache::extract_zips(DiagnosticContext& context,
+                                           const Filesystem& fs,
+                                           const IReadBinaryProvider& provider,
+                                           View<const InstallPlanAction*> actions,
+                                           View<Optional<ZipResource>> zips,
+                                           View<CacheStatus*> statuses,
+                                           Span<RestoreResult> out_status)
+    {
+        if (!m_config.direct_restore)
+        {
+            provider.extract_zips(context, fs, actions, zips, out_status);
+            return;
+        }
+
+        std::vector<Optional<DeferredArchive>> deferred(actions.size());
+        execute_in_parallel(actions.size(), [&](size_t i) {
+            if (auto zip = zips[i].get())
+            {
+                deferred[i] = try_defer_archive(fs, actions[i]->package_dir, *zip);
+            }
+        });
+
+        // Archives which could not be deferred are extracted by the provider as usual
+        std::vector<Optional<ZipResource>> remaining_zips(zips.begin(), zips.end());
+        bool any_remaining = false;
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            if (!deferred[i].has_value())
+            {
+                any_remaining |= remaining_zips[i].has_value();
+            }
+            else
+            {
+                remaining_zips[i].clear();
+                out_status[i] = RestoreResult::restored;
+                auto previous = statuses[i]->set_deferred_archive(std::move(deferred[i]));
+                if (auto previous_archive = previous.get())
+                {
+                    if (previous_archive->zip.to_remove == RemoveWhen::always &&
+                        previous_archive->zip.path != zips[i].get()->path)
+                    {
+                        fs.remove(previous_archive->zip.path, IgnoreErrors{});
+                    }
+                }
+            }
+        }
+
+        if (any_remaining)
+        {
+            provider.extract_zips(context, fs, actions, remaining_zips, out_status);
+        }
+    }
+
     void ReadOnlyBinaryCache::install_read_provider(std::unique_ptr<IReadBinaryProvider>&& provider)
     {
         m_config.read.push_back(std::move(provider));
     }
 
+    void ReadOnlyBinaryCache::set_concurrent_fetch(bool concurrent_fetch) noexcept
+    {
+        m_config.concurrent_fetch = concurrent_fetch;
+    }
+
+    void ReadOnlyBinaryCache::set_direct_restore(bool direct_restore) noexcept
+    {
+        m_config.direct_restore = direct_restore;
+    }
+
     void ReadOnlyBinaryCache::mark_all_unrestored()
     {
         for (auto& entry : m_status)
@@ -2697,6 +3322,8 @@ namespace vcpkg
             s.use_nuget_cache = args.use_nuget_cache.value_or(false);
 
             m_config.nuget_repo = get_nuget_repo_info_from_env(args);
+            m_config.concurrent_fetch = s.concurrent_fetch;
+            m_config.direct_restore = s.direct_restore;
 
             const auto& buildtrees = paths.buildtrees();
 
@@ -2899,11 +3526,35 @@ namespace vcpkg
 
         return true;
     }
-    BinaryCache::BinaryCache(const Filesystem& fs)
-        : m_fs(fs), m_bg_msg_sink(stdout_sink), m_push_thread(&BinaryCache::push_thread_main, this)
+    BinaryCache::BinaryCache(const Filesystem& fs) : BinaryCache(fs, default_max_push_workers()) { }
+    BinaryCache::BinaryCache(const Filesystem& fs, size_t max_push_workers)
+        : m_fs(fs), m_bg_msg_sink(stdout_sink), m_max_push_workers((std::max)(max_push_workers, size_t{1}))
+    {
+    }
+    BinaryCache::~BinaryCache()
+    {
+        wait_for_async_complete_and_join();
+        // Remove downloaded archives of packages that were restored but never installed
+        for (auto&& status : m_status)
+        {
+            auto deferred_archive = status.second.set_deferred_archive(nullopt);
+            if (auto archive = deferred_archive.get())
+            {
+                if (archive->zip.to_remove == RemoveWhen::always)
+                {
+                    m_fs.remove(archive->zip.path, IgnoreErrors{});
+                }
+            }
+        }
+    }
+
+    void BinaryCache::install_write_provider(std::unique_ptr<IWriteBinaryProvider>&& provider)
     {
+        Checks::check_exit(VCPKG_LINE_INFO, !m_push_threads_started);
+        m_needs_nuspec_data |= provider->needs_nuspec_data();
+        m_needs_zip_file |= provider->needs_zip_file();
+        m_config.write.push_back(std::move(provider));
     }
-    BinaryCache::~BinaryCache() { wait_for_async_complete_and_join(); }
 
     void BinaryCache::push_success(CleanPackages clean_packages, const InstallPlanAction& action)
     {
@@ -2918,6 +3569,14 @@ namespace vcpkg
             else
             {
                 restored = it->second.is_restored();
+                auto deferred_archive = it->second.set_deferred_archive(nullopt);
+                if (auto archive = deferred_archive.get())
+                {
+                    if (archive->zip.to_remove == RemoveWhen::always)
+                    {
+                        m_fs.remove(archive->zip.path, IgnoreErrors{});
+                    }
+                }
 
                 // Purge all status information on push_success (cache invalidation)
                 // - push_success may delete packages/ (invalidate restore)
@@ -2927,7 +3586,6 @@ namespace vcpkg
 
             if (!restored && !m_config.write.empty())
             {
-                ElapsedTimer timer;
                 BinaryPackageWriteInfo request{action};
 
                 if (m_needs_nuspec_data)
@@ -2941,11 +3599,16 @@ namespace vcpkg
                     request.unique_write_provider = true;
                 }
 
+                if (!m_push_threads_started)
+                {
+                    start_push_threads();
+                }
+
                 m_synchronizer.add_submitted();
                 msg::println(msg::format(msgSubmittingBinaryCacheBackground,
                                          msg::spec = action.display_name(),
                                          msg::count = m_config.write.size()));
-                m_actions_to_push.push(ActionToPush{std::move(request), clean_packages});
+                m_actions_to_push.push(std::make_shared<PushJob>(std::move(request), clean_packages));
                 return;
             }
         }
@@ -2968,66 +3631,142 @@ namespace vcpkg
         }
 
         m_bg_msg_sink.publish_directly_to_out_sink();
+
+        // Drain the stages in order: once every compression thread has exited, no more work can reach the upload
+        // queues.
         m_actions_to_push.stop();
-        if (m_push_thread.joinable())
+        for (auto&& thread : m_compress_threads)
+        {
+            thread.join();
+        }
+
+        m_compress_threads.clear();
+        for (auto&& queue : m_provider_queues)
+        {
+            queue->jobs.stop();
+        }
+
+        for (auto&& queue : m_provider_queues)
+        {
+            for (auto&& thread : queue->threads)
+            {
+                thread.join();
+            }
+
+            queue->threads.clear();
+        }
+    }
+
+    void BinaryCache::start_push_threads()
+    {
+        m_push_threads_started = true;
+        for (auto&& provider : m_config.write)
+        {
+            auto& queue = *m_provider_queues.emplace_back(std::make_unique<ProviderPushQueue>());
+            queue.provider = provider.get();
+            const auto upload_thread_count =
+                (std::max)((std::min)(provider->max_concurrent_pushes(), m_max_push_workers), size_t{1});
+            for (size_t i = 0; i < upload_thread_count; ++i)
+            {
+                queue.threads.emplace_back(&BinaryCache::upload_thread_main, this, std::ref(queue));
+            }
+        }
+
+        for (size_t i = 0; i < m_max_push_workers; ++i)
         {
-            m_push_thread.join();
+            m_compress_threads.emplace_back(&BinaryCache::compress_thread_main, this);
         }
     }
 
-    void BinaryCache::push_thread_main()
+    void BinaryCache::compress_thread_main()
     {
-        std::vector<ActionToPush> my_tasks;
+        std::shared_ptr<PushJob> job;
         PrintingDiagnosticContext pdc{m_bg_msg_sink};
-        WarningDiagnosticContext wdc{pdc};
-        while (m_actions_to_push.get_work(my_tasks))
+        std::vector<ProviderPushQueue*> destinations;
+        while (m_actions_to_push.get_one(job))
         {
-            for (auto& action_to_push : my_tasks)
+            job->started = ElapsedTime::clock::now();
+            auto& request = job->request;
+            if (m_needs_zip_file)
             {
-                ElapsedTimer timer;
-                if (m_needs_zip_file)
+                Path zip_path = request.package_dir + ".zip";
+                if (m_zip_tool.compress_directory_to_zip(pdc, m_fs, request.package_dir, zip_path))
                 {
-                    Path zip_path = action_to_push.request.package_dir + ".zip";
-                    if (m_zip_tool.compress_directory_to_zip(pdc, m_fs, action_to_push.request.package_dir, zip_path))
-                    {
-                        action_to_push.request.zip_path = std::move(zip_path);
-                    }
+                    request.zip_path = std::move(zip_path);
                 }
+            }
 
-                size_t num_destinations = 0;
-                for (auto&& provider : m_config.write)
+            destinations.clear();
+            for (auto&& queue : m_provider_queues)
+            {
+                if (!queue->provider->needs_zip_file() || request.zip_path.has_value())
                 {
-                    if (!provider->needs_zip_file() || action_to_push.request.zip_path.has_value())
-                    {
-                        num_destinations += provider->push_success(pdc, m_fs, action_to_push.request);
-                    }
+                    destinations.push_back(queue.get());
                 }
+            }
 
-                if (action_to_push.request.zip_path)
-                {
-                    (void)m_fs.remove(wdc, *action_to_push.request.zip_path.get());
-                }
+            if (destinations.empty())
+            {
+                complete_push(*job);
+                continue;
+            }
 
-                if (action_to_push.clean_after_push == CleanPackages::Yes)
-                {
-                    (void)m_fs.remove_all(wdc, action_to_push.request.package_dir);
-                }
+            // Set the count before any upload thread can see the job, as they may finish before we return.
+            job->remaining_uploads.store(destinations.size(), std::memory_order_release);
+            for (auto destination : destinations)
+            {
+                destination->jobs.push(job);
+            }
 
-                auto sync_state = m_synchronizer.fetch_add_completed();
-                auto message = msg::format(msgSubmittingBinaryCacheComplete,
-                                           msg::spec = action_to_push.request.display_name,
-                                           msg::count = num_destinations,
-                                           msg::elapsed = timer.elapsed());
-                if (sync_state.submission_complete)
-                {
-                    message.append_raw(fmt::format(" ({}/{})", sync_state.jobs_completed, sync_state.jobs_submitted));
-                }
+            job.reset();
+        }
+    }
 
-                m_bg_msg_sink.println(message);
+    void BinaryCache::upload_thread_main(ProviderPushQueue& queue)
+    {
+        std::shared_ptr<PushJob> job;
+        PrintingDiagnosticContext pdc{m_bg_msg_sink};
+        while (queue.jobs.get_one(job))
+        {
+            job->num_destinations.fetch_add(queue.provider->push_success(pdc, m_fs, job->request),
+                                            std::memory_order_relaxed);
+            if (job->remaining_uploads.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                complete_push(*job);
             }
+
+            job.reset();
         }
     }
 
+    void BinaryCache::complete_push(PushJob& job)
+    {
+        PrintingDiagnosticContext pdc{m_bg_msg_sink};
+        WarningDiagnosticContext wdc{pdc};
+        auto& request = job.request;
+        if (request.zip_path)
+        {
+            (void)m_fs.remove(wdc, *request.zip_path.get());
+        }
+
+        if (job.clean_after_push == CleanPackages::Yes)
+        {
+            (void)m_fs.remove_all(wdc, request.package_dir);
+        }
+
+        auto sync_state = m_synchronizer.fetch_add_completed();
+        auto message = msg::format(msgSubmittingBinaryCacheComplete,
+                                   msg::spec = request.display_name,
+                                   msg::count = job.num_destinations.load(std::memory_order_relaxed),
+                                   msg::elapsed = ElapsedTime(ElapsedTime::clock::now() - job.started));
+        if (sync_state.submission_complete)
+        {
+            message.append_raw(fmt::format(" ({}/{})", sync_state.jobs_completed, sync_state.jobs_submitted));
+        }
+
+        m_bg_msg_sink.println(message);
+    }
+
     bool CacheStatus::should_attempt_precheck(const IReadBinaryProvider* sender) const noexcept
     {
         switch (m_status)
@@ -3057,6 +3796,16 @@ namespace vcpkg
 
     bool CacheStatus::is_restored() const noexcept { return m_status == CacheStatusState::restored; }
 
+    const DeferredArchive* CacheStatus::deferred_archive() const noexcept
+    {
+        return m_status == CacheStatusState::restored ? m_deferred_archive.get() : nullptr;
+    }
+
+    Optional<DeferredArchive> CacheStatus::set_deferred_archive(Optional<DeferredArchive>&& archive)
+    {
+        return std::exchange(m_deferred_archive, std::move(archive));
+    }
+
     void CacheStatus::mark_unavailable(const IReadBinaryProvider* sender)
     {
         if (!Util::Vectors::contains(m_known_unavailable_providers, sender))
@@ -3224,6 +3973,26 @@ ExpectedL<BinaryConfigParserState> vcpkg::parse_binary_provider_configs(const st
     return s;
 }
 
+std::vector<std::string> vcpkg::parse_object_storage_listing(StringView output)
+{
+    std::vector<std::string> result;
+    for (auto&& line : Strings::split(output, '\n'))
+    {
+        // gsutil prints the URL of each object, while aws prints the date, time, size, and name of each object.
+        // Both print "subdirectories" with a trailing /, which are skipped.
+        const auto trimmed = Strings::trim(line);
+        const auto name_start = std::find_if(trimmed.rbegin(), trimmed.rend(), [](char c) {
+                                    return c == '/' || ParserBase::is_whitespace(c);
+                                }).base();
+        if (name_start != trimmed.end())
+        {
+            result.emplace_back(name_start, trimmed.end());
+        }
+    }
+
+    return result;
+}
+
 std::string vcpkg::format_version_for_feedref(StringView version_text, StringView abi_tag)
 {
     // this cannot use DotVersion::try_parse or DateVersion::try_parse,
@@ -3365,6 +4134,8 @@ LocalizedString vcpkg::format_help_topic_binary_caching()
     table.format("x-gcs,<prefix>[,<rw>]", msg::format(msgHelpBinaryCachingGcs));
     table.format("x-cos,<prefix>[,<rw>]", msg::format(msgHelpBinaryCachingCos));
     table.format("x-az-universal,<organization>,<project>,<feed>[,<rw>]", msg::format(msgHelpBinaryCachingAzUpkg));
+    table.format("x-concurrent-fetch", msg::format(msgHelpBinaryCachingConcurrentFetch));
+    table.format("x-direct-restore", msg::format(msgHelpBinaryCachingDirectRestore));
     table.blank();
 
     // NuGet sources:
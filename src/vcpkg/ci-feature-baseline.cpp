@@ -21,7 +21,7 @@ namespace
         else if (auto maybe_platform = entry.platform.get())
         {
             return maybe_platform->value.evaluate(
-                var_provider.get_or_load_dep_info_vars(PackageSpec{entry.name.value, triplet}, host_triplet));
+                var_provider.get_or_load_dep_info_identifiers(PackageSpec{entry.name.value, triplet}, host_triplet));
         }
         return true;
     }
@@ -1,16 +1,29 @@
 #include <vcpkg/base/contractual-constants.h>
+#include <vcpkg/base/diagnostics.h>
+#include <vcpkg/base/file-hash-cache.h>
+#include <vcpkg/base/hash.h>
+#include <vcpkg/base/json.h>
 #include <vcpkg/base/optional.h>
+#include <vcpkg/base/parallel-algorithms.h>
+#include <vcpkg/base/parse.h>
 #include <vcpkg/base/span.h>
 #include <vcpkg/base/strings.h>
 #include <vcpkg/base/system.debug.h>
+#include <vcpkg/base/system.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
 
 #include <vcpkg/buildenvironment.h>
 #include <vcpkg/cmakevars.h>
+#include <vcpkg/commands.version.h>
 #include <vcpkg/dependencies.h>
+#include <vcpkg/platform-expression.h>
+#include <vcpkg/tools.h>
 #include <vcpkg/vcpkgpaths.h>
 
+#include <mutex>
+#include <set>
+
 using namespace vcpkg;
 namespace vcpkg::CMakeVars
 {
@@ -42,11 +55,28 @@ namespace vcpkg::CMakeVars
         return *vars;
     }
 
+    const PlatformExpression::ContextIdentifiers& CMakeVarProvider::get_or_load_dep_info_identifiers(
+        const PackageSpec& spec, Triplet host_triplet) const
+    {
+        auto identifiers = get_dep_info_identifiers(spec);
+        if (!identifiers)
+        {
+            load_dep_info_vars({&spec, 1}, host_triplet);
+            identifiers = get_dep_info_identifiers(spec);
+            Checks::check_exit(VCPKG_LINE_INFO, identifiers != nullptr);
+        }
+
+        return *identifiers;
+    }
+
     namespace
     {
+        using VarList = std::vector<std::pair<std::string, std::string>>;
+
         struct TripletCMakeVarProvider : CMakeVarProvider
         {
             explicit TripletCMakeVarProvider(const vcpkg::VcpkgPaths& paths) : paths(paths) { }
+            ~TripletCMakeVarProvider();
             TripletCMakeVarProvider(const TripletCMakeVarProvider&) = delete;
             TripletCMakeVarProvider& operator=(const TripletCMakeVarProvider&) = delete;
 
@@ -62,6 +92,9 @@ namespace vcpkg::CMakeVars
             const std::unordered_map<std::string, std::string>* get_dep_info_vars(
                 const PackageSpec& spec) const override;
 
+            const PlatformExpression::ContextIdentifiers* get_dep_info_identifiers(
+                const PackageSpec& spec) const override;
+
             const std::unordered_map<std::string, std::string>* get_tag_vars(const PackageSpec& spec) const override;
 
         public:
@@ -69,11 +102,33 @@ namespace vcpkg::CMakeVars
 
             Path create_dep_info_extraction_file(const View<PackageSpec> specs) const;
 
-            void launch_and_split(const Path& script_path,
-                                  std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const;
+            // Does not exit on failure, as it runs on the worker threads of launch_and_split_sharded
+            static ExpectedL<Unit> launch_and_split(const Command& cmd,
+                                                    Span<std::vector<std::pair<std::string, std::string>>> vars);
+
+            template<class SpecType>
+            void launch_and_split_sharded(View<SpecType> specs,
+                                          Path (TripletCMakeVarProvider::*create_extraction_file)(View<SpecType>)
+                                              const,
+                                          std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const;
+
+            // Like launch_and_split_sharded, but serves the variables of specs that were extracted by a previous
+            // invocation from the cache.
+            template<class SpecType>
+            void extract_vars(View<SpecType> specs,
+                              Path (TripletCMakeVarProvider::*create_extraction_file)(View<SpecType>) const,
+                              StringLiteral kind,
+                              std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const;
+
+            CMakeVarsCache& get_cache() const;
+            const Optional<std::string>& get_triplet_cache_key(Triplet triplet) const;
 
             const VcpkgPaths& paths;
+            mutable std::unique_ptr<CMakeVarsCache> cache;
+            mutable Optional<std::string> common_cache_key;
+            mutable std::unordered_map<Triplet, Optional<std::string>> triplet_cache_keys;
             mutable std::unordered_map<PackageSpec, std::unordered_map<std::string, std::string>> dep_resolution_vars;
+            mutable std::unordered_map<PackageSpec, PlatformExpression::ContextIdentifiers> dep_resolution_identifiers;
             mutable std::unordered_map<PackageSpec, std::unordered_map<std::string, std::string>> tag_vars;
             mutable std::unordered_map<Triplet, std::unordered_map<std::string, std::string>> generic_triplet_vars;
         };
@@ -118,6 +173,25 @@ endmacro()
         return extraction_file;
     }
 
+    // The features passed to vcpkg_get_tags
+    static std::string tag_feature_list(const FullPackageSpec& spec)
+    {
+        std::string featurelist;
+        for (auto&& f : spec.features)
+        {
+            if (f == FeatureNameCore || f == FeatureNameDefault || f == "*") continue;
+            if (!featurelist.empty()) featurelist.push_back(';');
+            featurelist.append(f);
+        }
+
+        return featurelist;
+    }
+
+    static std::string tag_feature_list(const PackageSpec&) { return std::string(); }
+
+    static const PackageSpec& package_spec_of(const FullPackageSpec& spec) { return spec.package_spec; }
+    static const PackageSpec& package_spec_of(const PackageSpec& spec) { return spec; }
+
     Path TripletCMakeVarProvider::create_tag_extraction_file(const View<FullPackageSpec> specs) const
     {
         const Filesystem& fs = paths.get_filesystem();
@@ -170,18 +244,10 @@ endfunction()
 
         for (const auto& spec : specs)
         {
-            std::string featurelist;
-            for (auto&& f : spec.features)
-            {
-                if (f == FeatureNameCore || f == FeatureNameDefault || f == "*") continue;
-                if (!featurelist.empty()) featurelist.push_back(';');
-                featurelist.append(f);
-            }
-
             fmt::format_to(std::back_inserter(extraction_file),
                            "vcpkg_get_tags(\"{}\" \"{}\" \"{}\")\n",
                            spec.package_spec.name(),
-                           featurelist,
+                           tag_feature_list(spec),
                            emitted_triplets[spec.package_spec.triplet()]);
         }
 
@@ -257,65 +323,782 @@ endfunction()
         return dep_info_path;
     }
 
-    void TripletCMakeVarProvider::launch_and_split(
-        const Path& script_path, std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const
+    static constexpr StringLiteral PORT_START_GUID = "d8187afd-ea4a-4fc3-9aa4-a6782e1ed9af";
+    static constexpr StringLiteral PORT_END_GUID = "8c504940-be29-4cba-9f8f-6cd83e9d87b7";
+    static constexpr StringLiteral BLOCK_START_GUID = "c35112b6-d1ba-415b-aa5d-81de856ef8eb";
+    static constexpr StringLiteral BLOCK_END_GUID = "e1e74b5c-18cb-4474-a6bd-5c1c8bc81f3f";
+
+    CMakeVarsOutputParser::CMakeVarsOutputParser(Span<std::vector<std::pair<std::string, std::string>>> vars)
+        : m_vars(vars)
+    {
+    }
+
+    void CMakeVarsOutputParser::parse_line(StringView line)
+    {
+        switch (m_state)
+        {
+            case State::OutsidePort:
+                if (line == PORT_START_GUID)
+                {
+                    m_state = State::InPort;
+                    m_port_has_block = false;
+                    return;
+                }
+
+                break;
+            case State::InPort:
+                if (line == BLOCK_START_GUID)
+                {
+                    m_state = State::InBlock;
+                    m_port_has_block = true;
+                    return;
+                }
+
+                if (line == PORT_END_GUID)
+                {
+                    m_state = State::OutsidePort;
+                    if (!m_port_has_block && !m_error)
+                    {
+                        m_error = msg::format(msgFailedToParseCMakeConsoleOut);
+                    }
+
+                    ++m_ports;
+                    return;
+                }
+
+                break;
+            case State::InBlock:
+                if (line == BLOCK_END_GUID)
+                {
+                    m_state = State::InPort;
+                }
+                else if (m_ports < m_vars.size())
+                {
+                    std::vector<std::string> s = Strings::split(line, '=');
+                    if (s.size() == 1 || s.size() == 2)
+                    {
+                        m_vars[m_ports].emplace_back(std::move(s[0]), s.size() == 1 ? "" : std::move(s[1]));
+                    }
+                    else if (!m_error)
+                    {
+                        m_error = msg::format(
+                            msgUnexpectedFormat, msg::expected = "VARIABLE_NAME=VARIABLE_VALUE", msg::actual = line);
+                    }
+                }
+
+                return;
+        }
+
+        m_other_lines.emplace_back(line.begin(), line.end());
+    }
+
+    ExpectedL<Unit> CMakeVarsOutputParser::finish() const
+    {
+        if (auto error = m_error.get())
+        {
+            return *error;
+        }
+
+        if (m_state != State::OutsidePort || m_ports != m_vars.size())
+        {
+            return msg::format(msgFailedToParseCMakeConsoleOut);
+        }
+
+        return Unit{};
+    }
+
+    ExpectedL<Unit> parse_cmake_vars_output(StringView output,
+                                            Span<std::vector<std::pair<std::string, std::string>>> vars)
+    {
+        CMakeVarsOutputParser parser{vars};
+        auto first = output.begin();
+        const auto last = output.end();
+        while (first != last)
+        {
+            auto newline = std::find(first, last, '\n');
+            auto line_end = newline;
+            if (line_end != first && *(line_end - 1) == '\r')
+            {
+                --line_end;
+            }
+
+            parser.parse_line(StringView{first, line_end});
+            first = newline == last ? last : newline + 1;
+        }
+
+        return parser.finish();
+    }
+
+    ExpectedL<Unit> TripletCMakeVarProvider::launch_and_split(
+        const Command& cmd, Span<std::vector<std::pair<std::string, std::string>>> vars)
     {
-        static constexpr StringLiteral PORT_START_GUID = "d8187afd-ea4a-4fc3-9aa4-a6782e1ed9af";
-        static constexpr StringLiteral PORT_END_GUID = "8c504940-be29-4cba-9f8f-6cd83e9d87b7";
-        static constexpr StringLiteral BLOCK_START_GUID = "c35112b6-d1ba-415b-aa5d-81de856ef8eb";
-        static constexpr StringLiteral BLOCK_END_GUID = "e1e74b5c-18cb-4474-a6bd-5c1c8bc81f3f";
+        // The output is parsed as it is streamed
+        CMakeVarsOutputParser parser{vars};
+        auto maybe_exit_code =
+            cmd_execute_and_stream_lines(cmd, [&parser](StringView line) { parser.parse_line(line); });
+        auto exit_code = maybe_exit_code.get();
+        if (!exit_code)
+        {
+            return std::move(maybe_exit_code).error();
+        }
 
-        auto cmd = vcpkg::make_cmake_cmd(paths, script_path, {});
+        if (*exit_code != 0)
+        {
+            return msg::format(msgCommandFailed, msg::command_line = cmd.command_line())
+                .append_raw('\n')
+                .append_raw(Strings::join(", ", parser.other_lines()));
+        }
 
-        std::vector<std::string> lines;
-        auto const exit_code = cmd_execute_and_stream_lines(cmd, [&](StringView sv) {
-                                   lines.emplace_back(sv.begin(), sv.end());
-                               }).value_or_exit(VCPKG_LINE_INFO);
+        return parser.finish();
+    }
 
-        if (exit_code != 0)
+    // Extraction scripts are not split into pieces smaller than this, as each CMake process has a fixed startup
+    // cost that would otherwise outweigh interpreting the script in parallel.
+    static constexpr size_t min_specs_per_extraction_shard = 32;
+
+    std::vector<size_t> extraction_shard_ends(size_t spec_count, size_t max_shards)
+    {
+        const size_t shard_count = std::max(
+            size_t{1},
+            std::min((spec_count + min_specs_per_extraction_shard - 1) / min_specs_per_extraction_shard, max_shards));
+        std::vector<size_t> ends;
+        ends.reserve(shard_count);
+        for (size_t i = 0; i < shard_count; ++i)
         {
-            Checks::msg_exit_with_message(VCPKG_LINE_INFO,
-                                          msg::format(msgCommandFailed, msg::command_line = cmd.command_line())
-                                              .append_raw('\n')
-                                              .append_raw(Strings::join(", ", lines)));
+            ends.push_back(spec_count * (i + 1) / shard_count);
         }
 
-        const auto end = lines.cend();
+        return ends;
+    }
 
-        auto port_start = std::find(lines.cbegin(), end, PORT_START_GUID);
-        auto port_end = std::find(port_start, end, PORT_END_GUID);
-        Checks::msg_check_exit(VCPKG_LINE_INFO, port_start != end && port_end != end, msgFailedToParseCMakeConsoleOut);
+    template<class SpecType>
+    void TripletCMakeVarProvider::launch_and_split_sharded(
+        View<SpecType> specs,
+        Path (TripletCMakeVarProvider::*create_extraction_file)(View<SpecType>) const,
+        std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const
+    {
+        struct Shard
+        {
+            Path script_path;
+            Command cmd;
+            Span<std::vector<std::pair<std::string, std::string>>> vars;
+            Optional<LocalizedString> error;
+        };
 
-        for (auto var_itr = vars.begin(); port_start != end && var_itr != vars.end(); ++var_itr)
+        // CMake interprets each script on a single thread, so large sets of specs are split across several
+        // concurrent CMake processes. The scripts and commands are created up front because VcpkgPaths may not be
+        // used from several threads.
+        const auto shard_ends = extraction_shard_ends(specs.size(), get_concurrency());
+        std::vector<Shard> shards;
+        shards.reserve(shard_ends.size());
+        size_t first = 0;
+        for (const size_t last : shard_ends)
         {
-            auto block_start = std::find(port_start, port_end, BLOCK_START_GUID);
-            Checks::msg_check_exit(VCPKG_LINE_INFO, block_start != port_end, msgFailedToParseCMakeConsoleOut);
-            auto block_end = std::find(++block_start, port_end, BLOCK_END_GUID);
+            auto script_path = (this->*create_extraction_file)(View<SpecType>{specs.data() + first, last - first});
+            auto cmd = vcpkg::make_cmake_cmd(paths, script_path, {});
+            shards.push_back(Shard{std::move(script_path), std::move(cmd), {vars.data() + first, last - first}});
+            first = last;
+        }
 
-            while (block_start != port_end)
+        // Failures are reported once every shard has finished, so that no CMake process is left running and their
+        // output is not interleaved
+        parallel_for_each(shards, [](Shard& shard) {
+            auto maybe_result = launch_and_split(shard.cmd, shard.vars);
+            if (!maybe_result)
             {
-                while (block_start != block_end)
+                shard.error = std::move(maybe_result).error();
+            }
+        });
+
+        Optional<LocalizedString> errors;
+        for (auto&& shard : shards)
+        {
+            paths.get_filesystem().remove(shard.script_path, VCPKG_LINE_INFO);
+            if (auto error = shard.error.get())
+            {
+                if (auto existing = errors.get())
+                {
+                    existing->append_raw('\n').append(*error);
+                }
+                else
                 {
-                    const std::string& line = *block_start;
+                    errors = std::move(*error);
+                }
+            }
+        }
 
-                    std::vector<std::string> s = Strings::split(line, '=');
-                    Checks::msg_check_exit(VCPKG_LINE_INFO,
-                                           s.size() == 1 || s.size() == 2,
-                                           msgUnexpectedFormat,
-                                           msg::expected = "VARIABLE_NAME=VARIABLE_VALUE",
-                                           msg::actual = line);
+        if (auto error = errors.get())
+        {
+            Checks::msg_exit_with_message(VCPKG_LINE_INFO, *error);
+        }
+    }
+
+    static constexpr int64_t cmake_vars_cache_version = 1;
+    static constexpr StringLiteral CMakeVarsCacheJsonIdVersion = "version";
+    static constexpr StringLiteral CMakeVarsCacheJsonIdEntries = "entries";
+
+    CMakeVarsCache::CMakeVarsCache(const ReadOnlyFilesystem& fs, Optional<Path> cache_file, size_t max_entries)
+        : m_cache_file(std::move(cache_file)), m_max_entries(max_entries)
+    {
+        auto cache_file_path = m_cache_file.get();
+        if (!cache_file_path)
+        {
+            return;
+        }
+
+        std::error_code ec;
+        auto contents = fs.read_contents(*cache_file_path, ec);
+        if (ec)
+        {
+            return;
+        }
+
+        auto maybe_doc = Json::parse_object(contents, *cache_file_path);
+        auto doc = maybe_doc.get();
+        if (!doc)
+        {
+            return;
+        }
 
-                    var_itr->emplace_back(std::move(s[0]), s.size() == 1 ? "" : std::move(s[1]));
+        auto version = doc->get(CMakeVarsCacheJsonIdVersion);
+        auto entries = doc->get(CMakeVarsCacheJsonIdEntries);
+        if (!version || !version->is_integer() || version->integer(VCPKG_LINE_INFO) != cmake_vars_cache_version ||
+            !entries || !entries->is_object())
+        {
+            return;
+        }
 
-                    ++block_start;
+        for (auto&& entry : entries->object(VCPKG_LINE_INFO))
+        {
+            auto vars = entry.second.maybe_object();
+            if (!vars) continue;
+            Entry new_entry;
+            bool valid = true;
+            for (auto&& var : *vars)
+            {
+                if (!var.second.is_string())
+                {
+                    valid = false;
+                    break;
                 }
 
-                block_start = std::find(block_end, port_end, BLOCK_START_GUID);
-                block_end = std::find(block_start, port_end, BLOCK_END_GUID);
+                new_entry.vars.emplace_back(var.first.to_string(), var.second.string(VCPKG_LINE_INFO).to_string());
             }
 
-            port_start = std::find(port_end, end, PORT_START_GUID);
-            port_end = std::find(port_start, end, PORT_END_GUID);
+            if (valid)
+            {
+                m_entries.emplace(entry.first.to_string(), std::move(new_entry));
+            }
+        }
+    }
+
+    const VarList* CMakeVarsCache::find(const std::string& key)
+    {
+        if (!m_cache_file.has_value())
+        {
+            return nullptr;
+        }
+
+        auto it = m_entries.find(key);
+        if (it == m_entries.end())
+        {
+            return nullptr;
+        }
+
+        it->second.used = true;
+        return &it->second.vars;
+    }
+
+    void CMakeVarsCache::store(const std::string& key, const VarList& vars)
+    {
+        if (!m_cache_file.has_value())
+        {
+            return;
+        }
+
+        auto& entry = m_entries[key];
+        entry.vars = vars;
+        entry.used = true;
+        m_dirty = true;
+    }
+
+    void CMakeVarsCache::save(const Filesystem& fs)
+    {
+        auto cache_file = m_cache_file.get();
+        if (!cache_file || !m_dirty)
+        {
+            return;
+        }
+
+        Json::Object entries;
+        for (bool used : {true, false})
+        {
+            for (auto&& entry : m_entries)
+            {
+                if (entry.second.used != used) continue;
+                if (entries.size() == m_max_entries) break;
+                auto& vars = entries.insert(entry.first, Json::Object{});
+                for (auto&& var : entry.second.vars)
+                {
+                    vars.insert_or_replace(var.first, var.second);
+                }
+            }
+        }
+
+        Json::Object doc;
+        doc.insert(CMakeVarsCacheJsonIdVersion, Json::Value::integer(cmake_vars_cache_version));
+        doc.insert(CMakeVarsCacheJsonIdEntries, std::move(entries));
+
+        std::error_code ec;
+        const Path temp_path = fmt::format("{}.{}.tmp", cache_file->native(), get_process_id());
+        fs.write_contents_and_dirs(temp_path, Json::stringify(doc, Json::JsonStyle::with_spaces(0)), ec);
+        if (!ec)
+        {
+            fs.rename(temp_path, *cache_file, ec);
+        }
+
+        if (ec)
+        {
+            fs.remove(temp_path, IgnoreErrors{});
+            return;
+        }
+
+        m_dirty = false;
+    }
+
+    Optional<Path> get_cmake_vars_cache_file(const Path& buildtrees)
+    {
+        const auto maybe_setting = get_environment_variable(EnvironmentVariableXVcpkgCMakeVarsCache);
+        const auto setting = maybe_setting.get();
+        if (setting && Strings::case_insensitive_ascii_equals(*setting, "off"))
+        {
+            return nullopt;
+        }
+
+        return buildtrees / FileCMakeVarsCacheDotJson;
+    }
+
+    // The caches of the providers which exist. Commands usually end by exiting the process without destroying their
+    // provider, so rather than after each extraction, caches are saved when their provider is destroyed or by
+    // save_cmake_vars_caches(), whichever comes first.
+    static std::mutex g_unsaved_caches_mtx;
+    static std::vector<std::pair<const Filesystem*, CMakeVarsCache*>> g_unsaved_caches;
+
+    void save_cmake_vars_caches()
+    {
+        std::lock_guard<std::mutex> lock(g_unsaved_caches_mtx);
+        for (auto&& unsaved_cache : g_unsaved_caches)
+        {
+            unsaved_cache.second->save(*unsaved_cache.first);
+        }
+
+        g_unsaved_caches.clear();
+    }
+
+    TripletCMakeVarProvider::~TripletCMakeVarProvider()
+    {
+        if (!cache)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(g_unsaved_caches_mtx);
+        const auto it = Util::find_if(g_unsaved_caches, [this](const std::pair<const Filesystem*, CMakeVarsCache*>& c) {
+            return c.second == cache.get();
+        });
+        if (it != g_unsaved_caches.end())
+        {
+            g_unsaved_caches.erase(it);
+            cache->save(paths.get_filesystem());
+        }
+    }
+
+    CMakeVarsCache& TripletCMakeVarProvider::get_cache() const
+    {
+        if (!cache)
+        {
+            const auto& fs = paths.get_filesystem();
+            cache = std::make_unique<CMakeVarsCache>(fs, get_cmake_vars_cache_file(paths.buildtrees()));
+            std::lock_guard<std::mutex> lock(g_unsaved_caches_mtx);
+            g_unsaved_caches.emplace_back(&fs, cache.get());
+        }
+
+        return *cache;
+    }
+
+    // Environment variables that the scripts of vcpkg or CMake itself may read while extracting the variables of any
+    // triplet. Variables which triplets read themselves are found by get_triplet_cmake_vars_cache_key().
+    static constexpr StringLiteral cmake_vars_environment_variables[] = {"PATH",
+                                                                         "CC",
+                                                                         "CXX",
+                                                                         "CFLAGS",
+                                                                         "CXXFLAGS",
+                                                                         "CPPFLAGS",
+                                                                         "LDFLAGS",
+                                                                         "INCLUDE",
+                                                                         "LIB",
+                                                                         "LIBPATH",
+                                                                         "PROCESSOR_ARCHITECTURE",
+                                                                         "PROCESSOR_ARCHITEW6432",
+                                                                         "SDKROOT",
+                                                                         "MACOSX_DEPLOYMENT_TARGET"};
+    static constexpr StringLiteral cmake_vars_environment_prefixes[] = {"VCPKG_", "X_VCPKG_", "CMAKE_"};
+
+    static bool is_cmake_vars_environment_variable(StringView name, View<std::string> passthrough_env_vars)
+    {
+        for (auto&& allowed : cmake_vars_environment_variables)
+        {
+            if (Strings::case_insensitive_ascii_equals(name, allowed)) return true;
+        }
+
+        for (auto&& prefix : cmake_vars_environment_prefixes)
+        {
+            if (Strings::case_insensitive_ascii_starts_with(name, prefix)) return true;
+        }
+
+        for (auto&& passthrough : passthrough_env_vars)
+        {
+            if (Strings::case_insensitive_ascii_equals(name, passthrough)) return true;
+        }
+
+        return false;
+    }
+
+    std::string get_common_cmake_vars_cache_key(StringView ports_cmake_hash,
+                                                const std::map<std::string, std::string>& script_hashes,
+                                                View<std::pair<Path, FileMetadata>> cmake_candidates,
+                                                std::vector<std::string> environment)
+    {
+        std::string key;
+        fmt::format_to(
+            std::back_inserter(key), "vcpkg {}\nports.cmake {}\n", VCPKG_BASE_VERSION_AS_STRING, ports_cmake_hash);
+        for (auto&& script : script_hashes)
+        {
+            fmt::format_to(std::back_inserter(key), "script {} {}\n", script.first, script.second);
+        }
+
+        for (auto&& candidate : cmake_candidates)
+        {
+            fmt::format_to(std::back_inserter(key),
+                           "cmake {} {} {} {}\n",
+                           candidate.first,
+                           candidate.second.size,
+                           candidate.second.last_write_time,
+                           candidate.second.inode);
+        }
+
+        // The variables that VCPKG_KEEP_ENV_VARS passes through to builds
+        std::vector<std::string> passthrough_env_vars;
+        for (auto&& variable : environment)
+        {
+            const auto equals = variable.find('=');
+            if (equals != std::string::npos &&
+                Strings::case_insensitive_ascii_equals(StringView{variable.data(), equals},
+                                                       EnvironmentVariableVcpkgKeepEnvVars))
+            {
+                passthrough_env_vars = Strings::split(StringView{variable}.substr(equals + 1), ';');
+            }
+        }
+
+        Util::sort(environment);
+        for (auto&& variable : environment)
+        {
+            const StringView name{variable.data(), std::min(variable.find('='), variable.size())};
+            if (is_cmake_vars_environment_variable(name, passthrough_env_vars))
+            {
+                fmt::format_to(std::back_inserter(key), "env {}\n", variable);
+            }
+        }
+
+        return Hash::get_string_sha256(key);
+    }
+
+    static bool is_cmake_identifier_char(char ch)
+    {
+        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_';
+    }
+
+    // Appends the files that `contents`, the contents of a CMake file in `directory`, includes to `included`. Modules
+    // included by name are not appended, as they are found among CMake's own modules. Returns false if a path depends
+    // on anything other than CMAKE_CURRENT_LIST_DIR, or is relative and so depends on the working directory.
+    static bool find_included_files(const std::string& contents, const Path& directory, std::vector<Path>& included)
+    {
+        static constexpr StringLiteral include_command = "include";
+        static constexpr StringLiteral current_list_dir = "${CMAKE_CURRENT_LIST_DIR}/";
+        const auto lowercase = Strings::ascii_to_lowercase(contents);
+        for (auto found = lowercase.find(include_command.data()); found != std::string::npos;
+             found = lowercase.find(include_command.data(), found + include_command.size()))
+        {
+            if (found != 0 && is_cmake_identifier_char(lowercase[found - 1]))
+            {
+                continue;
+            }
+
+            auto first = found + include_command.size();
+            while (first < contents.size() && (contents[first] == ' ' || contents[first] == '\t'))
+            {
+                ++first;
+            }
+
+            if (first == contents.size() || contents[first] != '(')
+            {
+                // include_guard, include_directories, and so on
+                continue;
+            }
+
+            ++first;
+            while (first < contents.size() && ParserBase::is_whitespace(contents[first]))
+            {
+                ++first;
+            }
+
+            size_t last;
+            if (first < contents.size() && contents[first] == '"')
+            {
+                ++first;
+                last = std::min(contents.find('"', first), contents.size());
+            }
+            else
+            {
+                last = first;
+                while (last < contents.size() && !ParserBase::is_whitespace(contents[last]) && contents[last] != ')')
+                {
+                    ++last;
+                }
+            }
+
+            const auto argument = StringView{contents}.substr(first, last - first);
+            if (argument.starts_with(current_list_dir))
+            {
+                const auto relative = argument.substr(current_list_dir.size());
+                if (relative.contains('$'))
+                {
+                    return false;
+                }
+
+                included.push_back(directory / relative);
+                continue;
+            }
+
+            if (argument.contains('$'))
+            {
+                return false;
+            }
+
+            Path argument_path{argument};
+            if (argument_path.is_absolute())
+            {
+                included.push_back(std::move(argument_path));
+                continue;
+            }
+
+            if (argument.contains('/') || argument.contains('\\') ||
+                Strings::case_insensitive_ascii_ends_with(argument, ".cmake"))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Inserts the names of the environment variables that `contents`, the contents of a CMake file, reads into
+    // `names`. Returns false if the name of one depends on a variable.
+    static bool find_environment_references(const std::string& contents, std::set<std::string>& names)
+    {
+        static constexpr StringLiteral env_reference = "ENV{";
+        for (auto found = contents.find(env_reference.data()); found != std::string::npos;
+             found = contents.find(env_reference.data(), found + env_reference.size()))
+        {
+            if (found != 0 && is_cmake_identifier_char(contents[found - 1]))
+            {
+                continue;
+            }
+
+            const auto first = found + env_reference.size();
+            const auto last = contents.find('}', first);
+            const auto name = StringView{contents}.substr(first, last - first);
+            if (last == std::string::npos || name.contains('$'))
+            {
+                return false;
+            }
+
+            names.insert(name.to_string());
+        }
+
+        return true;
+    }
+
+    Optional<std::string> get_triplet_cmake_vars_cache_key(const Filesystem& fs,
+                                                           FileHashCache& file_hash_cache,
+                                                           StringView common_key,
+                                                           Triplet triplet,
+                                                           const Path& triplet_file)
+    {
+        std::string key;
+        fmt::format_to(std::back_inserter(key), "common {}\ntriplet {} {}\n", common_key, triplet, triplet_file);
+        auto sibling_files = fs.get_regular_files_non_recursive(triplet_file.parent_path(), VCPKG_LINE_INFO);
+        Util::sort(sibling_files);
+        for (auto&& sibling_file : sibling_files)
+        {
+            if (sibling_file.extension() != ".cmake") continue;
+            fmt::format_to(std::back_inserter(key),
+                           "file {} {}\n",
+                           sibling_file.filename(),
+                           file_hash_cache.get_file_sha256(fs, sibling_file).value_or_exit(VCPKG_LINE_INFO));
+        }
+
+        // The files included by the triplet, and by those files in turn
+        std::vector<Path> pending{triplet_file};
+        std::set<std::string> visited{triplet_file.native()};
+        std::set<std::string> environment_variables;
+        while (!pending.empty())
+        {
+            const auto file = std::move(pending.back());
+            pending.pop_back();
+            std::error_code ec;
+            const auto contents = fs.read_contents(file, ec);
+            if (ec)
+            {
+                fmt::format_to(std::back_inserter(key), "include {} missing\n", file);
+                continue;
+            }
+
+            if (file != triplet_file)
+            {
+                fmt::format_to(std::back_inserter(key),
+                               "include {} {}\n",
+                               file,
+                               file_hash_cache.get_contents_sha256(fs, file, contents));
+            }
+
+            std::vector<Path> included;
+            if (!find_included_files(contents, file.parent_path(), included) ||
+                !find_environment_references(contents, environment_variables))
+            {
+                return nullopt;
+            }
+
+            for (auto&& included_file : included)
+            {
+                if (visited.insert(included_file.native()).second)
+                {
+                    pending.push_back(std::move(included_file));
+                }
+            }
+        }
+
+        // The environment variables read by those files
+        for (auto&& name : environment_variables)
+        {
+            const auto value = get_environment_variable(name);
+            if (auto v = value.get())
+            {
+                fmt::format_to(std::back_inserter(key), "env {}={}\n", name, *v);
+            }
+            else
+            {
+                fmt::format_to(std::back_inserter(key), "env {} unset\n", name);
+            }
+        }
+
+        return Hash::get_string_sha256(key);
+    }
+
+    const Optional<std::string>& TripletCMakeVarProvider::get_triplet_cache_key(Triplet triplet) const
+    {
+        auto it = triplet_cache_keys.find(triplet);
+        if (it != triplet_cache_keys.end())
+        {
+            return it->second;
+        }
+
+        const auto& fs = paths.get_filesystem();
+        if (!common_cache_key.has_value())
+        {
+            // Finding CMake would run every candidate to check its version, so the key covers all of them instead
+            // If they can't be found, the key does not matter, as extracting any variables will fail
+            FullyBufferedDiagnosticContext ignored_context;
+            std::vector<std::pair<Path, FileMetadata>> cmake_candidates;
+            for (auto&& candidate : paths.get_tool_cache().get_tool_candidates(ignored_context, fs, Tools::CMAKE))
+            {
+                std::error_code ec;
+                auto metadata = fs.file_metadata(candidate, ec);
+                if (!ec)
+                {
+                    cmake_candidates.emplace_back(std::move(candidate), metadata);
+                }
+            }
+
+            common_cache_key = get_common_cmake_vars_cache_key(paths.get_ports_cmake_hash(),
+                                                               paths.get_cmake_script_hashes(),
+                                                               cmake_candidates,
+                                                               get_environment_variables());
+        }
+
+        return triplet_cache_keys
+            .emplace(triplet,
+                     get_triplet_cmake_vars_cache_key(fs,
+                                                      paths.get_file_hash_cache(),
+                                                      *common_cache_key.get(),
+                                                      triplet,
+                                                      paths.get_triplet_db().get_triplet_file_path(triplet)))
+            .first->second;
+    }
+
+    template<class SpecType>
+    void TripletCMakeVarProvider::extract_vars(
+        View<SpecType> specs,
+        Path (TripletCMakeVarProvider::*create_extraction_file)(View<SpecType>) const,
+        StringLiteral kind,
+        std::vector<std::vector<std::pair<std::string, std::string>>>& vars) const
+    {
+        auto& vars_cache = get_cache();
+        std::vector<std::string> keys;
+        std::vector<SpecType> missing_specs;
+        std::vector<size_t> missing_indices;
+        for (size_t i = 0; i < specs.size(); ++i)
+        {
+            const auto& package_spec = package_spec_of(specs[i]);
+            // Specs of triplets that cannot be cached have an empty key
+            auto& key = keys.emplace_back();
+            if (auto triplet_key = get_triplet_cache_key(package_spec.triplet()).get())
+            {
+                key = Hash::get_string_sha256(fmt::format("triplet {}\n{} {}\nfeatures {}\n",
+                                                          *triplet_key,
+                                                          kind,
+                                                          package_spec.name(),
+                                                          tag_feature_list(specs[i])));
+            }
+
+            if (auto cached = key.empty() ? nullptr : vars_cache.find(key))
+            {
+                vars[i] = *cached;
+            }
+            else
+            {
+                missing_specs.push_back(specs[i]);
+                missing_indices.push_back(i);
+            }
+        }
+
+        if (missing_specs.empty())
+        {
+            Debug::println("Reusing cached CMake variables for ", specs.size(), " specs");
+            return;
+        }
+
+        std::vector<std::vector<std::pair<std::string, std::string>>> missing_vars(missing_specs.size());
+        launch_and_split_sharded(View<SpecType>{missing_specs}, create_extraction_file, missing_vars);
+        for (size_t i = 0; i < missing_specs.size(); ++i)
+        {
+            const auto& key = keys[missing_indices[i]];
+            if (!key.empty())
+            {
+                vars_cache.store(key, missing_vars[i]);
+            }
+
+            vars[missing_indices[i]] = std::move(missing_vars[i]);
         }
     }
 
@@ -324,9 +1107,10 @@ endfunction()
         std::vector<std::vector<std::pair<std::string, std::string>>> vars(1);
         // Hack: PackageSpecs should never have .name==""
         FullPackageSpec tag_extracts{{"", triplet}, {}};
-        const auto file_path = create_tag_extraction_file(View<FullPackageSpec>{&tag_extracts, 1});
-        launch_and_split(file_path, vars);
-        paths.get_filesystem().remove(file_path, VCPKG_LINE_INFO);
+        extract_vars(View<FullPackageSpec>{&tag_extracts, 1},
+                     &TripletCMakeVarProvider::create_tag_extraction_file,
+                     "tags",
+                     vars);
 
         generic_triplet_vars[triplet].insert(std::make_move_iterator(vars.front().begin()),
                                              std::make_move_iterator(vars.front().end()));
@@ -340,13 +1124,12 @@ endfunction()
         if (specs.size() == 0) return;
         Debug::println("Loading dep info for: ", Strings::join(" ", specs));
         std::vector<std::vector<std::pair<std::string, std::string>>> vars(specs.size());
-        const auto file_path = create_dep_info_extraction_file(specs);
         if (specs.size() > 100)
         {
             msg::println(msgLoadingDependencyInformation, msg::count = specs.size());
         }
-        launch_and_split(file_path, vars);
-        paths.get_filesystem().remove(file_path, VCPKG_LINE_INFO);
+        extract_vars(
+            View<PackageSpec>{specs}, &TripletCMakeVarProvider::create_dep_info_extraction_file, "dep-info", vars);
 
         auto var_list_itr = vars.begin();
         for (const PackageSpec& spec : specs)
@@ -357,6 +1140,7 @@ endfunction()
 
             ctxt.emplace("Z_VCPKG_IS_NATIVE", host_triplet == spec.triplet() ? "1" : "0");
 
+            dep_resolution_identifiers.emplace(spec, PlatformExpression::ContextIdentifiers::reduce(ctxt));
             dep_resolution_vars.emplace(spec, std::move(ctxt));
         }
     }
@@ -366,9 +1150,7 @@ endfunction()
         if (specs.empty()) return;
 
         std::vector<std::vector<std::pair<std::string, std::string>>> vars(specs.size());
-        const auto file_path = create_tag_extraction_file(specs);
-        launch_and_split(file_path, vars);
-        paths.get_filesystem().remove(file_path, VCPKG_LINE_INFO);
+        extract_vars(specs, &TripletCMakeVarProvider::create_tag_extraction_file, "tags", vars);
 
         auto var_list_itr = vars.begin();
         for (const auto& spec : specs)
@@ -395,6 +1177,12 @@ endfunction()
         return Util::lookup_value(dep_resolution_vars, spec);
     }
 
+    const PlatformExpression::ContextIdentifiers* TripletCMakeVarProvider::get_dep_info_identifiers(
+        const PackageSpec& spec) const
+    {
+        return Util::lookup_value(dep_resolution_identifiers, spec);
+    }
+
     const std::unordered_map<std::string, std::string>* TripletCMakeVarProvider::get_tag_vars(
         const PackageSpec& spec) const
     {
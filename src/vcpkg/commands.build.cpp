@@ -2,11 +2,13 @@
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/chrono.h>
 #include <vcpkg/base/contractual-constants.h>
+#include <vcpkg/base/file-hash-cache.h>
 #include <vcpkg/base/file_sink.h>
 #include <vcpkg/base/hash.h>
 #include <vcpkg/base/message_sinks.h>
 #include <vcpkg/base/messages.h>
 #include <vcpkg/base/optional.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/stringview.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/system.h>
@@ -38,6 +40,8 @@
 #include <vcpkg/vcpkgpaths.h>
 
 #include <iterator>
+#include <mutex>
+#include <unordered_map>
 
 using namespace vcpkg;
 
@@ -634,7 +638,7 @@ namespace vcpkg
                                            const PreBuildInfo& pre_build_info,
                                            const Toolset& toolset);
 
-    static const std::string& get_toolchain_cache(Cache<Path, std::string>& cache,
+    static const std::string& get_toolchain_cache(ConcurrentCache<Path, std::string>& cache,
                                                   const Path& tcfile,
                                                   const ReadOnlyFilesystem& fs)
     {
@@ -650,6 +654,264 @@ namespace vcpkg
         });
     }
 
+    std::string get_compiler_info_cache_key(const Filesystem& fs,
+                                            FileHashCache& file_hash_cache,
+                                            const Path& detect_compiler_dir,
+                                            StringView cmake_version,
+                                            StringView ports_cmake_hash,
+                                            Triplet triplet,
+                                            View<std::string> passthrough_env_vars,
+                                            const Toolset& toolset,
+                                            StringView triplet_hash,
+                                            StringView toolchain_hash,
+                                            View<Path> compilers)
+    {
+        std::string key;
+        fmt::format_to(std::back_inserter(key),
+                       "vcpkg {}\ncmake {}\ntriplet {} {}\ntoolchain {}\nports.cmake {}\ntoolset {} {} {} {}\n",
+                       VCPKG_BASE_VERSION_AS_STRING,
+                       cmake_version,
+                       triplet,
+                       triplet_hash,
+                       toolchain_hash,
+                       ports_cmake_hash,
+                       toolset.version,
+                       toolset.full_version,
+                       toolset.vcvarsall,
+                       Strings::join(" ", toolset.vcvarsall_options));
+
+        auto detect_compiler_files = fs.get_regular_files_non_recursive(detect_compiler_dir, VCPKG_LINE_INFO);
+        Util::sort(detect_compiler_files);
+        for (auto&& file : detect_compiler_files)
+        {
+            fmt::format_to(std::back_inserter(key),
+                           "detect_compiler {} {}\n",
+                           file.filename(),
+                           file_hash_cache.get_file_sha256(fs, file).value_or_exit(VCPKG_LINE_INFO));
+        }
+
+        static constexpr StringLiteral compiler_environment_variables[] = {
+            "PATH", "CC", "CXX", "CFLAGS", "CXXFLAGS", "CPPFLAGS", "LDFLAGS", "INCLUDE", "LIB"};
+        auto append_environment_variable = [&](ZStringView name) {
+            const auto value = get_environment_variable(name);
+            if (auto v = value.get())
+            {
+                fmt::format_to(std::back_inserter(key), "env {}={}\n", name, *v);
+            }
+        };
+        for (auto&& name : compiler_environment_variables)
+        {
+            append_environment_variable(name);
+        }
+
+        for (auto&& name : passthrough_env_vars)
+        {
+            append_environment_variable(name);
+        }
+
+        // A compiler upgraded in place keeps its path, but not its size, last write time, or inode
+        for (auto&& compiler : compilers)
+        {
+            std::error_code ec;
+            const auto metadata = fs.file_metadata(compiler, ec);
+            if (!ec)
+            {
+                fmt::format_to(std::back_inserter(key),
+                               "compiler {} {} {} {}\n",
+                               compiler,
+                               metadata.size,
+                               metadata.last_write_time,
+                               metadata.inode);
+            }
+        }
+
+        return Hash::get_string_sha256(key);
+    }
+
+    static constexpr int64_t compiler_info_cache_version = 1;
+    // Only the most recently used entries are kept, so that the cache does not grow without bound
+    static constexpr size_t compiler_info_cache_max_entries = 16;
+    static constexpr StringLiteral CompilerInfoCacheJsonIdVersion = "version";
+    static constexpr StringLiteral CompilerInfoCacheJsonIdEntries = "entries";
+    static constexpr StringLiteral CompilerInfoCacheJsonIdKey = "key";
+    static constexpr StringLiteral CompilerInfoCacheJsonIdId = "id";
+    static constexpr StringLiteral CompilerInfoCacheJsonIdCompilerVersion = "compiler-version";
+    static constexpr StringLiteral CompilerInfoCacheJsonIdHash = "hash";
+    static constexpr StringLiteral CompilerInfoCacheJsonIdPath = "path";
+    static constexpr StringLiteral CompilerInfoCacheJsonIdPathMetadata = "path-metadata";
+
+    static std::string describe_compiler_path_metadata(const Filesystem& fs, const std::string& compiler_path)
+    {
+        if (compiler_path.empty())
+        {
+            return std::string();
+        }
+
+        std::error_code ec;
+        const auto metadata = fs.file_metadata(compiler_path, ec);
+        if (ec)
+        {
+            return std::string();
+        }
+
+        return fmt::format("{} {} {}", metadata.size, metadata.last_write_time, metadata.inode);
+    }
+
+    Json::Array load_compiler_info_cache_entries(const Filesystem& fs, const Path& cache_file)
+    {
+        std::error_code ec;
+        auto contents = fs.read_contents(cache_file, ec);
+        if (ec)
+        {
+            return Json::Array{};
+        }
+
+        auto maybe_doc = Json::parse_object(contents, cache_file);
+        auto doc = maybe_doc.get();
+        if (!doc)
+        {
+            return Json::Array{};
+        }
+
+        auto version = doc->get(CompilerInfoCacheJsonIdVersion);
+        auto entries = doc->get(CompilerInfoCacheJsonIdEntries);
+        if (!version || !version->is_integer() || version->integer(VCPKG_LINE_INFO) != compiler_info_cache_version ||
+            !entries || !entries->is_array())
+        {
+            return Json::Array{};
+        }
+
+        return std::move(*entries).array(VCPKG_LINE_INFO);
+    }
+
+    Optional<CompilerInfo> find_cached_compiler_info(const Filesystem& fs, const Json::Array& entries, StringView key)
+    {
+        for (auto&& entry : entries)
+        {
+            auto obj = entry.maybe_object();
+            if (!obj) continue;
+            auto entry_key = obj->get(CompilerInfoCacheJsonIdKey);
+            if (!entry_key || !entry_key->is_string() || entry_key->string(VCPKG_LINE_INFO) != key) continue;
+
+            CompilerInfo compiler_info;
+            std::string path_metadata;
+            for (auto&& field : {std::make_pair(CompilerInfoCacheJsonIdId, &compiler_info.id),
+                                 std::make_pair(CompilerInfoCacheJsonIdCompilerVersion, &compiler_info.version),
+                                 std::make_pair(CompilerInfoCacheJsonIdHash, &compiler_info.hash),
+                                 std::make_pair(CompilerInfoCacheJsonIdPath, &compiler_info.path),
+                                 std::make_pair(CompilerInfoCacheJsonIdPathMetadata, &path_metadata)})
+            {
+                auto value = obj->get(field.first);
+                if (!value || !value->is_string()) return nullopt;
+                *field.second = value->string(VCPKG_LINE_INFO).to_string();
+            }
+
+            // The compiler that was found may have been replaced by one that is not on PATH under a usual name
+            if (compiler_info.hash.empty() ||
+                path_metadata != describe_compiler_path_metadata(fs, compiler_info.path))
+            {
+                return nullopt;
+            }
+
+            return compiler_info;
+        }
+
+        return nullopt;
+    }
+
+    void save_cached_compiler_info(const Filesystem& fs,
+                                   const Path& cache_file,
+                                   StringView key,
+                                   const CompilerInfo& compiler_info)
+    {
+        // Builds of different triplets may detect compilers at once, as may other vcpkg processes sharing buildtrees
+        static std::mutex cache_file_mtx;
+        std::lock_guard<std::mutex> lock(cache_file_mtx);
+        std::error_code ec;
+        fs.create_directories(cache_file.parent_path(), ec);
+        FullyBufferedDiagnosticContext lock_context;
+        const auto guard = fs.take_exclusive_file_lock(lock_context, fmt::format("{}.lock", cache_file.native()));
+        if (!guard)
+        {
+            return;
+        }
+
+        auto entries = load_compiler_info_cache_entries(fs, cache_file);
+        Json::Array new_entries;
+        auto& new_entry = new_entries.push_back(Json::Object{});
+        new_entry.insert(CompilerInfoCacheJsonIdKey, key);
+        new_entry.insert(CompilerInfoCacheJsonIdId, compiler_info.id);
+        new_entry.insert(CompilerInfoCacheJsonIdCompilerVersion, compiler_info.version);
+        new_entry.insert(CompilerInfoCacheJsonIdHash, compiler_info.hash);
+        new_entry.insert(CompilerInfoCacheJsonIdPath, compiler_info.path);
+        new_entry.insert(CompilerInfoCacheJsonIdPathMetadata,
+                         describe_compiler_path_metadata(fs, compiler_info.path));
+        for (auto&& entry : entries)
+        {
+            if (new_entries.size() == compiler_info_cache_max_entries) break;
+            auto obj = entry.maybe_object();
+            if (!obj) continue;
+            auto entry_key = obj->get(CompilerInfoCacheJsonIdKey);
+            if (!entry_key || !entry_key->is_string() || entry_key->string(VCPKG_LINE_INFO) == key) continue;
+            new_entries.push_back(std::move(*obj));
+        }
+
+        Json::Object doc;
+        doc.insert(CompilerInfoCacheJsonIdVersion, Json::Value::integer(compiler_info_cache_version));
+        doc.insert(CompilerInfoCacheJsonIdEntries, std::move(new_entries));
+
+        // The cache only saves time, so failing to write it is not an error
+        const Path temp_path = fmt::format("{}.{}.tmp", cache_file.native(), get_process_id());
+        fs.write_contents_and_dirs(temp_path, Json::stringify(doc), ec);
+        if (!ec)
+        {
+            fs.rename(temp_path, cache_file, ec);
+        }
+
+        if (ec)
+        {
+            fs.remove(temp_path, IgnoreErrors{});
+        }
+    }
+
+    // Like load_compiler_info, but reuses the result of an earlier invocation with the same cache key.
+    static CompilerInfo load_compiler_info_cached(const VcpkgPaths& paths,
+                                                  const PreBuildInfo& pre_build_info,
+                                                  const Toolset& toolset,
+                                                  StringView triplet_hash,
+                                                  StringView toolchain_hash)
+    {
+        const auto& fs = paths.get_filesystem();
+        const auto cache_file = paths.buildtrees() / FileCompilerInfoCacheDotJson;
+        const StringView compiler_stems[] = {"cc", "c++", "gcc", "g++", "clang", "clang++", "cl"};
+        const auto key = get_compiler_info_cache_key(fs,
+                                                     paths.get_file_hash_cache(),
+                                                     paths.scripts / FileDetectCompiler,
+                                                     paths.get_tool_version_required(Tools::CMAKE),
+                                                     paths.get_ports_cmake_hash(),
+                                                     pre_build_info.triplet,
+                                                     pre_build_info.passthrough_env_vars,
+                                                     toolset,
+                                                     triplet_hash,
+                                                     toolchain_hash,
+                                                     fs.find_from_PATH(compiler_stems));
+        auto maybe_cached = find_cached_compiler_info(fs, load_compiler_info_cache_entries(fs, cache_file), key);
+        if (auto cached = maybe_cached.get())
+        {
+            Debug::println("Reusing cached compiler hash for triplet ", pre_build_info.triplet, ": ", cached->hash);
+            if (!cached->path.empty())
+            {
+                msg::println(msgCompilerPath, msg::path = cached->path);
+            }
+
+            return std::move(*cached);
+        }
+
+        auto compiler_info = load_compiler_info(paths, pre_build_info, toolset);
+        save_cached_compiler_info(fs, cache_file, key, compiler_info);
+        return compiler_info;
+    }
+
     const CompilerInfo& EnvCache::get_compiler_info(const VcpkgPaths& paths,
                                                     const PreBuildInfo& pre_build_info,
                                                     const Toolset& toolset)
@@ -671,7 +933,7 @@ namespace vcpkg
         return triplet_entry.compiler_info.get_lazy(toolchain_hash, [&]() -> CompilerInfo {
             if (m_compiler_tracking)
             {
-                return load_compiler_info(paths, pre_build_info, toolset);
+                return load_compiler_info_cached(paths, pre_build_info, toolset, triplet_entry.hash, toolchain_hash);
             }
             else
             {
@@ -790,6 +1052,7 @@ namespace vcpkg
     static void get_generic_cmake_build_args(const VcpkgPaths& paths,
                                              Triplet triplet,
                                              const Toolset& toolset,
+                                             unsigned int concurrency,
                                              std::vector<CMakeVariable>& out_vars)
     {
         out_vars.emplace_back(CMakeVariableCmd, "BUILD");
@@ -797,7 +1060,7 @@ namespace vcpkg
         out_vars.emplace_back(CMakeVariableTargetTriplet, triplet.canonical_name());
         out_vars.emplace_back(CMakeVariableTargetTripletFile, paths.get_triplet_db().get_triplet_file_path(triplet));
         out_vars.emplace_back(CMakeVariableBaseVersion, VCPKG_BASE_VERSION_AS_STRING);
-        out_vars.emplace_back(CMakeVariableConcurrency, std::to_string(get_concurrency()));
+        out_vars.emplace_back(CMakeVariableConcurrency, std::to_string(concurrency));
         out_vars.emplace_back(CMakeVariablePlatformToolset, toolset.version);
         // Make sure GIT could be found
         out_vars.emplace_back(CMakeVariableGit, paths.get_tool_path_required(Tools::GIT));
@@ -822,7 +1085,7 @@ namespace vcpkg
             {CMakeVariableZChainloadToolchainFile, pre_build_info.toolchain_file()},
         };
 
-        get_generic_cmake_build_args(paths, triplet, toolset, cmake_args);
+        get_generic_cmake_build_args(paths, triplet, toolset, get_concurrency(), cmake_args);
 
         auto cmd = vcpkg::make_cmake_cmd(paths, paths.ports_cmake, std::move(cmake_args));
         RedirectedProcessLaunchSettings settings;
@@ -952,7 +1215,9 @@ namespace vcpkg
 
         const auto* maybe_toolset = action.abi_info.value_or_exit(VCPKG_LINE_INFO).toolset;
         Checks::check_exit(VCPKG_LINE_INFO, maybe_toolset != nullptr);
-        get_generic_cmake_build_args(paths, action.spec.triplet(), *maybe_toolset, variables);
+        // Packages built at the same time share the available processors
+        const auto concurrency = (std::max)(1u, get_concurrency() / build_options.concurrent_builds);
+        get_generic_cmake_build_args(paths, action.spec.triplet(), *maybe_toolset, concurrency, variables);
         if (Util::Enum::to_bool(build_options.only_downloads))
         {
             variables.emplace_back(CMakeVariableDownloadMode, "true");
@@ -1135,7 +1400,8 @@ namespace vcpkg
                                                 Triplet host_triplet,
                                                 const BuildPackageOptions& build_options,
                                                 const InstallPlanAction& action,
-                                                bool all_dependencies_satisfied)
+                                                bool all_dependencies_satisfied,
+                                                MessageSink& build_out)
     {
         const auto& pre_build_info = action.pre_build_info(VCPKG_LINE_INFO);
 
@@ -1147,19 +1413,17 @@ namespace vcpkg
 
         if (triplet_db.is_community_triplet_path(triplet_file_path))
         {
-            msg::print(LocalizedString::from_raw(triplet_file_path)
-                           .append_raw(": ")
-                           .append_raw(InfoPrefix)
-                           .append(msgLoadedCommunityTriplet)
-                           .append_raw('\n'));
+            build_out.println(LocalizedString::from_raw(triplet_file_path)
+                                  .append_raw(": ")
+                                  .append_raw(InfoPrefix)
+                                  .append(msgLoadedCommunityTriplet));
         }
         else if (triplet_db.is_overlay_triplet_path(triplet_file_path))
         {
-            msg::print(LocalizedString::from_raw(triplet_file_path)
-                           .append_raw(": ")
-                           .append_raw(InfoPrefix)
-                           .append(msgLoadedOverlayTriplet)
-                           .append_raw('\n'));
+            build_out.println(LocalizedString::from_raw(triplet_file_path)
+                                  .append_raw(": ")
+                                  .append_raw(InfoPrefix)
+                                  .append(msgLoadedOverlayTriplet));
         }
 
         switch (scfl.kind)
@@ -1169,27 +1433,24 @@ namespace vcpkg
                 // intentionally no output for these
                 break;
             case PortSourceKind::Overlay:
-                msg::print(LocalizedString::from_raw(scfl.port_directory())
-                               .append_raw(": ")
-                               .append_raw(InfoPrefix)
-                               .append(msgInstallingOverlayPort)
-                               .append_raw('\n'));
+                build_out.println(LocalizedString::from_raw(scfl.port_directory())
+                                      .append_raw(": ")
+                                      .append_raw(InfoPrefix)
+                                      .append(msgInstallingOverlayPort));
                 break;
             case PortSourceKind::Git:
-                msg::print(LocalizedString::from_raw(scfl.port_directory())
-                               .append_raw(": ")
-                               .append_raw(InfoPrefix)
-                               .append(msgInstallingFromGitRegistry)
-                               .append_raw(' ')
-                               .append_raw(scfl.spdx_location)
-                               .append_raw('\n'));
+                build_out.println(LocalizedString::from_raw(scfl.port_directory())
+                                      .append_raw(": ")
+                                      .append_raw(InfoPrefix)
+                                      .append(msgInstallingFromGitRegistry)
+                                      .append_raw(' ')
+                                      .append_raw(scfl.spdx_location));
                 break;
             case PortSourceKind::Filesystem:
-                msg::print(LocalizedString::from_raw(scfl.port_directory())
-                               .append_raw(": ")
-                               .append_raw(InfoPrefix)
-                               .append(msgInstallingFromFilesystemRegistry)
-                               .append_raw('\n'));
+                build_out.println(LocalizedString::from_raw(scfl.port_directory())
+                                      .append_raw(": ")
+                                      .append_raw(InfoPrefix)
+                                      .append(msgInstallingFromFilesystemRegistry));
                 break;
             default: Checks::unreachable(VCPKG_LINE_INFO);
         }
@@ -1212,14 +1473,39 @@ namespace vcpkg
         auto stdoutlog = buildpath / ("stdout-" + action.spec.triplet().canonical_name() + ".log");
         Optional<WriteFilePointer> out_file_storage = fs.open_for_write(stdoutlog, VCPKG_LINE_INFO);
         auto& out_file = out_file_storage.value_or_exit(VCPKG_LINE_INFO);
+        const bool build_out_is_console = &build_out == &out_sink;
+        std::string partial_line;
         auto return_code = cmd_execute_and_stream_data(cmd, settings, [&](StringView sv) {
-            msg::write_unlocalized_text(Color::none, sv);
+            if (build_out_is_console)
+            {
+                msg::write_unlocalized_text(Color::none, sv);
+            }
+            else
+            {
+                // Other sinks receive whole lines
+                partial_line.append(sv.data(), sv.size());
+                auto first = partial_line.begin();
+                for (auto newline = std::find(first, partial_line.end(), '\n'); newline != partial_line.end();
+                     newline = std::find(first, partial_line.end(), '\n'))
+                {
+                    build_out.println(LocalizedString::from_raw(std::string(first, newline)));
+                    first = newline + 1;
+                }
+
+                partial_line.erase(partial_line.begin(), first);
+            }
+
             Checks::msg_check_exit(VCPKG_LINE_INFO,
                                    out_file.write(sv.data(), 1, sv.size()) == sv.size(),
                                    msgErrorWhileWriting,
                                    msg::path = stdoutlog);
         });
 
+        if (!partial_line.empty())
+        {
+            build_out.println(LocalizedString::from_raw(std::move(partial_line)));
+        }
+
         out_file_storage.clear();
         const auto buildtimeus = timer.microseconds();
         const auto spec_string = action.spec.to_string();
@@ -1267,7 +1553,7 @@ namespace vcpkg
         size_t error_count = 0;
         {
             FileSink file_sink{fs, stdoutlog, Append::YES};
-            TeeSink combo_sink{out_sink, file_sink};
+            TeeSink combo_sink{build_out, file_sink};
             error_count = perform_post_build_lint_checks(action, paths, pre_build_info, build_info, combo_sink);
         };
         if (error_count != 0 && build_options.backcompat_features == BackcompatFeatures::Prohibit)
@@ -1287,9 +1573,11 @@ namespace vcpkg
                                                                      Triplet host_triplet,
                                                                      const BuildPackageOptions& build_options,
                                                                      const InstallPlanAction& action,
-                                                                     bool all_dependencies_satisfied)
+                                                                     bool all_dependencies_satisfied,
+                                                                     MessageSink& build_out)
     {
-        auto result = do_build_package(args, paths, host_triplet, build_options, action, all_dependencies_satisfied);
+        auto result = do_build_package(
+            args, paths, host_triplet, build_options, action, all_dependencies_satisfied, build_out);
 
         if (build_options.clean_buildtrees == CleanBuildtrees::Yes && result.code == BuildResult::Succeeded)
         {
@@ -1323,7 +1611,7 @@ namespace vcpkg
     }
 
     static std::string grdk_hash(const Filesystem& fs,
-                                 Cache<Path, Optional<std::string>>& grdk_cache,
+                                 ConcurrentCache<Path, Optional<std::string>>& grdk_cache,
                                  const PreBuildInfo& pre_build_info)
     {
         auto maybe_gxdk_header_path = get_grdk_header_path(pre_build_info);
@@ -1352,7 +1640,7 @@ namespace vcpkg
     }
 
     static void abi_entries_from_pre_build_info(const Filesystem& fs,
-                                                Cache<Path, Optional<std::string>>& grdk_cache,
+                                                ConcurrentCache<Path, Optional<std::string>>& grdk_cache,
                                                 const PreBuildInfo& pre_build_info,
                                                 std::vector<AbiEntry>& abi_tag_entries)
     {
@@ -1371,12 +1659,28 @@ namespace vcpkg
         }
     }
 
-    static void populate_abi_tag(const VcpkgPaths& paths,
+    namespace
+    {
+        // The state of one action whose ABI is being computed by compute_all_abis
+        struct AbiComputation
+        {
+            explicit AbiComputation(InstallPlanAction& action) : action(&action) { }
+
+            InstallPlanAction* action;
+            std::vector<AbiEntry> abi_tag_entries;
+            // Dependencies whose ABIs are computed in the same pass; their entries are added once they are known
+            std::vector<std::pair<std::string, const InstallPlanAction*>> pending_dependencies;
+            const std::string* triplet_abi = nullptr;
+            const SpecAbiInfoCacheEntry* port_dir_cache_entry = nullptr;
+            // The ABI can be finalized once every wave before this one is done
+            size_t wave = 0;
+        };
+    }
+
+    // Returns whether the package ABI of `action` should be computed
+    static bool prepare_abi_info(const VcpkgPaths& paths,
                                  InstallPlanAction& action,
-                                 std::unique_ptr<PreBuildInfo>&& proto_pre_build_info,
-                                 Span<const AbiEntry> dependency_abis,
-                                 SpecAbiInfoCache& spec_abi_cache,
-                                 Cache<Path, Optional<std::string>>& grdk_cache)
+                                 std::unique_ptr<PreBuildInfo>&& proto_pre_build_info)
     {
         Checks::check_exit(VCPKG_LINE_INFO, static_cast<bool>(proto_pre_build_info));
         const auto& pre_build_info = *proto_pre_build_info;
@@ -1388,40 +1692,49 @@ namespace vcpkg
         if (action.use_head_version == UseHeadVersion::Yes)
         {
             Debug::print("Binary caching for package ", action.spec, " is disabled due to --head\n");
-            return;
+            return false;
         }
         if (action.editable == Editable::Yes)
         {
             Debug::print("Binary caching for package ", action.spec, " is disabled due to --editable\n");
-            return;
+            return false;
         }
 
         abi_info.compiler_info = &paths.get_compiler_info(*abi_info.pre_build_info, toolset);
-        for (auto&& dep_abi : dependency_abis)
+        return true;
+    }
+
+    static bool check_dependency_abi(const InstallPlanAction& action, const AbiEntry& dep_abi)
+    {
+        if (dep_abi.value.empty())
         {
-            if (dep_abi.value.empty())
-            {
-                Debug::print("Binary caching for package ",
-                             action.spec,
-                             " is disabled due to missing abi info for ",
-                             dep_abi.key,
-                             '\n');
-                return;
-            }
+            Debug::print("Binary caching for package ",
+                         action.spec,
+                         " is disabled due to missing abi info for ",
+                         dep_abi.key,
+                         '\n');
+            return false;
         }
 
-        std::vector<AbiEntry> abi_tag_entries(dependency_abis.begin(), dependency_abis.end());
+        return true;
+    }
 
-        const auto& triplet_abi = paths.get_triplet_info(pre_build_info, toolset);
-        abi_info.triplet_abi = &triplet_abi;
-        const auto& triplet_canonical_name = action.spec.triplet().canonical_name();
-        abi_tag_entries.emplace_back(AbiTagTriplet, triplet_canonical_name);
-        abi_tag_entries.emplace_back(AbiTagTripletAbi, triplet_abi);
+    // Hashes the port directory and the other files that contribute to the ABI of `computation`. Safe to call for
+    // several computations at once.
+    static void hash_abi_files(const VcpkgPaths& paths,
+                               AbiComputation& computation,
+                               SpecAbiInfoCache& spec_abi_cache,
+                               ConcurrentCache<Path, Optional<std::string>>& grdk_cache)
+    {
+        auto& action = *computation.action;
+        const auto& pre_build_info = *action.abi_info.value_or_exit(VCPKG_LINE_INFO).pre_build_info;
+        auto& abi_tag_entries = computation.abi_tag_entries;
         auto& fs = paths.get_filesystem();
+        auto& file_hash_cache = paths.get_file_hash_cache();
         abi_entries_from_pre_build_info(fs, grdk_cache, pre_build_info, abi_tag_entries);
 
         auto&& port_dir = action.source_control_file_and_location().port_directory();
-        const auto& port_dir_cache_entry = spec_abi_cache.get_lazy(action.spec, [&]() {
+        computation.port_dir_cache_entry = &spec_abi_cache.get_lazy(action.spec, [&]() {
             SpecAbiInfoCacheEntry port_dir_cache_entry;
 
             std::string portfile_cmake_contents;
@@ -1441,17 +1754,16 @@ namespace vcpkg
                 port_dir_cache_entry.files = std::move(rel_port_files);
             }
             const auto& rel_port_files = port_dir_cache_entry.files;
-            for (size_t i = 0; i < abi_info.pre_build_info->hash_additional_files.size(); ++i)
+            for (size_t i = 0; i < pre_build_info.hash_additional_files.size(); ++i)
             {
-                const auto& file = abi_info.pre_build_info->hash_additional_files[i];
+                const auto& file = pre_build_info.hash_additional_files[i];
                 if (file.is_relative() || !fs.is_regular_file(file))
                 {
                     Checks::msg_exit_with_message(
                         VCPKG_LINE_INFO, msgInvalidValueHashAdditionalFiles, msg::path = file);
                 }
-                abi_tag_entries.emplace_back(
-                    fmt::format("additional_file_{}", i),
-                    Hash::get_file_hash(fs, file, Hash::Algorithm::Sha256).value_or_exit(VCPKG_LINE_INFO));
+                abi_tag_entries.emplace_back(fmt::format("additional_file_{}", i),
+                                             file_hash_cache.get_file_sha256(fs, file).value_or_exit(VCPKG_LINE_INFO));
             }
 
             for (const Path& rel_port_file : rel_port_files)
@@ -1462,13 +1774,13 @@ namespace vcpkg
                 {
                     const auto contents = fs.read_contents(abs_port_file, VCPKG_LINE_INFO);
                     portfile_cmake_contents += contents;
-                    port_dir_cache_entry.hashes.push_back(vcpkg::Hash::get_string_sha256(contents));
+                    port_dir_cache_entry.hashes.push_back(
+                        file_hash_cache.get_contents_sha256(fs, abs_port_file, contents));
                 }
                 else
                 {
                     port_dir_cache_entry.hashes.push_back(
-                        vcpkg::Hash::get_file_hash(fs, abs_port_file, Hash::Algorithm::Sha256)
-                            .value_or_exit(VCPKG_LINE_INFO));
+                        file_hash_cache.get_file_sha256(fs, abs_port_file).value_or_exit(VCPKG_LINE_INFO));
                 }
                 port_dir_cache_entry.abi_entries.emplace_back(rel_port_file, port_dir_cache_entry.hashes.back());
             }
@@ -1485,31 +1797,45 @@ namespace vcpkg
             return port_dir_cache_entry;
         });
 
-        Util::Vectors::append(abi_tag_entries, port_dir_cache_entry.abi_entries);
+        Util::Vectors::append(abi_tag_entries, computation.port_dir_cache_entry->abi_entries);
 
-        for (size_t i = 0; i < abi_info.pre_build_info->post_portfile_includes.size(); ++i)
+        for (size_t i = 0; i < pre_build_info.post_portfile_includes.size(); ++i)
         {
-            auto& file = abi_info.pre_build_info->post_portfile_includes[i];
+            auto& file = pre_build_info.post_portfile_includes[i];
             if (file.is_relative() || !fs.is_regular_file(file) || file.extension() != ".cmake")
             {
                 Checks::msg_exit_with_message(VCPKG_LINE_INFO, msgInvalidValuePostPortfileIncludes, msg::path = file);
             }
 
-            abi_tag_entries.emplace_back(
-                fmt::format("post_portfile_include_{}", i),
-                Hash::get_file_hash(fs, file, Hash::Algorithm::Sha256).value_or_exit(VCPKG_LINE_INFO));
+            abi_tag_entries.emplace_back(fmt::format("post_portfile_include_{}", i),
+                                         file_hash_cache.get_file_sha256(fs, file).value_or_exit(VCPKG_LINE_INFO));
         }
+    }
 
-        abi_tag_entries.emplace_back(AbiTagCMake, paths.get_tool_version_required(Tools::CMAKE));
+    // Combines the entries collected for `computation` into the package ABI. The ABIs of all pending dependencies
+    // must already be known.
+    static void finalize_abi_tag(const VcpkgPaths& paths,
+                                 AbiComputation& computation,
+                                 View<AbiEntry> common_abi_entries)
+    {
+        auto& action = *computation.action;
+        auto& abi_tag_entries = computation.abi_tag_entries;
+        for (auto&& pending : computation.pending_dependencies)
+        {
+            const auto& dep_abi = abi_tag_entries.emplace_back(pending.first, pending.second->package_abi_or_empty());
+            if (!check_dependency_abi(action, dep_abi))
+            {
+                return;
+            }
+        }
 
-        // This #ifdef is mirrored in tools.cpp's PowershellProvider
-#if defined(_WIN32)
-        abi_tag_entries.emplace_back(AbiTagPowershell, paths.get_tool_version_required("powershell-core"));
-#endif
+        auto& abi_info = action.abi_info.value_or_exit(VCPKG_LINE_INFO);
+        abi_info.triplet_abi = computation.triplet_abi;
+        const auto& triplet_canonical_name = action.spec.triplet().canonical_name();
+        abi_tag_entries.emplace_back(AbiTagTriplet, triplet_canonical_name);
+        abi_tag_entries.emplace_back(AbiTagTripletAbi, *computation.triplet_abi);
+        abi_tag_entries.insert(abi_tag_entries.end(), common_abi_entries.begin(), common_abi_entries.end());
 
-        abi_tag_entries.emplace_back(AbiTagPortsDotCMake, paths.get_ports_cmake_hash().to_string());
-        abi_tag_entries.emplace_back(AbiTagPostBuildChecks, "2");
-        abi_tag_entries.emplace_back(AbiTagSbomInfo, "1");
         InternalFeatureSet sorted_feature_list = action.feature_list;
         // Check that no "default" feature is present. Default features must be resolved before attempting to calculate
         // a package ABI, so the "default" should not have made it here.
@@ -1553,12 +1879,42 @@ namespace vcpkg
             return;
         }
 
+        auto& fs = paths.get_filesystem();
         Path abi_file_path = paths.build_dir(action.spec.name()) / (triplet_canonical_name + ".vcpkg_abi_info.txt");
         fs.write_contents_and_dirs(abi_file_path, full_abi_info, VCPKG_LINE_INFO);
         abi_info.package_abi = Hash::get_string_sha256(full_abi_info);
         abi_info.abi_tag_file.emplace(std::move(abi_file_path));
-        abi_info.relative_port_files = port_dir_cache_entry.files;
-        abi_info.relative_port_hashes = port_dir_cache_entry.hashes;
+        abi_info.relative_port_files = computation.port_dir_cache_entry->files;
+        abi_info.relative_port_hashes = computation.port_dir_cache_entry->hashes;
+    }
+
+    AbiDependencyIndex::AbiDependencyIndex(const StatusParagraphs& status_db)
+    {
+        for (auto&& status_pgh : status_db)
+        {
+            if (status_pgh->package.feature.empty())
+            {
+                // status_db iterates newest first, so the first paragraph for a spec is the one find() would return
+                m_core_status_paragraphs.emplace(status_pgh->package.spec, status_pgh.get());
+            }
+        }
+    }
+
+    void AbiDependencyIndex::add_action(const PackageSpec& spec, size_t action_index)
+    {
+        m_action_indices.emplace(spec, action_index);
+    }
+
+    size_t AbiDependencyIndex::find_action(const PackageSpec& spec) const
+    {
+        auto it = m_action_indices.find(spec);
+        return it == m_action_indices.end() ? SIZE_MAX : it->second;
+    }
+
+    const StatusParagraph* AbiDependencyIndex::find_installed(const PackageSpec& spec) const
+    {
+        auto it = m_core_status_paragraphs.find(spec);
+        return it == m_core_status_paragraphs.end() ? nullptr : it->second;
     }
 
     void compute_all_abis(const VcpkgPaths& paths,
@@ -1576,26 +1932,34 @@ namespace vcpkg
                           const StatusParagraphs& status_db,
                           SpecAbiInfoCache& spec_abi_cache)
     {
-        Cache<Path, Optional<std::string>> grdk_cache;
-        for (auto it = action_plan.install_actions.begin(); it != action_plan.install_actions.end(); ++it)
-        {
-            auto& action = *it;
+        // ABIs are computed in three phases:
+        // 1. In plan order, resolve dependencies and query the toolset, compiler, and triplet information, which
+        //    VcpkgPaths caches without synchronization.
+        // 2. Hash the files of every port in parallel, as they do not depend on any other ABI.
+        // 3. Combine everything into the package ABIs, in parallel waves such that each action is finalized after
+        //    the actions it depends on.
+        std::vector<AbiComputation> computations;
+        auto& install_actions = action_plan.install_actions;
+        // The index in computations of each install action, or SIZE_MAX if its ABI is not being computed
+        std::vector<size_t> computation_indices(install_actions.size(), SIZE_MAX);
+        AbiDependencyIndex dependency_index{status_db};
+        for (size_t action_index = 0; action_index < install_actions.size(); ++action_index)
+        {
+            auto& action = install_actions[action_index];
+            dependency_index.add_action(action.spec, action_index);
             if (action.abi_info.has_value()) continue;
 
-            std::vector<AbiEntry> dependency_abis;
+            AbiComputation computation{action};
             for (auto&& pspec : action.package_dependencies)
             {
                 if (pspec == action.spec) continue;
-                auto it2 = std::find_if(action_plan.install_actions.begin(), it, [&](const InstallPlanAction& ipa) {
-                    return ipa.spec == pspec;
-                });
-
-                if (it2 == it)
+                const auto dependency_action_index = dependency_index.find_action(pspec);
+                if (dependency_action_index == SIZE_MAX)
                 {
                     // If the action plan was built from an existing install tree, existing dependencies won't be in the
                     // plan. Look for their ABI from the installed tree.
-                    auto status_it = status_db.find(pspec);
-                    if (status_it == status_db.end())
+                    auto status_pgh = dependency_index.find_installed(pspec);
+                    if (!status_pgh)
                     {
                         Checks::unreachable(
                             VCPKG_LINE_INFO,
@@ -1604,36 +1968,98 @@ namespace vcpkg
 
                     // Note that this may be empty string if the installed dependency was itself UseHeadVersion or
                     // Editable
-                    dependency_abis.emplace_back(pspec.name(), status_it->get()->package.abi);
+                    computation.abi_tag_entries.emplace_back(pspec.name(), status_pgh->package.abi);
+                    continue;
                 }
-                else
+
+                const auto& dependency = install_actions[dependency_action_index];
+                const auto dependency_computation_index = computation_indices[dependency_action_index];
+                if (dependency_computation_index == SIZE_MAX)
                 {
                     // Note that the ABI of the dependency may be empty if it depends on something with UseHeadVersion
                     // or Editable
-                    dependency_abis.emplace_back(pspec.name(), it2->package_abi_or_empty());
+                    computation.abi_tag_entries.emplace_back(pspec.name(), dependency.package_abi_or_empty());
+                }
+                else
+                {
+                    computation.pending_dependencies.emplace_back(pspec.name(), &dependency);
+                    computation.wave =
+                        (std::max)(computation.wave, computations[dependency_computation_index].wave + 1);
                 }
             }
 
             const auto* tag_vars = var_provider.get_tag_vars(action.spec);
             Checks::check_exit(VCPKG_LINE_INFO, tag_vars != nullptr);
-            populate_abi_tag(paths,
-                             action,
-                             std::make_unique<PreBuildInfo>(paths, action.spec.triplet(), *tag_vars),
-                             dependency_abis,
-                             spec_abi_cache,
-                             grdk_cache);
+            auto pre_build_info = std::make_unique<PreBuildInfo>(paths, action.spec.triplet(), *tag_vars);
+            if (!prepare_abi_info(paths, action, std::move(pre_build_info)))
+            {
+                continue;
+            }
+
+            if (!std::all_of(computation.abi_tag_entries.begin(),
+                             computation.abi_tag_entries.end(),
+                             [&](const AbiEntry& dep_abi) { return check_dependency_abi(action, dep_abi); }))
+            {
+                continue;
+            }
+
+            auto& abi_info = action.abi_info.value_or_exit(VCPKG_LINE_INFO);
+            computation.triplet_abi = &paths.get_triplet_info(*abi_info.pre_build_info, *abi_info.toolset);
+            computation_indices[action_index] = computations.size();
+            computations.push_back(std::move(computation));
+        }
+
+        if (computations.empty())
+        {
+            return;
+        }
+
+        // Populate the lazily computed members of VcpkgPaths used by the parallel phases
+        auto& file_hash_cache = paths.get_file_hash_cache();
+        paths.get_cmake_script_hashes();
+        std::vector<AbiEntry> common_abi_entries;
+        common_abi_entries.emplace_back(AbiTagCMake, paths.get_tool_version_required(Tools::CMAKE));
+
+        // This #ifdef is mirrored in tools.cpp's PowershellProvider
+#if defined(_WIN32)
+        common_abi_entries.emplace_back(AbiTagPowershell, paths.get_tool_version_required("powershell-core"));
+#endif
+
+        common_abi_entries.emplace_back(AbiTagPortsDotCMake, paths.get_ports_cmake_hash().to_string());
+        common_abi_entries.emplace_back(AbiTagPostBuildChecks, "2");
+        common_abi_entries.emplace_back(AbiTagSbomInfo, "1");
+
+        ConcurrentCache<Path, Optional<std::string>> grdk_cache;
+        parallel_for_each(computations, [&](AbiComputation& computation) {
+            hash_abi_files(paths, computation, spec_abi_cache, grdk_cache);
+        });
+
+        file_hash_cache.save(paths.get_filesystem());
+
+        std::vector<std::vector<AbiComputation*>> waves;
+        for (auto&& computation : computations)
+        {
+            if (computation.wave >= waves.size())
+            {
+                waves.resize(computation.wave + 1);
+            }
+
+            waves[computation.wave].push_back(&computation);
+        }
+
+        for (auto&& wave : waves)
+        {
+            parallel_for_each(wave, [&](AbiComputation* computation) {
+                finalize_abi_tag(paths, *computation, common_abi_entries);
+            });
         }
     }
 
-    ExtendedBuildResult build_package(const VcpkgCmdArguments& args,
-                                      const VcpkgPaths& paths,
-                                      Triplet host_triplet,
-                                      const BuildPackageOptions& build_options,
-                                      const InstallPlanAction& action,
-                                      const IBuildLogsRecorder& build_logs_recorder,
-                                      const StatusParagraphs& status_db)
+    Optional<ExtendedBuildResult> check_build_dependencies(const BuildPackageOptions& build_options,
+                                                           const InstallPlanAction& action,
+                                                           const StatusParagraphs& status_db,
+                                                           bool& all_dependencies_satisfied)
     {
-        auto& filesystem = paths.get_filesystem();
         auto& spec = action.spec;
         std::map<PackageSpec, std::set<std::string>> missing_fspecs;
         for (const auto& kv : action.feature_dependencies)
@@ -1648,20 +2074,21 @@ namespace vcpkg
             }
         }
 
-        const bool all_dependencies_satisfied = missing_fspecs.empty();
+        all_dependencies_satisfied = missing_fspecs.empty();
         if (build_options.only_downloads == OnlyDownloads::No)
         {
             if (!all_dependencies_satisfied)
             {
-                return {action.spec,
-                        BuildResult::CascadedDueToMissingDependencies,
-                        Util::fmap(std::move(missing_fspecs),
-                                   [](std::pair<PackageSpec, std::set<std::string>>&& missing_features) {
-                                       return FullPackageSpec{
-                                           std::move(missing_features.first),
-                                           InternalFeatureSet{std::make_move_iterator(missing_features.second.begin()),
-                                                              std::make_move_iterator(missing_features.second.end())}};
-                                   })};
+                return ExtendedBuildResult{
+                    action.spec,
+                    BuildResult::CascadedDueToMissingDependencies,
+                    Util::fmap(std::move(missing_fspecs),
+                               [](std::pair<PackageSpec, std::set<std::string>>&& missing_features) {
+                                   return FullPackageSpec{
+                                       std::move(missing_features.first),
+                                       InternalFeatureSet{std::make_move_iterator(missing_features.second.begin()),
+                                                          std::make_move_iterator(missing_features.second.end())}};
+                               })};
             }
 
             // assert that all_dependencies_satisfied is accurate above by checking that they're all installed
@@ -1679,9 +2106,23 @@ namespace vcpkg
             }
         }
 
+        return nullopt;
+    }
+
+    ExtendedBuildResult build_checked_package(const VcpkgCmdArguments& args,
+                                              const VcpkgPaths& paths,
+                                              Triplet host_triplet,
+                                              const BuildPackageOptions& build_options,
+                                              const InstallPlanAction& action,
+                                              const IBuildLogsRecorder& build_logs_recorder,
+                                              bool all_dependencies_satisfied,
+                                              MessageSink& build_out)
+    {
+        auto& filesystem = paths.get_filesystem();
+        auto& spec = action.spec;
         auto& abi_info = action.abi_info.value_or_exit(VCPKG_LINE_INFO);
         ExtendedBuildResult result = do_build_package_and_clean_buildtrees(
-            args, paths, host_triplet, build_options, action, all_dependencies_satisfied);
+            args, paths, host_triplet, build_options, action, all_dependencies_satisfied, build_out);
         if (abi_info.abi_tag_file)
         {
             auto& abi_file = *abi_info.abi_tag_file.get();
@@ -1695,6 +2136,31 @@ namespace vcpkg
         return result;
     }
 
+    ExtendedBuildResult build_package(const VcpkgCmdArguments& args,
+                                      const VcpkgPaths& paths,
+                                      Triplet host_triplet,
+                                      const BuildPackageOptions& build_options,
+                                      const InstallPlanAction& action,
+                                      const IBuildLogsRecorder& build_logs_recorder,
+                                      const StatusParagraphs& status_db)
+    {
+        bool all_dependencies_satisfied;
+        if (auto missing_dependencies =
+                check_build_dependencies(build_options, action, status_db, all_dependencies_satisfied))
+        {
+            return std::move(*missing_dependencies.get());
+        }
+
+        return build_checked_package(args,
+                                     paths,
+                                     host_triplet,
+                                     build_options,
+                                     action,
+                                     build_logs_recorder,
+                                     all_dependencies_satisfied,
+                                     out_sink);
+    }
+
     void BuildResultCounts::increment(BuildResult build_result)
     {
         switch (build_result)
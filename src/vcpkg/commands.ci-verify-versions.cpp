@@ -3,17 +3,25 @@
 #include <vcpkg/base/checks.h>
 #include <vcpkg/base/contractual-constants.h>
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/git-objects.h>
 #include <vcpkg/base/git.h>
+#include <vcpkg/base/json.h>
 #include <vcpkg/base/message_sinks.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/strings.h>
+#include <vcpkg/base/system.h>
 #include <vcpkg/base/util.h>
 
 #include <vcpkg/commands.ci-verify-versions.h>
+#include <vcpkg/commands.version.h>
 #include <vcpkg/paragraphs.h>
 #include <vcpkg/registries.h>
+#include <vcpkg/tools.h>
 #include <vcpkg/vcpkgcmdarguments.h>
 #include <vcpkg/vcpkgpaths.h>
 
+#include <set>
+
 using namespace vcpkg;
 
 namespace
@@ -30,39 +38,103 @@ namespace
         }
     }
 
+    constexpr int64_t verified_git_trees_version = 1;
+    constexpr StringLiteral JsonIdVcpkgVersion = "vcpkg-version";
+    constexpr StringLiteral JsonIdVerified = "verified";
+
+    // Loads the port in `git_tree` by reading its manifest straight from the git object database. Returns nullopt
+    // if that is not possible, or if the tree does not hold exactly one of vcpkg.json and CONTROL, in which case
+    // the tree must be checked out so that the usual diagnostics are produced.
+    Optional<ExpectedL<SourceControlFileAndLocation>> try_load_port_from_git_objects(const VcpkgPaths& paths,
+                                                                                   const Path& dot_git_dir,
+                                                                                   const std::string& port_name,
+                                                                                   const std::string& git_tree,
+                                                                                   MessageSink& warning_sink)
+    {
+        auto objects = paths.get_git_object_database(dot_git_dir);
+        if (!objects)
+        {
+            return nullopt;
+        }
+
+        auto maybe_manifest = objects->read_blob(fmt::format("{}:{}", git_tree, FileVcpkgDotJson));
+        auto maybe_control = objects->read_blob(fmt::format("{}:{}", git_tree, FileControl));
+        auto manifest = maybe_manifest.get();
+        auto control = maybe_control.get();
+        if (!manifest == !control)
+        {
+            return nullopt;
+        }
+
+        // Diagnostics name the files where git_checkout_port would have put them
+        const auto port_directory = paths.versions_output() / port_name / git_tree;
+        auto control_path = port_directory / (manifest ? FileVcpkgDotJson : FileControl);
+        auto maybe_scf = manifest ? Paragraphs::try_load_port_manifest_text(*manifest, control_path, warning_sink)
+                                  : Paragraphs::try_load_control_file_text(*control, control_path);
+        return std::move(maybe_scf).map([&](std::unique_ptr<SourceControlFile>&& scf) {
+            return SourceControlFileAndLocation{std::move(scf),
+                                                std::move(control_path),
+                                                Paragraphs::builtin_git_tree_spdx_location(git_tree),
+                                                std::string(),
+                                                PortSourceKind::Git,
+                                                git_tree};
+        });
+    }
+
+    ExpectedL<SourceControlFileAndLocation> load_git_tree_port(const VcpkgPaths& paths,
+                                                               const Path& dot_git_dir,
+                                                               const std::string& port_name,
+                                                               const std::string& git_tree,
+                                                               MessageSink& warning_sink)
+    {
+        auto maybe_loaded = try_load_port_from_git_objects(paths, dot_git_dir, port_name, git_tree, warning_sink);
+        if (auto loaded = maybe_loaded.get())
+        {
+            return std::move(*loaded);
+        }
+
+        auto maybe_extracted_tree = paths.git_checkout_port(port_name, git_tree, dot_git_dir);
+        auto extracted_tree = maybe_extracted_tree.get();
+        if (!extracted_tree)
+        {
+            return std::move(maybe_extracted_tree).error();
+        }
+
+        return Paragraphs::try_load_port_required(paths.get_filesystem(),
+                                                  port_name,
+                                                  PortLocation(*extracted_tree,
+                                                               Paragraphs::builtin_git_tree_spdx_location(git_tree),
+                                                               std::string(),
+                                                               PortSourceKind::Git,
+                                                               git_tree))
+            .maybe_scfl;
+    }
+
+    LocalizedString format_git_tree_verified(const Path& versions_file_path,
+                                             const std::string& port_name,
+                                             const GitVersionDbEntry& version_entry)
+    {
+        return LocalizedString::from_raw(versions_file_path)
+            .append_raw(": ")
+            .append_raw(MessagePrefix)
+            .append(msgVersionVerifiedOK,
+                    msg::version_spec = VersionSpec{port_name, version_entry.version.version},
+                    msg::git_tree_sha = version_entry.git_tree);
+    }
+
     bool verify_git_tree(MessageSink& errors_sink,
                          MessageSink& success_sink,
                          const VcpkgPaths& paths,
+                         const ExpectedL<Path>& versions_dot_git_dir,
                          const std::string& port_name,
                          const Path& versions_file_path,
                          const GitVersionDbEntry& version_entry)
     {
         bool success = true;
-        auto maybe_extracted_tree = paths.versions_dot_git_dir().then(
-            [&](Path&& dot_git) { return paths.git_checkout_port(port_name, version_entry.git_tree, dot_git); });
-        auto extracted_tree = maybe_extracted_tree.get();
-        if (!extracted_tree)
-        {
-            success = false;
-            errors_sink.println(Color::error,
-                                LocalizedString::from_raw(versions_file_path)
-                                    .append_raw(": ")
-                                    .append(maybe_extracted_tree.error())
-                                    .append_raw('\n')
-                                    .append_raw(NotePrefix)
-                                    .append(msgWhileValidatingVersion, msg::version = version_entry.version.version));
-            return success;
-        }
-
-        auto load_result = Paragraphs::try_load_port_required(
-            paths.get_filesystem(),
-            port_name,
-            PortLocation(*extracted_tree,
-                         Paragraphs::builtin_git_tree_spdx_location(version_entry.git_tree),
-                         std::string(),
-                         PortSourceKind::Git,
-                         version_entry.git_tree));
-        auto scfl = load_result.maybe_scfl.get();
+        auto maybe_scfl = versions_dot_git_dir.then([&](const Path& dot_git_dir) {
+            return load_git_tree_port(paths, dot_git_dir, port_name, version_entry.git_tree, errors_sink);
+        });
+        auto scfl = maybe_scfl.get();
         if (!scfl)
         {
             success = false;
@@ -79,7 +151,7 @@ namespace
             errors_sink.println(Color::error,
                                 LocalizedString::from_raw(versions_file_path)
                                     .append_raw(": ")
-                                    .append(load_result.maybe_scfl.error())
+                                    .append(maybe_scfl.error())
                                     .append_raw('\n')
                                     .append_raw(NotePrefix)
                                     .append(msgWhileValidatingVersion, msg::version = version_entry.version.version));
@@ -127,12 +199,7 @@ namespace
 
         if (success)
         {
-            success_sink.println(LocalizedString::from_raw(versions_file_path)
-                                     .append_raw(": ")
-                                     .append_raw(MessagePrefix)
-                                     .append(msgVersionVerifiedOK,
-                                             msg::version_spec = VersionSpec{port_name, version_entry.version.version},
-                                             msg::git_tree_sha = version_entry.git_tree));
+            success_sink.println(format_git_tree_verified(versions_file_path, port_name, version_entry));
         }
 
         return success;
@@ -517,6 +584,149 @@ namespace vcpkg
         nullptr,
     };
 
+    std::string verified_git_tree_key(const std::string& port_name, const GitVersionDbEntry& version_entry)
+    {
+        return fmt::format("{} {} {} {}",
+                           port_name,
+                           version_entry.git_tree,
+                           get_scheme_name(version_entry.version.scheme),
+                           version_entry.version.version);
+    }
+
+    VerifiedGitTreesCache::VerifiedGitTreesCache(const ReadOnlyFilesystem& fs, Path cache_file)
+        : m_cache_file(std::move(cache_file))
+    {
+        std::error_code ec;
+        auto contents = fs.read_contents(m_cache_file, ec);
+        if (ec)
+        {
+            return;
+        }
+
+        auto maybe_doc = Json::parse_object(contents, m_cache_file);
+        auto doc = maybe_doc.get();
+        if (!doc)
+        {
+            return;
+        }
+
+        auto version = doc->get(JsonIdVersion);
+        auto vcpkg_version = doc->get(JsonIdVcpkgVersion);
+        auto verified = doc->get(JsonIdVerified);
+        if (!version || !version->is_integer() || version->integer(VCPKG_LINE_INFO) != verified_git_trees_version ||
+            !vcpkg_version || !vcpkg_version->is_string() ||
+            vcpkg_version->string(VCPKG_LINE_INFO) != VCPKG_BASE_VERSION_AS_STRING || !verified ||
+            !verified->is_array())
+        {
+            return;
+        }
+
+        for (auto&& key : verified->array(VCPKG_LINE_INFO))
+        {
+            if (key.is_string())
+            {
+                m_previously_verified.insert(key.string(VCPKG_LINE_INFO).to_string());
+            }
+        }
+    }
+
+    bool VerifiedGitTreesCache::was_verified(const std::string& key) const
+    {
+        return Util::Sets::contains(m_previously_verified, key);
+    }
+
+    void VerifiedGitTreesCache::save(const Filesystem& fs, const std::set<std::string>& verified) const
+    {
+        if (verified == m_previously_verified)
+        {
+            return;
+        }
+
+        Json::Array verified_array;
+        for (auto&& key : verified)
+        {
+            verified_array.push_back(Json::Value::string(key));
+        }
+
+        Json::Object doc;
+        doc.insert(JsonIdVersion, Json::Value::integer(verified_git_trees_version));
+        doc.insert(JsonIdVcpkgVersion, Json::Value::string(VCPKG_BASE_VERSION_AS_STRING));
+        doc.insert(JsonIdVerified, std::move(verified_array));
+
+        std::error_code ec;
+        const Path temp_path = fmt::format("{}.{}.tmp", m_cache_file.native(), get_process_id());
+        fs.write_contents_and_dirs(temp_path, Json::stringify(doc, Json::JsonStyle::with_spaces(0)), ec);
+        if (!ec)
+        {
+            fs.rename(temp_path, m_cache_file, ec);
+        }
+
+        if (ec)
+        {
+            fs.remove(temp_path, IgnoreErrors{});
+        }
+    }
+
+    bool verify_git_trees_in_parallel(const Filesystem& fs,
+                                      MessageSink& sink,
+                                      const VerifiedGitTreesCache& verified_cache,
+                                      View<GitTreeVerification> verifications,
+                                      bool verbose,
+                                      const GitTreeVerifier& verify)
+    {
+        // Collects the lines printed while verifying one version database entry, so that entries verified in
+        // parallel can be printed in order
+        struct VerificationResult
+        {
+            bool success = false;
+            std::vector<MessageLine> output;
+        };
+
+        std::vector<VerificationResult> results(verifications.size());
+        execute_in_parallel(verifications.size(), [&](size_t idx) {
+            auto& verification = verifications[idx];
+            auto& result = results[idx];
+            LineBufferSink output;
+            if (verified_cache.was_verified(verification.key))
+            {
+                result.success = true;
+                if (verbose)
+                {
+                    output.println(format_git_tree_verified(
+                        *verification.versions_file_path, *verification.port_name, *verification.version_entry));
+                }
+            }
+            else
+            {
+                result.success = verify(output, verbose ? static_cast<MessageSink&>(output) : null_sink, verification);
+            }
+
+            result.output = std::move(output.lines);
+        });
+
+        bool success = true;
+        std::set<std::string> verified;
+        for (size_t idx = 0; idx < verifications.size(); ++idx)
+        {
+            for (auto&& line : results[idx].output)
+            {
+                sink.println(std::move(line));
+            }
+
+            if (results[idx].success)
+            {
+                verified.insert(verifications[idx].key);
+            }
+            else
+            {
+                success = false;
+            }
+        }
+
+        verified_cache.save(fs, verified);
+        return success;
+    }
+
     void command_ci_verify_versions_and_exit(const VcpkgCmdArguments& args, const VcpkgPaths& paths)
     {
         auto parsed_args = args.parse_arguments(CommandCiVerifyVersionsMetadata);
@@ -564,6 +774,8 @@ namespace vcpkg
             }
         }
 
+        std::vector<GitTreeVerification> git_tree_verifications;
+
         // We run version database checks at the end in case any of the above created new cache entries
         for (auto&& versions_cache_entry : versions_database.cache())
         {
@@ -588,16 +800,40 @@ namespace vcpkg
             {
                 for (auto&& version_entry : *entries)
                 {
-                    success &= verify_git_tree(errors_sink,
-                                               success_sink,
-                                               paths,
-                                               port_name,
-                                               versions_cache_entry.second.versions_file_path,
-                                               version_entry);
+                    auto& verification = git_tree_verifications.emplace_back();
+                    verification.port_name = &port_name;
+                    verification.versions_file_path = &versions_cache_entry.second.versions_file_path;
+                    verification.version_entry = &version_entry;
+                    verification.key = verified_git_tree_key(port_name, version_entry);
                 }
             }
         }
 
+        if (verify_git_trees)
+        {
+            VerifiedGitTreesCache verified_cache(fs, paths.buildtrees() / FileVerifiedGitTreesDotJson);
+            auto versions_dot_git_dir = paths.versions_dot_git_dir();
+            // The tool cache is not safe to populate from several threads
+            paths.get_tool_path(null_diagnostic_context, Tools::GIT);
+            success &= verify_git_trees_in_parallel(
+                fs,
+                errors_sink,
+                verified_cache,
+                git_tree_verifications,
+                verbose,
+                [&](MessageSink& verify_errors_sink,
+                    MessageSink& verify_success_sink,
+                    const GitTreeVerification& verification) {
+                    return verify_git_tree(verify_errors_sink,
+                                           verify_success_sink,
+                                           paths,
+                                           versions_dot_git_dir,
+                                           *verification.port_name,
+                                           *verification.versions_file_path,
+                                           *verification.version_entry);
+                });
+        }
+
         if (!success)
         {
             Checks::exit_fail(VCPKG_LINE_INFO);
@@ -3,6 +3,7 @@
 #include <vcpkg/base/contractual-constants.h>
 #include <vcpkg/base/files.h>
 #include <vcpkg/base/hash.h>
+#include <vcpkg/base/message_sinks.h>
 #include <vcpkg/base/messages.h>
 #include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/path.h>
@@ -31,7 +32,10 @@
 #include <vcpkg/vcpkgpaths.h>
 #include <vcpkg/xunitwriter.h>
 
+#include <condition_variable>
 #include <iterator>
+#include <mutex>
+#include <set>
 
 namespace
 {
@@ -53,21 +57,11 @@ namespace
         InstalledFile& operator=(InstalledFile&&) = default;
     };
 
-    struct InstalledFilePathCompare
+    // Whether a file of a package directory describes the package rather than being installed
+    bool is_package_control_file(StringView filename)
     {
-        bool operator()(const std::string& lhs, const InstalledFile& rhs) const noexcept
-        {
-            return Strings::case_insensitive_ascii_less(lhs, rhs.file_path);
-        }
-        bool operator()(const InstalledFile& lhs, const std::string& rhs) const noexcept
-        {
-            return Strings::case_insensitive_ascii_less(lhs.file_path, rhs);
-        }
-        bool operator()(const InstalledFile& lhs, const InstalledFile& rhs) const noexcept
-        {
-            return Strings::case_insensitive_ascii_less(lhs.file_path, rhs.file_path);
-        }
-    };
+        return filename == FileControl || filename == FileVcpkgDotJson || filename == FileBuildInfo;
+    }
 
     static constexpr StringLiteral SYMLINK_STATUS = "symlink_status";
     static constexpr StringLiteral STATUS = "status";
@@ -136,10 +130,10 @@ namespace vcpkg
         {
             if (Util::any_of(manifest_core.default_features, [](const auto& f) { return !f.platform.is_empty(); }))
             {
-                const auto& vars = var_provider.get_or_load_dep_info_vars(toplevel, host_triplet);
+                const auto& identifiers = var_provider.get_or_load_dep_info_identifiers(toplevel, host_triplet);
                 for (const auto& f : manifest_core.default_features)
                 {
-                    if (f.platform.evaluate(vars)) features.push_back(f.name);
+                    if (f.platform.evaluate(identifiers)) features.push_back(f.name);
                 }
             }
             else
@@ -238,7 +232,7 @@ namespace vcpkg
                 switch (status)
                 {
                     case FileType::regular:
-                        if (filename == FileControl || filename == FileVcpkgDotJson || filename == FileBuildInfo)
+                        if (is_package_control_file(filename))
                         {
                             // Do not copy the control file or manifest file
                             status = FileType::none;
@@ -362,47 +356,135 @@ namespace vcpkg
         return result;
     }
 
-    static std::vector<InstalledFile> build_list_of_installed_files(
-        std::vector<StatusParagraphAndAssociatedFiles>&& pgh_and_files, Triplet triplet)
+    static std::vector<std::string> build_list_of_archive_files(const DeferredArchive& archive)
     {
-        const size_t installed_remove_char_count = triplet.canonical_name().size() + 1; // +1 for the slash
-        std::vector<InstalledFile> output;
-        for (StatusParagraphAndAssociatedFiles& t : pgh_and_files)
+        // Like the listing of a package directory, this includes every directory containing an entry
+        std::vector<std::string> result;
+        for (auto&& entry : archive.entries)
         {
-            if (t.pgh.package.spec.triplet() != triplet)
+            for (auto slash = entry.name.find('/'); slash != std::string::npos; slash = entry.name.find('/', slash + 1))
+            {
+                result.push_back(entry.name.substr(0, slash));
+            }
+
+            result.push_back(entry.name);
+        }
+
+        Util::sort_unique_erase(result);
+        return result;
+    }
+
+    // Installs the files of a package restored from the binary cache by extracting them directly from its archive,
+    // rather than linking or copying them from the package directory like install_files_and_write_listfile.
+    // Diagnostics are printed to `out`, the sink of the action being installed.
+    static void install_archive_and_write_listfile(const Filesystem& fs,
+                                                   const DeferredArchive& archive,
+                                                   const Path& destination_installed,
+                                                   StringView triplet_canonical_name,
+                                                   const Path& listfile,
+                                                   MessageSink& out)
+    {
+        PrintingDiagnosticContext context{out};
+        auto destination_triplet = destination_installed / triplet_canonical_name;
+        fs.create_directories(destination_triplet, VCPKG_LINE_INFO);
+        fs.create_directories(listfile.parent_path(), VCPKG_LINE_INFO);
+
+        std::string listfile_triplet_prefix;
+        listfile_triplet_prefix.reserve(triplet_canonical_name.size() + 1); // +1 for the slash
+        listfile_triplet_prefix.append(triplet_canonical_name.data(), triplet_canonical_name.size()).push_back('/');
+
+        std::vector<std::string> listfile_lines;
+        listfile_lines.push_back(listfile_triplet_prefix);
+
+        std::set<std::string> directories;
+        std::vector<Zip::Entry> entries;
+        for (auto&& entry : archive.entries)
+        {
+            for (auto slash = entry.name.find('/'); slash != std::string::npos; slash = entry.name.find('/', slash + 1))
+            {
+                directories.insert(entry.name.substr(0, slash));
+            }
+
+            if (entry.kind == Zip::EntryKind::Directory)
+            {
+                directories.insert(entry.name);
+                continue;
+            }
+
+            const auto filename = parse_filename(entry.name);
+            if (filename == FileDotDsStore ||
+                (entry.kind == Zip::EntryKind::RegularFile && is_package_control_file(filename)))
             {
                 continue;
             }
 
-            const std::string package_display_name = t.pgh.package.display_name();
-            for (std::string& file : t.files)
+            listfile_lines.push_back(listfile_triplet_prefix + entry.name);
+            entries.push_back(entry);
+        }
+
+        // Each directory is ordered before its subdirectories
+        std::error_code ec;
+        for (auto&& directory : directories)
+        {
+            auto target = destination_triplet / directory;
+            fs.create_directory(target, ec);
+            if (ec)
             {
-                file.erase(0, installed_remove_char_count);
-                output.emplace_back(std::move(file), package_display_name);
+                context.report_error(msgInstallFailed, msg::path = target, msg::error_msg = ec.message());
             }
+
+            // Trailing slash for directories
+            listfile_lines.push_back(fmt::format("{}{}/", listfile_triplet_prefix, directory));
         }
 
-        return output;
+        // Existing files are removed rather than overwritten, as they may be hard links to files in a package
+        // directory
+        std::mutex console_mutex;
+        execute_in_parallel(entries.size(), [&](size_t idx) {
+            const auto target = destination_triplet / entries[idx].name;
+            std::error_code remove_ec;
+            if (fs.remove(target, remove_ec) || remove_ec)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(console_mutex);
+                    context.report(
+                        DiagnosticLine{DiagKind::Warning, msg::format(msgOverwritingFile, msg::path = target)});
+                } // unlock
+
+                fs.remove_all(target, IgnoreErrors{});
+            }
+        });
+
+        // The listfile is written first so that the files of a partially extracted package can still be removed
+        std::sort(listfile_lines.begin(), listfile_lines.end());
+        fs.write_lines(listfile, listfile_lines, VCPKG_LINE_INFO);
+        if (!Zip::extract_entries(context, fs, archive.zip.path, entries, destination_triplet, get_concurrency()))
+        {
+            context.report(
+                DiagnosticLine{DiagKind::Note, archive.zip.path, msg::format(msgWhileExtractingThisArchive)});
+            Checks::exit_fail(VCPKG_LINE_INFO);
+        }
     }
 
-    static bool check_for_install_conflicts(const Filesystem& fs,
-                                            const std::vector<std::string>& package_files,
+    static bool check_for_install_conflicts(const std::vector<std::string>& package_files,
                                             const InstalledPaths& installed,
-                                            const StatusParagraphs& status_db,
-                                            const PackageSpec& spec)
+                                            const InstalledFileIndex& installed_file_index,
+                                            const PackageSpec& spec,
+                                            MessageSink& out)
     {
-        std::vector<InstalledFile> installed_files =
-            build_list_of_installed_files(get_installed_files_and_upgrade(fs, installed, status_db), spec.triplet());
+        const auto triplet_prefix = spec.triplet().canonical_name() + '/';
         std::vector<InstalledFile> intersection;
-
-        Util::sort(installed_files, InstalledFilePathCompare{});
-        assert(std::is_sorted(package_files.begin(), package_files.end(), Strings::case_insensitive_ascii_less));
-        std::set_intersection(installed_files.begin(),
-                              installed_files.end(),
-                              package_files.begin(),
-                              package_files.end(),
-                              std::back_inserter(intersection),
-                              InstalledFilePathCompare{});
+        std::string installed_file = triplet_prefix;
+        for (auto&& package_file : package_files)
+        {
+            installed_file.resize(triplet_prefix.size());
+            installed_file.append(package_file);
+            for (auto&& owner : installed_file_index.find(installed_file))
+            {
+                intersection.emplace_back(owner.file.substr(triplet_prefix.size()).to_string(),
+                                          owner.owner_display_name.to_string());
+            }
+        }
 
         if (intersection.empty())
         {
@@ -416,7 +498,11 @@ namespace vcpkg
             });
 
         const auto triplet_install_path = installed.triplet_dir(spec.triplet());
-        msg::println_error(msgConflictingFiles, msg::path = triplet_install_path.generic_u8string(), msg::spec = spec);
+        DiagnosticLine{DiagKind::Error,
+                       msg::format(msgConflictingFiles,
+                                   msg::path = triplet_install_path.generic_u8string(),
+                                   msg::spec = spec)}
+            .print_to(out);
 
         auto i = intersection.begin();
         while (i != intersection.end())
@@ -432,10 +518,9 @@ namespace vcpkg
                 this_conflict_list.emplace_back(LocalizedString::from_raw(std::move(i->file_path)));
             }
 
-            msg::print(msg::format(msgInstalledBy, msg::path = conflicting_display_name)
-                           .append_raw(':')
-                           .append_floating_list(1, this_conflict_list)
-                           .append_raw('\n'));
+            out.println(msg::format(msgInstalledBy, msg::path = conflicting_display_name)
+                            .append_raw(':')
+                            .append_floating_list(1, this_conflict_list));
         }
 
         return true;
@@ -443,15 +528,19 @@ namespace vcpkg
 
     static InstallResult install_package(const VcpkgPaths& paths,
                                          const Path& package_dir,
+                                         const DeferredArchive* deferred_archive,
                                          const BinaryControlFile& bcf,
-                                         StatusParagraphs& status_db)
+                                         StatusParagraphs& status_db,
+                                         InstalledFileIndex& installed_file_index,
+                                         MessageSink& out)
     {
         auto& fs = paths.get_filesystem();
         const auto& installed = paths.installed();
         const auto& bcf_core_paragraph = bcf.core_paragraph;
         const auto& bcf_spec = bcf_core_paragraph.spec;
-        auto package_files = build_list_of_package_files(fs, package_dir);
-        if (check_for_install_conflicts(fs, package_files, installed, status_db, bcf_spec))
+        auto package_files = deferred_archive ? build_list_of_archive_files(*deferred_archive)
+                                              : build_list_of_package_files(fs, package_dir);
+        if (check_for_install_conflicts(package_files, installed, installed_file_index, bcf_spec, out))
         {
             return InstallResult::FILE_CONFLICTS;
         }
@@ -474,13 +563,27 @@ namespace vcpkg
             status_db.insert(std::make_unique<StatusParagraph>(feature_paragraph));
         }
 
-        install_files_and_write_listfile(fs,
-                                         package_dir,
-                                         package_files,
-                                         installed.root(),
-                                         bcf_spec.triplet().canonical_name(),
-                                         installed.listfile_path(bcf_core_paragraph),
-                                         SymlinkHydrate::CopySymlinks);
+        if (deferred_archive)
+        {
+            install_archive_and_write_listfile(fs,
+                                               *deferred_archive,
+                                               installed.root(),
+                                               bcf_spec.triplet().canonical_name(),
+                                               installed.listfile_path(bcf_core_paragraph),
+                                               out);
+        }
+        else
+        {
+            install_files_and_write_listfile(fs,
+                                             package_dir,
+                                             package_files,
+                                             installed.root(),
+                                             bcf_spec.triplet().canonical_name(),
+                                             installed.listfile_path(bcf_core_paragraph),
+                                             SymlinkHydrate::CopySymlinks);
+        }
+
+        installed_file_index.add_package(fs, installed, bcf_core_paragraph);
 
         source_paragraph.status.state = InstallState::INSTALLED;
         database_write_update(fs, installed, source_paragraph);
@@ -517,21 +620,35 @@ namespace vcpkg
         }
     }
 
+    // The state shared by the actions of an install plan while their packages are built, possibly several at once.
+    // `mtx` serializes reading and modifying the installed tree: the status database, the installed file index, and
+    // the binary cache's knowledge of which packages were restored.
+    struct InstallPlanState
+    {
+        StatusParagraphs& status_db;
+        InstalledFileIndex& installed_file_index;
+        BinaryCache& binary_cache;
+        std::mutex mtx;
+    };
+
     static ExtendedBuildResult perform_install_plan_action_2(const VcpkgCmdArguments& args,
                                                              const VcpkgPaths& paths,
                                                              Triplet host_triplet,
                                                              const BuildPackageOptions& build_options,
                                                              const InstallPlanAction& action,
-                                                             StatusParagraphs& status_db,
-                                                             BinaryCache& binary_cache,
-                                                             const IBuildLogsRecorder& build_logs_recorder)
+                                                             InstallPlanState& state,
+                                                             const IBuildLogsRecorder& build_logs_recorder,
+                                                             MessageSink& out)
     {
         auto& fs = paths.get_filesystem();
+        std::unique_lock<std::mutex> lock(state.mtx);
 
         bool all_dependencies_satisfied;
         std::unique_ptr<BinaryControlFile> bcf;
-        if (binary_cache.is_restored(action))
+        const DeferredArchive* deferred_archive = nullptr;
+        if (state.binary_cache.is_restored(action))
         {
+            deferred_archive = state.binary_cache.deferred_archive(action);
             auto maybe_bcf = Paragraphs::try_load_cached_package(fs, action.package_dir, action.spec);
             bcf = std::make_unique<BinaryControlFile>(std::move(maybe_bcf).value_or_exit(VCPKG_LINE_INFO));
             all_dependencies_satisfied = true;
@@ -542,16 +659,31 @@ namespace vcpkg
         }
         else
         {
-            msg::println(action.use_head_version == UseHeadVersion::Yes ? msgBuildingFromHead : msgBuildingPackage,
-                         msg::spec = action.display_name());
+            out.println(action.use_head_version == UseHeadVersion::Yes ? msgBuildingFromHead : msgBuildingPackage,
+                        msg::spec = action.display_name());
 
-            auto result =
-                build_package(args, paths, host_triplet, build_options, action, build_logs_recorder, status_db);
+            auto maybe_result =
+                check_build_dependencies(build_options, action, state.status_db, all_dependencies_satisfied);
+            if (!maybe_result)
+            {
+                // Other packages are built and installed while this one builds
+                lock.unlock();
+                maybe_result = build_checked_package(args,
+                                                     paths,
+                                                     host_triplet,
+                                                     build_options,
+                                                     action,
+                                                     build_logs_recorder,
+                                                     all_dependencies_satisfied,
+                                                     out);
+                lock.lock();
+            }
 
+            auto& result = *maybe_result.get();
             if (BuildResult::Downloaded == result.code)
             {
-                msg::println(Color::success, msgDownloadedSources, msg::spec = action.display_name());
-                return result;
+                out.println(Color::success, msgDownloadedSources, msg::spec = action.display_name());
+                return std::move(result);
             }
 
             all_dependencies_satisfied = result.unmet_dependencies.empty();
@@ -559,11 +691,11 @@ namespace vcpkg
             {
                 for (auto&& msg : action.dependency_diagnostics)
                 {
-                    msg.print_to(out_sink);
+                    msg.print_to(out);
                 }
 
-                msg::println_error(create_error_message(result, action.spec));
-                return result;
+                DiagnosticLine{DiagKind::Error, create_error_message(result, action.spec)}.print_to(out);
+                return std::move(result);
             }
 
             bcf = std::move(result.binary_control_file);
@@ -573,14 +705,20 @@ namespace vcpkg
         BuildResult code;
         if (all_dependencies_satisfied)
         {
-            const auto install_result = install_package(paths, action.package_dir, *bcf, status_db);
+            const auto install_result = install_package(paths,
+                                                        action.package_dir,
+                                                        deferred_archive,
+                                                        *bcf,
+                                                        state.status_db,
+                                                        state.installed_file_index,
+                                                        out);
             switch (install_result)
             {
                 case InstallResult::SUCCESS: code = BuildResult::Succeeded; break;
                 case InstallResult::FILE_CONFLICTS: code = BuildResult::FileConflicts; break;
                 default: Checks::unreachable(VCPKG_LINE_INFO);
             }
-            binary_cache.push_success(build_options.clean_packages, action);
+            state.binary_cache.push_success(build_options.clean_packages, action);
         }
         else
         {
@@ -604,14 +742,14 @@ namespace vcpkg
                                                           Triplet host_triplet,
                                                           const BuildPackageOptions& build_options,
                                                           const InstallPlanAction& action,
-                                                          StatusParagraphs& status_db,
-                                                          BinaryCache& binary_cache,
-                                                          const IBuildLogsRecorder& build_logs_recorder)
+                                                          InstallPlanState& state,
+                                                          const IBuildLogsRecorder& build_logs_recorder,
+                                                          MessageSink& out)
     {
         const ElapsedTimer install_timer;
         const auto start_time = std::chrono::system_clock::now();
         auto build_result = perform_install_plan_action_2(
-            args, paths, host_triplet, build_options, action, status_db, binary_cache, build_logs_recorder);
+            args, paths, host_triplet, build_options, action, state, build_logs_recorder, out);
         const auto timing = install_timer.elapsed();
         const auto& abi_info = action.abi_info.value_or_exit(VCPKG_LINE_INFO);
         return InstallSpecSummary{std::move(build_result),
@@ -624,6 +762,109 @@ namespace vcpkg
                                   abi_info.compiler_info};
     }
 
+    static unsigned int get_max_concurrent_builds()
+    {
+        auto maybe_user_defined = get_environment_variable(EnvironmentVariableXVcpkgBuildConcurrency);
+        if (auto user_defined = maybe_user_defined.get())
+        {
+            auto maybe_builds = Strings::strto<int>(*user_defined);
+            auto builds = maybe_builds.get();
+            if (!builds || *builds <= 0)
+            {
+                Checks::msg_exit_with_message(VCPKG_LINE_INFO,
+                                              msgEnvInvalidMaxConcurrency,
+                                              msg::env_var = EnvironmentVariableXVcpkgBuildConcurrency,
+                                              msg::value = *user_defined);
+            }
+
+            return static_cast<unsigned int>(*builds);
+        }
+
+        return 1;
+    }
+
+    InstallPlanScheduler::InstallPlanScheduler(View<InstallPlanAction> actions)
+        : m_actions(actions), m_remaining_dependencies(actions.size()), m_dependents(actions.size())
+    {
+        std::map<PackageSpec, size_t> action_indexes;
+        for (size_t idx = 0; idx < actions.size(); ++idx)
+        {
+            action_indexes.emplace(actions[idx].spec, idx);
+        }
+
+        for (size_t idx = 0; idx < actions.size(); ++idx)
+        {
+            for (auto&& dependency : actions[idx].package_dependencies)
+            {
+                auto it = action_indexes.find(dependency);
+                // The plan is topologically sorted, so dependencies always come first
+                if (it != action_indexes.end() && it->second < idx)
+                {
+                    ++m_remaining_dependencies[idx];
+                    m_dependents[it->second].push_back(idx);
+                }
+            }
+
+            if (m_remaining_dependencies[idx] == 0)
+            {
+                m_ready.insert(m_ready.end(), idx);
+            }
+        }
+    }
+
+    Optional<size_t> InstallPlanScheduler::start_next()
+    {
+        if (m_stopped)
+        {
+            return nullopt;
+        }
+
+        while (!m_ready.empty())
+        {
+            const auto idx = *m_ready.begin();
+            m_ready.erase(m_ready.begin());
+            auto running_port = m_running_ports.emplace(m_actions[idx].spec.name(), std::vector<size_t>{});
+            if (!running_port.second)
+            {
+                // Another action of the same port is running; this one becomes ready again when that one finishes
+                running_port.first->second.push_back(idx);
+                continue;
+            }
+
+            ++m_started;
+            ++m_running;
+            return idx;
+        }
+
+        return nullopt;
+    }
+
+    void InstallPlanScheduler::finish(size_t idx)
+    {
+        --m_running;
+        auto running_port = m_running_ports.find(m_actions[idx].spec.name());
+        if (running_port != m_running_ports.end())
+        {
+            m_ready.insert(running_port->second.begin(), running_port->second.end());
+            m_running_ports.erase(running_port);
+        }
+
+        for (auto dependent : m_dependents[idx])
+        {
+            if (--m_remaining_dependencies[dependent] == 0)
+            {
+                m_ready.insert(dependent);
+            }
+        }
+    }
+
+    void InstallPlanScheduler::stop() { m_stopped = true; }
+
+    bool InstallPlanScheduler::done() const
+    {
+        return (m_stopped || m_started == m_actions.size()) && m_running == 0;
+    }
+
     template<typename SummaryType>
     static void format_results_block(std::map<Triplet, BuildResultCounts>& summary_counts,
                                      std::string& to_print,
@@ -753,22 +994,114 @@ namespace vcpkg
                                                            nullptr);
         }
 
-        for (auto&& action : action_plan.install_actions)
+        // Loaded after the removals above, which delete the listfiles of the removed packages
+        auto installed_file_index = InstalledFileIndex::load(fs, paths.installed(), status_db);
+        InstallPlanState state{status_db, installed_file_index, binary_cache};
+        const auto& install_actions = action_plan.install_actions;
+        BuildPackageOptions scheduled_build_options = build_options;
+        // Removing the downloads after each package would remove those of packages that are still being built
+        if (build_options.clean_downloads == CleanDownloads::No)
         {
-            binary_cache.print_updates();
-            const auto action_display_name = action.display_name();
-            msg::println(msgInstallingPackage,
-                         msg::action_index = action_index,
-                         msg::count = action_count,
-                         msg::spec = action_display_name);
-            ++action_index;
-            if (auto package_abi = action.package_abi())
+            scheduled_build_options.concurrent_builds = static_cast<unsigned int>(
+                (std::max)(size_t{1}, (std::min)(size_t{get_max_concurrent_builds()}, install_actions.size())));
+        }
+
+        // Each build's console output is printed all at once when it finishes, unless only one is built at a time.
+        // Everything below is guarded by state.mtx.
+        const bool buffer_build_output = scheduled_build_options.concurrent_builds != 1;
+        InstallPlanScheduler scheduler(install_actions);
+        std::condition_variable scheduler_cv;
+        std::vector<Optional<InstallSpecSummary>> results(install_actions.size());
+        Optional<size_t> stopping_failure;
+        execute_in_parallel(scheduled_build_options.concurrent_builds, [&](size_t) {
+            std::unique_lock<std::mutex> lock(state.mtx);
+            for (;;)
             {
-                msg::println(msgPackageAbi, msg::spec = action_display_name, msg::package_abi = *package_abi);
+                Optional<size_t> next;
+                scheduler_cv.wait(lock,
+                                  [&] { return scheduler.done() || (next = scheduler.start_next()).has_value(); });
+                const auto idx = next.get();
+                if (!idx)
+                {
+                    return;
+                }
+
+                auto& action = install_actions[*idx];
+                binary_cache.print_updates();
+                const auto action_display_name = action.display_name();
+                msg::println(msgInstallingPackage,
+                             msg::action_index = action_index,
+                             msg::count = action_count,
+                             msg::spec = action_display_name);
+                ++action_index;
+                if (auto package_abi = action.package_abi())
+                {
+                    msg::println(msgPackageAbi, msg::spec = action_display_name, msg::package_abi = *package_abi);
+                }
+
+                lock.unlock();
+                LineBufferSink build_output;
+                auto result = perform_install_plan_action(args,
+                                                          paths,
+                                                          host_triplet,
+                                                          scheduled_build_options,
+                                                          action,
+                                                          state,
+                                                          build_logs_recorder,
+                                                          buffer_build_output ? build_output : out_sink);
+                lock.lock();
+                for (auto&& line : build_output.lines)
+                {
+                    out_sink.println(std::move(line));
+                }
+
+                if (result.build_result.code != BuildResult::Succeeded && build_options.keep_going == KeepGoing::No)
+                {
+                    if (!stopping_failure)
+                    {
+                        stopping_failure = *idx;
+                    }
+
+                    scheduler.stop();
+                }
+                else
+                {
+                    msg::println(msgElapsedForPackage, msg::spec = action.spec, msg::elapsed = result.timing);
+                }
+
+                results[*idx].emplace(std::move(result));
+                scheduler.finish(*idx);
+                scheduler_cv.notify_all();
             }
+        });
 
-            auto& result = summary.install_results.emplace_back(perform_install_plan_action(
-                args, paths, host_triplet, build_options, action, status_db, binary_cache, build_logs_recorder));
+        if (auto failure_index = stopping_failure.get())
+        {
+            auto& action = install_actions[*failure_index];
+            auto& result = *results[*failure_index].get();
+            msg::println(msgElapsedForPackage, msg::spec = action.spec, msg::elapsed = result.timing);
+            print_user_troubleshooting_message(
+                action,
+                args.detected_ci(),
+                paths,
+                result.build_result.error_logs,
+                result.build_result.stdoutlog.then([&](auto&) -> Optional<Path> {
+                    auto issue_body_path = paths.installed().issue_body_path();
+                    paths.get_filesystem().write_contents(
+                        issue_body_path,
+                        create_github_issue(args, paths, result, include_manifest_in_github_issue),
+                        VCPKG_LINE_INFO);
+                    return issue_body_path;
+                }));
+            installed_file_index.save(fs, paths.installed());
+            binary_cache.wait_for_async_complete_and_join();
+            Checks::exit_fail(VCPKG_LINE_INFO);
+        }
+
+        for (size_t idx = 0; idx < install_actions.size(); ++idx)
+        {
+            auto& action = install_actions[idx];
+            auto& result = summary.install_results.emplace_back(std::move(*results[idx].get()));
             if (result.build_result.code == BuildResult::Succeeded)
             {
                 const auto& scfl = action.source_control_file_and_location();
@@ -802,25 +1135,6 @@ namespace vcpkg
                     }
                 }
             }
-            else if (build_options.keep_going == KeepGoing::No)
-            {
-                msg::println(msgElapsedForPackage, msg::spec = action.spec, msg::elapsed = result.timing);
-                print_user_troubleshooting_message(
-                    action,
-                    args.detected_ci(),
-                    paths,
-                    result.build_result.error_logs,
-                    result.build_result.stdoutlog.then([&](auto&) -> Optional<Path> {
-                        auto issue_body_path = paths.installed().issue_body_path();
-                        paths.get_filesystem().write_contents(
-                            issue_body_path,
-                            create_github_issue(args, paths, result, include_manifest_in_github_issue),
-                            VCPKG_LINE_INFO);
-                        return issue_body_path;
-                    }));
-                binary_cache.wait_for_async_complete_and_join();
-                Checks::exit_fail(VCPKG_LINE_INFO);
-            }
 
             switch (result.build_result.code)
             {
@@ -842,10 +1156,9 @@ namespace vcpkg
                 case BuildResult::CacheMissing: summary.failed = true; break;
                 default: Checks::unreachable(VCPKG_LINE_INFO);
             }
-
-            msg::println(msgElapsedForPackage, msg::spec = action.spec, msg::elapsed = result.timing);
         }
 
+        installed_file_index.save(fs, paths.installed());
         database_sync(fs, paths.installed(), installed_lock);
         summary.elapsed = timer.elapsed();
         return summary;
@@ -10,24 +10,19 @@ using namespace vcpkg;
 
 namespace
 {
-    void search_file(const ReadOnlyFilesystem& fs,
+    void search_file(const Filesystem& fs,
                      const InstalledPaths& installed,
-                     const std::string& file_substr,
+                     const std::string& file_prefix,
                      const StatusParagraphs& status_db)
     {
-        const auto installed_files = get_installed_files(fs, installed, status_db);
-        for (auto&& pgh_and_file : installed_files)
+        auto installed_file_index = InstalledFileIndex::load(fs, installed, status_db);
+        for (auto&& file_and_owner : installed_file_index.find_prefix(file_prefix))
         {
-            const StatusParagraph& pgh = pgh_and_file.pgh;
-
-            for (const std::string& file : pgh_and_file.files)
-            {
-                if (file.find(file_substr) != std::string::npos)
-                {
-                    msg::write_unlocalized_text(Color::none, fmt::format("{}: {}\n", pgh.package.display_name(), file));
-                }
-            }
+            msg::write_unlocalized_text(
+                Color::none, fmt::format("{}: {}\n", file_and_owner.owner_display_name, file_and_owner.file));
         }
+
+        installed_file_index.save(fs, installed);
     }
 } // unnamed namespace
 
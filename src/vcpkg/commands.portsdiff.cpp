@@ -1,4 +1,5 @@
 #include <vcpkg/base/files.h>
+#include <vcpkg/base/git-objects.h>
 #include <vcpkg/base/git.h>
 #include <vcpkg/base/system.process.h>
 #include <vcpkg/base/util.h>
@@ -48,12 +49,13 @@ namespace
         }
 
         const auto temp_checkout_path = paths.buildtrees() / temp_name;
-        if (!git_extract_tree(context,
-                              fs,
-                              git_exe,
-                              GitRepoLocator{GitRepoLocatorKind::CurrentDirectory, builtin_ports_directory},
-                              temp_checkout_path,
-                              fmt::format("{}:{}", git_commit_id, *builtin_ports_prefix)))
+        const auto locator = GitRepoLocator{GitRepoLocatorKind::CurrentDirectory, builtin_ports_directory};
+        const auto treeish = fmt::format("{}:{}", git_commit_id, *builtin_ports_prefix);
+        auto maybe_git_dir = git_absolute_git_dir(null_diagnostic_context, fs, git_exe, locator);
+        auto git_dir = maybe_git_dir.get();
+        auto objects = git_dir ? paths.get_git_object_database(*git_dir) : nullptr;
+        if ((!objects || !objects->extract_tree(fs, treeish, temp_checkout_path)) &&
+            !git_extract_tree(context, fs, git_exe, locator, temp_checkout_path, treeish))
         {
             return nullopt;
         }
@@ -628,8 +628,9 @@ namespace vcpkg
 
             if (expected_overall_state == CiFeatureBaselineState::Skip) continue;
             PackageSpec package_spec(port->core_paragraph->name, target_triplet);
-            const auto dep_info_vars = var_provider.get_or_load_dep_info_vars(package_spec, host_triplet);
-            if (!port->core_paragraph->supports_expression.evaluate(dep_info_vars))
+            const auto& dep_info_identifiers =
+                var_provider.get_or_load_dep_info_identifiers(package_spec, host_triplet);
+            if (!port->core_paragraph->supports_expression.evaluate(dep_info_identifiers))
             {
                 msg::println(
                     msgPortNotSupported, msg::package_name = port->core_paragraph->name, msg::triplet = target_triplet);
@@ -654,7 +655,7 @@ namespace vcpkg
             InternalFeatureSet combined_features{{FeatureNameCore.to_string()}};
             for (const auto& feature : port->feature_paragraphs)
             {
-                if (!feature->supports_expression.evaluate(dep_info_vars))
+                if (!feature->supports_expression.evaluate(dep_info_identifiers))
                 {
                     // skip unsupported features
                     continue;
@@ -105,12 +105,12 @@ namespace vcpkg
                         if (Util::any_of(scfl.source_control_file->core_paragraph->default_features,
                                          [](const auto& feature) { return !feature.platform.is_empty(); }))
                         {
-                            if (const auto* vars = var_provider.get_dep_info_vars(m_spec))
+                            if (const auto* identifiers = var_provider.get_dep_info_identifiers(m_spec))
                             {
                                 info.defaults_requested = true;
                                 for (auto&& f : scfl.source_control_file->core_paragraph->default_features)
                                 {
-                                    if (f.platform.evaluate(*vars))
+                                    if (f.platform.evaluate(*identifiers))
                                     {
                                         info.default_features.push_back(f.name);
                                     }
@@ -164,7 +164,7 @@ namespace vcpkg
                     // This feature has already been completely handled
                     return;
                 }
-                const auto* maybe_vars = var_provider.get_dep_info_vars(m_spec);
+                const auto* maybe_identifiers = var_provider.get_dep_info_identifiers(m_spec);
                 const std::vector<Dependency>* qualified_deps =
                     scfl.source_control_file->find_dependencies_for_feature(feature);
                 if (!qualified_deps)
@@ -176,18 +176,18 @@ namespace vcpkg
                 }
 
                 std::vector<FeatureSpec> dep_list;
-                if (maybe_vars)
+                if (maybe_identifiers)
                 {
                     // Qualified dependency resolution is available
                     for (auto&& dep : *qualified_deps)
                     {
-                        if (dep.platform.evaluate(*maybe_vars))
+                        if (dep.platform.evaluate(*maybe_identifiers))
                         {
                             std::vector<std::string> features;
                             features.reserve(dep.features.size());
                             for (const auto& f : dep.features)
                             {
-                                if (f.platform.evaluate(*maybe_vars))
+                                if (f.platform.evaluate(*maybe_identifiers))
                                 {
                                     features.push_back(f.name);
                                 }
@@ -892,9 +892,9 @@ namespace vcpkg
                     auto supports_expression = clust.get_applicable_supports_expression(spec);
                     if (supports_expression && !supports_expression->is_empty())
                     {
-                        const auto* dep_info_vars = m_var_provider.get_dep_info_vars(spec.spec());
-                        Checks::check_exit(VCPKG_LINE_INFO, dep_info_vars != nullptr);
-                        if (!supports_expression->evaluate(*dep_info_vars))
+                        const auto* dep_info_identifiers = m_var_provider.get_dep_info_identifiers(spec.spec());
+                        Checks::check_exit(VCPKG_LINE_INFO, dep_info_identifiers != nullptr);
+                        if (!supports_expression->evaluate(*dep_info_identifiers))
                         {
                             const auto supports_expression_text = to_string(*supports_expression);
                             if (unsupported_port_action == UnsupportedPortAction::Error)
@@ -1476,7 +1476,7 @@ namespace vcpkg
             void require_port_defaults(PackageNode& ref, const std::string& origin);
 
             void resolve_stack(const ConstraintFrame& frame);
-            const CMakeVars::CMakeVars& batch_load_vars(const ConstraintFrame& frame);
+            const PlatformExpression::ContextIdentifiers& batch_load_identifiers(const ConstraintFrame& frame);
 
             const PackageNode* find_package(const PackageSpec& spec) const;
 
@@ -1496,10 +1496,11 @@ namespace vcpkg
             std::vector<LocalizedString> m_errors;
         };
 
-        const CMakeVars::CMakeVars& VersionedPackageGraph::batch_load_vars(const ConstraintFrame& frame)
+        const PlatformExpression::ContextIdentifiers& VersionedPackageGraph::batch_load_identifiers(
+            const ConstraintFrame& frame)
         {
-            auto vars = m_var_provider.get_dep_info_vars(frame.spec);
-            if (!vars)
+            auto identifiers = m_var_provider.get_dep_info_identifiers(frame.spec);
+            if (!identifiers)
             {
                 // We want to batch as many dep_infos as possible, so look ahead in the frame and stack
                 std::unordered_set<PackageSpec> spec_set = {frame.spec};
@@ -1519,19 +1520,19 @@ namespace vcpkg
 
                 std::vector<PackageSpec> spec_vec(spec_set.begin(), spec_set.end());
                 m_var_provider.load_dep_info_vars(spec_vec, m_host_triplet);
-                vars = m_var_provider.get_dep_info_vars(frame.spec);
-                Checks::check_exit(VCPKG_LINE_INFO, vars != nullptr);
-                return *vars;
+                identifiers = m_var_provider.get_dep_info_identifiers(frame.spec);
+                Checks::check_exit(VCPKG_LINE_INFO, identifiers != nullptr);
+                return *identifiers;
             }
-            return *vars;
+            return *identifiers;
         }
 
         void VersionedPackageGraph::resolve_stack(const ConstraintFrame& frame)
         {
             for (auto&& dep : frame.deps)
             {
-                // duplicate is_empty check avoids possibly needless batch_load_vars call
-                if (!dep.platform.is_empty() && !dep.platform.evaluate(batch_load_vars(frame))) continue;
+                // duplicate is_empty check avoids possibly needless batch_load_identifiers call
+                if (!dep.platform.is_empty() && !dep.platform.evaluate(batch_load_identifiers(frame))) continue;
 
                 PackageSpec dep_spec(dep.name, dep.host ? m_host_triplet : frame.spec.triplet());
                 auto node = require_package(dep_spec, frame.spec.name());
@@ -1738,7 +1739,7 @@ namespace vcpkg
                 return true;
             }
 
-            return platform_expr.evaluate(m_var_provider.get_or_load_dep_info_vars(spec, m_host_triplet));
+            return platform_expr.evaluate(m_var_provider.get_or_load_dep_info_identifiers(spec, m_host_triplet));
         }
 
         void VersionedPackageGraph::add_override(const std::string& name, const Version& v)
@@ -1940,12 +1941,13 @@ namespace vcpkg
                 if (p.second)
                 {
                     // Newly inserted -> Add stack frame
-                    auto maybe_vars = m_var_provider.get_or_load_dep_info_vars(p.first->first, m_host_triplet);
+                    const auto& identifiers =
+                        m_var_provider.get_or_load_dep_info_identifiers(p.first->first, m_host_triplet);
 
                     std::vector<std::string> default_features;
                     for (const auto& feature : node->second.scfl->source_control_file->core_paragraph->default_features)
                     {
-                        if (feature.platform.evaluate(maybe_vars))
+                        if (feature.platform.evaluate(identifiers))
                         {
                             default_features.push_back(feature.name);
                         }
@@ -2028,10 +2030,10 @@ namespace vcpkg
             for (auto&& action : ret.install_actions)
             {
                 const auto& scfl = action.source_control_file_and_location();
-                const auto& vars = m_var_provider.get_or_load_dep_info_vars(action.spec, m_host_triplet);
+                const auto& identifiers = m_var_provider.get_or_load_dep_info_identifiers(action.spec, m_host_triplet);
                 // Evaluate core supports condition
                 const auto& supports_expr = scfl.source_control_file->core_paragraph->supports_expression;
-                if (!supports_expr.evaluate(vars))
+                if (!supports_expr.evaluate(identifiers))
                 {
                     ret.unsupported_features.emplace(std::piecewise_construct,
                                                      std::forward_as_tuple(action.spec, FeatureNameCore),
@@ -2045,7 +2047,7 @@ namespace vcpkg
 
                     const auto* fpgh = scfl.source_control_file->find_feature(fdeps.first);
                     Checks::check_exit(VCPKG_LINE_INFO, fpgh != nullptr);
-                    if (!fpgh->supports_expression.evaluate(vars))
+                    if (!fpgh->supports_expression.evaluate(identifiers))
                     {
                         ret.unsupported_features.emplace(std::piecewise_construct,
                                                          std::forward_as_tuple(action.spec, fdeps.first),
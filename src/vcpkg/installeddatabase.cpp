@@ -8,6 +8,8 @@
 #include <vcpkg/paragraphs.h>
 #include <vcpkg/statusparagraphs.h>
 
+#include <algorithm>
+
 namespace vcpkg
 {
     static StatusParagraphs load_current_database(const ReadOnlyFilesystem& fs, const Path& vcpkg_dir_status_file)
@@ -24,9 +26,394 @@ namespace vcpkg
         return StatusParagraphs(std::move(status_pghs));
     }
 
+    // The status snapshot is the header followed by one or more segments. Each segment is its payload size, a
+    // checksum of its payload, and the payload: the metadata of the status file that the snapshot describes once
+    // this segment is applied, then a count of status paragraphs and the paragraphs themselves. The paragraphs of
+    // the first segment are the contents of the status file; later segments are appended by database_sync and
+    // their paragraphs are applied with StatusParagraphs::insert, just like update records.
+    // All integers are 64-bit little endian.
+    static constexpr StringLiteral StatusSnapshotHeader = "vcpkg-status-snapshot 1\n";
+
+    // A snapshot with more segments than this, or whose later segments hold more paragraphs than its first, is
+    // rewritten rather than appended to.
+    static constexpr size_t StatusSnapshotMaxSegments = 16;
+
+    struct StatusSnapshotState
+    {
+        bool valid = false;
+        size_t segments = 0;
+        size_t base_paragraphs = 0;
+        size_t appended_paragraphs = 0;
+    };
+
+    static std::uint64_t status_snapshot_checksum(StringView payload) noexcept
+    {
+        // FNV-1a; this only needs to detect torn or corrupted writes
+        std::uint64_t result = 0xcbf29ce484222325ull;
+        for (unsigned char c : payload)
+        {
+            result = (result ^ c) * 0x100000001b3ull;
+        }
+
+        return result;
+    }
+
+    static void append_snapshot_integer(std::string& out, std::uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    static void append_snapshot_string(std::string& out, StringView value)
+    {
+        append_snapshot_integer(out, value.size());
+        out.append(value.data(), value.size());
+    }
+
+    static void append_snapshot_strings(std::string& out, const std::vector<std::string>& values)
+    {
+        append_snapshot_integer(out, values.size());
+        for (auto&& value : values)
+        {
+            append_snapshot_string(out, value);
+        }
+    }
+
+    static void append_snapshot_paragraph(std::string& out, const StatusParagraph& pgh)
+    {
+        const auto& package = pgh.package;
+        append_snapshot_string(out, package.spec.name());
+        append_snapshot_string(out, package.spec.triplet().canonical_name());
+        append_snapshot_string(out, package.version.text);
+        append_snapshot_integer(out, static_cast<std::uint64_t>(package.version.port_version));
+        append_snapshot_string(out, package.feature);
+        append_snapshot_strings(out, package.description);
+        append_snapshot_strings(out, package.maintainers);
+        append_snapshot_strings(out, package.default_features);
+        append_snapshot_integer(out, package.dependencies.size());
+        for (auto&& dependency : package.dependencies)
+        {
+            append_snapshot_string(out, dependency.name());
+            append_snapshot_string(out, dependency.triplet().canonical_name());
+        }
+
+        append_snapshot_string(out, package.abi);
+        append_snapshot_integer(out, static_cast<std::uint64_t>(pgh.status.want));
+        append_snapshot_integer(out, static_cast<std::uint64_t>(pgh.status.state));
+    }
+
+    static void append_snapshot_segment(std::string& out,
+                                        const FileMetadata& status_metadata,
+                                        const std::vector<const StatusParagraph*>& pghs)
+    {
+        std::string payload;
+        append_snapshot_integer(payload, status_metadata.size);
+        append_snapshot_integer(payload, static_cast<std::uint64_t>(status_metadata.last_write_time));
+        append_snapshot_integer(payload, status_metadata.inode);
+        append_snapshot_integer(payload, pghs.size());
+        for (auto pgh : pghs)
+        {
+            append_snapshot_paragraph(payload, *pgh);
+        }
+
+        append_snapshot_integer(out, payload.size());
+        append_snapshot_integer(out, status_snapshot_checksum(payload));
+        out.append(payload);
+    }
+
+    namespace
+    {
+        struct StatusSnapshotReader
+        {
+            explicit StatusSnapshotReader(StringView data) : m_data(data) { }
+
+            bool at_end() const noexcept { return m_data.empty(); }
+
+            bool read_integer(std::uint64_t& value) noexcept
+            {
+                if (m_data.size() < 8)
+                {
+                    return false;
+                }
+
+                value = 0;
+                for (int i = 0; i < 8; ++i)
+                {
+                    value |= static_cast<std::uint64_t>(static_cast<unsigned char>(m_data[i])) << (8 * i);
+                }
+
+                m_data = m_data.substr(8);
+                return true;
+            }
+
+            bool read_bytes(std::uint64_t size, StringView& value) noexcept
+            {
+                if (m_data.size() < size)
+                {
+                    return false;
+                }
+
+                value = m_data.substr(0, static_cast<size_t>(size));
+                m_data = m_data.substr(static_cast<size_t>(size));
+                return true;
+            }
+
+            bool read_string(std::string& value)
+            {
+                std::uint64_t size;
+                StringView bytes;
+                if (!read_integer(size) || !read_bytes(size, bytes))
+                {
+                    return false;
+                }
+
+                value.assign(bytes.data(), bytes.size());
+                return true;
+            }
+
+            bool read_strings(std::vector<std::string>& values)
+            {
+                std::uint64_t count;
+                if (!read_integer(count) || count > m_data.size())
+                {
+                    return false;
+                }
+
+                values.resize(static_cast<size_t>(count));
+                for (auto&& value : values)
+                {
+                    if (!read_string(value))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            std::unique_ptr<StatusParagraph> read_paragraph()
+            {
+                auto pgh = std::make_unique<StatusParagraph>();
+                auto& package = pgh->package;
+                std::string name;
+                std::string triplet;
+                std::uint64_t port_version;
+                std::uint64_t dependency_count;
+                if (!read_string(name) || !read_string(triplet) || !read_string(package.version.text) ||
+                    !read_integer(port_version) || !read_string(package.feature) ||
+                    !read_strings(package.description) || !read_strings(package.maintainers) ||
+                    !read_strings(package.default_features) || !read_integer(dependency_count) ||
+                    dependency_count > m_data.size())
+                {
+                    return nullptr;
+                }
+
+                package.spec = PackageSpec{std::move(name), Triplet::from_canonical_name(triplet)};
+                package.version.port_version = static_cast<int>(port_version);
+                package.dependencies.reserve(static_cast<size_t>(dependency_count));
+                for (std::uint64_t i = 0; i < dependency_count; ++i)
+                {
+                    if (!read_string(name) || !read_string(triplet))
+                    {
+                        return nullptr;
+                    }
+
+                    package.dependencies.emplace_back(std::move(name), Triplet::from_canonical_name(triplet));
+                }
+
+                std::uint64_t want;
+                std::uint64_t state;
+                if (!read_string(package.abi) || !read_integer(want) || !read_integer(state) ||
+                    want > static_cast<std::uint64_t>(Want::PURGE) ||
+                    state > static_cast<std::uint64_t>(InstallState::INSTALLED))
+                {
+                    return nullptr;
+                }
+
+                pgh->status.want = static_cast<Want>(want);
+                pgh->status.state = static_cast<InstallState>(state);
+                return pgh;
+            }
+
+        private:
+            StringView m_data;
+        };
+    }
+
+    // Loads the status snapshot if it describes the status file as it is now.
+    static Optional<StatusParagraphs> load_status_snapshot(const ReadOnlyFilesystem& fs,
+                                                           const InstalledPaths& installed,
+                                                           StatusSnapshotState& state)
+    {
+        std::error_code ec;
+        const auto status_metadata = fs.file_metadata(installed.vcpkg_dir_status_file(), ec);
+        if (ec)
+        {
+            return nullopt;
+        }
+
+        const auto contents = fs.read_contents(installed.vcpkg_dir_status_snapshot_file(), ec);
+        if (ec || !StringView{contents}.starts_with(StatusSnapshotHeader))
+        {
+            return nullopt;
+        }
+
+        StatusParagraphs status_db;
+        StatusSnapshotState loaded;
+        FileMetadata described;
+        StatusSnapshotReader segments{StringView{contents}.substr(StatusSnapshotHeader.size())};
+        while (!segments.at_end())
+        {
+            std::uint64_t payload_size;
+            std::uint64_t checksum;
+            StringView payload;
+            if (!segments.read_integer(payload_size) || !segments.read_integer(checksum) ||
+                !segments.read_bytes(payload_size, payload) || status_snapshot_checksum(payload) != checksum)
+            {
+                return nullopt;
+            }
+
+            StatusSnapshotReader reader{payload};
+            std::uint64_t last_write_time;
+            std::uint64_t count;
+            if (!reader.read_integer(described.size) || !reader.read_integer(last_write_time) ||
+                !reader.read_integer(described.inode) || !reader.read_integer(count) || count > payload.size())
+            {
+                return nullopt;
+            }
+
+            described.last_write_time = static_cast<int64_t>(last_write_time);
+            std::vector<std::unique_ptr<StatusParagraph>> pghs;
+            pghs.reserve(static_cast<size_t>(count));
+            for (std::uint64_t i = 0; i < count; ++i)
+            {
+                auto pgh = reader.read_paragraph();
+                if (!pgh)
+                {
+                    return nullopt;
+                }
+
+                pghs.push_back(std::move(pgh));
+            }
+
+            if (!reader.at_end())
+            {
+                return nullopt;
+            }
+
+            if (loaded.segments == 0)
+            {
+                loaded.base_paragraphs = pghs.size();
+                status_db = StatusParagraphs(std::move(pghs));
+            }
+            else
+            {
+                loaded.appended_paragraphs += pghs.size();
+                for (auto&& pgh : pghs)
+                {
+                    status_db.insert(std::move(pgh));
+                }
+            }
+
+            ++loaded.segments;
+        }
+
+        if (loaded.segments == 0 || described.size != status_metadata.size ||
+            described.last_write_time != status_metadata.last_write_time || described.inode != status_metadata.inode)
+        {
+            return nullopt;
+        }
+
+        loaded.valid = true;
+        state = loaded;
+        return status_db;
+    }
+
+    // Writing the snapshot is best effort; if it fails, the next load parses the status file instead.
+    static void write_status_snapshot(const Filesystem& fs,
+                                      const InstalledPaths& installed,
+                                      const StatusParagraphs& status_db)
+    {
+        std::error_code ec;
+        const auto status_metadata = fs.file_metadata(installed.vcpkg_dir_status_file(), ec);
+        if (ec)
+        {
+            return;
+        }
+
+        // StatusParagraphs iterates newest first, but the snapshot stores paragraphs in status file order
+        std::vector<const StatusParagraph*> pghs;
+        for (auto&& pgh : status_db)
+        {
+            pghs.push_back(pgh.get());
+        }
+
+        std::reverse(pghs.begin(), pghs.end());
+        std::string contents(StatusSnapshotHeader.data(), StatusSnapshotHeader.size());
+        append_snapshot_segment(contents, status_metadata, pghs);
+        const auto snapshot_file = installed.vcpkg_dir_status_snapshot_file();
+        const auto snapshot_file_new = installed.vcpkg_dir() / FileStatusSnapshotNew;
+        fs.write_contents(snapshot_file_new, contents, ec);
+        if (!ec)
+        {
+            fs.rename(snapshot_file_new, snapshot_file, ec);
+        }
+
+        if (ec)
+        {
+            fs.remove(snapshot_file_new, IgnoreErrors{});
+        }
+    }
+
+    static void append_status_snapshot(const Filesystem& fs,
+                                       const InstalledPaths& installed,
+                                       const std::vector<const StatusParagraph*>& pghs)
+    {
+        std::error_code ec;
+        const auto status_metadata = fs.file_metadata(installed.vcpkg_dir_status_file(), ec);
+        if (ec)
+        {
+            return;
+        }
+
+        std::string segment;
+        append_snapshot_segment(segment, status_metadata, pghs);
+        const auto snapshot_file = installed.vcpkg_dir_status_snapshot_file();
+        auto f = fs.open_for_write(snapshot_file, Append::YES, ec);
+        if (!ec && f.write(segment.data(), 1, segment.size()) != segment.size())
+        {
+            // A partially written segment fails its checksum, so the snapshot would be ignored anyway
+            f.close();
+            fs.remove(snapshot_file, IgnoreErrors{});
+        }
+    }
+
+    static StatusParagraphs load_current_database(const ReadOnlyFilesystem& fs,
+                                                  const InstalledPaths& installed,
+                                                  StatusSnapshotState& snapshot_state)
+    {
+        const auto status_file = installed.vcpkg_dir_status_file();
+        if (!fs.exists(status_file, IgnoreErrors{}))
+        {
+            // no status file, use empty db
+            return StatusParagraphs{};
+        }
+
+        auto maybe_snapshot = load_status_snapshot(fs, installed, snapshot_state);
+        if (auto snapshot = maybe_snapshot.get())
+        {
+            return std::move(*snapshot);
+        }
+
+        return load_current_database(fs, status_file);
+    }
+
     static std::vector<Path> apply_database_updates(const ReadOnlyFilesystem& fs,
                                                     StatusParagraphs& current_status_db,
-                                                    const Path& updates_dir)
+                                                    const Path& updates_dir,
+                                                    std::vector<const StatusParagraph*>* updated_pghs)
     {
         auto update_files = fs.get_regular_files_non_recursive(updates_dir, VCPKG_LINE_INFO);
         Util::sort(update_files);
@@ -39,7 +426,11 @@ namespace vcpkg
                 auto pghs = Paragraphs::get_paragraphs(fs, file).value_or_exit(VCPKG_LINE_INFO);
                 for (auto&& p : pghs)
                 {
-                    current_status_db.insert(std::make_unique<StatusParagraph>(file, std::move(p)));
+                    auto updated = current_status_db.insert(std::make_unique<StatusParagraph>(file, std::move(p)));
+                    if (updated_pghs && !Util::contains(*updated_pghs, updated->get()))
+                    {
+                        updated_pghs->push_back(updated->get());
+                    }
                 }
             }
         }
@@ -49,20 +440,37 @@ namespace vcpkg
 
     static void apply_database_updates_on_disk(const Filesystem& fs,
                                                const InstalledPaths& installed,
-                                               StatusParagraphs& current_status_db)
+                                               StatusParagraphs& current_status_db,
+                                               const StatusSnapshotState& snapshot_state)
     {
-        auto update_files = apply_database_updates(fs, current_status_db, installed.vcpkg_dir_updates());
+        std::vector<const StatusParagraph*> updated_pghs;
+        auto update_files =
+            apply_database_updates(fs, current_status_db, installed.vcpkg_dir_updates(), &updated_pghs);
         if (!update_files.empty())
         {
             const auto status_file = installed.vcpkg_dir_status_file();
             const auto status_file_new = Path(status_file.parent_path()) / FileStatusNew;
             fs.write_contents(status_file_new, Strings::serialize(current_status_db), VCPKG_LINE_INFO);
             fs.rename(status_file_new, status_file, VCPKG_LINE_INFO);
+            if (snapshot_state.valid && snapshot_state.segments < StatusSnapshotMaxSegments &&
+                snapshot_state.appended_paragraphs + updated_pghs.size() <= snapshot_state.base_paragraphs)
+            {
+                append_status_snapshot(fs, installed, updated_pghs);
+            }
+            else
+            {
+                write_status_snapshot(fs, installed, current_status_db);
+            }
+
             for (auto&& file : update_files)
             {
                 fs.remove(file, VCPKG_LINE_INFO);
             }
         }
+        else if (!snapshot_state.valid)
+        {
+            write_status_snapshot(fs, installed, current_status_db);
+        }
     }
 
     static void take_lock(DiagnosticContext& context,
@@ -145,17 +553,9 @@ namespace vcpkg
                                    const InstalledPaths& installed,
                                    const InstalledDatabaseLock& /* witness */)
     {
-        const auto maybe_status_file = installed.vcpkg_dir_status_file();
-        if (!fs.exists(maybe_status_file, IgnoreErrors{}))
-        {
-            // no status file, use empty db
-            StatusParagraphs current_status_db;
-            (void)apply_database_updates(fs, current_status_db, installed.vcpkg_dir_updates());
-            return current_status_db;
-        }
-
-        StatusParagraphs current_status_db = load_current_database(fs, maybe_status_file);
-        (void)apply_database_updates(fs, current_status_db, installed.vcpkg_dir_updates());
+        StatusSnapshotState snapshot_state;
+        StatusParagraphs current_status_db = load_current_database(fs, installed, snapshot_state);
+        (void)apply_database_updates(fs, current_status_db, installed.vcpkg_dir_updates(), nullptr);
         return current_status_db;
     }
 
@@ -163,17 +563,9 @@ namespace vcpkg
                                    const InstalledPaths& installed,
                                    const InstalledDatabaseLock& /* witness */)
     {
-        const auto status_file = installed.vcpkg_dir_status_file();
-        if (!fs.exists(status_file, IgnoreErrors{}))
-        {
-            // no status file, use empty db
-            StatusParagraphs current_status_db;
-            apply_database_updates_on_disk(fs, installed, current_status_db);
-            return current_status_db;
-        }
-
-        StatusParagraphs current_status_db = load_current_database(fs, status_file);
-        apply_database_updates_on_disk(fs, installed, current_status_db);
+        StatusSnapshotState snapshot_state;
+        StatusParagraphs current_status_db = load_current_database(fs, installed, snapshot_state);
+        apply_database_updates_on_disk(fs, installed, current_status_db, snapshot_state);
         return current_status_db;
     }
 
@@ -277,6 +669,30 @@ namespace vcpkg
         return Util::fmap(ipv_map, [](auto&& p) -> InstalledPackageView { return std::move(p.second); });
     }
 
+    // Reads the files listed in `listfile_path`, without the directories.
+    template<bool AndUpdate, class FilesystemLike>
+    static std::vector<std::string> read_listfile(const FilesystemLike& fs, const Path& listfile_path)
+    {
+        std::vector<std::string> installed_files_of_current_pgh =
+            fs.read_lines(listfile_path).value_or_exit(VCPKG_LINE_INFO);
+        Strings::inplace_trim_all_and_remove_whitespace_strings(installed_files_of_current_pgh);
+        if (upgrade_to_slash_terminated_sorted_format(installed_files_of_current_pgh))
+        {
+            if constexpr (AndUpdate)
+            {
+                // Replace the listfile on disk
+                const auto updated_listfile_path = listfile_path + "_updated";
+                fs.write_lines(updated_listfile_path, installed_files_of_current_pgh, VCPKG_LINE_INFO);
+                fs.rename(updated_listfile_path, listfile_path, VCPKG_LINE_INFO);
+            }
+        }
+
+        // Remove the directories
+        Util::erase_remove_if(installed_files_of_current_pgh,
+                              [](const std::string& file) { return file.back() == '/'; });
+        return installed_files_of_current_pgh;
+    }
+
     template<bool AndUpdate, class FilesystemLike>
     static std::vector<StatusParagraphAndAssociatedFiles> get_installed_files_impl(const FilesystemLike& fs,
                                                                                    const InstalledPaths& installed,
@@ -291,26 +707,8 @@ namespace vcpkg
                 continue;
             }
 
-            const auto listfile_path = installed.listfile_path(pgh->package);
-            std::vector<std::string> installed_files_of_current_pgh =
-                fs.read_lines(listfile_path).value_or_exit(VCPKG_LINE_INFO);
-            Strings::inplace_trim_all_and_remove_whitespace_strings(installed_files_of_current_pgh);
-            if (upgrade_to_slash_terminated_sorted_format(installed_files_of_current_pgh))
-            {
-                if constexpr (AndUpdate)
-                {
-                    // Replace the listfile on disk
-                    const auto updated_listfile_path = listfile_path + "_updated";
-                    fs.write_lines(updated_listfile_path, installed_files_of_current_pgh, VCPKG_LINE_INFO);
-                    fs.rename(updated_listfile_path, listfile_path, VCPKG_LINE_INFO);
-                }
-            }
-
-            // Remove the directories
-            Util::erase_remove_if(installed_files_of_current_pgh,
-                                  [](const std::string& file) { return file.back() == '/'; });
-
-            StatusParagraphAndAssociatedFiles pgh_and_files{*pgh, std::move(installed_files_of_current_pgh)};
+            StatusParagraphAndAssociatedFiles pgh_and_files{
+                *pgh, read_listfile<AndUpdate>(fs, installed.listfile_path(pgh->package))};
             installed_files.push_back(std::move(pgh_and_files));
         }
 
@@ -330,4 +728,300 @@ namespace vcpkg
     {
         return get_installed_files_impl<true>(fs, installed, status_db);
     }
+
+    static constexpr StringLiteral InstalledFileIndexHeader = "vcpkg-installed-file-index 1";
+
+    // The index file consists of the header line, followed for each package by a line
+    // @<listfile name>\t<listfile size>\t<listfile last write time>\t<listfile inode>\t<file count>
+    // and then that many lines naming the installed files.
+    std::map<std::string, InstalledFileIndex::Owner> InstalledFileIndex::parse_saved_owners(StringView text)
+    {
+        std::map<std::string, Owner> owners;
+        auto next_line = [&](StringView& line) {
+            if (text.empty()) return false;
+            auto newline = std::find(text.begin(), text.end(), '\n');
+            line = StringView{text.begin(), newline};
+            text = StringView{newline == text.end() ? newline : newline + 1, text.end()};
+            return true;
+        };
+
+        StringView line;
+        if (!next_line(line) || line != InstalledFileIndexHeader)
+        {
+            return owners;
+        }
+
+        while (next_line(line))
+        {
+            auto fields = Strings::split_keep_empty(line, '\t');
+            if (fields.size() != 5 || fields[0].size() < 2 || fields[0][0] != '@')
+            {
+                return {};
+            }
+
+            auto size = Strings::strto<uint64_t>(fields[1]);
+            auto last_write_time = Strings::strto<int64_t>(fields[2]);
+            auto inode = Strings::strto<uint64_t>(fields[3]);
+            auto file_count = Strings::strto<size_t>(fields[4]);
+            if (!size || !last_write_time || !inode || !file_count)
+            {
+                return {};
+            }
+
+            Owner owner;
+            owner.listfile_metadata.size = *size.get();
+            owner.listfile_metadata.last_write_time = *last_write_time.get();
+            owner.listfile_metadata.inode = *inode.get();
+            owner.files.reserve(*file_count.get());
+            for (size_t i = 0; i < *file_count.get(); ++i)
+            {
+                if (!next_line(line))
+                {
+                    return {};
+                }
+
+                owner.files.push_back(line.to_string());
+            }
+
+            owners.insert_or_assign(fields[0].substr(1), std::move(owner));
+        }
+
+        return owners;
+    }
+
+    InstalledFileIndex InstalledFileIndex::load(const Filesystem& fs,
+                                                const InstalledPaths& installed,
+                                                const StatusParagraphs& status_db)
+    {
+        InstalledFileIndex index;
+        std::map<std::string, Owner> saved_owners;
+        {
+            std::error_code ec;
+            auto contents = fs.read_contents(installed.installed_file_index_path(), ec);
+            if (!ec)
+            {
+                saved_owners = parse_saved_owners(contents);
+            }
+        }
+
+        const auto saved_owner_count = saved_owners.size();
+        size_t reused_owner_count = 0;
+        for (const std::unique_ptr<StatusParagraph>& pgh : status_db)
+        {
+            if (!pgh->is_installed() || pgh->package.is_feature())
+            {
+                continue;
+            }
+
+            const auto listfile_path = installed.listfile_path(pgh->package);
+            const auto listfile_name = listfile_path.filename().to_string();
+            std::error_code ec;
+            auto metadata = fs.file_metadata(listfile_path, ec);
+            auto saved = saved_owners.find(listfile_name);
+            Owner owner;
+            if (!ec && saved != saved_owners.end() && saved->second.listfile_metadata.size == metadata.size &&
+                saved->second.listfile_metadata.last_write_time == metadata.last_write_time &&
+                saved->second.listfile_metadata.inode == metadata.inode)
+            {
+                owner = std::move(saved->second);
+                ++reused_owner_count;
+            }
+            else
+            {
+                owner.files = read_listfile<true>(fs, listfile_path);
+                // Read after any upgrade of the listfile's format
+                owner.listfile_metadata = fs.file_metadata(listfile_path, ec);
+                index.m_dirty = true;
+            }
+
+            owner.display_name = pgh->package.display_name();
+            index.m_owners.insert_or_assign(listfile_name, std::move(owner));
+        }
+
+        if (reused_owner_count != saved_owner_count)
+        {
+            index.m_dirty = true;
+        }
+
+        for (auto&& owner : index.m_owners)
+        {
+            index.index_owner(owner.second);
+        }
+
+        return index;
+    }
+
+    void InstalledFileIndex::add_package(const Filesystem& fs,
+                                         const InstalledPaths& installed,
+                                         const BinaryParagraph& core_pgh)
+    {
+        const auto listfile_path = installed.listfile_path(core_pgh);
+        Owner new_owner;
+        new_owner.display_name = core_pgh.display_name();
+        new_owner.files = read_listfile<true>(fs, listfile_path);
+        std::error_code ec;
+        new_owner.listfile_metadata = fs.file_metadata(listfile_path, ec);
+
+        auto listfile_name = listfile_path.filename().to_string();
+        auto it = m_owners.find(listfile_name);
+        if (it == m_owners.end())
+        {
+            it = m_owners.emplace(std::move(listfile_name), std::move(new_owner)).first;
+        }
+        else
+        {
+            unindex_owner(it->second);
+            it->second = std::move(new_owner);
+        }
+
+        index_owner(it->second);
+        m_dirty = true;
+    }
+
+    std::vector<InstalledFileOwner> InstalledFileIndex::find(StringView file) const
+    {
+        std::vector<InstalledFileOwner> result;
+        auto range = m_files.equal_range(Strings::ascii_to_lowercase(file));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            const auto& owner = *it->second.first;
+            result.push_back(InstalledFileOwner{owner.files[it->second.second], owner.display_name});
+        }
+
+        return result;
+    }
+
+    std::vector<InstalledFileOwner> InstalledFileIndex::find_prefix(StringView prefix)
+    {
+        if (m_sorted_suffixes.empty())
+        {
+            for (auto&& file : m_files)
+            {
+                const StringView key = file.first;
+                m_sorted_suffixes.emplace_back(key, file.second);
+                for (auto slash = std::find(key.begin(), key.end(), '/'); slash != key.end();
+                     slash = std::find(slash + 1, key.end(), '/'))
+                {
+                    if (slash + 1 != key.end())
+                    {
+                        m_sorted_suffixes.emplace_back(StringView{slash + 1, key.end()}, file.second);
+                    }
+                }
+            }
+
+            Util::sort(m_sorted_suffixes, [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+        }
+
+        const auto lowercase_prefix = Strings::ascii_to_lowercase(prefix);
+        std::vector<std::pair<const Owner*, size_t>> matches;
+        for (auto it = std::lower_bound(m_sorted_suffixes.begin(),
+                                        m_sorted_suffixes.end(),
+                                        StringView{lowercase_prefix},
+                                        [](const auto& suffix, StringView value) { return suffix.first < value; });
+             it != m_sorted_suffixes.end() && it->first.starts_with(lowercase_prefix);
+             ++it)
+        {
+            matches.push_back(it->second);
+        }
+
+        // A file matches once for each part of its path that starts with prefix
+        Util::sort_unique_erase(matches, [](const auto& lhs, const auto& rhs) {
+            if (lhs.first->display_name != rhs.first->display_name)
+            {
+                return lhs.first->display_name < rhs.first->display_name;
+            }
+
+            return lhs.second < rhs.second;
+        });
+        return Util::fmap(matches, [](const std::pair<const Owner*, size_t>& match) {
+            return InstalledFileOwner{match.first->files[match.second], match.first->display_name};
+        });
+    }
+
+    std::vector<InstalledFileOwner> InstalledFileIndex::all_files() const
+    {
+        std::vector<InstalledFileOwner> result;
+        result.reserve(m_files.size());
+        for (auto&& owner : m_owners)
+        {
+            for (auto&& file : owner.second.files)
+            {
+                result.push_back(InstalledFileOwner{file, owner.second.display_name});
+            }
+        }
+
+        return result;
+    }
+
+    void InstalledFileIndex::save(const Filesystem& fs, const InstalledPaths& installed)
+    {
+        if (!m_dirty)
+        {
+            return;
+        }
+
+        std::string contents;
+        contents.append(InstalledFileIndexHeader.data(), InstalledFileIndexHeader.size()).push_back('\n');
+        for (auto&& owner : m_owners)
+        {
+            fmt::format_to(std::back_inserter(contents),
+                           "@{}\t{}\t{}\t{}\t{}\n",
+                           owner.first,
+                           owner.second.listfile_metadata.size,
+                           owner.second.listfile_metadata.last_write_time,
+                           owner.second.listfile_metadata.inode,
+                           owner.second.files.size());
+            for (auto&& file : owner.second.files)
+            {
+                contents.append(file).push_back('\n');
+            }
+        }
+
+        // The index is derived from the listfiles, so failing to write it only costs time on the next load
+        const auto index_path = installed.installed_file_index_path();
+        const auto temp_path = index_path + "_new";
+        std::error_code ec;
+        fs.write_contents(temp_path, contents, ec);
+        if (!ec)
+        {
+            fs.rename(temp_path, index_path, ec);
+        }
+
+        if (ec)
+        {
+            fs.remove(temp_path, IgnoreErrors{});
+            return;
+        }
+
+        m_dirty = false;
+    }
+
+    void InstalledFileIndex::index_owner(const Owner& owner)
+    {
+        m_sorted_suffixes.clear();
+        for (size_t i = 0; i < owner.files.size(); ++i)
+        {
+            m_files.emplace(Strings::ascii_to_lowercase(owner.files[i]), std::make_pair(&owner, i));
+        }
+    }
+
+    void InstalledFileIndex::unindex_owner(const Owner& owner)
+    {
+        m_sorted_suffixes.clear();
+        for (auto&& file : owner.files)
+        {
+            auto range = m_files.equal_range(Strings::ascii_to_lowercase(file));
+            for (auto it = range.first; it != range.second;)
+            {
+                if (it->second.first == &owner)
+                {
+                    it = m_files.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+    }
 }
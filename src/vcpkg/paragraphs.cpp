@@ -4,6 +4,7 @@
 #include <vcpkg/base/contractual-constants.h>
 #include <vcpkg/base/files.h>
 #include <vcpkg/base/messages.h>
+#include <vcpkg/base/parallel-algorithms.h>
 #include <vcpkg/base/parse.h>
 #include <vcpkg/base/system.debug.h>
 #include <vcpkg/base/util.h>
@@ -555,38 +556,74 @@ namespace vcpkg::Paragraphs
         return maybe_paragraphs.error();
     }
 
-    LoadResults try_load_all_registry_ports(const RegistrySet& registries)
+    namespace
     {
-        LoadResults ret;
-        std::vector<std::string> ports = registries.get_all_reachable_port_names().value_or_exit(VCPKG_LINE_INFO);
-        for (const auto& port_name : ports)
+        struct RegistryPortLoadResult
         {
+            ExpectedL<Unit> baseline = Unit{};
+            Optional<ExpectedL<SourceControlFileAndLocation>> maybe_scfl;
+        };
+
+        RegistryPortLoadResult try_load_registry_port(const RegistrySet& registries, StringView port_name)
+        {
+            RegistryPortLoadResult result;
             const auto impl = registries.registry_for_port(port_name);
             if (!impl)
             {
                 // this is a port for which no registry is set
                 // this can happen when there's no default registry,
                 // and a registry has a port definition which it doesn't own the name of.
-                continue;
+                return result;
             }
 
-            auto maybe_baseline_version = impl->get_baseline_version(port_name).value_or_exit(VCPKG_LINE_INFO);
-            auto baseline_version = maybe_baseline_version.get();
-            if (!baseline_version) continue; // port is attributed to this registry, but it is not in the baseline
+            auto maybe_baseline_version = impl->get_baseline_version(port_name);
+            auto baseline_version_opt = maybe_baseline_version.get();
+            if (!baseline_version_opt)
+            {
+                result.baseline = std::move(maybe_baseline_version).error();
+                return result;
+            }
+
+            auto baseline_version = baseline_version_opt->get();
+            if (!baseline_version) return result; // port is attributed to this registry, but it is not in the baseline
             auto maybe_port_entry = impl->get_port_entry(port_name);
             const auto port_entry = maybe_port_entry.get();
-            if (!port_entry) continue;  // port is attributed to this registry, but loading it failed
-            if (!*port_entry) continue; // port is attributed to this registry, but doesn't exist in this registry
-            auto maybe_scfl = (*port_entry)->try_load_port(*baseline_version);
-            if (const auto scfl = maybe_scfl.get())
+            if (!port_entry) return result;  // port is attributed to this registry, but loading it failed
+            if (!*port_entry) return result; // port is attributed to this registry, but doesn't exist in this registry
+            result.maybe_scfl = (*port_entry)->try_load_port(*baseline_version);
+            return result;
+        }
+    }
+
+    LoadResults try_load_all_registry_ports(const RegistrySet& registries)
+    {
+        LoadResults ret;
+        std::vector<std::string> ports = registries.get_all_reachable_port_names().value_or_exit(VCPKG_LINE_INFO);
+        // Ports are loaded concurrently, then collected in the order of their names so that the results and errors
+        // do not depend on scheduling.
+        std::vector<RegistryPortLoadResult> results(ports.size());
+        execute_in_parallel(ports.size(),
+                            [&](size_t idx) { results[idx] = try_load_registry_port(registries, ports[idx]); });
+
+        for (size_t idx = 0; idx < ports.size(); ++idx)
+        {
+            auto& result = results[idx];
+            result.baseline.value_or_exit(VCPKG_LINE_INFO);
+            auto maybe_scfl = result.maybe_scfl.get();
+            if (!maybe_scfl)
+            {
+                continue;
+            }
+
+            if (const auto scfl = maybe_scfl->get())
             {
                 ret.paragraphs.push_back(std::move(*scfl));
             }
             else
             {
                 ret.errors.emplace_back(std::piecewise_construct,
-                                        std::forward_as_tuple(port_name.data(), port_name.size()),
-                                        std::forward_as_tuple(std::move(maybe_scfl).error()));
+                                        std::forward_as_tuple(std::move(ports[idx])),
+                                        std::forward_as_tuple(std::move(*maybe_scfl).error()));
             }
         }
 
@@ -6,6 +6,8 @@
 
 #include <vcpkg/platform-expression.h>
 
+#include <algorithm>
+#include <iterator>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -554,6 +556,7 @@ namespace vcpkg::PlatformExpression
         if (other.underlying_)
         {
             this->underlying_ = other.underlying_->clone();
+            compile();
         }
     }
     Expr& Expr::operator=(const Expr& other)
@@ -567,10 +570,11 @@ namespace vcpkg::PlatformExpression
             this->underlying_.reset();
         }
 
+        compile();
         return *this;
     }
 
-    Expr::Expr(std::unique_ptr<ExprImpl>&& e) : underlying_(std::move(e)) { }
+    Expr::Expr(std::unique_ptr<ExprImpl>&& e) : underlying_(std::move(e)) { compile(); }
     Expr::~Expr() = default;
 
     Expr Expr::Identifier(StringView id)
@@ -589,179 +593,374 @@ namespace vcpkg::PlatformExpression
             ExprKind::op_or, Util::fmap(exprs, [](Expr& expr) { return std::move(expr.underlying_); })));
     }
 
-    bool Expr::evaluate(const Context& context) const
+    namespace
     {
-        if (!this->underlying_)
+        static_assert(static_cast<int>(Identifier::native) < 64, "each built in identifier needs a bit");
+        uint64_t identifier_bit(Identifier id) { return uint64_t{1} << static_cast<int>(id); }
+
+        // the variables of a context which identifiers depend on
+        enum class IdentifierVariable
         {
-            return true; // empty expression is always true
+            target_architecture,
+            cmake_system_name,
+            library_linkage,
+            crt_linkage,
+            xbox_console_target,
+            is_native,
+            override_vars,
+            count,
+        };
+
+        struct IdentifierCondition
+        {
+            Identifier id;
+            IdentifierVariable variable;
+            StringLiteral value;
+        };
+
+        // an identifier is true if any of its conditions is; xbox and native are handled separately
+        constexpr IdentifierCondition identifier_conditions[] = {
+            {Identifier::x64, IdentifierVariable::target_architecture, "x64"},
+            {Identifier::x86, IdentifierVariable::target_architecture, "x86"},
+            // For backwards compatability arm is also true for arm64.
+            // This is because it previously was only checking for a substring.
+            {Identifier::arm, IdentifierVariable::target_architecture, "arm"},
+            {Identifier::arm, IdentifierVariable::target_architecture, "arm64"},
+            {Identifier::arm32, IdentifierVariable::target_architecture, "arm"},
+            {Identifier::arm64, IdentifierVariable::target_architecture, "arm64"},
+            {Identifier::arm64ec, IdentifierVariable::target_architecture, "arm64ec"},
+            {Identifier::wasm32, IdentifierVariable::target_architecture, "wasm32"},
+            {Identifier::mips64, IdentifierVariable::target_architecture, "mips64"},
+            {Identifier::windows, IdentifierVariable::cmake_system_name, ""},
+            {Identifier::windows, IdentifierVariable::cmake_system_name, "WindowsStore"},
+            {Identifier::windows, IdentifierVariable::cmake_system_name, "MinGW"},
+            {Identifier::mingw, IdentifierVariable::cmake_system_name, "MinGW"},
+            {Identifier::linux, IdentifierVariable::cmake_system_name, "Linux"},
+            {Identifier::freebsd, IdentifierVariable::cmake_system_name, "FreeBSD"},
+            {Identifier::openbsd, IdentifierVariable::cmake_system_name, "OpenBSD"},
+            {Identifier::netbsd, IdentifierVariable::cmake_system_name, "NetBSD"},
+            {Identifier::bsd, IdentifierVariable::cmake_system_name, "FreeBSD"},
+            {Identifier::bsd, IdentifierVariable::cmake_system_name, "OpenBSD"},
+            {Identifier::bsd, IdentifierVariable::cmake_system_name, "NetBSD"},
+            {Identifier::solaris, IdentifierVariable::cmake_system_name, "SunOS"},
+            {Identifier::osx, IdentifierVariable::cmake_system_name, "Darwin"},
+            {Identifier::uwp, IdentifierVariable::cmake_system_name, "WindowsStore"},
+            {Identifier::android, IdentifierVariable::cmake_system_name, "Android"},
+            {Identifier::emscripten, IdentifierVariable::cmake_system_name, "Emscripten"},
+            {Identifier::ios, IdentifierVariable::cmake_system_name, "iOS"},
+            {Identifier::qnx, IdentifierVariable::cmake_system_name, "QNX"},
+            {Identifier::vxworks, IdentifierVariable::cmake_system_name, "VxWorks"},
+            {Identifier::tvos, IdentifierVariable::cmake_system_name, "tvOS"},
+            {Identifier::watchos, IdentifierVariable::cmake_system_name, "watchOS"},
+            {Identifier::visionos, IdentifierVariable::cmake_system_name, "visionOS"},
+            {Identifier::ohos, IdentifierVariable::cmake_system_name, "OHOS"},
+            {Identifier::static_link, IdentifierVariable::library_linkage, "static"},
+            {Identifier::static_crt, IdentifierVariable::crt_linkage, "static"},
+        };
+    }
+
+    ContextIdentifiers ContextIdentifiers::reduce(const Context& context)
+    {
+        static const std::string variable_names[] = {
+            "VCPKG_TARGET_ARCHITECTURE",
+            "VCPKG_CMAKE_SYSTEM_NAME",
+            "VCPKG_LIBRARY_LINKAGE",
+            "VCPKG_CRT_LINKAGE",
+            "VCPKG_XBOX_CONSOLE_TARGET",
+            "Z_VCPKG_IS_NATIVE",
+            "VCPKG_DEP_INFO_OVERRIDE_VARS",
+        };
+        static_assert(std::size(variable_names) == static_cast<size_t>(IdentifierVariable::count),
+                      "each variable needs a name");
+
+        const std::string* variable_values[std::size(variable_names)];
+        for (size_t idx = 0; idx < std::size(variable_names); ++idx)
+        {
+            auto iter = context.find(variable_names[idx]);
+            variable_values[idx] = iter == context.end() ? nullptr : &iter->second;
         }
 
-        std::map<std::string, bool> override_ctxt;
+        ContextIdentifiers result;
+        for (auto&& condition : identifier_conditions)
         {
-            auto override_vars = context.find("VCPKG_DEP_INFO_OVERRIDE_VARS");
-            if (override_vars != context.end())
+            auto value = variable_values[static_cast<size_t>(condition.variable)];
+            if (value && *value == condition.value)
             {
-                auto cmake_list = Strings::split(override_vars->second, ';');
-                for (auto& override_id : cmake_list)
-                {
-                    if (!override_id.empty())
-                    {
-                        if (override_id[0] == '!')
-                        {
-                            override_ctxt.emplace(override_id.substr(1), false);
-                        }
-                        else
-                        {
-                            override_ctxt.emplace(override_id, true);
-                        }
-                    }
-                }
+                result.true_identifiers_ |= identifier_bit(condition.id);
             }
         }
 
-        struct Visitor
+        auto xbox_target = variable_values[static_cast<size_t>(IdentifierVariable::xbox_console_target)];
+        if (xbox_target && !xbox_target->empty())
         {
-            const Context& context;
-            const std::map<std::string, bool>& override_ctxt;
+            result.true_identifiers_ |= identifier_bit(Identifier::xbox);
+        }
+
+        auto is_native = variable_values[static_cast<size_t>(IdentifierVariable::is_native)];
+        if (!is_native)
+        {
+            result.missing_identifiers_ |= identifier_bit(Identifier::native);
+        }
+        else if (*is_native == "1")
+        {
+            result.true_identifiers_ |= identifier_bit(Identifier::native);
+        }
+
+        auto override_vars = variable_values[static_cast<size_t>(IdentifierVariable::override_vars)];
+        if (!override_vars)
+        {
+            return result;
+        }
 
-            bool true_if_exists_and_nonempty(const std::string& variable_name) const
+        // the first override of an identifier wins
+        uint64_t overridden_identifiers = 0;
+        for (auto&& override_id : Strings::split(*override_vars, ';'))
+        {
+            const bool value = override_id[0] != '!';
+            auto name = StringView{override_id}.substr(value ? 0 : 1);
+            auto id = string2identifier(name);
+            if (id == Identifier::invalid)
             {
-                auto iter = context.find(variable_name);
-                if (iter == context.end())
+                auto it = std::lower_bound(result.other_overrides_.begin(),
+                                           result.other_overrides_.end(),
+                                           name,
+                                           [](const std::pair<std::string, bool>& entry, StringView name) {
+                                               return entry.first < name;
+                                           });
+                if (it == result.other_overrides_.end() || it->first != name)
                 {
-                    return false;
+                    result.other_overrides_.emplace(it, name.to_string(), value);
                 }
 
-                return !iter->second.empty();
+                continue;
             }
 
-            bool true_if_exists_and_equal(const std::string& variable_name, const std::string& value) const
+            const auto bit = identifier_bit(id);
+            if (overridden_identifiers & bit)
             {
-                auto iter = context.find(variable_name);
-                if (iter == context.end())
-                {
-                    return false;
-                }
-                return iter->second == value;
+                continue;
+            }
+
+            overridden_identifiers |= bit;
+            result.missing_identifiers_ &= ~bit;
+            if (value)
+            {
+                result.true_identifiers_ |= bit;
+            }
+            else
+            {
+                result.true_identifiers_ &= ~bit;
+            }
+        }
+
+        return result;
+    }
+
+    namespace detail
+    {
+        enum class OpCode : unsigned char
+        {
+            identifier,
+            other_identifier,
+            op_not,
+            op_and,
+            op_or,
+            // the expression could not be parsed, so cannot be evaluated
+            invalid,
+        };
+
+        // Expressions are flattened into a sequence of instructions in prefix order; each instruction is followed by
+        // the instructions of its operands.
+        struct Instruction
+        {
+            OpCode op;
+            // op_and and op_or: the number of operands which follow
+            uint32_t operands = 0;
+            // identifier: the bit of the identifier; op_and and op_or: the bits of the operands which are built in
+            // identifiers, which are folded into the masks rather than following as instructions
+            uint64_t mask = 0;
+            // op_and and op_or: the bits of the operands which are negated built in identifiers
+            uint64_t negated_mask = 0;
+            // other_identifier: the name of the identifier, owned by the ExprImpl the program was compiled from
+            const std::string* name = nullptr;
+        };
+
+        // Appends the instructions of an expression to `program`
+        struct Compiler
+        {
+            std::vector<Instruction>& program;
+
+            static Identifier builtin_identifier(const ExprImpl& expr)
+            {
+                return expr.kind == ExprKind::identifier ? string2identifier(expr.identifier) : Identifier::invalid;
             }
 
-            bool visit(const ExprImpl& expr) const
+            void compile(const ExprImpl& expr)
             {
-                if (expr.kind == ExprKind::identifier)
+                switch (expr.kind)
                 {
-                    if (!override_ctxt.empty())
+                    case ExprKind::identifier:
                     {
-                        auto override_id = override_ctxt.find(expr.identifier);
-                        if (override_id != override_ctxt.end())
+                        auto id = string2identifier(expr.identifier);
+                        if (id == Identifier::invalid)
                         {
-                            return override_id->second;
+                            program.push_back({OpCode::other_identifier});
+                            program.back().name = &expr.identifier;
                         }
-                        // Fall through to use the cmake logic if the id does not have an override
+                        else
+                        {
+                            program.push_back({OpCode::identifier});
+                            program.back().mask = identifier_bit(id);
+                        }
+                        return;
                     }
-
-                    auto id = string2identifier(expr.identifier);
-                    switch (id)
+                    case ExprKind::op_not:
+                        program.push_back({OpCode::op_not});
+                        compile(*expr.exprs.at(0));
+                        return;
+                    case ExprKind::op_and:
+                    case ExprKind::op_or:
+                    case ExprKind::op_list:
                     {
-                        case Identifier::invalid:
-                            // Point out in the diagnostic that they should add to the override list because that is
-                            // what most users should do, however it is also valid to update the built in identifiers to
-                            // recognize the name.
-                            msg::println_warning(msgUnrecognizedIdentifier, msg::value = expr.identifier);
-                            return false;
-                        case Identifier::x64: return true_if_exists_and_equal("VCPKG_TARGET_ARCHITECTURE", "x64");
-                        case Identifier::x86: return true_if_exists_and_equal("VCPKG_TARGET_ARCHITECTURE", "x86");
-                        case Identifier::arm:
-                            // For backwards compatability arm is also true for arm64.
-                            // This is because it previously was only checking for a substring.
-                            return true_if_exists_and_equal("VCPKG_TARGET_ARCHITECTURE", "arm") ||
-                                   true_if_exists_and_equal("VCPKG_TARGET_ARCHITECTURE", "arm64");
-                        case Identifier::arm32: return true_if_exists_and_equal("VCPKG_TARGET_ARCHITECTURE", "arm");
-                        case Identifier::arm64: return true_if_exists_and_equal("VCPKG_TARGET_ARCHITECTURE", "arm64");
-                        case Identifier::arm64ec:
-                            return true_if_exists_and_equal("VCPKG_TARGET_ARCHITECTURE", "arm64ec");
-                        case Identifier::windows:
-                            return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "") ||
-                                   true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "WindowsStore") ||
-                                   true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "MinGW");
-                        case Identifier::mingw: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "MinGW");
-                        case Identifier::linux: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "Linux");
-                        case Identifier::freebsd: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "FreeBSD");
-                        case Identifier::openbsd: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "OpenBSD");
-                        case Identifier::netbsd: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "NetBSD");
-                        case Identifier::bsd:
-                            return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "FreeBSD") ||
-                                   true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "OpenBSD") ||
-                                   true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "NetBSD");
-                        case Identifier::solaris: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "SunOS");
-                        case Identifier::osx: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "Darwin");
-                        case Identifier::uwp:
-                            return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "WindowsStore");
-                        case Identifier::xbox: return true_if_exists_and_nonempty("VCPKG_XBOX_CONSOLE_TARGET");
-                        case Identifier::android: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "Android");
-                        case Identifier::emscripten:
-                            return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "Emscripten");
-                        case Identifier::ios: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "iOS");
-                        case Identifier::qnx: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "QNX");
-                        case Identifier::vxworks: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "VxWorks");
-                        case Identifier::wasm32: return true_if_exists_and_equal("VCPKG_TARGET_ARCHITECTURE", "wasm32");
-                        case Identifier::mips64: return true_if_exists_and_equal("VCPKG_TARGET_ARCHITECTURE", "mips64");
-                        case Identifier::tvos: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "tvOS");
-                        case Identifier::watchos: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "watchOS");
-                        case Identifier::visionos:
-                            return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "visionOS");
-                        case Identifier::ohos: return true_if_exists_and_equal("VCPKG_CMAKE_SYSTEM_NAME", "OHOS");
-                        case Identifier::static_link:
-                            return true_if_exists_and_equal("VCPKG_LIBRARY_LINKAGE", "static");
-                        case Identifier::static_crt: return true_if_exists_and_equal("VCPKG_CRT_LINKAGE", "static");
-                        case Identifier::native:
+                        const auto index = program.size();
+                        program.push_back({expr.kind == ExprKind::op_and ? OpCode::op_and : OpCode::op_or});
+                        for (const auto& e : expr.exprs)
                         {
-                            auto is_native = context.find("Z_VCPKG_IS_NATIVE");
-                            if (is_native == context.end())
+                            auto id = builtin_identifier(*e);
+                            if (id != Identifier::invalid)
                             {
-                                Checks::unreachable(VCPKG_LINE_INFO);
+                                program[index].mask |= identifier_bit(id);
+                                continue;
                             }
 
-                            return is_native->second == "1";
+                            if (e->kind == ExprKind::op_not)
+                            {
+                                id = builtin_identifier(*e->exprs.at(0));
+                                if (id != Identifier::invalid)
+                                {
+                                    program[index].negated_mask |= identifier_bit(id);
+                                    continue;
+                                }
+                            }
+
+                            ++program[index].operands;
+                            compile(*e);
                         }
+                        return;
                     }
-                    Checks::unreachable(VCPKG_LINE_INFO);
+                    case ExprKind::op_empty:
+                    case ExprKind::op_invalid: program.push_back({OpCode::invalid}); return;
                 }
-                else if (expr.kind == ExprKind::op_not)
+                Checks::unreachable(VCPKG_LINE_INFO);
+            }
+        };
+    }
+
+    void Expr::compile()
+    {
+        program_.clear();
+        if (!underlying_)
+        {
+            return;
+        }
+
+        Compiler{program_}.compile(*underlying_);
+    }
+
+    bool Expr::evaluate(const Context& context) const
+    {
+        if (!this->underlying_)
+        {
+            return true; // empty expression is always true
+        }
+
+        return evaluate(ContextIdentifiers::reduce(context));
+    }
+
+    bool Expr::evaluate(const ContextIdentifiers& identifiers) const
+    {
+        if (!this->underlying_)
+        {
+            return true; // empty expression is always true
+        }
+
+        struct Evaluator
+        {
+            const ContextIdentifiers& identifiers;
+            const Instruction* next;
+
+            uint64_t true_bits(uint64_t mask) const
+            {
+                if (identifiers.missing_identifiers_ & mask)
                 {
-                    return !visit(*expr.exprs.at(0));
+                    Checks::unreachable(VCPKG_LINE_INFO);
                 }
-                else if (expr.kind == ExprKind::op_and)
-                {
-                    bool valid = true;
 
-                    // we want to print errors in all expressions, so we check all of the expressions all the time
-                    for (const auto& e : expr.exprs)
-                    {
-                        valid &= visit(*e);
-                    }
+                return identifiers.true_identifiers_ & mask;
+            }
 
-                    return valid;
-                }
-                else if ((expr.kind == ExprKind::op_or) || (expr.kind == ExprKind::op_list))
+            bool evaluate_next()
+            {
+                const Instruction& instruction = *next++;
+                switch (instruction.op)
                 {
-                    bool valid = false;
+                    case OpCode::identifier: return true_bits(instruction.mask) != 0;
+                    case OpCode::other_identifier:
+                    {
+                        const auto& name = *instruction.name;
+                        const auto& overrides = identifiers.other_overrides_;
+                        auto it = std::lower_bound(
+                            overrides.begin(),
+                            overrides.end(),
+                            name,
+                            [](const std::pair<std::string, bool>& entry, const std::string& name) {
+                                return entry.first < name;
+                            });
+                        if (it != overrides.end() && it->first == name)
+                        {
+                            return it->second;
+                        }
 
-                    // we want to print errors in all expressions, so we check all of the expressions all the time
-                    for (const auto& e : expr.exprs)
+                        // Point out in the diagnostic that they should add to the override list because that is
+                        // what most users should do, however it is also valid to update the built in identifiers to
+                        // recognize the name.
+                        msg::println_warning(msgUnrecognizedIdentifier, msg::value = name);
+                        return false;
+                    }
+                    case OpCode::op_not: return !evaluate_next();
+                    case OpCode::op_and:
                     {
-                        valid |= visit(*e);
+                        bool valid = true_bits(instruction.mask) == instruction.mask &&
+                                     true_bits(instruction.negated_mask) == 0;
+
+                        // we want to print errors in all expressions, so we check all of the expressions all the time
+                        for (uint32_t i = 0; i < instruction.operands; ++i)
+                        {
+                            valid &= evaluate_next();
+                        }
+
+                        return valid;
                     }
+                    case OpCode::op_or:
+                    {
+                        bool valid = true_bits(instruction.mask) != 0 ||
+                                     true_bits(instruction.negated_mask) != instruction.negated_mask;
 
-                    return valid;
-                }
-                else
-                {
-                    Checks::unreachable(VCPKG_LINE_INFO);
+                        // we want to print errors in all expressions, so we check all of the expressions all the time
+                        for (uint32_t i = 0; i < instruction.operands; ++i)
+                        {
+                            valid |= evaluate_next();
+                        }
+
+                        return valid;
+                    }
+                    case OpCode::invalid: break;
                 }
+                Checks::unreachable(VCPKG_LINE_INFO);
             }
         };
 
-        return Visitor{context, override_ctxt}.visit(*this->underlying_);
+        return Evaluator{identifiers, program_.data()}.evaluate_next();
     }
 
     int Expr::complexity() const
@@ -789,12 +988,14 @@ namespace vcpkg::PlatformExpression
     Expr& Expr::negate()
     {
         underlying_->negate();
+        compile();
         return *this;
     }
 
     Expr& Expr::simplify()
     {
         underlying_->simplify();
+        compile();
         return *this;
     }
 
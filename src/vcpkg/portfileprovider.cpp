@@ -13,6 +13,7 @@
 
 #include <functional>
 #include <map>
+#include <mutex>
 
 using namespace vcpkg;
 
@@ -420,7 +421,7 @@ namespace vcpkg
 
         private:
             const RegistrySet& registry_set;
-            Cache<std::string, ExpectedL<Version>> m_baseline_cache;
+            ConcurrentCache<std::string, ExpectedL<Version>> m_baseline_cache;
         };
 
         struct VersionedPortfileProviderImpl : IFullVersionedPortfileProvider
@@ -429,34 +430,37 @@ namespace vcpkg
             VersionedPortfileProviderImpl(const VersionedPortfileProviderImpl&) = delete;
             VersionedPortfileProviderImpl& operator=(const VersionedPortfileProviderImpl&) = delete;
 
-            const ExpectedL<std::unique_ptr<RegistryEntry>>& entry(StringView name) const
+            ExpectedL<std::unique_ptr<RegistryEntry>> load_entry(StringView name) const
             {
-                auto entry_it = m_entry_cache.find(name);
-                if (entry_it == m_entry_cache.end())
+                if (auto reg = m_registry_set.registry_for_port(name))
                 {
-                    if (auto reg = m_registry_set.registry_for_port(name))
+                    if (auto entry = reg->get_port_entry(name))
                     {
-                        if (auto entry = reg->get_port_entry(name))
-                        {
-                            entry_it = m_entry_cache.emplace(name.to_string(), std::move(entry)).first;
-                        }
-                        else
-                        {
-                            entry_it = m_entry_cache
-                                           .emplace(name.to_string(),
-                                                    msg::format(msgPortDoesNotExist, msg::package_name = name))
-                                           .first;
-                        }
+                        return entry;
                     }
-                    else
+
+                    return msg::format(msgPortDoesNotExist, msg::package_name = name);
+                }
+
+                return msg::format_error(msgNoRegistryForPort, msg::package_name = name);
+            }
+
+            const ExpectedL<std::unique_ptr<RegistryEntry>>& entry(StringView name) const
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    auto entry_it = m_entry_cache.find(name);
+                    if (entry_it != m_entry_cache.end())
                     {
-                        entry_it = m_entry_cache
-                                       .emplace(name.to_string(),
-                                                msg::format_error(msgNoRegistryForPort, msg::package_name = name))
-                                       .first;
+                        return entry_it->second;
                     }
                 }
-                return entry_it->second;
+
+                // Entries are loaded without holding the lock so that different ports load concurrently; if two
+                // threads load the same port, the first one to finish wins.
+                auto loaded = load_entry(name);
+                std::lock_guard<std::mutex> lock(m_mtx);
+                return m_entry_cache.emplace(name.to_string(), std::move(loaded)).first->second;
             }
 
             ExpectedL<SourceControlFileAndLocation> load_control_file(const VersionSpec& version_spec) const
@@ -501,13 +505,21 @@ namespace vcpkg
             virtual ExpectedL<const SourceControlFileAndLocation&> get_control_file(
                 const VersionSpec& version_spec) const override
             {
-                auto it = m_control_cache.find(version_spec);
-                if (it == m_control_cache.end())
+                const ExpectedL<SourceControlFileAndLocation>* maybe_scfl;
+                {
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    auto it = m_control_cache.find(version_spec);
+                    maybe_scfl = it == m_control_cache.end() ? nullptr : &it->second;
+                }
+
+                if (!maybe_scfl)
                 {
-                    it = m_control_cache.emplace(version_spec, load_control_file(version_spec)).first;
+                    auto loaded = load_control_file(version_spec);
+                    std::lock_guard<std::mutex> lock(m_mtx);
+                    maybe_scfl = &m_control_cache.emplace(version_spec, std::move(loaded)).first->second;
                 }
 
-                return it->second.map(
+                return maybe_scfl->map(
                     [](const SourceControlFileAndLocation& x) -> const SourceControlFileAndLocation& { return x; });
             }
 
@@ -515,6 +527,7 @@ namespace vcpkg
                 std::map<std::string, const SourceControlFileAndLocation*>& out) const override
             {
                 auto all_ports = Paragraphs::load_all_registry_ports(m_registry_set);
+                std::lock_guard<std::mutex> lock(m_mtx);
                 for (auto&& scfl : all_ports)
                 {
                     auto it = m_control_cache.emplace(scfl.to_version_spec(), std::move(scfl)).first;
@@ -526,6 +539,9 @@ namespace vcpkg
             const RegistrySet& m_registry_set;
             mutable std::unordered_map<VersionSpec, ExpectedL<SourceControlFileAndLocation>, VersionSpecHasher>
                 m_control_cache;
+            // Guards m_control_cache and m_entry_cache. Their elements are never erased, so references to them
+            // remain valid after the lock is released.
+            mutable std::mutex m_mtx;
             mutable std::map<std::string, ExpectedL<std::unique_ptr<RegistryEntry>>, std::less<>> m_entry_cache;
         };
 
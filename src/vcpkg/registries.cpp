@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <iterator>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -190,6 +191,7 @@ namespace
                 return get_unstale_stale_versions_tree_path();
             }
 
+            std::lock_guard<std::mutex> lock(m_stale_versions_tree_mtx);
             if (!m_stale_versions_tree.has_value())
             {
                 auto maybe_tree =
@@ -221,6 +223,7 @@ namespace
         std::string m_reference;
         std::string m_baseline_identifier;
         DelayedInit<ExpectedL<LockFile::Entry>> m_lock_entry;
+        mutable std::mutex m_stale_versions_tree_mtx;
         mutable Optional<Path> m_stale_versions_tree;
         DelayedInit<ExpectedL<Path>> m_versions_tree;
         DelayedInit<ExpectedL<Baseline>> m_baseline;
@@ -311,7 +314,7 @@ namespace
 
         const ReadOnlyFilesystem& m_fs;
         const Path m_builtin_ports_directory;
-        Cache<Path, ExpectedL<SourceControlFileAndLocation>> m_scfls;
+        ConcurrentCache<Path, ExpectedL<SourceControlFileAndLocation>> m_scfls;
     };
 
     // This registry implementation is a builtin registry with a provided
@@ -1008,31 +1011,24 @@ namespace
 {
     using namespace vcpkg;
 
+    // Baselines are objects, which parse_baseline_versions reads one member at a time; this deserializer is only
+    // used to report values of other types
     struct BaselineDeserializer final : Json::IDeserializer<std::map<std::string, Version, std::less<>>>
     {
         LocalizedString type_name() const override { return msg::format(msgABaselineObject); }
 
-        Optional<type> visit_object(Json::Reader& r, const Json::Object& obj) const override
-        {
-            std::map<std::string, Version, std::less<>> result;
-
-            for (auto pr : obj)
-            {
-                const auto& version_value = pr.second;
-                Version version;
-                r.visit_in_key(version_value, pr.first, version, baseline_version_tag_deserializer);
-
-                result.emplace(pr.first.to_string(), std::move(version));
-            }
-
-            return result;
-        }
-
         static const BaselineDeserializer instance;
     };
 
     const BaselineDeserializer BaselineDeserializer::instance;
 
+    // the error Json::parse_object reports for documents which are not objects
+    LocalizedString expected_an_object_error(StringView origin)
+    {
+        return LocalizedString::from_raw(
+            DiagnosticLine{DiagKind::Error, origin, msg::format(msgExpectedAnObject)}.to_string());
+    }
+
     Path relative_path_to_versions(StringView port_name)
     {
         char prefix[] = {port_name[0], '-', '\0'};
@@ -1041,16 +1037,49 @@ namespace
 
     ExpectedL<Baseline> parse_baseline_versions(StringView contents, StringView baseline, StringView origin)
     {
-        auto maybe_object = Json::parse_object(contents, origin);
-        auto object = maybe_object.get();
-        if (!object)
+        // baseline.json is read in one pass, building only the versions of the requested baseline
+        Json::PullReader parser(contents, origin);
+        if (!parser.begin_object())
         {
-            return std::move(maybe_object).error();
+            parser.skip_value();
+            return parser.finish().then([&](Unit) -> ExpectedL<Baseline> { return expected_an_object_error(origin); });
         }
 
         auto real_baseline = baseline.size() == 0 ? StringView{JsonIdDefault} : baseline;
-        auto baseline_value = object->get(real_baseline);
-        if (!baseline_value)
+        Json::Reader r(origin);
+        Baseline result;
+        bool found = false;
+        std::string key;
+        while (parser.next_member(key))
+        {
+            if (key != real_baseline)
+            {
+                parser.skip_value();
+                continue;
+            }
+
+            found = true;
+            if (!parser.begin_object())
+            {
+                // reports that the baseline is not an object
+                r.visit_in_key(parser, real_baseline, result, BaselineDeserializer::instance);
+                continue;
+            }
+
+            r.object_members_in_key(parser, real_baseline, [&](const std::string& port_name) {
+                Version version;
+                r.visit_in_key(parser, port_name, version, baseline_version_tag_deserializer);
+                result.emplace(port_name, std::move(version));
+            });
+        }
+
+        auto finished = parser.finish();
+        if (!finished)
+        {
+            return std::move(finished).error();
+        }
+
+        if (!found)
         {
             return LocalizedString::from_raw(origin)
                 .append_raw(": ")
@@ -1060,9 +1089,6 @@ namespace
                         msg::json_type = msg::format(msgABaselineObject));
         }
 
-        Json::Reader r(origin);
-        Baseline result;
-        r.visit_in_key(*baseline_value, real_baseline, result, BaselineDeserializer::instance);
         if (!r.messages().any_errors())
         {
             return std::move(result);
@@ -1108,8 +1134,14 @@ namespace vcpkg
                Strings::case_insensitive_ascii_equals(url, builtin_registry_git_url_git_form_with_dot_git);
     }
 
+    // Guards the lockdata and modified flag of every LockFile; registries sharing a lock file resolve their entries
+    // concurrently when ports are loaded in parallel. Fetches are done with the lock held so that each remote and
+    // reference is fetched only once.
+    static std::mutex g_lockfile_mtx;
+
     ExpectedL<LockFile::Entry> LockFile::get_or_fetch(const VcpkgPaths& paths, StringView repo, StringView reference)
     {
+        std::lock_guard<std::mutex> lock(g_lockfile_mtx);
         auto range = lockdata.equal_range(repo);
         auto it = std::find_if(range.first, range.second, [&reference](const LockDataType::value_type& repo2entry) {
             return repo2entry.second.reference == reference;
@@ -1132,8 +1164,22 @@ namespace vcpkg
 
         return LockFile::Entry{this, it};
     }
+
+    std::string LockFile::Entry::commit_id() const
+    {
+        std::lock_guard<std::mutex> lock(g_lockfile_mtx);
+        return data->second.commit_id;
+    }
+
+    bool LockFile::Entry::stale() const
+    {
+        std::lock_guard<std::mutex> lock(g_lockfile_mtx);
+        return data->second.stale;
+    }
+
     ExpectedL<Unit> LockFile::Entry::ensure_up_to_date(const VcpkgPaths& paths) const
     {
+        std::lock_guard<std::mutex> lock(g_lockfile_mtx);
         if (data->second.stale)
         {
             StringView repo(data->first);
@@ -1341,6 +1387,63 @@ namespace vcpkg
 
 namespace
 {
+    // versions files are read in one pass, deserializing each entry as it is read
+    template<class Entry>
+    ExpectedL<Optional<std::vector<Entry>>> parse_versions_file(StringView contents,
+                                                                const Path& versions_file_path,
+                                                                const Json::IDeserializer<Entry>& entry_deserializer)
+    {
+        Json::PullReader parser(contents, versions_file_path);
+        Json::Reader r(versions_file_path);
+        const bool is_object = parser.begin_object();
+        bool found_versions = false;
+        std::vector<Entry> db_entries;
+        if (is_object)
+        {
+            std::string key;
+            while (parser.next_member(key))
+            {
+                if (key == JsonIdVersions && parser.begin_array())
+                {
+                    found_versions = true;
+                    db_entries = r.array_elements_in_key(parser, JsonIdVersions, entry_deserializer)
+                                     .value_or_exit(VCPKG_LINE_INFO);
+                }
+                else
+                {
+                    parser.skip_value();
+                }
+            }
+        }
+        else
+        {
+            parser.skip_value();
+        }
+
+        auto finished = parser.finish();
+        if (!finished)
+        {
+            return std::move(finished).error();
+        }
+
+        if (!is_object)
+        {
+            return expected_an_object_error(versions_file_path);
+        }
+
+        if (!found_versions)
+        {
+            return msg::format_error(msgFailedToParseNoVersionsArray, msg::path = versions_file_path);
+        }
+
+        if (r.messages().any_errors())
+        {
+            return r.messages().join();
+        }
+
+        return db_entries;
+    }
+
     ExpectedL<Optional<std::vector<GitVersionDbEntry>>> load_git_versions_file_impl(const ReadOnlyFilesystem& fs,
                                                                                     const Path& versions_file_path)
     {
@@ -1356,25 +1459,7 @@ namespace
             return format_filesystem_call_error(ec, "read_contents", {versions_file_path});
         }
 
-        return Json::parse_object(contents, versions_file_path)
-            .then([&](Json::Object&& versions_json) -> ExpectedL<Optional<std::vector<GitVersionDbEntry>>> {
-                auto maybe_versions_array = versions_json.get(JsonIdVersions);
-                if (!maybe_versions_array || !maybe_versions_array->is_array())
-                {
-                    return msg::format_error(msgFailedToParseNoVersionsArray, msg::path = versions_file_path);
-                }
-
-                std::vector<GitVersionDbEntry> db_entries;
-                GitVersionDbEntryArrayDeserializer deserializer{};
-                Json::Reader r(versions_file_path);
-                r.visit_in_key(*maybe_versions_array, JsonIdVersions, db_entries, deserializer);
-                if (r.messages().any_errors())
-                {
-                    return r.messages().join();
-                }
-
-                return db_entries;
-            });
+        return parse_versions_file(contents, versions_file_path, GitVersionDbEntryDeserializer{});
     }
 
     ExpectedL<Optional<std::vector<FilesystemVersionDbEntry>>> load_filesystem_versions_file_impl(
@@ -1392,25 +1477,7 @@ namespace
             return format_filesystem_call_error(ec, "read_contents", {versions_file_path});
         }
 
-        return Json::parse_object(contents, versions_file_path)
-            .then([&](Json::Object&& versions_json) -> ExpectedL<Optional<std::vector<FilesystemVersionDbEntry>>> {
-                auto maybe_versions_array = versions_json.get(JsonIdVersions);
-                if (!maybe_versions_array || !maybe_versions_array->is_array())
-                {
-                    return msg::format_error(msgFailedToParseNoVersionsArray, msg::path = versions_file_path);
-                }
-
-                std::vector<FilesystemVersionDbEntry> db_entries;
-                FilesystemVersionDbEntryArrayDeserializer deserializer{registry_root};
-                Json::Reader r(versions_file_path);
-                r.visit_in_key(*maybe_versions_array, JsonIdVersions, db_entries, deserializer);
-                if (r.messages().any_errors())
-                {
-                    return r.messages().join();
-                }
-
-                return db_entries;
-            });
+        return parse_versions_file(contents, versions_file_path, FilesystemVersionDbEntryDeserializer{registry_root});
     }
 } // unnamed namespace
 
@@ -9,14 +9,30 @@ namespace vcpkg
 {
     StatusParagraphs::StatusParagraphs(std::vector<std::unique_ptr<StatusParagraph>>&& ps) : paragraphs(std::move(ps))
     {
+        for (size_t i = 0; i < paragraphs.size(); ++i)
+        {
+            index_paragraph(i);
+        }
+    }
+
+    void StatusParagraphs::index_paragraph(size_t index)
+    {
+        indices_by_name[paragraphs[index]->package.spec.name()].push_back(index);
     }
 
     std::vector<std::unique_ptr<StatusParagraph>*> StatusParagraphs::find_all(const std::string& name, Triplet triplet)
     {
         std::vector<std::unique_ptr<StatusParagraph>*> spghs;
-        for (auto&& p : *this)
+        auto indices = indices_by_name.find(name);
+        if (indices == indices_by_name.end())
         {
-            if (p->package.spec.name() == name && p->package.spec.triplet() == triplet)
+            return spghs;
+        }
+
+        for (auto it = indices->second.rbegin(); it != indices->second.rend(); ++it)
+        {
+            auto& p = paragraphs[*it];
+            if (p->package.spec.triplet() == triplet)
             {
                 if (p->package.is_feature())
                 {
@@ -34,11 +50,17 @@ namespace vcpkg
 
     Optional<InstalledPackageView> StatusParagraphs::get_installed_package_view(const PackageSpec& spec) const
     {
+        auto indices = indices_by_name.find(spec.name());
+        if (indices == indices_by_name.end())
+        {
+            return nullopt;
+        }
+
         InstalledPackageView ipv;
-        for (auto&& p : *this)
+        for (auto it = indices->second.rbegin(); it != indices->second.rend(); ++it)
         {
-            if (p->package.spec.name() == spec.name() && p->package.spec.triplet() == spec.triplet() &&
-                p->is_installed())
+            auto& p = paragraphs[*it];
+            if (p->package.spec.triplet() == spec.triplet() && p->is_installed())
             {
                 if (p->package.is_feature())
                 {
@@ -60,35 +82,40 @@ namespace vcpkg
         return nullopt;
     }
 
+    size_t StatusParagraphs::find_index(const std::string& name, Triplet triplet, const std::string& feature) const
+    {
+        // The core feature maps to .feature == ""
+        const StringView stored_feature = feature == FeatureNameCore ? StringView{} : StringView{feature};
+        auto indices = indices_by_name.find(name);
+        if (indices != indices_by_name.end())
+        {
+            for (auto it = indices->second.rbegin(); it != indices->second.rend(); ++it)
+            {
+                const auto& pgh = paragraphs[*it];
+                if (pgh->package.spec.triplet() == triplet && stored_feature == pgh->package.feature)
+                {
+                    return *it;
+                }
+            }
+        }
+
+        return SIZE_MAX;
+    }
+
     StatusParagraphs::iterator StatusParagraphs::find(const std::string& name,
                                                       Triplet triplet,
                                                       const std::string& feature)
     {
-        if (feature == FeatureNameCore)
-        {
-            // The core feature maps to .feature is empty
-            return find(name, triplet, {});
-        }
-        return std::find_if(begin(), end(), [&](const std::unique_ptr<StatusParagraph>& pgh) {
-            const PackageSpec& spec = pgh->package.spec;
-            return spec.name() == name && spec.triplet() == triplet && pgh->package.feature == feature;
-        });
+        const auto index = find_index(name, triplet, feature);
+        return index == SIZE_MAX ? end() : iterator_at(index);
     }
 
     StatusParagraphs::const_iterator StatusParagraphs::find(const std::string& name,
                                                             Triplet triplet,
                                                             const std::string& feature) const
     {
-        if (feature == FeatureNameCore)
-        {
-            // The core feature maps to .feature == ""
-            return find(name, triplet, "");
-        }
-
-        return std::find_if(begin(), end(), [&](const std::unique_ptr<StatusParagraph>& pgh) {
-            const PackageSpec& spec = pgh->package.spec;
-            return spec.name() == name && spec.triplet() == triplet && pgh->package.feature == feature;
-        });
+        const auto index = find_index(name, triplet, feature);
+        return index == SIZE_MAX ? end() : iterator_at(index);
     }
 
     StatusParagraphs::const_iterator StatusParagraphs::find_installed(const PackageSpec& spec) const
@@ -137,6 +164,7 @@ namespace vcpkg
         if (ptr == end())
         {
             paragraphs.push_back(std::move(pgh));
+            index_paragraph(paragraphs.size() - 1);
             return paragraphs.rbegin();
         }
 
@@ -20,6 +20,7 @@
 #include <vcpkg/versions.h>
 
 #include <map>
+#include <mutex>
 
 #include <fmt/ranges.h>
 
@@ -903,6 +904,30 @@ namespace vcpkg
         }
     };
 
+    // Calls `func` with the ToolProvider for `tool`. Tools which are found without one, such as tar, are not handled.
+    template<class Func>
+    static auto visit_tool_provider(StringView tool, Func&& func)
+    {
+        // These are specially handled, and may be found in locations like Program Files, the PATH etc as well as the
+        // auto-downloaded location.
+        if (tool == Tools::CMAKE) return func(CMakeProvider());
+        if (tool == Tools::GIT) return func(GitProvider());
+        if (tool == Tools::NINJA) return func(NinjaProvider());
+        if (tool == Tools::POWERSHELL_CORE) return func(PowerShellCoreProvider());
+        if (tool == Tools::NUGET) return func(NuGetProvider());
+        if (tool == Tools::NODE) return func(NodeProvider());
+        if (tool == Tools::MONO) return func(MonoProvider());
+        if (tool == Tools::GSUTIL) return func(GsutilProvider());
+        if (tool == Tools::AWSCLI) return func(AwsCliProvider());
+        if (tool == Tools::AZCOPY) return func(AzCopyProvider());
+        if (tool == Tools::AZCLI) return func(AzCliProvider());
+        if (tool == Tools::COSCLI) return func(CosCliProvider());
+        if (tool == Tools::PYTHON3) return func(Python3Provider());
+        if (tool == Tools::PYTHON3_WITH_VENV) return func(Python3WithVEnvProvider());
+        if (tool == Tools::SEVEN_ZIP || tool == Tools::SEVEN_ZIP_ALT) return func(SevenZipProvider());
+        return func(GenericToolProvider{tool});
+    }
+
     struct ToolCacheImpl final : ToolCache
     {
         AssetCachingSettings asset_cache_settings;
@@ -911,6 +936,9 @@ namespace vcpkg
         const Path tools;
         const RequireExactVersions abiToolVersionHandling;
 
+        // Tools are looked up from several threads when ports are loaded in parallel. The mutex is recursive because
+        // finding some tools requires finding others first.
+        mutable std::recursive_mutex m_mtx;
         ContextCache<std::string, PathAndVersion> path_version_cache;
         mutable Optional<ExpectedT<std::vector<ToolDataEntry>, std::vector<DiagnosticLine>>> m_tool_data_cache;
 
@@ -1062,34 +1090,85 @@ namespace vcpkg
             return nullptr;
         }
 
-        Optional<PathAndVersion> get_path(DiagnosticContext& context,
-                                          const Filesystem& fs,
-                                          const ToolProvider& tool) const
+        struct ToolSearch
+        {
+            Optional<ToolData> tool_data;
+            bool env_force_system_binaries;
+            bool download_available;
+            bool consider_system;
+            bool consider_downloads;
+            // The paths to consider, in order of preference; none of them has been run yet
+            std::vector<Path> candidate_paths;
+        };
+
+        Optional<ToolSearch> start_tool_search(DiagnosticContext& context,
+                                               const Filesystem& fs,
+                                               const ToolProvider& tool) const
         {
-            const bool env_force_system_binaries =
-                get_environment_variable(EnvironmentVariableVcpkgForceSystemBinaries).has_value();
-            const bool env_force_download_binaries =
-                get_environment_variable(EnvironmentVariableVcpkgForceDownloadedBinaries).has_value();
             auto maybe_all_tool_data = load_tool_data(context, fs);
             if (!maybe_all_tool_data)
             {
                 return nullopt;
             }
 
-            const auto maybe_tool_data = get_tool_data(*maybe_all_tool_data, tool.tool_data_name());
-            const bool download_available = download_is_available(maybe_tool_data);
+            ToolSearch search;
+            search.tool_data = get_tool_data(*maybe_all_tool_data, tool.tool_data_name());
+            search.env_force_system_binaries =
+                get_environment_variable(EnvironmentVariableVcpkgForceSystemBinaries).has_value();
+            const bool env_force_download_binaries =
+                get_environment_variable(EnvironmentVariableVcpkgForceDownloadedBinaries).has_value();
+            search.download_available = download_is_available(search.tool_data);
             // search for system searchable tools unless forcing downloads and download available
             const auto system_exe_stems = tool.system_exe_stems();
-            const bool consider_system =
-                !system_exe_stems.empty() && !(env_force_download_binaries && download_available);
+            search.consider_system =
+                !system_exe_stems.empty() && !(env_force_download_binaries && search.download_available);
             // search for downloaded tools unless forcing system search
-            const bool consider_downloads = !env_force_system_binaries || !consider_system;
+            search.consider_downloads = !search.env_force_system_binaries || !search.consider_system;
+
+            if (auto tool_data = search.tool_data.get())
+            {
+                if (search.consider_downloads && search.download_available)
+                {
+                    // If we would consider downloading the tool, prefer the downloaded copy
+                    search.candidate_paths.push_back(tool_data->exe_path(tools));
+                }
+            }
+
+            if (search.consider_system)
+            {
+                // If we are considering system copies, first search the PATH, then search any special system locations
+                // (e.g Program Files).
+                auto paths_from_path = fs.find_from_PATH(system_exe_stems);
+                search.candidate_paths.insert(
+                    search.candidate_paths.end(), paths_from_path.cbegin(), paths_from_path.cend());
+                tool.add_system_paths(context, fs, search.candidate_paths);
+            }
+
+            return search;
+        }
+
+        Optional<PathAndVersion> get_path(DiagnosticContext& context,
+                                          const Filesystem& fs,
+                                          const ToolProvider& tool) const
+        {
+            auto maybe_search = start_tool_search(context, fs, tool);
+            auto search = maybe_search.get();
+            if (!search)
+            {
+                return nullopt;
+            }
+
+            const auto& maybe_tool_data = search->tool_data;
+            const bool env_force_system_binaries = search->env_force_system_binaries;
+            const bool download_available = search->download_available;
+            const bool consider_system = search->consider_system;
+            const bool consider_downloads = search->consider_downloads;
+            auto& candidate_paths = search->candidate_paths;
 
             const bool exact_version = tool.is_abi_sensitive() && abiToolVersionHandling == RequireExactVersions::YES;
             // forcing system search also disables version detection
             const bool ignore_version = env_force_system_binaries || tool.ignore_version();
 
-            std::vector<Path> candidate_paths;
             std::array<int, 3> min_version = tool.default_min_version();
             const std::string* expected_exact_version = nullptr;
 
@@ -1109,21 +1188,6 @@ namespace vcpkg
                 {
                     min_version = version->cooked;
                 }
-
-                if (consider_downloads && download_available)
-                {
-                    // If we would consider downloading the tool, prefer the downloaded copy
-                    candidate_paths.push_back(tool_data->exe_path(tools));
-                }
-            }
-
-            if (consider_system)
-            {
-                // If we are considering system copies, first search the PATH, then search any special system locations
-                // (e.g Program Files).
-                auto paths_from_path = fs.find_from_PATH(system_exe_stems);
-                candidate_paths.insert(candidate_paths.end(), paths_from_path.cbegin(), paths_from_path.cend());
-                tool.add_system_paths(context, fs, candidate_paths);
             }
 
             std::string considered_versions;
@@ -1236,34 +1300,9 @@ namespace vcpkg
                                                    const Filesystem& fs,
                                                    StringView tool) const
         {
+            std::lock_guard<std::recursive_mutex> lock(m_mtx);
             return path_version_cache.get_lazy(
                 context, tool, [this, &fs, &tool](DiagnosticContext& inner_context) -> Optional<PathAndVersion> {
-                    // First deal with specially handled tools.
-                    // For these we may look in locations like Program Files, the PATH etc as well as the
-                    // auto-downloaded location.
-                    if (tool == Tools::CMAKE) return get_path(inner_context, fs, CMakeProvider());
-                    if (tool == Tools::GIT) return get_path(inner_context, fs, GitProvider());
-                    if (tool == Tools::NINJA) return get_path(inner_context, fs, NinjaProvider());
-                    if (tool == Tools::POWERSHELL_CORE) return get_path(inner_context, fs, PowerShellCoreProvider());
-                    if (tool == Tools::NUGET) return get_path(inner_context, fs, NuGetProvider());
-                    if (tool == Tools::NODE) return get_path(inner_context, fs, NodeProvider());
-                    if (tool == Tools::MONO) return get_path(inner_context, fs, MonoProvider());
-                    if (tool == Tools::GSUTIL) return get_path(inner_context, fs, GsutilProvider());
-                    if (tool == Tools::AWSCLI) return get_path(inner_context, fs, AwsCliProvider());
-                    if (tool == Tools::AZCOPY) return get_path(inner_context, fs, AzCopyProvider());
-                    if (tool == Tools::AZCLI) return get_path(inner_context, fs, AzCliProvider());
-                    if (tool == Tools::COSCLI) return get_path(inner_context, fs, CosCliProvider());
-                    if (tool == Tools::PYTHON3) return get_path(inner_context, fs, Python3Provider());
-                    if (tool == Tools::PYTHON3_WITH_VENV)
-                    {
-                        return get_path(inner_context, fs, Python3WithVEnvProvider());
-                    }
-
-                    if (tool == Tools::SEVEN_ZIP || tool == Tools::SEVEN_ZIP_ALT)
-                    {
-                        return get_path(inner_context, fs, SevenZipProvider());
-                    }
-
                     if (tool == Tools::TAR)
                     {
                         auto maybe_system_tar = find_system_tar(inner_context, fs);
@@ -1286,11 +1325,39 @@ namespace vcpkg
                         return nullopt;
                     }
 
-                    GenericToolProvider provider{tool};
-                    return get_path(inner_context, fs, provider);
+                    return visit_tool_provider(tool, [&](const ToolProvider& provider) {
+                        return get_path(inner_context, fs, provider);
+                    });
                 });
         }
 
+        virtual std::vector<Path> get_tool_candidates(DiagnosticContext& context,
+                                                      const Filesystem& fs,
+                                                      StringView tool) const override
+        {
+            if (tool == Tools::TAR || tool == Tools::CMAKE_SYSTEM)
+            {
+                auto maybe_path = tool == Tools::TAR ? find_system_tar(context, fs) : find_system_cmake(context, fs);
+                if (auto path = maybe_path.get())
+                {
+                    return {std::move(*path)};
+                }
+
+                return {};
+            }
+
+            std::lock_guard<std::recursive_mutex> lock(m_mtx);
+            return visit_tool_provider(tool, [&](const ToolProvider& provider) {
+                auto maybe_search = start_tool_search(context, fs, provider);
+                if (auto search = maybe_search.get())
+                {
+                    return std::move(search->candidate_paths);
+                }
+
+                return std::vector<Path>{};
+            });
+        }
+
         virtual const std::string* get_tool_version(DiagnosticContext& context,
                                                     const Filesystem& fs,
                                                     StringView tool) const override
@@ -3,10 +3,11 @@
 #include <vcpkg/base/contractual-constants.h>
 #include <vcpkg/base/downloads.h>
 #include <vcpkg/base/expected.h>
+#include <vcpkg/base/file-hash-cache.h>
 #include <vcpkg/base/files.h>
 #include <vcpkg/base/fmt.h>
+#include <vcpkg/base/git-objects.h>
 #include <vcpkg/base/git.h>
-#include <vcpkg/base/hash.h>
 #include <vcpkg/base/jsonreader.h>
 #include <vcpkg/base/lazy.h>
 #include <vcpkg/base/messages.h>
@@ -34,6 +35,8 @@
 #include <vcpkg/vcpkgpaths.h>
 #include <vcpkg/visualstudio.h>
 
+#include <mutex>
+
 namespace
 {
     using namespace vcpkg;
@@ -287,6 +290,8 @@ namespace
         Lazy<ToolsetsInformation> toolsets;
         Lazy<std::map<std::string, std::string>> cmake_script_hashes;
         Lazy<std::string> ports_cmake_hash;
+        Lazy<std::unique_ptr<FileHashCache>> file_hash_cache;
+        std::mutex m_installed_lock_mtx;
         Optional<vcpkg::LockFile> m_installed_lock;
     };
 
@@ -625,6 +630,9 @@ namespace vcpkg
 
         Optional<ManifestAndPath> m_manifest_doc;
         ConfigurationAndSource m_config;
+
+        std::mutex m_git_object_databases_mtx;
+        std::map<std::string, std::unique_ptr<GitObjectDatabase>, std::less<>> m_git_object_databases;
     };
 
     VcpkgPaths::VcpkgPaths(const Filesystem& filesystem, const VcpkgCmdArguments& args, const BundleSettings& bundle)
@@ -717,7 +725,7 @@ namespace vcpkg
                     continue;
                 }
                 helpers.emplace(file.stem().to_string(),
-                                Hash::get_file_hash(fs, file, Hash::Algorithm::Sha256).value_or_exit(VCPKG_LINE_INFO));
+                                this->get_file_hash_cache().get_file_sha256(fs, file).value_or_exit(VCPKG_LINE_INFO));
             }
             return helpers;
         });
@@ -726,13 +734,40 @@ namespace vcpkg
     StringView VcpkgPaths::get_ports_cmake_hash() const
     {
         return m_pimpl->ports_cmake_hash.get_lazy([this]() -> std::string {
-            return Hash::get_file_hash(get_filesystem(), ports_cmake, Hash::Algorithm::Sha256)
-                .value_or_exit(VCPKG_LINE_INFO);
+            return get_file_hash_cache().get_file_sha256(get_filesystem(), ports_cmake).value_or_exit(VCPKG_LINE_INFO);
+        });
+    }
+
+    FileHashCache& VcpkgPaths::get_file_hash_cache() const
+    {
+        return *m_pimpl->file_hash_cache.get_lazy([this]() {
+            auto mode = FileHashCacheMode::Enabled;
+            const auto maybe_setting = get_environment_variable(EnvironmentVariableXVcpkgFileHashCache);
+            if (auto setting = maybe_setting.get())
+            {
+                if (Strings::case_insensitive_ascii_equals(*setting, "off"))
+                {
+                    mode = FileHashCacheMode::Disabled;
+                }
+                else if (Strings::case_insensitive_ascii_equals(*setting, "strict"))
+                {
+                    mode = FileHashCacheMode::Strict;
+                }
+            }
+
+            Optional<Path> cache_file;
+            if (auto buildtrees_dir = m_pimpl->buildtrees.get())
+            {
+                cache_file = *buildtrees_dir / FileFileHashCacheDotJson;
+            }
+
+            return std::make_unique<FileHashCache>(get_filesystem(), mode, std::move(cache_file));
         });
     }
 
     LockFile& VcpkgPaths::get_installed_lockfile() const
     {
+        std::lock_guard<std::mutex> lock(m_pimpl->m_installed_lock_mtx);
         if (!m_pimpl->m_installed_lock.has_value())
         {
             m_pimpl->m_installed_lock = load_lockfile(get_filesystem(), installed().lockfile_path());
@@ -973,6 +1008,15 @@ namespace vcpkg
 
     ExpectedL<std::string> VcpkgPaths::git_show(StringView treeish, const Path& dot_git_dir) const
     {
+        if (auto objects = get_git_object_database(dot_git_dir))
+        {
+            auto maybe_blob = objects->read_blob(treeish);
+            if (auto blob = maybe_blob.get())
+            {
+                return std::move(*blob);
+            }
+        }
+
         SinkBufferedDiagnosticContext bdc{out_sink};
         if (const auto* git_tool_path = get_tool_path(bdc, Tools::GIT))
         {
@@ -989,6 +1033,25 @@ namespace vcpkg
         return LocalizedString::from_raw(bdc.to_string());
     }
 
+    GitObjectDatabase* VcpkgPaths::get_git_object_database(const Path& dot_git_dir) const
+    {
+        const auto maybe_setting = get_environment_variable(EnvironmentVariableXVcpkgGitObjectReader);
+        const auto setting = maybe_setting.get();
+        if (setting && Strings::case_insensitive_ascii_equals(*setting, "off"))
+        {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_pimpl->m_git_object_databases_mtx);
+        auto& objects = m_pimpl->m_git_object_databases[dot_git_dir.native()];
+        if (!objects)
+        {
+            objects = std::make_unique<GitObjectDatabase>(get_filesystem(), dot_git_dir);
+        }
+
+        return objects.get();
+    }
+
     Optional<std::vector<GitLSTreeEntry>> VcpkgPaths::get_builtin_ports_directory_trees(
         DiagnosticContext& context) const
     {
@@ -1142,8 +1205,17 @@ namespace vcpkg
     // hash
     ExpectedL<std::string> VcpkgPaths::git_show_from_remote_registry(StringView hash, const Path& relative_path) const
     {
-        SinkBufferedDiagnosticContext bdc{stderr_sink};
         auto revision = fmt::format("{}:{}", hash, relative_path.generic_u8string());
+        if (auto objects = get_git_object_database(m_pimpl->m_registries_dot_git_dir))
+        {
+            auto maybe_blob = objects->read_blob(revision);
+            if (auto blob = maybe_blob.get())
+            {
+                return std::move(*blob);
+            }
+        }
+
+        SinkBufferedDiagnosticContext bdc{stderr_sink};
         if (const auto* git_tool_path = get_tool_path(bdc, Tools::GIT))
         {
             auto cmd =
@@ -1162,8 +1234,17 @@ namespace vcpkg
     ExpectedL<std::string> VcpkgPaths::git_find_object_id_for_remote_registry_path(StringView hash,
                                                                                    const Path& relative_path) const
     {
-        SinkBufferedDiagnosticContext bdc{stderr_sink};
         auto revision = fmt::format("{}:{}", hash, relative_path.generic_u8string());
+        if (auto objects = get_git_object_database(m_pimpl->m_registries_dot_git_dir))
+        {
+            auto maybe_object_id = objects->resolve(revision);
+            if (auto object_id = maybe_object_id.get())
+            {
+                return std::move(*object_id);
+            }
+        }
+
+        SinkBufferedDiagnosticContext bdc{stderr_sink};
         if (const auto* git_tool_path = get_tool_path(bdc, Tools::GIT))
         {
             auto cmd =
@@ -1183,6 +1264,14 @@ namespace vcpkg
 
     ExpectedL<Unit> VcpkgPaths::git_read_tree(const Path& destination, StringView tree, const Path& dot_git_dir) const
     {
+        if (auto objects = get_git_object_database(dot_git_dir))
+        {
+            if (objects->extract_tree(get_filesystem(), tree, destination))
+            {
+                return Unit{};
+            }
+        }
+
         SinkBufferedDiagnosticContext bdc{out_sink};
         if (auto git_path = get_tool_path(bdc, Tools::GIT))
         {